@@ -0,0 +1,30 @@
+/**
+ * @file bench_util.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_BENCH_BENCH_UTIL_HH
+#define HORIZON_BENCH_BENCH_UTIL_HH
+
+#include <cstdint>
+
+namespace horizon
+{
+    namespace horizon_bench
+    {
+        // results are stored here, so the work producing them is not optimized out
+        inline volatile std::uint64_t sink;
+
+        // splitmix64, deterministic across runs
+        inline std::uint64_t next_random(std::uint64_t &state)
+        {
+            std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+    }
+}
+
+#endif
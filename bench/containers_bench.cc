@@ -0,0 +1,384 @@
+/**
+ * @file containers_bench.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./bench_util.hh"
+#include "../deps/hashtable/flat_hashtable.hh"
+#include "../deps/hashtable/hashtable.hh"
+#include "../deps/pair/inline_pair.hh"
+#include "../deps/pair/pair.hh"
+#include "../deps/string/string.hh"
+#include "../deps/vector/vector.hh"
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+    namespace hd = horizon::horizon_deps;
+    using horizon::horizon_bench::next_random;
+    using horizon::horizon_bench::sink;
+
+    constexpr std::size_t REPS = 5;
+
+    // elements (or characters) touched by one measurement, small sizes are repeated up to it
+    constexpr std::size_t WORK = 1 << 20;
+
+    /**
+     * @brief Best of `REPS` runs of `fn`, in nanoseconds per operation
+     */
+    template <typename F>
+    double best_ns(const std::size_t &ops, F &&fn)
+    {
+        double best = 0;
+        for (std::size_t r = 0; r < REPS; r++)
+        {
+            clock_type::time_point start = clock_type::now();
+            fn();
+            double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+            if (r == 0 || ns < best)
+                best = ns;
+        }
+        return best / static_cast<double>(ops ? ops : 1);
+    }
+
+    // `ratio` above 1 means the deps container is faster
+    void report(const char *test, const char *deps, const std::size_t &size, const double &deps_ns, const double &std_ns)
+    {
+        std::printf("%-22s %-16s %9zu %12.2f %12.2f %8.2fx\n", test, deps, size, deps_ns, std_ns, std_ns / deps_ns);
+    }
+
+    void bench_string(const std::size_t &n)
+    {
+        std::size_t rounds = (WORK / n ? WORK / n : 1);
+        hd::string src_d(hd::string('x', n));
+        std::string src_s(n, 'x');
+        const char chunk[] = "identifier_name_"; // 16 characters
+
+        double d = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   hd::string s;
+                                   for (std::size_t i = 0; i < n; i++)
+                                       s.append('x');
+                                   sink = s.length();
+                               } });
+        double s = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   std::string str;
+                                   for (std::size_t i = 0; i < n; i++)
+                                       str.push_back('x');
+                                   sink = str.length();
+                               } });
+        report("append char", "string", n, d, s);
+
+        std::size_t chunks = (n / 16 ? n / 16 : 1);
+        d = best_ns(rounds * chunks, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::string str;
+                            for (std::size_t i = 0; i < chunks; i++)
+                                str.append(chunk);
+                            sink = str.length();
+                        } });
+        s = best_ns(rounds * chunks, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            std::string str;
+                            for (std::size_t i = 0; i < chunks; i++)
+                                str.append(chunk);
+                            sink = str.length();
+                        } });
+        report("append 16 chars", "string", n, d, s);
+
+        for (const std::size_t &len : {std::size_t(8), std::size_t(64)})
+        {
+            if (len > n)
+                continue;
+            std::size_t span = n - len + 1;
+            char name[32];
+            std::snprintf(name, sizeof(name), "substr %zu", len);
+            d = best_ns(WORK, [&]()
+                        {
+                            std::size_t sum = 0;
+                            for (std::size_t i = 0; i < WORK; i++)
+                                sum += src_d.substr((i * 7) % span, len).length();
+                            sink = sum; });
+            s = best_ns(WORK, [&]()
+                        {
+                            std::size_t sum = 0;
+                            for (std::size_t i = 0; i < WORK; i++)
+                                sum += src_s.substr((i * 7) % span, len).length();
+                            sink = sum; });
+            report(name, "string", n, d, s);
+        }
+
+        hd::string other_d(src_d);
+        std::string other_s(src_s);
+        d = best_ns(rounds, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            sum += (src_d == other_d);
+                        sink = sum; });
+        s = best_ns(rounds, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            sum += (src_s == other_s);
+                        sink = sum; });
+        report("compare equal", "string", n, d, s);
+
+        d = best_ns(rounds, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            sum += src_d.hash();
+                        sink = sum; });
+        s = best_ns(rounds, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            sum += std::hash<std::string>()(src_s);
+                        sink = sum; });
+        report("hash", "string", n, d, s);
+    }
+
+    void bench_vector(const std::size_t &n)
+    {
+        std::size_t rounds = (WORK / n ? WORK / n : 1);
+        double d = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   hd::vector<std::size_t> v;
+                                   for (std::size_t i = 0; i < n; i++)
+                                       v.add(i);
+                                   sink = v.length();
+                               } });
+        double s = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   std::vector<std::size_t> v;
+                                   for (std::size_t i = 0; i < n; i++)
+                                       v.push_back(i);
+                                   sink = v.size();
+                               } });
+        report("add (growing)", "vector", n, d, s);
+
+        d = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::vector<std::size_t> v(n);
+                            for (std::size_t i = 0; i < n; i++)
+                                v.add(i);
+                            sink = v.length();
+                        } });
+        s = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            std::vector<std::size_t> v;
+                            v.reserve(n);
+                            for (std::size_t i = 0; i < n; i++)
+                                v.push_back(i);
+                            sink = v.size();
+                        } });
+        report("add (reserved)", "vector", n, d, s);
+
+        // growing moves every element, which for strings is a relocation in deps and a move in std
+        d = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::vector<hd::string> v;
+                            for (std::size_t i = 0; i < n; i++)
+                                v.add(hd::string("lexeme"));
+                            sink = v.length();
+                        } });
+        s = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            std::vector<std::string> v;
+                            for (std::size_t i = 0; i < n; i++)
+                                v.push_back(std::string("lexeme"));
+                            sink = v.size();
+                        } });
+        report("add string (growing)", "vector", n, d, s);
+    }
+
+    void bench_hashtable(const std::size_t &n)
+    {
+        std::size_t rounds = (WORK / n ? WORK / n : 1);
+        std::vector<std::size_t> keys(n);
+        std::uint64_t state = 42;
+        for (std::size_t i = 0; i < n; i++)
+            keys[i] = static_cast<std::size_t>(next_random(state));
+
+        double s = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   std::unordered_map<std::size_t, std::size_t> table;
+                                   for (std::size_t i = 0; i < n; i++)
+                                       table.emplace(keys[i], i);
+                                   sink = table.size();
+                               } });
+        double d = best_ns(rounds * n, [&]()
+                           {
+                               for (std::size_t r = 0; r < rounds; r++)
+                               {
+                                   hd::hashtable<std::size_t, std::size_t> table(16);
+                                   for (std::size_t i = 0; i < n; i++)
+                                       (void)table.append(keys[i], i);
+                                   sink = table.length();
+                               } });
+        report("insert (rehashing)", "hashtable", n, d, s);
+        d = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::flat_hashtable<std::size_t, std::size_t> table;
+                            for (std::size_t i = 0; i < n; i++)
+                                (void)table.append(keys[i], i);
+                            sink = table.length();
+                        } });
+        report("insert (rehashing)", "flat_hashtable", n, d, s);
+
+        s = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            std::unordered_map<std::size_t, std::size_t> table;
+                            table.reserve(n);
+                            for (std::size_t i = 0; i < n; i++)
+                                table.emplace(keys[i], i);
+                            sink = table.size();
+                        } });
+        d = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::hashtable<std::size_t, std::size_t> table(n + 1);
+                            for (std::size_t i = 0; i < n; i++)
+                                (void)table.append(keys[i], i);
+                            sink = table.length();
+                        } });
+        report("insert (sized)", "hashtable", n, d, s);
+        d = best_ns(rounds * n, [&]()
+                    {
+                        for (std::size_t r = 0; r < rounds; r++)
+                        {
+                            hd::flat_hashtable<std::size_t, std::size_t> table;
+                            table.reserve(n);
+                            for (std::size_t i = 0; i < n; i++)
+                                (void)table.append(keys[i], i);
+                            sink = table.length();
+                        } });
+        report("insert (sized)", "flat_hashtable", n, d, s);
+
+        std::unordered_map<std::size_t, std::size_t> std_table;
+        hd::hashtable<std::size_t, std::size_t> table(16);
+        hd::flat_hashtable<std::size_t, std::size_t> flat;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            std_table.emplace(keys[i], i);
+            (void)table.append(keys[i], i);
+            (void)flat.append(keys[i], i);
+        }
+        s = best_ns(rounds * n, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            for (std::size_t i = 0; i < n; i++)
+                                sum += std_table.find(keys[i])->second;
+                        sink = sum; });
+        d = best_ns(rounds * n, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            for (std::size_t i = 0; i < n; i++)
+                                sum += *table.find(keys[i]);
+                        sink = sum; });
+        report("lookup hit", "hashtable", n, d, s);
+        d = best_ns(rounds * n, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            for (std::size_t i = 0; i < n; i++)
+                                sum += *flat.find(keys[i]);
+                        sink = sum; });
+        report("lookup hit", "flat_hashtable", n, d, s);
+    }
+
+    void bench_pair(const std::size_t &n)
+    {
+        std::size_t rounds = (WORK / n ? WORK / n : 1);
+        double s = best_ns(rounds * n, [&]()
+                           {
+                               std::size_t sum = 0;
+                               for (std::size_t r = 0; r < rounds; r++)
+                                   for (std::size_t i = 0; i < n; i++)
+                                   {
+                                       std::pair<std::string, std::size_t> p(std::string("name"), i);
+                                       sum += p.second;
+                                   }
+                               sink = sum; });
+        double d = best_ns(rounds * n, [&]()
+                           {
+                               std::size_t sum = 0;
+                               for (std::size_t r = 0; r < rounds; r++)
+                                   for (std::size_t i = 0; i < n; i++)
+                                   {
+                                       hd::pair<hd::string, std::size_t> p(hd::string("name"), std::size_t(i));
+                                       sum += p.get_second();
+                                   }
+                               sink = sum; });
+        report("construct", "pair", n, d, s);
+        d = best_ns(rounds * n, [&]()
+                    {
+                        std::size_t sum = 0;
+                        for (std::size_t r = 0; r < rounds; r++)
+                            for (std::size_t i = 0; i < n; i++)
+                            {
+                                hd::inline_pair<hd::string, std::size_t> p(hd::string("name"), std::size_t(i));
+                                sum += p.get_second();
+                            }
+                        sink = sum; });
+        report("construct", "inline_pair", n, d, s);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t max_size = (argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : (1 << 20));
+    std::printf("best of %zu runs, ns per operation, ratio = std / deps\n", REPS);
+    std::printf("%-22s %-16s %9s %12s %12s %9s\n", "test", "container", "size", "deps ns", "std ns", "ratio");
+    for (std::size_t n = 16; n <= max_size; n *= 16)
+    {
+        bench_string(n);
+        bench_vector(n);
+        bench_hashtable(n);
+        bench_pair(n);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file hashtable_bench.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "./bench_util.hh"
+#include "../deps/hashtable/hashtable.hh"
+#include "../deps/hashtable/flat_hashtable.hh"
+#include "../deps/string/string.hh"
+#include "../deps/vector/vector.hh"
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+    using horizon::horizon_bench::next_random;
+    using horizon::horizon_bench::sink;
+
+    double elapsed_ms(const clock_type::time_point &start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    }
+
+    void report(const char *test, const char *table, const double &ms, const std::size_t &ops)
+    {
+        std::printf("%-22s %-16s %10.2f ms %8.1f ns/op\n", test, table, ms, ms * 1e6 / static_cast<double>(ops));
+    }
+
+    void bench_integers(const std::size_t &count)
+    {
+        horizon::horizon_deps::vector<std::size_t> keys(count);
+        std::uint64_t state = 42;
+        for (std::size_t i = 0; i < count; i++)
+            keys.add(static_cast<std::size_t>(next_random(state)));
+
+        {
+            horizon::horizon_deps::hashtable<std::size_t, std::size_t> table(16);
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                (void)table.append(keys[i], i);
+            report("int insert", "hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.get_value(keys[i]);
+            report("int lookup hit", "hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.contains(keys[i] + 1);
+            report("int lookup miss", "hashtable", elapsed_ms(start), count);
+            sink = sum;
+        }
+        {
+            std::unordered_map<std::size_t, std::size_t> table;
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                table.emplace(keys[i], i);
+            report("int insert", "unordered_map", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.find(keys[i])->second;
+            report("int lookup hit", "unordered_map", elapsed_ms(start), count);
+            start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.count(keys[i] + 1);
+            report("int lookup miss", "unordered_map", elapsed_ms(start), count);
+            sink = sum;
+        }
+        {
+            horizon::horizon_deps::flat_hashtable<std::size_t, std::size_t> table;
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                (void)table.append(keys[i], i);
+            report("int insert", "flat_hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += *table.find(keys[i]);
+            report("int lookup hit", "flat_hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.contains(keys[i] + 1);
+            report("int lookup miss", "flat_hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            horizon::horizon_deps::flat_hashtable<std::size_t, std::size_t> reserved;
+            reserved.reserve(count);
+            for (std::size_t i = 0; i < count; i++)
+                (void)reserved.append(keys[i], i);
+            report("int insert reserved", "flat_hashtable", elapsed_ms(start), count);
+            sink = sum;
+        }
+    }
+
+    void bench_strings(const std::size_t &count)
+    {
+        horizon::horizon_deps::vector<horizon::horizon_deps::string> keys(count);
+        char buffer[64];
+        std::uint64_t state = 7;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::snprintf(buffer, sizeof(buffer), "identifier_%llx", static_cast<unsigned long long>(next_random(state) & 0xffffffffULL));
+            keys.add(horizon::horizon_deps::string(buffer));
+        }
+
+        {
+            horizon::horizon_deps::hashtable<horizon::horizon_deps::string, std::size_t> table(16);
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                (void)table.append(keys[i], i);
+            report("string insert", "hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.get_value(keys[i]);
+            report("string lookup hit", "hashtable", elapsed_ms(start), count);
+            sink = sum;
+        }
+        {
+            std::unordered_map<std::string_view, std::size_t> table;
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                table.emplace(std::string_view(keys[i].c_str(), keys[i].length()), i);
+            report("string insert", "unordered_map", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += table.find(std::string_view(keys[i].c_str(), keys[i].length()))->second;
+            report("string lookup hit", "unordered_map", elapsed_ms(start), count);
+            sink = sum;
+        }
+        {
+            horizon::horizon_deps::flat_hashtable<horizon::horizon_deps::string, std::size_t, horizon::horizon_deps::flat_string_hash, horizon::horizon_deps::flat_string_equal> table;
+            clock_type::time_point start = clock_type::now();
+            for (std::size_t i = 0; i < count; i++)
+                (void)table.append(keys[i], i);
+            report("string insert", "flat_hashtable", elapsed_ms(start), count);
+            start = clock_type::now();
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < count; i++)
+                sum += *table.find(std::string_view(keys[i].c_str(), keys[i].length()));
+            report("string lookup hit", "flat_hashtable", elapsed_ms(start), count);
+            sink = sum;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t count = (argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 1000000);
+    std::printf("%zu keys\n", count);
+    bench_integers(count);
+    bench_strings(count / 4);
+    return EXIT_SUCCESS;
+}
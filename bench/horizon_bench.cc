@@ -0,0 +1,444 @@
+/**
+ * @file horizon_bench.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+#include "./bench_util.hh"
+#include "../deps/string/string.hh"
+#include "../deps/vector/vector.hh"
+#include "../src/lexer/lexer.hh"
+#include "../src/misc/load_file.hh"
+#include "../src/misc/out_buffer.hh"
+#include "../src/parser/parser.hh"
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+    using horizon::horizon_deps::string;
+    using horizon::horizon_deps::vector;
+    using horizon::horizon_bench::next_random;
+
+    void appendf(string &out, const char *fmt, ...)
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, fmt);
+        int len = std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        out.append(horizon::horizon_deps::str_view(buffer, static_cast<std::size_t>(len < static_cast<int>(sizeof(buffer)) ? len : sizeof(buffer) - 1)));
+    }
+
+    /**
+     * Corpus generators: every one of them writes the same source for the same `scale`, 2.5 to 8 MB at scale 1
+     */
+
+    // 100k small functions
+    void make_wide(string &out, const double &scale, std::uint64_t state)
+    {
+        std::size_t count = static_cast<std::size_t>(100000 * scale);
+        for (std::size_t i = 0; i < count; i++)
+            appendf(out, "func f%zu(int32: a, int32: b): int32 {\n    return a * %u + b;\n}\n", i, static_cast<unsigned>(next_random(state) % 1000));
+    }
+
+    // expressions nested 256 parentheses deep and blocks nested 64 deep
+    void make_deep(string &out, const double &scale, std::uint64_t state)
+    {
+        constexpr std::size_t EXPR_DEPTH = 256, BLOCK_DEPTH = 64;
+        std::size_t count = static_cast<std::size_t>(1000 * scale);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            appendf(out, "func d%zu(int32: a): int32 {\n", i);
+            for (std::size_t d = 0; d < BLOCK_DEPTH; d++)
+                out.append(d % 2 ? "while (a) {\n" : "if (a) {\n");
+            out.append("a -= 1;\n");
+            for (std::size_t d = 0; d < BLOCK_DEPTH; d++)
+                out.append("}\n");
+            out.append("return ");
+            for (std::size_t d = 0; d < EXPR_DEPTH; d++)
+                out.append('(');
+            out.append('a');
+            for (std::size_t d = 0; d < EXPR_DEPTH; d++)
+                appendf(out, " %c %u)", "+-*/"[d % 4], static_cast<unsigned>(next_random(state) % 97 + 1));
+            out.append(";\n}\n");
+        }
+    }
+
+    // huge string literals and tables of numbers
+    void make_literal(string &out, const double &scale, std::uint64_t state)
+    {
+        constexpr std::size_t STRING_LEN = 16 * 1024, TABLE_LEN = 512;
+        std::size_t count = static_cast<std::size_t>(200 * scale);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            appendf(out, "let: s%zu = \"", i);
+            for (std::size_t c = 0; c < STRING_LEN; c++)
+            {
+                std::uint64_t r = next_random(state);
+                if (r % 64 == 0)
+                    out.append("\\n");
+                else
+                    out.append(static_cast<char>('a' + r % 26));
+            }
+            out.append("\";\n");
+            appendf(out, "dec64: t%zu_0 = 0.5", i);
+            for (std::size_t c = 1; c < TABLE_LEN; c++)
+            {
+                std::uint64_t r = next_random(state);
+                if (r % 2)
+                    appendf(out, ", t%zu_%zu = %llu", i, c, static_cast<unsigned long long>(r % 4000000000ULL));
+                else
+                    appendf(out, ", t%zu_%zu = %llu.%03u", i, c, static_cast<unsigned long long>((r >> 8) % 100000), static_cast<unsigned>(r % 1000));
+            }
+            out.append(";\n");
+        }
+    }
+
+    // four fifths of the bytes are comments
+    void make_comment(string &out, const double &scale, std::uint64_t state)
+    {
+        std::size_t count = static_cast<std::size_t>(20000 * scale);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            out.append('`');
+            std::size_t words = 20 + next_random(state) % 40;
+            for (std::size_t w = 0; w < words; w++)
+                out.append(w % 12 == 11 ? "comment text\n" : "comment ");
+            out.append("`\n");
+            appendf(out, "func c%zu(): int32 {\n    `the return value` return %u; `trailing`\n}\n", i, static_cast<unsigned>(next_random(state) % 1000));
+        }
+    }
+
+    // long, mostly distinct identifiers
+    void make_identifier(string &out, const double &scale, std::uint64_t state)
+    {
+        std::size_t count = static_cast<std::size_t>(20000 * scale);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            unsigned long long a = next_random(state) & 0xffffffffffULL, b = next_random(state) & 0xffffffffffULL, c = next_random(state) & 0xffffffULL;
+            appendf(out, "func compute_%llx_value_%zu(int32: argument_%llx, int32: other_argument_%llx): int32 {\n", a, i, b, c);
+            appendf(out, "    int32: local_variable_%llx = argument_%llx + other_argument_%llx * shared_global_%llu;\n", a ^ b, b, c, static_cast<unsigned long long>(i % 512));
+            appendf(out, "    return compute_%llx_value_%zu(local_variable_%llx, argument_%llx);\n}\n", a, i, a ^ b, b);
+        }
+    }
+
+    struct shape
+    {
+        const char *M_name;
+        void (*M_make)(string &, const double &, std::uint64_t);
+    };
+
+    const shape SHAPES[] = {
+        {"wide", make_wide},
+        {"deep", make_deep},
+        {"literal", make_literal},
+        {"comment", make_comment},
+        {"identifier", make_identifier},
+    };
+
+    constexpr std::size_t PHASES = 3;
+    const char *const PHASE_NAMES[PHASES] = {"load", "lex", "parse"};
+
+    struct result
+    {
+        const char *M_shape;
+        const char *M_phase;
+        std::size_t M_bytes, M_tokens;
+        double M_min, M_p50, M_p90, M_p99, M_max, M_mean; // milliseconds
+    };
+
+    // nearest rank
+    double percentile(const vector<double> &sorted, const double &p)
+    {
+        std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.length()) + 0.999999);
+        return sorted[(rank == 0 ? 0 : rank - 1)];
+    }
+
+    double elapsed_ms(const clock_type::time_point &start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+    }
+
+    /**
+     * @brief Loads, lexes and parses `path` `warmup + reps` times and adds one result per phase, false if the corpus does not compile
+     */
+    bool measure(const char *shape_name, const char *path, const std::size_t &warmup, const std::size_t &reps, vector<result> &results)
+    {
+        vector<double> samples[PHASES];
+        std::size_t bytes = 0, tokens = 0;
+        for (std::size_t rep = 0; rep < warmup + reps; rep++)
+        {
+            double ms[PHASES];
+            clock_type::time_point start = clock_type::now();
+            horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> file = horizon::horizon_misc::load_file(path);
+            ms[0] = elapsed_ms(start);
+            if (!file)
+                return false;
+
+            start = clock_type::now();
+            horizon::horizon_lexer::lexer lex(file.raw());
+            bool ok = lex.init_lexing();
+            ms[1] = elapsed_ms(start);
+            if (!ok)
+                return false;
+            tokens = lex.get().length() - 1;
+
+            start = clock_type::now();
+            horizon::horizon_parser::parser parse(std::move(lex.move()), file.raw());
+            ok = parse.init_parsing();
+            ms[2] = elapsed_ms(start);
+            if (!ok)
+                return false;
+
+            bytes = file->M_content.length();
+            if (rep >= warmup)
+                for (std::size_t p = 0; p < PHASES; p++)
+                    samples[p].add(ms[p]);
+        }
+        for (std::size_t p = 0; p < PHASES; p++)
+        {
+            vector<double> &s = samples[p];
+            std::sort(s.begin(), s.end());
+            double sum = 0;
+            for (const double &v : s)
+                sum += v;
+            results.add(result{shape_name, PHASE_NAMES[p], bytes, tokens, s[0], percentile(s, 50), percentile(s, 90), percentile(s, 99), s[s.length() - 1], sum / static_cast<double>(s.length())});
+        }
+        return true;
+    }
+
+    double mb_per_s(const result &r)
+    {
+        return (r.M_p50 > 0 ? static_cast<double>(r.M_bytes) / (1024.0 * 1024.0) / (r.M_p50 / 1000.0) : 0);
+    }
+
+    void print_table(const vector<result> &results)
+    {
+        std::printf("%-11s %-6s %10s %10s %10s %10s %10s %10s %10s %12s\n", "shape", "phase", "MB", "min ms", "p50 ms", "p90 ms", "p99 ms", "max ms", "MB/s", "tokens/s");
+        for (const result &r : results)
+        {
+            double tokens_s = (r.M_p50 > 0 ? static_cast<double>(r.M_tokens) / (r.M_p50 / 1000.0) : 0);
+            std::printf("%-11s %-6s %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f %10.1f %12.0f\n", r.M_shape, r.M_phase, static_cast<double>(r.M_bytes) / (1024.0 * 1024.0),
+                        r.M_min, r.M_p50, r.M_p90, r.M_p99, r.M_max, mb_per_s(r), tokens_s);
+        }
+    }
+
+    /**
+     * @brief One result per line, so that `read_baseline` can find them again without a JSON parser
+     */
+    bool write_json(const char *path, const vector<result> &results, const double &scale, const std::size_t &warmup, const std::size_t &reps)
+    {
+        std::FILE *fptr = (std::strcmp(path, "-") == 0 ? stdout : std::fopen(path, "wb"));
+        if (!fptr)
+        {
+            std::fprintf(stderr, "horizon_bench: error: '%s' cannot be opened for writing: %s\n", path, std::strerror(errno));
+            return false;
+        }
+        std::fprintf(fptr, "{\"scale\":%g,\"warmup\":%zu,\"reps\":%zu,\"results\":[\n", scale, warmup, reps);
+        for (std::size_t i = 0; i < results.length(); i++)
+        {
+            const result &r = results[i];
+            std::fprintf(fptr, "{\"shape\":\"%s\",\"phase\":\"%s\",\"bytes\":%zu,\"tokens\":%zu,\"min_ms\":%.6f,\"p50_ms\":%.6f,\"p90_ms\":%.6f,\"p99_ms\":%.6f,\"max_ms\":%.6f,\"mean_ms\":%.6f,\"mb_per_s\":%.3f}%s\n",
+                         r.M_shape, r.M_phase, r.M_bytes, r.M_tokens, r.M_min, r.M_p50, r.M_p90, r.M_p99, r.M_max, r.M_mean, mb_per_s(r), (i + 1 < results.length() ? "," : ""));
+        }
+        std::fprintf(fptr, "]}\n");
+        if (fptr != stdout)
+            std::fclose(fptr);
+        return true;
+    }
+
+    /**
+     * @brief Median of `shape`/`phase` in a file written by `write_json` and the size of its corpus, a negative median if it has none
+     */
+    double baseline_p50(const string &json, const char *shape, const char *phase, std::size_t &bytes)
+    {
+        char key[128];
+        std::snprintf(key, sizeof(key), "{\"shape\":\"%s\",\"phase\":\"%s\",\"bytes\":", shape, phase);
+        const char *found = std::strstr(json.c_str(), key);
+        if (!found)
+            return -1;
+        bytes = static_cast<std::size_t>(std::strtoull(found + std::strlen(key), nullptr, 10));
+        const char *p50 = std::strstr(found, "\"p50_ms\":");
+        const char *end = std::strchr(found, '}');
+        if (!p50 || (end && p50 > end))
+            return -1;
+        return std::strtod(p50 + 9, nullptr);
+    }
+
+    /**
+     * @brief Prints the change of every median against `path` to `out` and returns the number of results slower by more than `threshold` percent
+     */
+    std::size_t compare_baseline(std::FILE *out, const char *path, const vector<result> &results, const double &threshold, bool &ok)
+    {
+        horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> file = horizon::horizon_misc::load_file(path);
+        ok = static_cast<bool>(file);
+        if (!ok)
+            return 0;
+        std::size_t regressions = 0;
+        std::fprintf(out, "\nagainst %s (regression above +%.1f%%)\n%-11s %-6s %12s %12s %9s\n", path, threshold, "shape", "phase", "base p50", "p50", "change");
+        for (const result &r : results)
+        {
+            std::size_t bytes = 0;
+            double base = baseline_p50(file->M_content, r.M_shape, r.M_phase, bytes);
+            if (base <= 0 || bytes != r.M_bytes)
+            {
+                // a shape the baseline does not have, or a corpus of another --scale
+                std::fprintf(out, "%-11s %-6s %12s %12.3f %9s\n", r.M_shape, r.M_phase, "-", r.M_p50, (base <= 0 ? "new" : "other size"));
+                continue;
+            }
+            double change = (r.M_p50 - base) / base * 100.0;
+            bool regressed = change > threshold;
+            regressions += regressed;
+            std::fprintf(out, "%-11s %-6s %12.3f %12.3f %+8.1f%%%s\n", r.M_shape, r.M_phase, base, r.M_p50, change, (regressed ? "  REGRESSION" : ""));
+        }
+        return regressions;
+    }
+
+    bool parse_size(const char *arg, const char *name, std::size_t &out)
+    {
+        char *end = nullptr;
+        unsigned long long val = std::strtoull(arg, &end, 10);
+        if (!*arg || *end)
+        {
+            std::fprintf(stderr, "horizon_bench: error: invalid value '%s' for '%s'\n", arg, name);
+            return false;
+        }
+        out = static_cast<std::size_t>(val);
+        return true;
+    }
+
+    bool parse_double(const char *arg, const char *name, double &out)
+    {
+        char *end = nullptr;
+        out = std::strtod(arg, &end);
+        if (!*arg || *end || out <= 0)
+        {
+            std::fprintf(stderr, "horizon_bench: error: invalid value '%s' for '%s'\n", arg, name);
+            return false;
+        }
+        return true;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: horizon_bench [--shape=all|wide|deep|literal|comment|identifier] [--scale=1] [--warmup=2] [--reps=10]\n"
+                             "                     [--json=<path>|-] [--baseline=<path>] [--threshold=5] [--dir=<path>] [--keep]\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *only = "all", *json = nullptr, *baseline = nullptr;
+    double scale = 1, threshold = 5;
+    std::size_t warmup = 2, reps = 10;
+    bool keep = false;
+    std::filesystem::path dir;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "--shape=", 8) == 0)
+            only = arg + 8;
+        else if (std::strncmp(arg, "--scale=", 8) == 0)
+        {
+            if (!parse_double(arg + 8, "--scale", scale))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--warmup=", 9) == 0)
+        {
+            if (!parse_size(arg + 9, "--warmup", warmup))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--reps=", 7) == 0)
+        {
+            if (!parse_size(arg + 7, "--reps", reps) || reps == 0)
+            {
+                std::fprintf(stderr, "horizon_bench: error: '--reps' must be positive\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strncmp(arg, "--json=", 7) == 0)
+            json = arg + 7;
+        else if (std::strncmp(arg, "--baseline=", 11) == 0)
+            baseline = arg + 11;
+        else if (std::strncmp(arg, "--threshold=", 12) == 0)
+        {
+            if (!parse_double(arg + 12, "--threshold", threshold))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--dir=", 6) == 0)
+            dir = arg + 6;
+        else if (std::strcmp(arg, "--keep") == 0)
+            keep = true;
+        else if (std::strcmp(arg, "--help") == 0)
+        {
+            usage();
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (dir.empty())
+        dir = std::filesystem::temp_directory_path();
+
+    vector<result> results;
+    bool any = false;
+    for (const shape &s : SHAPES)
+    {
+        if (std::strcmp(only, "all") != 0 && std::strcmp(only, s.M_name) != 0)
+            continue;
+        any = true;
+        string source;
+        s.M_make(source, scale, 42);
+        std::filesystem::path path = dir / (string("horizon_bench_") + s.M_name + ".hr").c_str();
+        std::FILE *fptr = std::fopen(path.string().c_str(), "wb");
+        if (!fptr || std::fwrite(source.c_str(), sizeof(char), source.length(), fptr) != source.length())
+        {
+            std::fprintf(stderr, "horizon_bench: error: '%s' cannot be opened for writing: %s\n", path.string().c_str(), std::strerror(errno));
+            if (fptr)
+                std::fclose(fptr);
+            return EXIT_FAILURE;
+        }
+        std::fclose(fptr);
+        bool ok = measure(s.M_name, path.string().c_str(), warmup, reps, results);
+        if (!keep)
+            std::filesystem::remove(path);
+        if (!ok)
+        {
+            std::fprintf(stderr, "horizon_bench: error: the '%s' corpus does not compile\n", s.M_name);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!any)
+    {
+        std::fprintf(stderr, "horizon_bench: error: unknown shape '%s'\n", only);
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    bool json_to_stdout = (json && std::strcmp(json, "-") == 0);
+    if (!json_to_stdout)
+        print_table(results);
+    if (json && !write_json(json, results, scale, warmup, reps))
+        return EXIT_FAILURE;
+    if (baseline)
+    {
+        bool ok;
+        std::size_t regressions = compare_baseline(json_to_stdout ? stderr : stdout, baseline, results, threshold, ok);
+        if (!ok || regressions)
+            return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file interner_bench.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "./bench_util.hh"
+#include "../deps/hashtable/concurrent_interner.hh"
+#include "../deps/hashtable/flat_hashtable.hh"
+#include "../deps/string/string.hh"
+#include "../deps/vector/vector.hh"
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+    using horizon::horizon_bench::next_random;
+    using horizon::horizon_bench::sink;
+
+    /**
+     * A token stream the way a lexer sees identifiers: a few names are very common (loop counters, `self`-like names),
+     * most are rare. Indices into `vocab` follow a roughly 1/x distribution.
+     */
+    struct corpus
+    {
+        horizon::horizon_deps::vector<horizon::horizon_deps::string> M_vocab;
+        horizon::horizon_deps::vector<std::uint32_t> M_stream;
+    };
+
+    void make_corpus(corpus &c, const std::size_t &vocab, const std::size_t &tokens)
+    {
+        char buffer[64];
+        std::uint64_t state = 11;
+        for (std::size_t i = 0; i < vocab; i++)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%s_%llx", (i % 3 == 0 ? "value" : (i % 3 == 1 ? "get_item" : "tmp")), static_cast<unsigned long long>(next_random(state) & 0xffffffULL));
+            c.M_vocab.add(horizon::horizon_deps::string(buffer));
+        }
+        for (std::size_t i = 0; i < tokens; i++)
+        {
+            double u = static_cast<double>(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+            std::size_t index = static_cast<std::size_t>(static_cast<double>(vocab) * u * u * u);
+            c.M_stream.add(static_cast<std::uint32_t>(index < vocab ? index : vocab - 1));
+        }
+    }
+
+    // the same work behind one global lock, what sharing a single-threaded table between threads would cost
+    class locked_table
+    {
+      private:
+        std::mutex M_lock;
+        horizon::horizon_deps::flat_hashtable<std::string_view, std::uint32_t> M_table;
+        std::uint32_t M_next = 0;
+
+      public:
+        std::uint32_t intern(const char *str, const std::size_t &len)
+        {
+            std::lock_guard<std::mutex> guard(this->M_lock);
+            std::string_view key(str, len);
+            const std::uint32_t *found = this->M_table.find(key);
+            if (found)
+                return *found;
+            (void)this->M_table.append(key, this->M_next);
+            return this->M_next++;
+        }
+    };
+
+    template <typename TABLE>
+    double run(TABLE &table, const corpus &c, const std::size_t &threads)
+    {
+        horizon::horizon_deps::vector<std::thread> pool(threads);
+        std::size_t per_thread = c.M_stream.length() / threads;
+        clock_type::time_point start = clock_type::now();
+        for (std::size_t t = 0; t < threads; t++)
+        {
+            pool.add(std::thread([&table, &c, t, per_thread]()
+                                 {
+                                     std::uint64_t sum = 0;
+                                     for (std::size_t i = t * per_thread; i < (t + 1) * per_thread; i++)
+                                     {
+                                         const horizon::horizon_deps::string &name = c.M_vocab[c.M_stream[i]];
+                                         sum += table.intern(name.c_str(), name.length());
+                                     }
+                                     sink = sum; }));
+        }
+        for (std::size_t t = 0; t < threads; t++)
+            pool[t].join();
+        return std::chrono::duration<double>(clock_type::now() - start).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t tokens = (argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : 4000000);
+    std::size_t vocab = (argc > 2 ? static_cast<std::size_t>(std::strtoull(argv[2], nullptr, 10)) : 100000);
+    corpus c;
+    make_corpus(c, vocab, tokens);
+    std::printf("%zu identifiers, %zu distinct names, %u hardware threads\n", tokens, vocab, std::thread::hardware_concurrency());
+    std::printf("%-8s %16s %16s %16s %10s\n", "threads", "interner cold", "interner warm", "global lock", "speedup");
+
+    double base = 0;
+    for (std::size_t threads = 1; threads <= 64; threads *= 2)
+    {
+        horizon::horizon_deps::concurrent_interner interner;
+        double cold = run(interner, c, threads);
+        double warm = run(interner, c, threads); // every name is already there, lookups only
+        locked_table locked;
+        double global = run(locked, c, threads);
+        std::size_t done = (tokens / threads) * threads;
+        if (threads == 1)
+            base = static_cast<double>(done) / warm;
+        std::printf("%-8zu %11.1f M/s %11.1f M/s %11.1f M/s %9.2fx\n", threads, static_cast<double>(done) / cold / 1e6, static_cast<double>(done) / warm / 1e6, static_cast<double>(done) / global / 1e6, static_cast<double>(done) / warm / base);
+    }
+    return EXIT_SUCCESS;
+}
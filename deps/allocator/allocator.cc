@@ -0,0 +1,320 @@
+/**
+ * @file allocator.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./allocator.hh"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        namespace
+        {
+            constexpr std::size_t ALIGN = alignof(std::max_align_t);
+
+            struct alignas(std::max_align_t) block_header
+            {
+                allocator *M_owner;
+                std::size_t M_size; // bytes usable after the header
+            };
+
+            constexpr std::size_t HEADER = sizeof(block_header);
+
+            thread_local allocator *current = nullptr;
+
+            inline std::size_t round_up(const std::size_t &size)
+            {
+                return (size + ALIGN - 1) & ~(ALIGN - 1);
+            }
+
+            inline block_header *header_of(void *ptr)
+            {
+                return reinterpret_cast<block_header *>(static_cast<char *>(ptr) - HEADER);
+            }
+        }
+
+        void *allocator::reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size)
+        {
+            void *block = this->allocate(new_size);
+            if (!block)
+                return nullptr;
+            if (ptr)
+            {
+                std::memcpy(block, ptr, old_size < new_size ? old_size : new_size);
+                this->deallocate(ptr, old_size);
+            }
+            return block;
+        }
+
+        void *malloc_allocator::allocate(const std::size_t &size)
+        {
+            return std::malloc(size);
+        }
+
+        void *malloc_allocator::reallocate(void *ptr, const std::size_t &, const std::size_t &new_size)
+        {
+            return std::realloc(ptr, new_size);
+        }
+
+        void malloc_allocator::deallocate(void *ptr, const std::size_t &)
+        {
+            std::free(ptr);
+        }
+
+        malloc_allocator &malloc_allocator::instance()
+        {
+            static malloc_allocator alloc;
+            return alloc;
+        }
+
+        arena_allocator::arena_allocator(const std::size_t &first_chunk, allocator &upstream)
+            : M_upstream(upstream), M_chunks(nullptr), M_curr(nullptr), M_end(nullptr), M_last(nullptr), M_next_chunk(round_up(first_chunk)), M_reserved(0) {}
+
+        void arena_allocator::new_chunk(const std::size_t &min_size)
+        {
+            std::size_t size = round_up(sizeof(chunk)) + min_size;
+            if (size < this->M_next_chunk)
+                size = this->M_next_chunk;
+            chunk *c = static_cast<chunk *>(this->M_upstream.allocate(size));
+            if (!c)
+                return;
+            c->M_next = this->M_chunks;
+            c->M_size = size;
+            this->M_chunks = c;
+            this->M_curr = reinterpret_cast<char *>(c) + round_up(sizeof(chunk));
+            this->M_end = reinterpret_cast<char *>(c) + size;
+            this->M_last = nullptr;
+            this->M_reserved += size;
+            // doubles up to 4 MiB so that big inputs do not end up with thousands of chunks
+            if (this->M_next_chunk < 4 * 1024 * 1024)
+                this->M_next_chunk *= 2;
+        }
+
+        void *arena_allocator::allocate(const std::size_t &size)
+        {
+            std::size_t rounded = round_up(size);
+            if (static_cast<std::size_t>(this->M_end - this->M_curr) < rounded)
+            {
+                this->new_chunk(rounded);
+                if (static_cast<std::size_t>(this->M_end - this->M_curr) < rounded)
+                    return nullptr;
+            }
+            this->M_last = this->M_curr;
+            this->M_curr += rounded;
+            return this->M_last;
+        }
+
+        void *arena_allocator::reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size)
+        {
+            if (ptr && ptr == this->M_last && static_cast<std::size_t>(this->M_end - this->M_last) >= round_up(new_size))
+            {
+                this->M_curr = this->M_last + round_up(new_size);
+                return ptr;
+            }
+            if (ptr && new_size <= old_size)
+                return ptr;
+            return allocator::reallocate(ptr, old_size, new_size);
+        }
+
+        void arena_allocator::deallocate(void *ptr, const std::size_t &)
+        {
+            if (ptr && ptr == this->M_last)
+            {
+                this->M_curr = this->M_last;
+                this->M_last = nullptr;
+            }
+        }
+
+        void arena_allocator::release()
+        {
+            while (this->M_chunks)
+            {
+                chunk *next = this->M_chunks->M_next;
+                this->M_upstream.deallocate(this->M_chunks, this->M_chunks->M_size);
+                this->M_chunks = next;
+            }
+            this->M_curr = this->M_end = this->M_last = nullptr;
+            this->M_reserved = 0;
+        }
+
+        void arena_allocator::reset()
+        {
+            chunk *keep = this->M_chunks;
+            if (!keep)
+                return;
+            for (chunk *c = keep->M_next; c;)
+            {
+                chunk *next = c->M_next;
+                this->M_reserved -= c->M_size;
+                this->M_upstream.deallocate(c, c->M_size);
+                c = next;
+            }
+            keep->M_next = nullptr;
+            this->M_curr = reinterpret_cast<char *>(keep) + round_up(sizeof(chunk));
+            this->M_end = reinterpret_cast<char *>(keep) + keep->M_size;
+            this->M_last = nullptr;
+        }
+
+        const std::size_t &arena_allocator::reserved() const
+        {
+            return this->M_reserved;
+        }
+
+        arena_allocator::~arena_allocator()
+        {
+            this->release();
+        }
+
+        pool_allocator::pool_allocator(allocator &upstream)
+            : M_upstream(upstream), M_free(), M_chunks(64 * 1024, upstream) {}
+
+        std::size_t pool_allocator::size_class(const std::size_t &size)
+        {
+            return size == 0 ? 0 : (size - 1) / GRANULE;
+        }
+
+        void *pool_allocator::allocate(const std::size_t &size)
+        {
+            if (size > MAX_POOLED)
+                return this->M_upstream.allocate(size);
+            std::size_t cls = pool_allocator::size_class(size);
+            if (this->M_free[cls])
+            {
+                free_block *block = this->M_free[cls];
+                this->M_free[cls] = block->M_next;
+                return block;
+            }
+            return this->M_chunks.allocate((cls + 1) * GRANULE);
+        }
+
+        void *pool_allocator::reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size)
+        {
+            if (ptr && old_size > MAX_POOLED && new_size > MAX_POOLED)
+                return this->M_upstream.reallocate(ptr, old_size, new_size);
+            if (ptr && old_size <= MAX_POOLED && new_size <= MAX_POOLED && pool_allocator::size_class(old_size) == pool_allocator::size_class(new_size))
+                return ptr;
+            return allocator::reallocate(ptr, old_size, new_size);
+        }
+
+        void pool_allocator::deallocate(void *ptr, const std::size_t &size)
+        {
+            if (!ptr)
+                return;
+            if (size > MAX_POOLED)
+            {
+                this->M_upstream.deallocate(ptr, size);
+                return;
+            }
+            free_block *block = static_cast<free_block *>(ptr);
+            std::size_t cls = pool_allocator::size_class(size);
+            block->M_next = this->M_free[cls];
+            this->M_free[cls] = block;
+        }
+
+        counting_allocator::counting_allocator(allocator &upstream, std::FILE *trace)
+            : M_upstream(upstream), M_trace(trace), M_stats() {}
+
+        void *counting_allocator::allocate(const std::size_t &size)
+        {
+            void *ptr = this->M_upstream.allocate(size);
+            if (ptr)
+            {
+                this->M_stats.M_allocs++;
+                this->M_stats.M_bytes += size;
+                this->M_stats.M_live += size;
+                if (this->M_stats.M_live > this->M_stats.M_peak)
+                    this->M_stats.M_peak = this->M_stats.M_live;
+            }
+            if (this->M_trace)
+                std::fprintf(this->M_trace, "allocate %zu -> %p\n", size, ptr);
+            return ptr;
+        }
+
+        void *counting_allocator::reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size)
+        {
+            void *block = this->M_upstream.reallocate(ptr, old_size, new_size);
+            if (block)
+            {
+                this->M_stats.M_reallocs++;
+                if (new_size > old_size)
+                    this->M_stats.M_bytes += new_size - old_size;
+                this->M_stats.M_live = this->M_stats.M_live - old_size + new_size;
+                if (this->M_stats.M_live > this->M_stats.M_peak)
+                    this->M_stats.M_peak = this->M_stats.M_live;
+            }
+            if (this->M_trace)
+                std::fprintf(this->M_trace, "reallocate %p %zu -> %zu -> %p\n", ptr, old_size, new_size, block);
+            return block;
+        }
+
+        void counting_allocator::deallocate(void *ptr, const std::size_t &size)
+        {
+            if (ptr)
+            {
+                this->M_stats.M_frees++;
+                this->M_stats.M_live -= size;
+            }
+            if (this->M_trace)
+                std::fprintf(this->M_trace, "deallocate %p %zu\n", ptr, size);
+            this->M_upstream.deallocate(ptr, size);
+        }
+
+        const allocator_stats &counting_allocator::stats() const
+        {
+            return this->M_stats;
+        }
+
+        allocator &current_allocator()
+        {
+            return current ? *current : malloc_allocator::instance();
+        }
+
+        allocator_scope::allocator_scope(allocator &alloc)
+            : M_prev(current)
+        {
+            current = &alloc;
+        }
+
+        allocator_scope::~allocator_scope()
+        {
+            current = this->M_prev;
+        }
+
+        void *allocate(const std::size_t &size)
+        {
+            allocator &owner = current_allocator();
+            block_header *header = static_cast<block_header *>(owner.allocate(HEADER + size));
+            if (!header)
+                return nullptr;
+            header->M_owner = &owner;
+            header->M_size = size;
+            return reinterpret_cast<char *>(header) + HEADER;
+        }
+
+        void *reallocate(void *ptr, const std::size_t &new_size)
+        {
+            if (!ptr)
+                return allocate(new_size);
+            block_header *header = header_of(ptr);
+            allocator *owner = header->M_owner;
+            header = static_cast<block_header *>(owner->reallocate(header, HEADER + header->M_size, HEADER + new_size));
+            if (!header)
+                return nullptr;
+            header->M_size = new_size;
+            return reinterpret_cast<char *>(header) + HEADER;
+        }
+
+        void deallocate(void *ptr)
+        {
+            if (!ptr)
+                return;
+            block_header *header = header_of(ptr);
+            header->M_owner->deallocate(header, HEADER + header->M_size);
+        }
+    }
+}
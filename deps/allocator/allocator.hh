@@ -0,0 +1,229 @@
+/**
+ * @file allocator.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_ALLOCATOR_ALLOCATOR_HH
+#define HORIZON_DEPS_ALLOCATOR_ALLOCATOR_HH
+
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../../src/misc/exit_heap_fail.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * Source of raw memory for every container in ./deps. Blocks are aligned to `alignof(std::max_align_t)`.
+         * None of the implementations below is thread-safe except `malloc_allocator`, an allocator belongs to the thread that installed it.
+         */
+        class allocator
+        {
+          public:
+            [[nodiscard]] virtual void *allocate(const std::size_t &size) = 0;
+
+            /**
+             * @brief Grows or shrinks `ptr` to `new_size` bytes keeping its first `min(old_size, new_size)` bytes, nullptr on failure
+             */
+            [[nodiscard]] virtual void *reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size);
+            virtual void deallocate(void *ptr, const std::size_t &size) = 0;
+            virtual ~allocator() = default;
+        };
+
+        /**
+         * @brief `malloc`/`realloc`/`free`, the default
+         */
+        class malloc_allocator final : public allocator
+        {
+          public:
+            [[nodiscard]] void *allocate(const std::size_t &size) override;
+            [[nodiscard]] void *reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size) override;
+            void deallocate(void *ptr, const std::size_t &size) override;
+
+            [[nodiscard]] static malloc_allocator &instance();
+        };
+
+        /**
+         * Bump allocator over chunks taken from `upstream`. `deallocate` only gives memory back when it was the last block handed out,
+         * everything else is freed at once by `release` or the destructor, in O(number of chunks).
+         */
+        class arena_allocator final : public allocator
+        {
+          private:
+            struct chunk
+            {
+                chunk *M_next;
+                std::size_t M_size;
+            };
+
+            allocator &M_upstream;
+            chunk *M_chunks;
+            char *M_curr, *M_end;
+            char *M_last; // last block handed out, can be grown or taken back in place
+            std::size_t M_next_chunk, M_reserved;
+
+          private:
+            void new_chunk(const std::size_t &min_size);
+
+          public:
+            arena_allocator(const std::size_t &first_chunk = 64 * 1024, allocator &upstream = malloc_allocator::instance());
+            arena_allocator(const arena_allocator &) = delete;
+            arena_allocator &operator=(const arena_allocator &) = delete;
+
+            [[nodiscard]] void *allocate(const std::size_t &size) override;
+            [[nodiscard]] void *reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size) override;
+            void deallocate(void *ptr, const std::size_t &size) override;
+
+            /**
+             * @brief Frees every chunk, all blocks handed out so far become invalid
+             */
+            void release();
+
+            /**
+             * @brief Like `release`, but keeps the newest (and largest) chunk to allocate from again
+             */
+            void reset();
+
+            /**
+             * @brief Bytes taken from upstream
+             */
+            [[nodiscard]] const std::size_t &reserved() const;
+            ~arena_allocator() override;
+        };
+
+        /**
+         * Free lists for blocks of up to `MAX_POOLED` bytes in steps of `alignof(std::max_align_t)`, carved out of chunks taken from `upstream`.
+         * Larger blocks are passed straight to `upstream`. Freed blocks are reused by the next allocation of the same size class.
+         */
+        class pool_allocator final : public allocator
+        {
+          public:
+            static constexpr std::size_t GRANULE = alignof(std::max_align_t);
+            static constexpr std::size_t MAX_POOLED = 512;
+            static constexpr std::size_t CLASSES = MAX_POOLED / GRANULE;
+
+          private:
+            struct free_block
+            {
+                free_block *M_next;
+            };
+
+            allocator &M_upstream;
+            free_block *M_free[CLASSES];
+            arena_allocator M_chunks;
+
+          private:
+            [[nodiscard]] static std::size_t size_class(const std::size_t &size);
+
+          public:
+            pool_allocator(allocator &upstream = malloc_allocator::instance());
+            pool_allocator(const pool_allocator &) = delete;
+            pool_allocator &operator=(const pool_allocator &) = delete;
+
+            [[nodiscard]] void *allocate(const std::size_t &size) override;
+            [[nodiscard]] void *reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size) override;
+            void deallocate(void *ptr, const std::size_t &size) override;
+        };
+
+        struct allocator_stats
+        {
+            std::size_t M_allocs = 0, M_reallocs = 0, M_frees = 0;
+            std::size_t M_bytes = 0; // total requested by allocate and by the growing part of reallocate
+            std::size_t M_live = 0, M_peak = 0;
+        };
+
+        /**
+         * Forwards to `upstream` and counts calls and bytes, writing one line per call to `trace` if it is not nullptr
+         */
+        class counting_allocator final : public allocator
+        {
+          private:
+            allocator &M_upstream;
+            std::FILE *M_trace;
+            allocator_stats M_stats;
+
+          public:
+            counting_allocator(allocator &upstream = malloc_allocator::instance(), std::FILE *trace = nullptr);
+            counting_allocator(const counting_allocator &) = delete;
+            counting_allocator &operator=(const counting_allocator &) = delete;
+
+            [[nodiscard]] void *allocate(const std::size_t &size) override;
+            [[nodiscard]] void *reallocate(void *ptr, const std::size_t &old_size, const std::size_t &new_size) override;
+            void deallocate(void *ptr, const std::size_t &size) override;
+
+            [[nodiscard]] const allocator_stats &stats() const;
+        };
+
+        /**
+         * @brief Allocator used by the calling thread for new blocks, `malloc_allocator::instance()` unless an `allocator_scope` is active
+         */
+        [[nodiscard]] allocator &current_allocator();
+
+        /**
+         * Makes `alloc` the calling thread's current allocator until the end of the scope. Blocks remember the allocator they came from,
+         * so they may be grown and freed after the scope ends, but `alloc` must outlive all of them.
+         */
+        class allocator_scope
+        {
+          private:
+            allocator *M_prev;
+
+          public:
+            allocator_scope(allocator &alloc);
+            allocator_scope(const allocator_scope &) = delete;
+            allocator_scope &operator=(const allocator_scope &) = delete;
+            ~allocator_scope();
+        };
+
+        /**
+         * @brief `size` bytes from the current allocator, nullptr on failure. The block records its allocator and size in a header in front of it
+         */
+        [[nodiscard]] void *allocate(const std::size_t &size);
+
+        /**
+         * @brief Resizes a block from `allocate` through the allocator it came from; `ptr` may be nullptr. Returns nullptr on failure
+         */
+        [[nodiscard]] void *reallocate(void *ptr, const std::size_t &new_size);
+
+        /**
+         * @brief Gives a block from `allocate` back to the allocator it came from; `ptr` may be nullptr
+         */
+        void deallocate(void *ptr);
+
+        /**
+         * @brief `new T(args...)` in a block from `allocate`, exits on allocation failure
+         */
+        template <typename T, typename... ARGS>
+        [[nodiscard]] T *create(ARGS &&...args)
+        {
+            void *ptr = allocate(sizeof(T));
+            horizon_misc::exit_heap_fail(ptr, "horizon::horizon_deps::create");
+            return ::new (ptr) T(std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * @brief Destroys an object from `create` (or from a class whose `operator new` is `allocate`) and frees its block
+         */
+        template <typename T>
+        void destroy(T *ptr)
+        {
+            if (!ptr)
+                return;
+            void *block;
+            if constexpr (std::is_polymorphic_v<T>)
+                block = const_cast<void *>(dynamic_cast<const volatile void *>(ptr)); // the most derived object starts the block
+            else
+                block = const_cast<void *>(static_cast<const volatile void *>(ptr));
+            ptr->~T();
+            deallocate(block);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file hash.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./hash.hh"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HORIZON_HASH_AES
+#include <immintrin.h>
+#endif
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        namespace
+        {
+            constexpr std::uint64_t SECRET[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+            // 64x64 -> 128 bit multiply, `a` gets the low half and `b` the high half
+            inline void mul128(std::uint64_t &a, std::uint64_t &b)
+            {
+#if defined(__SIZEOF_INT128__)
+                __extension__ typedef unsigned __int128 u128;
+                u128 r = static_cast<u128>(a) * b;
+                a = static_cast<std::uint64_t>(r);
+                b = static_cast<std::uint64_t>(r >> 64);
+#else
+                std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+                std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+                std::uint64_t c = t < rl;
+                std::uint64_t lo = t + (rm1 << 32);
+                c += lo < t;
+                a = lo;
+                b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+            }
+
+            // both halves of the product folded together
+            inline std::uint64_t mum(std::uint64_t a, std::uint64_t b)
+            {
+                mul128(a, b);
+                return a ^ b;
+            }
+
+            inline std::uint64_t read64(const unsigned char *p)
+            {
+                std::uint64_t v;
+                std::memcpy(&v, p, 8);
+                return v;
+            }
+
+            inline std::uint64_t read32(const unsigned char *p)
+            {
+                std::uint32_t v;
+                std::memcpy(&v, p, 4);
+                return v;
+            }
+
+            std::uint64_t hash_scalar(const unsigned char *p, const std::size_t &len, std::uint64_t seed)
+            {
+                seed ^= mum(seed ^ SECRET[0], SECRET[1]);
+                std::uint64_t a, b;
+                if (len <= 16)
+                {
+                    if (len >= 4)
+                    {
+                        // two overlapping 4-byte reads from each end cover 4..16 bytes
+                        std::size_t off = (len >> 3) << 2;
+                        a = (read32(p) << 32) | read32(p + off);
+                        b = (read32(p + len - 4) << 32) | read32(p + len - 4 - off);
+                    }
+                    else if (len > 0)
+                    {
+                        a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+                        b = 0;
+                    }
+                    else
+                        a = b = 0;
+                }
+                else
+                {
+                    std::size_t i = len;
+                    if (i > 48)
+                    {
+                        std::uint64_t see1 = seed, see2 = seed;
+                        do
+                        {
+                            seed = mum(read64(p) ^ SECRET[1], read64(p + 8) ^ seed);
+                            see1 = mum(read64(p + 16) ^ SECRET[2], read64(p + 24) ^ see1);
+                            see2 = mum(read64(p + 32) ^ SECRET[3], read64(p + 40) ^ see2);
+                            p += 48;
+                            i -= 48;
+                        } while (i > 48);
+                        seed ^= see1 ^ see2;
+                    }
+                    while (i > 16)
+                    {
+                        seed = mum(read64(p) ^ SECRET[1], read64(p + 8) ^ seed);
+                        p += 16;
+                        i -= 16;
+                    }
+                    a = read64(p + i - 16);
+                    b = read64(p + i - 8);
+                }
+                a ^= SECRET[1];
+                b ^= seed;
+                mul128(a, b);
+                return mum(a ^ SECRET[0] ^ len, b ^ SECRET[1]);
+            }
+
+#ifdef HORIZON_HASH_AES
+            __attribute__((target("aes,sse2"))) std::uint64_t hash_aes(const unsigned char *p, const std::size_t &len, const std::uint64_t &seed)
+            {
+                // two lanes of one AES round per 16 bytes, needs len >= 32
+                const __m128i key = _mm_set_epi64x(static_cast<long long>(SECRET[1]), static_cast<long long>(SECRET[0] ^ seed ^ len));
+                __m128i s0 = key;
+                __m128i s1 = _mm_set_epi64x(static_cast<long long>(SECRET[3]), static_cast<long long>(SECRET[2] ^ seed));
+                const unsigned char *q = p;
+                std::size_t i = len;
+                while (i > 32)
+                {
+                    s0 = _mm_aesenc_si128(_mm_xor_si128(s0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(q))), key);
+                    s1 = _mm_aesenc_si128(_mm_xor_si128(s1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(q + 16))), key);
+                    q += 32;
+                    i -= 32;
+                }
+                // the last 32 bytes, overlapping the previous block when `len` is not a multiple of 32
+                s0 = _mm_aesenc_si128(_mm_xor_si128(s0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + len - 32))), key);
+                s1 = _mm_aesenc_si128(_mm_xor_si128(s1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + len - 16))), key);
+                __m128i s = _mm_aesenc_si128(s0, s1);
+                s = _mm_aesenc_si128(s, key);
+                s = _mm_aesenc_si128(s, key);
+                std::uint64_t lo = static_cast<std::uint64_t>(_mm_cvtsi128_si64(s));
+                std::uint64_t hi = static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s)));
+                return mum(lo ^ SECRET[0], hi ^ SECRET[1]);
+            }
+
+            bool cpu_has_aes()
+            {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("aes");
+            }
+#endif
+        }
+
+        std::size_t hash_bytes(const void *data, const std::size_t &len, const std::uint64_t &seed)
+        {
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+#ifdef HORIZON_HASH_AES
+            if (len >= 64)
+            {
+                static const bool has_aes = cpu_has_aes();
+                if (has_aes)
+                    return static_cast<std::size_t>(hash_aes(p, len, seed));
+            }
+#endif
+            return static_cast<std::size_t>(hash_scalar(p, len, seed));
+        }
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * @file hash.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_HASH_HASH_HH
+#define HORIZON_DEPS_HASH_HASH_HH
+
+#include <cstddef>
+#include <cstdint>
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * @brief Non-cryptographic 64-bit hash of `len` bytes (wyhash), read 8 bytes at a time.
+         * Keys of 64 bytes or more go through AES-NI when the CPU has it, so values differ between machines and must never be stored
+         */
+        [[nodiscard]] std::size_t hash_bytes(const void *data, const std::size_t &len, const std::uint64_t &seed = 0);
+
+        /**
+         * @brief Scrambles every bit of `hash` into every other bit, for hashes (e.g. `std::hash` of an integer) that are not already mixed
+         */
+        [[nodiscard]] inline std::size_t hash_mix(const std::size_t &hash)
+        {
+            std::uint64_t h = static_cast<std::uint64_t>(hash);
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<std::size_t>(h ^ (h >> 31));
+        }
+    }
+}
+
+#endif
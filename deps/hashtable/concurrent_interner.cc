@@ -0,0 +1,268 @@
+/**
+ * @file concurrent_interner.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./concurrent_interner.hh"
+
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "../../src/misc/exit_heap_fail.hh"
+#include "../../src/misc/stats.hh"
+#include "../../src/colorize/colorize.h"
+#include "../../src/defines/defines.h"
+#include "../hash/hash.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        namespace
+        {
+            constexpr std::size_t CHARS_CHUNK = 64 * 1024;
+
+            inline std::size_t segment_of(const std::uint32_t &id)
+            {
+                return static_cast<std::size_t>(std::bit_width(static_cast<std::uint32_t>(id >> 10)));
+            }
+
+            inline std::size_t segment_base(const std::size_t &seg)
+            {
+                return seg == 0 ? 0 : (std::size_t(1024) << (seg - 1));
+            }
+
+            inline std::size_t segment_size(const std::size_t &seg)
+            {
+                return seg == 0 ? 1024 : (std::size_t(1024) << (seg - 1));
+            }
+
+            // the low 6 bits pick the shard, the position in the shard's table starts above them
+            inline std::size_t slot_pos(const std::size_t &hash, const std::size_t &cap)
+            {
+                return (hash >> 6) & (cap - 1);
+            }
+
+            inline std::uint64_t slot_tag(const std::size_t &hash)
+            {
+                return static_cast<std::uint64_t>(hash) & 0xffffffff00000000ULL;
+            }
+        }
+
+        concurrent_interner::table *concurrent_interner::new_table(const std::size_t &cap)
+        {
+            table *t = static_cast<table *>(std::calloc(1, sizeof(table)));
+            horizon_misc::exit_heap_fail(t, "horizon::horizon_deps::concurrent_interner");
+            t->M_slots = static_cast<std::atomic<std::uint64_t> *>(std::malloc(cap * sizeof(std::atomic<std::uint64_t>)));
+            horizon_misc::exit_heap_fail(t->M_slots, "horizon::horizon_deps::concurrent_interner");
+            for (std::size_t i = 0; i < cap; i++)
+                ::new (static_cast<void *>(t->M_slots + i)) std::atomic<std::uint64_t>(0);
+            t->M_cap = cap;
+            t->M_prev = nullptr;
+            return t;
+        }
+
+        const concurrent_interner::entry &concurrent_interner::entry_at(const std::uint32_t &id) const
+        {
+            std::size_t seg = segment_of(id);
+            return this->M_segments[seg].load(std::memory_order_acquire)[id - segment_base(seg)];
+        }
+
+        concurrent_interner::entry &concurrent_interner::new_entry(const std::uint32_t &id)
+        {
+            std::size_t seg = segment_of(id);
+            entry *block = this->M_segments[seg].load(std::memory_order_acquire);
+            if (!block)
+            {
+                std::lock_guard<std::mutex> guard(this->M_segment_lock);
+                block = this->M_segments[seg].load(std::memory_order_relaxed);
+                if (!block)
+                {
+                    block = static_cast<entry *>(std::malloc(segment_size(seg) * sizeof(entry)));
+                    horizon_misc::exit_heap_fail(block, "horizon::horizon_deps::concurrent_interner");
+                    this->M_segments[seg].store(block, std::memory_order_release);
+                }
+            }
+            return block[id - segment_base(seg)];
+        }
+
+        std::uint32_t concurrent_interner::find(const table *t, const std::size_t &hash, const char *str, const std::size_t &len, std::size_t &pos) const
+        {
+            std::uint64_t tag = slot_tag(hash);
+            pos = slot_pos(hash, t->M_cap);
+            horizon_misc::probe_counter probes;
+            for (;;)
+            {
+                probes.step();
+                std::uint64_t slot = t->M_slots[pos].load(std::memory_order_acquire);
+                if (slot == 0)
+                    return NULL_ID;
+                if ((slot & 0xffffffff00000000ULL) == tag)
+                {
+                    std::uint32_t id = static_cast<std::uint32_t>(slot) - 1;
+                    const entry &e = this->entry_at(id);
+                    if (e.M_length == len && std::memcmp(e.M_str, str, len) == 0)
+                        return id;
+                }
+                pos = (pos + 1) & (t->M_cap - 1);
+            }
+        }
+
+        const char *concurrent_interner::store_chars(shard &s, const char *str, const std::size_t &len)
+        {
+            if (static_cast<std::size_t>(s.M_chars_end - s.M_chars) < len + 1)
+            {
+                std::size_t size = (len + 1 > CHARS_CHUNK ? len + 1 : CHARS_CHUNK);
+                chars_chunk *chunk = static_cast<chars_chunk *>(std::malloc(sizeof(chars_chunk) + size));
+                // not `chunk` itself, nothing in it is written yet
+                if (!chunk)
+                    horizon_misc::exit_heap_fail(nullptr, "horizon::horizon_deps::concurrent_interner");
+                chunk->M_next = s.M_chunks;
+                s.M_chunks = chunk;
+                s.M_chars = reinterpret_cast<char *>(chunk + 1);
+                s.M_chars_end = s.M_chars + size;
+            }
+            char *dest = s.M_chars;
+            std::memcpy(dest, str, len);
+            dest[len] = 0;
+            s.M_chars += len + 1;
+            return dest;
+        }
+
+        void concurrent_interner::grow(shard &s)
+        {
+            table *old = s.M_table.load(std::memory_order_relaxed);
+            table *t = concurrent_interner::new_table(old->M_cap * 2);
+            horizon_misc::count(horizon_misc::stat_counter::STAT_HASHTABLE_REHASHES);
+            for (std::size_t i = 0; i < old->M_cap; i++)
+            {
+                std::uint64_t slot = old->M_slots[i].load(std::memory_order_relaxed);
+                if (slot == 0)
+                    continue;
+                std::size_t pos = slot_pos(this->entry_at(static_cast<std::uint32_t>(slot) - 1).M_hash, t->M_cap);
+                while (t->M_slots[pos].load(std::memory_order_relaxed) != 0)
+                    pos = (pos + 1) & (t->M_cap - 1);
+                t->M_slots[pos].store(slot, std::memory_order_relaxed);
+            }
+            t->M_prev = old;
+            s.M_table.store(t, std::memory_order_release);
+        }
+
+        void concurrent_interner::start()
+        {
+            for (std::size_t i = 0; i < SEGMENTS; i++)
+                this->M_segments[i].store(nullptr, std::memory_order_relaxed);
+            for (shard &s : this->M_shards)
+            {
+                s.M_table.store(concurrent_interner::new_table(64), std::memory_order_relaxed);
+                s.M_count = 0;
+                s.M_chunks = nullptr;
+                s.M_chars = s.M_chars_end = nullptr;
+            }
+        }
+
+        void concurrent_interner::release()
+        {
+            for (shard &s : this->M_shards)
+            {
+                table *t = s.M_table.load(std::memory_order_relaxed);
+                while (t)
+                {
+                    table *prev = t->M_prev;
+                    std::free(static_cast<void *>(t->M_slots));
+                    std::free(t);
+                    t = prev;
+                }
+                while (s.M_chunks)
+                {
+                    chars_chunk *next = s.M_chunks->M_next;
+                    std::free(s.M_chunks);
+                    s.M_chunks = next;
+                }
+            }
+            for (std::size_t i = 0; i < SEGMENTS; i++)
+                std::free(this->M_segments[i].load(std::memory_order_relaxed));
+        }
+
+        concurrent_interner::concurrent_interner()
+            : M_next_id(0)
+        {
+            this->start();
+        }
+
+        std::uint32_t concurrent_interner::intern(const char *str, const std::size_t &len)
+        {
+            if (!str)
+                return NULL_ID;
+            std::size_t hash = hash_bytes(str, len);
+            shard &s = this->M_shards[hash & (SHARDS - 1)];
+            std::size_t pos;
+            std::uint32_t id = this->find(s.M_table.load(std::memory_order_acquire), hash, str, len, pos);
+            if (id != NULL_ID)
+                return id;
+
+            std::lock_guard<std::mutex> guard(s.M_lock);
+            // another thread may have added it (or grown the table) since the lookup above
+            table *t = s.M_table.load(std::memory_order_relaxed);
+            id = this->find(t, hash, str, len, pos);
+            if (id != NULL_ID)
+                return id;
+
+            id = this->M_next_id.fetch_add(1, std::memory_order_relaxed);
+            if (id == NULL_ID)
+            {
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " " ENCLOSE(WHITE_FG, "horizon::horizon_deps::concurrent_interner:") " more than %u strings\n", NULL_ID);
+                else
+                    std::fprintf(stderr, "horizon: error: horizon::horizon_deps::concurrent_interner: more than %u strings\n", NULL_ID);
+                std::exit(EXIT_FAILURE);
+            }
+            entry &e = this->new_entry(id);
+            e.M_str = concurrent_interner::store_chars(s, str, len);
+            e.M_length = len;
+            e.M_hash = hash;
+            // publishes the entry written above to every reader that sees the slot
+            t->M_slots[pos].store(slot_tag(hash) | (static_cast<std::uint64_t>(id) + 1), std::memory_order_release);
+
+            // keep the load factor under 1/2 so that probes stay short
+            if (++s.M_count * 2 > t->M_cap)
+                this->grow(s);
+            return id;
+        }
+
+        const char *concurrent_interner::get(const std::uint32_t &id) const
+        {
+            if (id == NULL_ID)
+                return nullptr;
+            return this->entry_at(id).M_str;
+        }
+
+        std::size_t concurrent_interner::length(const std::uint32_t &id) const
+        {
+            if (id == NULL_ID)
+                return 0;
+            return this->entry_at(id).M_length;
+        }
+
+        std::uint32_t concurrent_interner::count() const
+        {
+            return this->M_next_id.load(std::memory_order_acquire);
+        }
+
+        void concurrent_interner::clear()
+        {
+            this->release();
+            this->start();
+            this->M_next_id.store(0, std::memory_order_release);
+        }
+
+        concurrent_interner::~concurrent_interner()
+        {
+            this->release();
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file concurrent_interner.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_HASHTABLE_CONCURRENT_INTERNER_HH
+#define HORIZON_DEPS_HASHTABLE_CONCURRENT_INTERNER_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * Insert-only string -> id map that any number of threads may use at once. Ids are dense, start at 0 and never change;
+         * the characters of an id never move either, so `get` pointers stay valid until the interner is destroyed or cleared.
+         * The keys are split over `SHARDS` open-addressing tables by hash. Looking up a string that is already interned and
+         * `get`/`length` take no lock and finish in a bounded number of steps; inserting a new string locks only its shard.
+         * A table that grows is replaced, the old one is kept (readers may still be probing it) until the interner is destroyed or cleared.
+         */
+        class concurrent_interner
+        {
+          public:
+            static constexpr std::uint32_t NULL_ID = static_cast<std::uint32_t>(-1);
+            static constexpr std::size_t SHARDS = 64;
+
+          private:
+            struct entry
+            {
+                const char *M_str;
+                std::size_t M_length;
+                std::size_t M_hash;
+            };
+
+            // slot = (upper 32 bits of the hash) << 32 | (id + 1), 0 if empty
+            struct table
+            {
+                std::size_t M_cap; // power of 2
+                std::atomic<std::uint64_t> *M_slots;
+                table *M_prev; // retired tables
+            };
+
+            struct chars_chunk
+            {
+                chars_chunk *M_next;
+            };
+
+            struct alignas(64) shard
+            {
+                std::mutex M_lock;
+                std::atomic<table *> M_table;
+                std::size_t M_count;
+                chars_chunk *M_chunks;
+                char *M_chars, *M_chars_end;
+            };
+
+            // segment 0 holds ids [0, FIRST_SEGMENT), segment k > 0 holds [FIRST_SEGMENT << (k - 1), FIRST_SEGMENT << k)
+            static constexpr std::size_t FIRST_SEGMENT_BITS = 10;
+            static constexpr std::size_t FIRST_SEGMENT = std::size_t(1) << FIRST_SEGMENT_BITS;
+            static constexpr std::size_t SEGMENTS = 32 - FIRST_SEGMENT_BITS + 1;
+
+            std::atomic<entry *> M_segments[SEGMENTS];
+            std::mutex M_segment_lock;
+            std::atomic<std::uint32_t> M_next_id;
+            shard M_shards[SHARDS];
+
+          private:
+            [[nodiscard]] static table *new_table(const std::size_t &cap);
+            [[nodiscard]] const entry &entry_at(const std::uint32_t &id) const;
+            [[nodiscard]] entry &new_entry(const std::uint32_t &id);
+            [[nodiscard]] std::uint32_t find(const table *t, const std::size_t &hash, const char *str, const std::size_t &len, std::size_t &pos) const;
+            [[nodiscard]] static const char *store_chars(shard &s, const char *str, const std::size_t &len);
+            void grow(shard &s);
+            void start();
+            void release();
+
+          public:
+            concurrent_interner();
+            concurrent_interner(const concurrent_interner &) = delete;
+            concurrent_interner &operator=(const concurrent_interner &) = delete;
+
+            /**
+             * @brief Id of the `len` bytes at `str`, adding them if they were not interned yet; NULL_ID for a nullptr `str`
+             */
+            [[nodiscard]] std::uint32_t intern(const char *str, const std::size_t &len);
+
+            /**
+             * @brief NUL-terminated characters of `id`, nullptr for NULL_ID
+             */
+            [[nodiscard]] const char *get(const std::uint32_t &id) const;
+            [[nodiscard]] std::size_t length(const std::uint32_t &id) const;
+
+            /**
+             * @brief Number of ids handed out so far
+             */
+            [[nodiscard]] std::uint32_t count() const;
+
+            /**
+             * @brief Forgets every string and frees their memory, ids start at 0 again. No other thread may use the interner
+             * meanwhile, and every id and `get` pointer handed out before is invalid afterwards
+             */
+            void clear();
+            ~concurrent_interner();
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,618 @@
+/**
+ * @file flat_hashtable.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_HASHTABLE_FLAT_HASHTABLE_HH
+#define HORIZON_DEPS_HASHTABLE_FLAT_HASHTABLE_HH
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <new>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../../src/misc/exit_heap_fail.hh"
+#include "../../src/misc/stats.hh"
+#include "../../src/colorize/colorize.h"
+#include "../../src/defines/defines.h"
+#include "../allocator/allocator.hh"
+#include "../string/string.hh"
+#include "../hash/hash.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        namespace flat_hashtable_detail
+        {
+            // control byte of a slot: EMPTY and DELETED have the sign bit set, a full slot holds the 7-bit `h2` of its key
+            constexpr signed char CTRL_EMPTY = -128;
+            constexpr signed char CTRL_DELETED = -2;
+            constexpr std::size_t GROUP_WIDTH = 16;
+
+            /**
+             * 16 control bytes probed at once, every `match_*` returns one bit per matching byte
+             */
+            struct group
+            {
+#if defined(__SSE2__)
+                __m128i M_ctrl;
+
+                inline explicit group(const signed char *ctrl)
+                    : M_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+
+                [[nodiscard]] inline std::uint32_t match(const signed char &h2) const
+                {
+                    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), this->M_ctrl)));
+                }
+
+                [[nodiscard]] inline std::uint32_t match_empty() const
+                {
+                    return this->match(CTRL_EMPTY);
+                }
+
+                [[nodiscard]] inline std::uint32_t match_empty_or_deleted() const
+                {
+                    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), this->M_ctrl)));
+                }
+#else
+                const signed char *M_ctrl;
+
+                inline explicit group(const signed char *ctrl)
+                    : M_ctrl(ctrl) {}
+
+                [[nodiscard]] inline std::uint32_t match(const signed char &h2) const
+                {
+                    std::uint32_t mask = 0;
+                    for (std::size_t i = 0; i < GROUP_WIDTH; i++)
+                        if (this->M_ctrl[i] == h2)
+                            mask |= 1U << i;
+                    return mask;
+                }
+
+                [[nodiscard]] inline std::uint32_t match_empty() const
+                {
+                    return this->match(CTRL_EMPTY);
+                }
+
+                [[nodiscard]] inline std::uint32_t match_empty_or_deleted() const
+                {
+                    std::uint32_t mask = 0;
+                    for (std::size_t i = 0; i < GROUP_WIDTH; i++)
+                        if (this->M_ctrl[i] < -1)
+                            mask |= 1U << i;
+                    return mask;
+                }
+#endif
+            };
+        }
+
+        /**
+         * Hashes `string`, `str_view`, `std::string_view` and C strings alike, so string keyed tables can be searched without building a `string`
+         */
+        struct flat_string_hash
+        {
+            using is_transparent = void;
+
+            [[nodiscard]] inline std::size_t operator()(const std::string_view &str) const
+            {
+                return hash_bytes(str.data(), str.length());
+            }
+
+            [[nodiscard]] inline std::size_t operator()(const string &str) const
+            {
+                return hash_bytes(str.c_str(), str.length());
+            }
+
+            [[nodiscard]] inline std::size_t operator()(const str_view &str) const
+            {
+                return hash_bytes(str.data(), str.length());
+            }
+
+            [[nodiscard]] inline std::size_t operator()(const char *str) const
+            {
+                return hash_bytes(str, std::strlen(str));
+            }
+        };
+
+        struct flat_string_equal
+        {
+            using is_transparent = void;
+
+            [[nodiscard]] static inline std::string_view view(const string &str)
+            {
+                return std::string_view(str.c_str(), str.length());
+            }
+
+            [[nodiscard]] static inline std::string_view view(const str_view &str)
+            {
+                return std::string_view(str.data(), str.length());
+            }
+
+            [[nodiscard]] static inline std::string_view view(const std::string_view &str)
+            {
+                return str;
+            }
+
+            [[nodiscard]] static inline std::string_view view(const char *str)
+            {
+                return std::string_view(str);
+            }
+
+            template <typename A, typename B>
+            [[nodiscard]] inline bool operator()(const A &a, const B &b) const
+            {
+                return flat_string_equal::view(a) == flat_string_equal::view(b);
+            }
+        };
+
+        /**
+         * Open-addressing hash map in the style of a swiss table: one control byte per slot, probed 16 slots at a time,
+         * power-of-two capacity, at most 7/8 full, removed slots leave tombstones that the next rehash drops.
+         * Entries are stored inline in one array, so pointers returned by find() are invalidated by any insertion.
+         * find(), contains() and remove() take any key type that `hashing_function` and `key_equal` accept (e.g. a `str_view`
+         * for `string` keys with flat_string_hash/flat_string_equal)
+         */
+        template <typename KEY, typename VALUE, typename hashing_function = std::hash<KEY>, typename key_equal = std::equal_to<KEY>>
+        class flat_hashtable
+        {
+          public:
+            struct entry
+            {
+                KEY M_key;
+                VALUE M_value;
+            };
+
+          private:
+            signed char *M_ctrl;
+            entry *M_slots;
+            std::size_t M_len, M_cap;
+            std::size_t M_growth_left; // insertions into EMPTY slots left before a rehash
+
+          private:
+            [[nodiscard]] static std::size_t mix(const std::size_t &hash);
+            [[nodiscard]] static std::size_t max_load(const std::size_t &cap);
+            void init_table(const std::size_t &cap);
+            void resize(const std::size_t &new_cap);
+            [[nodiscard]] std::size_t find_insert_slot(const std::size_t &hash) const;
+            template <typename K>
+            [[nodiscard]] std::size_t find_index(const K &__k) const;
+            template <typename K, typename V>
+            bool insert(K &&__k, V &&__v);
+            void destroy_all();
+            void copy_from(const flat_hashtable &ht);
+            [[noreturn]] void not_found() const;
+
+          public:
+            flat_hashtable();
+            explicit flat_hashtable(const std::size_t &init_cap);
+            flat_hashtable(const flat_hashtable &ht);
+            flat_hashtable(flat_hashtable &&ht) noexcept(true);
+
+            [[nodiscard]] bool append(const KEY &__k, const VALUE &__v);
+            [[nodiscard]] bool append(KEY &&__k, VALUE &&__v);
+
+            template <typename K>
+            [[nodiscard]] const VALUE *find(const K &__k) const;
+            template <typename K>
+            [[nodiscard]] VALUE *find(const K &__k);
+            template <typename K>
+            [[nodiscard]] bool contains(const K &__k) const;
+            template <typename K>
+            [[nodiscard]] const VALUE &get_value(const K &__k) const;
+            template <typename K>
+            [[nodiscard]] VALUE &get_value(const K &__k);
+            template <typename K>
+            bool remove(const K &__k);
+
+            /**
+             * @brief Makes room for `count` entries, so that many insertions never rehash
+             */
+            flat_hashtable &reserve(const std::size_t &count);
+            flat_hashtable &erase();
+
+            /**
+             * @brief Calls `func(key, value)` for every entry, in slot order
+             */
+            template <typename FUNC>
+            void for_each(FUNC &&func) const;
+
+            [[nodiscard]] bool is_null() const;
+            [[nodiscard]] bool is_empty() const;
+            [[nodiscard]] const std::size_t &length() const;
+            [[nodiscard]] const std::size_t &capacity() const;
+
+            flat_hashtable &operator=(const flat_hashtable &ht);
+            flat_hashtable &operator=(flat_hashtable &&ht) noexcept(true);
+
+            ~flat_hashtable();
+        };
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        std::size_t flat_hashtable<KEY, VALUE, hashing_function, key_equal>::mix(const std::size_t &hash)
+        {
+            // std::hash of integers and pointers is the identity, spread its bits before splitting it into h1/h2
+            std::uint64_t h = static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ULL;
+            return static_cast<std::size_t>(h ^ (h >> 32));
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        std::size_t flat_hashtable<KEY, VALUE, hashing_function, key_equal>::max_load(const std::size_t &cap)
+        {
+            return cap - cap / 8;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::init_table(const std::size_t &cap)
+        {
+            std::size_t c = flat_hashtable_detail::GROUP_WIDTH;
+            while (c < cap)
+                c *= 2;
+            this->M_ctrl = static_cast<signed char *>(horizon_deps::allocate(c));
+            horizon_misc::exit_heap_fail(this->M_ctrl, "horizon::horizon_deps::flat_hashtable");
+            std::memset(this->M_ctrl, flat_hashtable_detail::CTRL_EMPTY, c);
+            this->M_slots = static_cast<entry *>(horizon_deps::allocate(c * sizeof(entry)));
+            horizon_misc::exit_heap_fail(this->M_slots, "horizon::horizon_deps::flat_hashtable");
+            this->M_cap = c;
+            this->M_len = 0;
+            this->M_growth_left = flat_hashtable::max_load(c);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::resize(const std::size_t &new_cap)
+        {
+            signed char *old_ctrl = this->M_ctrl;
+            entry *old_slots = this->M_slots;
+            std::size_t old_cap = this->M_cap, old_len = this->M_len;
+
+            horizon_misc::count(horizon_misc::stat_counter::STAT_HASHTABLE_REHASHES);
+            this->init_table(new_cap);
+            for (std::size_t i = 0; i < old_cap; i++)
+            {
+                if (old_ctrl[i] < 0)
+                    continue;
+                std::size_t hash = flat_hashtable::mix(hashing_function()(old_slots[i].M_key));
+                std::size_t slot = this->find_insert_slot(hash);
+                this->M_ctrl[slot] = static_cast<signed char>(hash & 0x7f);
+                ::new (static_cast<void *>(this->M_slots + slot)) entry(std::move(old_slots[i]));
+                old_slots[i].~entry();
+            }
+            this->M_len = old_len;
+            this->M_growth_left -= old_len;
+            horizon_deps::deallocate(old_ctrl);
+            horizon_deps::deallocate(static_cast<void *>(old_slots));
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        std::size_t flat_hashtable<KEY, VALUE, hashing_function, key_equal>::find_insert_slot(const std::size_t &hash) const
+        {
+            std::size_t groups_mask = this->M_cap / flat_hashtable_detail::GROUP_WIDTH - 1;
+            std::size_t g = (hash >> 7) & groups_mask;
+            for (std::size_t step = 1;; step++)
+            {
+                std::size_t base = g * flat_hashtable_detail::GROUP_WIDTH;
+                std::uint32_t mask = flat_hashtable_detail::group(this->M_ctrl + base).match_empty_or_deleted();
+                if (mask != 0)
+                    return base + static_cast<std::size_t>(__builtin_ctz(mask));
+                g = (g + step) & groups_mask; // triangular probing visits every group
+            }
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        std::size_t flat_hashtable<KEY, VALUE, hashing_function, key_equal>::find_index(const K &__k) const
+        {
+            if (!this->M_ctrl)
+                return this->M_cap;
+            std::size_t hash = flat_hashtable::mix(hashing_function()(__k));
+            signed char h2 = static_cast<signed char>(hash & 0x7f);
+            std::size_t groups_mask = this->M_cap / flat_hashtable_detail::GROUP_WIDTH - 1;
+            std::size_t g = (hash >> 7) & groups_mask;
+            horizon_misc::probe_counter probes;
+            for (std::size_t step = 1; step <= groups_mask + 1; step++)
+            {
+                probes.step();
+                std::size_t base = g * flat_hashtable_detail::GROUP_WIDTH;
+                flat_hashtable_detail::group grp(this->M_ctrl + base);
+                for (std::uint32_t mask = grp.match(h2); mask != 0; mask &= mask - 1)
+                {
+                    std::size_t i = base + static_cast<std::size_t>(__builtin_ctz(mask));
+                    if (key_equal()(this->M_slots[i].M_key, __k))
+                        return i;
+                }
+                if (grp.match_empty() != 0)
+                    break;
+                g = (g + step) & groups_mask;
+            }
+            return this->M_cap;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K, typename V>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::insert(K &&__k, V &&__v)
+        {
+            if (!this->M_ctrl)
+                this->init_table(flat_hashtable_detail::GROUP_WIDTH);
+            else if (this->find_index(__k) != this->M_cap)
+                return false;
+
+            std::size_t hash = flat_hashtable::mix(hashing_function()(__k));
+            std::size_t slot = this->find_insert_slot(hash);
+            if (this->M_growth_left == 0 && this->M_ctrl[slot] == flat_hashtable_detail::CTRL_EMPTY)
+            {
+                // mostly tombstones: rehash in place, otherwise grow
+                this->resize(this->M_len * 2 < flat_hashtable::max_load(this->M_cap) ? this->M_cap : this->M_cap * 2);
+                slot = this->find_insert_slot(hash);
+            }
+            if (this->M_ctrl[slot] == flat_hashtable_detail::CTRL_EMPTY)
+                this->M_growth_left--;
+            this->M_ctrl[slot] = static_cast<signed char>(hash & 0x7f);
+            ::new (static_cast<void *>(this->M_slots + slot)) entry{KEY(std::forward<K>(__k)), VALUE(std::forward<V>(__v))};
+            this->M_len++;
+            return true;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::destroy_all()
+        {
+            for (std::size_t i = 0; i < this->M_cap; i++)
+                if (this->M_ctrl[i] >= 0)
+                    this->M_slots[i].~entry();
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::copy_from(const flat_hashtable &ht)
+        {
+            // same capacity and hash, so every entry keeps its slot
+            this->init_table(ht.M_cap);
+            std::memcpy(this->M_ctrl, ht.M_ctrl, ht.M_cap);
+            for (std::size_t i = 0; i < ht.M_cap; i++)
+                if (ht.M_ctrl[i] >= 0)
+                    ::new (static_cast<void *>(this->M_slots + i)) entry(ht.M_slots[i]);
+            this->M_len = ht.M_len;
+            this->M_growth_left = ht.M_growth_left;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::not_found() const
+        {
+            if (COLOR_ERR)
+                std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " " ENCLOSE(WHITE_FG, "horizon::horizon_deps::flat_hashtable:") " key was not found in hashtable %p\n", static_cast<const void *>(this->M_slots));
+            else
+                std::fprintf(stderr, "horizon: error: horizon::horizon_deps::flat_hashtable: key was not found in hashtable %p\n", static_cast<const void *>(this->M_slots));
+            std::exit(EXIT_FAILURE);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal>::flat_hashtable()
+        {
+            this->M_ctrl = nullptr;
+            this->M_slots = nullptr;
+            this->M_len = 0;
+            this->M_cap = 0;
+            this->M_growth_left = 0;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal>::flat_hashtable(const std::size_t &init_cap)
+        {
+            this->init_table(init_cap);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal>::flat_hashtable(const flat_hashtable &ht)
+        {
+            this->M_ctrl = nullptr;
+            this->M_slots = nullptr;
+            this->M_len = 0;
+            this->M_cap = 0;
+            this->M_growth_left = 0;
+            if (ht.M_ctrl)
+                this->copy_from(ht);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal>::flat_hashtable(flat_hashtable &&ht) noexcept(true)
+        {
+            this->M_ctrl = ht.M_ctrl;
+            this->M_slots = ht.M_slots;
+            this->M_len = ht.M_len;
+            this->M_cap = ht.M_cap;
+            this->M_growth_left = ht.M_growth_left;
+            ht.M_ctrl = nullptr;
+            ht.M_slots = nullptr;
+            ht.M_len = 0;
+            ht.M_cap = 0;
+            ht.M_growth_left = 0;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::append(const KEY &__k, const VALUE &__v)
+        {
+            return this->insert(__k, __v);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::append(KEY &&__k, VALUE &&__v)
+        {
+            return this->insert(std::move(__k), std::move(__v));
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        const VALUE *flat_hashtable<KEY, VALUE, hashing_function, key_equal>::find(const K &__k) const
+        {
+            std::size_t i = this->find_index(__k);
+            return i == this->M_cap ? nullptr : &this->M_slots[i].M_value;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        VALUE *flat_hashtable<KEY, VALUE, hashing_function, key_equal>::find(const K &__k)
+        {
+            std::size_t i = this->find_index(__k);
+            return i == this->M_cap ? nullptr : &this->M_slots[i].M_value;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::contains(const K &__k) const
+        {
+            return this->find_index(__k) != this->M_cap;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        const VALUE &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::get_value(const K &__k) const
+        {
+            std::size_t i = this->find_index(__k);
+            if (i == this->M_cap)
+                this->not_found();
+            return this->M_slots[i].M_value;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        VALUE &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::get_value(const K &__k)
+        {
+            std::size_t i = this->find_index(__k);
+            if (i == this->M_cap)
+                this->not_found();
+            return this->M_slots[i].M_value;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename K>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::remove(const K &__k)
+        {
+            std::size_t i = this->find_index(__k);
+            if (i == this->M_cap)
+                return false;
+            this->M_slots[i].~entry();
+            this->M_len--;
+            // a lookup stops at the first group that has an EMPTY slot, so the slot may become EMPTY again if its group has one
+            std::size_t base = i & ~(flat_hashtable_detail::GROUP_WIDTH - 1);
+            if (flat_hashtable_detail::group(this->M_ctrl + base).match_empty() != 0)
+            {
+                this->M_ctrl[i] = flat_hashtable_detail::CTRL_EMPTY;
+                this->M_growth_left++;
+            }
+            else
+                this->M_ctrl[i] = flat_hashtable_detail::CTRL_DELETED;
+            return true;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal> &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::reserve(const std::size_t &count)
+        {
+            std::size_t cap = flat_hashtable_detail::GROUP_WIDTH;
+            while (flat_hashtable::max_load(cap) < count)
+                cap *= 2;
+            if (!this->M_ctrl)
+                this->init_table(cap);
+            else if (cap > this->M_cap)
+                this->resize(cap);
+            return *this;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal> &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::erase()
+        {
+            if (this->M_ctrl)
+            {
+                this->destroy_all();
+                horizon_deps::deallocate(this->M_ctrl);
+                horizon_deps::deallocate(static_cast<void *>(this->M_slots));
+            }
+            this->M_ctrl = nullptr;
+            this->M_slots = nullptr;
+            this->M_len = 0;
+            this->M_cap = 0;
+            this->M_growth_left = 0;
+            return *this;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        template <typename FUNC>
+        void flat_hashtable<KEY, VALUE, hashing_function, key_equal>::for_each(FUNC &&func) const
+        {
+            for (std::size_t i = 0; i < this->M_cap; i++)
+                if (this->M_ctrl[i] >= 0)
+                    func(this->M_slots[i].M_key, this->M_slots[i].M_value);
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::is_null() const
+        {
+            return this->M_ctrl == nullptr;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        bool flat_hashtable<KEY, VALUE, hashing_function, key_equal>::is_empty() const
+        {
+            return this->M_len == 0;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        const std::size_t &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::length() const
+        {
+            return this->M_len;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        const std::size_t &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::capacity() const
+        {
+            return this->M_cap;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal> &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::operator=(const flat_hashtable &ht)
+        {
+            if (this != &ht)
+            {
+                this->erase();
+                if (ht.M_ctrl)
+                    this->copy_from(ht);
+            }
+            return *this;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal> &flat_hashtable<KEY, VALUE, hashing_function, key_equal>::operator=(flat_hashtable &&ht) noexcept(true)
+        {
+            if (this != &ht)
+            {
+                this->erase();
+                this->M_ctrl = ht.M_ctrl;
+                this->M_slots = ht.M_slots;
+                this->M_len = ht.M_len;
+                this->M_cap = ht.M_cap;
+                this->M_growth_left = ht.M_growth_left;
+                ht.M_ctrl = nullptr;
+                ht.M_slots = nullptr;
+                ht.M_len = 0;
+                ht.M_cap = 0;
+                ht.M_growth_left = 0;
+            }
+            return *this;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function, typename key_equal>
+        flat_hashtable<KEY, VALUE, hashing_function, key_equal>::~flat_hashtable()
+        {
+            this->erase();
+        }
+    }
+}
+
+#endif
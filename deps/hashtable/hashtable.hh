@@ -7,10 +7,15 @@
 #ifndef HORIZON_DEPS_HASHTABLE_HASHTABLE_HH
 #define HORIZON_DEPS_HASHTABLE_HASHTABLE_HH
 
+#include <cstring>
 #include <functional>
 
 #include "../../src/misc/exit_heap_fail.hh"
+#include "../../src/misc/stats.hh"
+#include "../../src/defines/defines.h"
+#include "../allocator/allocator.hh"
 #include "../pair/pair.hh"
+#include "../hash/hash.hh"
 
 namespace horizon
 {
@@ -45,7 +50,8 @@ namespace horizon
 
             void init_map(const std::size_t &__c);
             void rehash();
-            static std::size_t get_hash(const KEY &__k, const std::size_t &__c);
+            template <typename K>
+            static std::size_t get_hash(const K &__k, const std::size_t &__c);
 
           public:
             hashtable();
@@ -73,6 +79,14 @@ namespace horizon
 
             [[nodiscard]] bool contains(const KEY &__k) const;
 
+            /**
+             * @brief Looks up `__k` without converting it to KEY (e.g. a str_view for string keys), nullptr if it is not there
+             */
+            template <typename K>
+            [[nodiscard]] const VALUE *find(const K &__k) const;
+            template <typename K>
+            [[nodiscard]] VALUE *find(const K &__k);
+
             [[nodiscard]] hashtable &operator=(const hashtable &ht);
             [[nodiscard]] hashtable &operator=(hashtable &&ht) noexcept(true);
 
@@ -90,16 +104,19 @@ namespace horizon
         {
             this->M_cap = __c;
             this->M_len = 0;
-            this->M_table = new node<KEY, VALUE> *[this->M_cap]();
+            this->M_table = static_cast<node<KEY, VALUE> **>(horizon_deps::allocate(this->M_cap * sizeof(node<KEY, VALUE> *)));
             horizon_misc::exit_heap_fail(this->M_table, "horizon::horizon_deps::hashtable");
+            std::memset(static_cast<void *>(this->M_table), 0, this->M_cap * sizeof(node<KEY, VALUE> *));
         }
 
         template <typename KEY, typename VALUE, typename hashing_function>
         void hashtable<KEY, VALUE, hashing_function>::rehash()
         {
+            horizon_misc::count(horizon_misc::stat_counter::STAT_HASHTABLE_REHASHES);
             std::size_t new_cap = this->M_cap * 2;
-            node<KEY, VALUE> **temp_node = new node<KEY, VALUE> *[new_cap]();
+            node<KEY, VALUE> **temp_node = static_cast<node<KEY, VALUE> **>(horizon_deps::allocate(new_cap * sizeof(node<KEY, VALUE> *)));
             horizon_misc::exit_heap_fail(temp_node, "horizon::horizon_deps::hashtable");
+            std::memset(static_cast<void *>(temp_node), 0, new_cap * sizeof(node<KEY, VALUE> *));
             for (std::size_t i = 0; i < this->M_cap; i++)
             {
                 node<KEY, VALUE> *curr = this->M_table[i];
@@ -112,15 +129,16 @@ namespace horizon
                     curr = next;
                 }
             }
-            delete[] this->M_table;
+            horizon_deps::deallocate(static_cast<void *>(this->M_table));
             this->M_table = temp_node;
             this->M_cap = new_cap;
         }
 
         template <typename KEY, typename VALUE, typename hashing_function>
-        std::size_t hashtable<KEY, VALUE, hashing_function>::get_hash(const KEY &__k, const std::size_t &__c)
+        template <typename K>
+        std::size_t hashtable<KEY, VALUE, hashing_function>::get_hash(const K &__k, const std::size_t &__c)
         {
-            return hashing_function()(__k) % __c;
+            return hash_mix(hashing_function()(__k)) % __c;
         }
 
         template <typename KEY, typename VALUE, typename hashing_function>
@@ -171,15 +189,16 @@ namespace horizon
             if (!this->M_table)
                 this->init_map(16);
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                     return false;
-                curr = curr->next;
+                curr = curr->M_next;
             }
-            node<KEY, VALUE> *temp = new node<KEY, VALUE>({__k, __v});
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::hashtable");
+            node<KEY, VALUE> *temp = horizon_deps::create<node<KEY, VALUE>>(pair<KEY, VALUE>(__k, __v));
             temp->M_next = this->M_table[index];
             this->M_table[index] = temp;
             this->M_len++;
@@ -194,15 +213,16 @@ namespace horizon
             if (!this->M_table)
                 this->init_map(16);
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                     return false;
                 curr = curr->M_next;
             }
-            node<KEY, VALUE> *temp = new node<KEY, VALUE>({std::move(__k), std::move(__v)});
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::hashtable");
+            node<KEY, VALUE> *temp = horizon_deps::create<node<KEY, VALUE>>(pair<KEY, VALUE>(std::move(__k), std::move(__v)));
             temp->M_next = this->M_table[index];
             this->M_table[index] = temp;
             this->M_len++;
@@ -217,15 +237,16 @@ namespace horizon
             if (!this->M_table)
                 this->init_map(16);
             std::size_t index = hashtable::get_hash(__p.get_first(), this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __p.get_first())
                     return false;
-                curr = curr->next;
+                curr = curr->M_next;
             }
-            node<KEY, VALUE> *temp = new node<KEY, VALUE>(__p);
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::hashtable");
+            node<KEY, VALUE> *temp = horizon_deps::create<node<KEY, VALUE>>(__p);
             temp->M_next = this->M_table[index];
             this->M_table[index] = temp;
             this->M_len++;
@@ -240,15 +261,16 @@ namespace horizon
             if (!this->M_table)
                 this->init_map(16);
             std::size_t index = hashtable::get_hash(__p.get_first(), this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __p.get_first())
                     return false;
-                curr = curr->next;
+                curr = curr->M_next;
             }
-            node<KEY, VALUE> *temp = new node<KEY, VALUE>(std::move(__p));
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::hashtable");
+            node<KEY, VALUE> *temp = horizon_deps::create<node<KEY, VALUE>>(std::move(__p));
             temp->M_next = this->M_table[index];
             this->M_table[index] = temp;
             this->M_len++;
@@ -261,17 +283,19 @@ namespace horizon
         bool hashtable<KEY, VALUE, hashing_function>::remove(const KEY &__k)
         {
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             node<KEY, VALUE> *prev = nullptr;
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                 {
                     if (prev == nullptr)
-                        this->table[hash] = curr->next;
+                        this->M_table[index] = curr->M_next;
                     else
-                        prev->next = curr->next;
-                    delete curr;
+                        prev->M_next = curr->M_next;
+                    horizon_deps::destroy(curr);
                     this->M_len--;
                     return true;
                 }
@@ -325,11 +349,11 @@ namespace horizon
                 while (curr)
                 {
                     node<KEY, VALUE> *next = curr->M_next;
-                    delete curr;
+                    horizon_deps::destroy(curr);
                     curr = next;
                 }
             }
-            delete[] this->M_table;
+            horizon_deps::deallocate(static_cast<void *>(this->M_table));
             this->M_cap = 0;
             this->M_len = 0;
             this->M_table = nullptr;
@@ -352,9 +376,11 @@ namespace horizon
         const VALUE &hashtable<KEY, VALUE, hashing_function>::get_value(const KEY &__k) const
         {
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                     return curr->M_element.get_second();
                 curr = curr->M_next;
@@ -370,9 +396,11 @@ namespace horizon
         VALUE &hashtable<KEY, VALUE, hashing_function>::get_value(const KEY &__k)
         {
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                     return curr->M_element.get_second();
                 curr = curr->M_next;
@@ -388,9 +416,11 @@ namespace horizon
         bool hashtable<KEY, VALUE, hashing_function>::contains(const KEY &__k) const
         {
             std::size_t index = hashtable::get_hash(__k, this->M_cap);
+            horizon_misc::probe_counter probes;
             node<KEY, VALUE> *curr = this->M_table[index];
             while (curr)
             {
+                probes.step();
                 if (curr->M_element.get_first() == __k)
                     return true;
                 curr = curr->M_next;
@@ -398,6 +428,31 @@ namespace horizon
             return false;
         }
 
+        template <typename KEY, typename VALUE, typename hashing_function>
+        template <typename K>
+        const VALUE *hashtable<KEY, VALUE, hashing_function>::find(const K &__k) const
+        {
+            if (!this->M_table)
+                return nullptr;
+            horizon_misc::probe_counter probes;
+            node<KEY, VALUE> *curr = this->M_table[hashtable::get_hash(__k, this->M_cap)];
+            while (curr)
+            {
+                probes.step();
+                if (curr->M_element.get_first() == __k)
+                    return &curr->M_element.get_second();
+                curr = curr->M_next;
+            }
+            return nullptr;
+        }
+
+        template <typename KEY, typename VALUE, typename hashing_function>
+        template <typename K>
+        VALUE *hashtable<KEY, VALUE, hashing_function>::find(const K &__k)
+        {
+            return const_cast<VALUE *>(static_cast<const hashtable *>(this)->find(__k));
+        }
+
         template <typename KEY, typename VALUE, typename hashing_function>
         hashtable<KEY, VALUE, hashing_function> &hashtable<KEY, VALUE, hashing_function>::operator=(const hashtable &ht)
         {
@@ -0,0 +1,97 @@
+/**
+ * @file inline_pair.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_PAIR_INLINE_PAIR_HH
+#define HORIZON_DEPS_PAIR_INLINE_PAIR_HH
+
+#include <utility>
+
+#include "../traits/traits.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * A pair that stores both members by value, unlike `pair` it never allocates and has no null state.
+         * It is move-only, AST entries are owned by exactly one node
+         */
+        template <typename T, typename U = T>
+        class inline_pair
+        {
+          private:
+            T M_first;
+            U M_second;
+
+          public:
+            inline_pair();
+            inline_pair(T &&p1, U &&p2) noexcept(true);
+            inline_pair(const inline_pair &) = delete;
+            inline_pair(inline_pair &&p) noexcept(true);
+            [[nodiscard]] T &get_first();
+            [[nodiscard]] const T &get_first() const;
+            [[nodiscard]] U &get_second();
+            [[nodiscard]] const U &get_second() const;
+            inline_pair &operator=(const inline_pair &) = delete;
+            inline_pair &operator=(inline_pair &&p) noexcept(true);
+            ~inline_pair() = default;
+        };
+
+        template <typename T, typename U>
+        inline_pair<T, U>::inline_pair()
+            : M_first(), M_second() {}
+
+        template <typename T, typename U>
+        inline_pair<T, U>::inline_pair(T &&p1, U &&p2) noexcept(true)
+            : M_first(std::move(p1)), M_second(std::move(p2)) {}
+
+        template <typename T, typename U>
+        inline_pair<T, U>::inline_pair(inline_pair &&p) noexcept(true)
+            : M_first(std::move(p.M_first)), M_second(std::move(p.M_second)) {}
+
+        template <typename T, typename U>
+        T &inline_pair<T, U>::get_first()
+        {
+            return this->M_first;
+        }
+
+        template <typename T, typename U>
+        const T &inline_pair<T, U>::get_first() const
+        {
+            return this->M_first;
+        }
+
+        template <typename T, typename U>
+        U &inline_pair<T, U>::get_second()
+        {
+            return this->M_second;
+        }
+
+        template <typename T, typename U>
+        const U &inline_pair<T, U>::get_second() const
+        {
+            return this->M_second;
+        }
+
+        template <typename T, typename U>
+        inline_pair<T, U> &inline_pair<T, U>::operator=(inline_pair &&p) noexcept(true)
+        {
+            if (this != &p)
+            {
+                this->M_first = std::move(p.M_first);
+                this->M_second = std::move(p.M_second);
+            }
+            return *this;
+        }
+
+        template <typename T, typename U>
+        struct is_trivially_relocatable<inline_pair<T, U>> : std::bool_constant<is_trivially_relocatable_v<T> && is_trivially_relocatable_v<U>>
+        {
+        };
+    }
+}
+
+#endif
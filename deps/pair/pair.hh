@@ -8,6 +8,8 @@
 #define HORIZON_DEPS_PAIR_PAIR_HH
 
 #include "../../src/misc/exit_heap_fail.hh"
+#include "../allocator/allocator.hh"
+#include "../traits/traits.hh"
 
 namespace horizon
 {
@@ -26,6 +28,10 @@ namespace horizon
             pair(T &&p1, U &&p2) noexcept(true);
             pair(const pair &p);
             pair(pair &&p) noexcept(true);
+
+            /**
+             * @brief Adopts `p1` and `p2`, which must come from `horizon_deps::create`
+             */
             pair(T *p1, U *p2);
             [[nodiscard]] bool is_null() const;
             bool release();
@@ -53,28 +59,22 @@ namespace horizon
         template <typename T, typename U>
         pair<T, U>::pair(const T &p1, const U &p2)
         {
-            this->M_ptr1 = new T(p1);
-            this->M_ptr2 = new U(p2);
-            horizon_misc::exit_heap_fail(this->M_ptr1, "horizon::horizon_deps::pair");
-            horizon_misc::exit_heap_fail(this->M_ptr2, "horizon::horizon_deps::pair");
+            this->M_ptr1 = horizon_deps::create<T>(p1);
+            this->M_ptr2 = horizon_deps::create<U>(p2);
         }
 
         template <typename T, typename U>
         pair<T, U>::pair(T &&p1, U &&p2) noexcept(true)
         {
-            this->M_ptr1 = new T(std::move(p1));
-            this->M_ptr2 = new U(std::move(p2));
-            horizon_misc::exit_heap_fail(this->M_ptr1, "horizon::horizon_deps::pair");
-            horizon_misc::exit_heap_fail(this->M_ptr2, "horizon::horizon_deps::pair");
+            this->M_ptr1 = horizon_deps::create<T>(std::move(p1));
+            this->M_ptr2 = horizon_deps::create<U>(std::move(p2));
         }
 
         template <typename T, typename U>
         pair<T, U>::pair(const pair &p)
         {
-            this->M_ptr1 = new T(*p.M_ptr1);
-            this->M_ptr2 = new U(*p.M_ptr2);
-            horizon_misc::exit_heap_fail(this->M_ptr1, "horizon::horizon_deps::pair");
-            horizon_misc::exit_heap_fail(this->M_ptr2, "horizon::horizon_deps::pair");
+            this->M_ptr1 = horizon_deps::create<T>(*p.M_ptr1);
+            this->M_ptr2 = horizon_deps::create<U>(*p.M_ptr2);
         }
 
         template <typename T, typename U>
@@ -109,13 +109,13 @@ namespace horizon
             bool is_done = false;
             if (this->M_ptr1)
             {
-                delete this->M_ptr1;
+                horizon_deps::destroy(this->M_ptr1);
                 this->M_ptr1 = nullptr;
                 is_done = true;
             }
             if (this->M_ptr2)
             {
-                delete this->M_ptr2;
+                horizon_deps::destroy(this->M_ptr2);
                 this->M_ptr2 = nullptr;
                 is_done = true;
             }
@@ -176,10 +176,8 @@ namespace horizon
             if (this != &p)
             {
                 this->release();
-                this->M_ptr1 = new T(*p.M_ptr1);
-                this->M_ptr2 = new U(*p.M_ptr2);
-                horizon_misc::exit_heap_fail(this->M_ptr1, "horizon::horizon_deps::pair");
-                horizon_misc::exit_heap_fail(this->M_ptr2, "horizon::horizon_deps::pair");
+                this->M_ptr1 = horizon_deps::create<T>(*p.M_ptr1);
+                this->M_ptr2 = horizon_deps::create<U>(*p.M_ptr2);
             }
             return *this;
         }
@@ -211,15 +209,21 @@ namespace horizon
         {
             if (this->M_ptr1)
             {
-                delete this->M_ptr1;
+                horizon_deps::destroy(this->M_ptr1);
                 this->M_ptr1 = nullptr;
             }
             if (this->M_ptr2)
             {
-                delete this->M_ptr2;
+                horizon_deps::destroy(this->M_ptr2);
                 this->M_ptr2 = nullptr;
             }
         }
+
+        // only owns heap pointers
+        template <typename T, typename U>
+        struct is_trivially_relocatable<pair<T, U>> : std::true_type
+        {
+        };
     }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,369 @@
+/**
+ * @file scheduler.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./scheduler.hh"
+
+#include <cstdlib>
+#include <new>
+
+#include "../../src/misc/exit_heap_fail.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        namespace
+        {
+            // the scheduler the calling thread belongs to and its index there
+            struct worker_id
+            {
+                const scheduler *M_scheduler = nullptr;
+                std::size_t M_index = scheduler::NOT_A_WORKER;
+            };
+
+            thread_local worker_id current;
+
+            // spins before a thread without work goes to sleep, stealing is usually faster than a wake-up
+            constexpr std::size_t IDLE_SPINS = 64;
+        }
+
+        task::task(void (*invoke)(task *), void (*destroy)(task *))
+            : M_invoke(invoke), M_destroy(destroy), M_waiting(1), M_done(false), M_continuations(), M_next(nullptr) {}
+
+        bool task::is_done() const
+        {
+            return this->M_done.load(std::memory_order_acquire);
+        }
+
+        work_deque::ring *work_deque::new_ring(const std::int64_t &cap)
+        {
+            ring *r = static_cast<ring *>(std::calloc(1, sizeof(ring)));
+            horizon_misc::exit_heap_fail(r, "horizon::horizon_deps::work_deque");
+            r->M_items = static_cast<std::atomic<task *> *>(std::malloc(static_cast<std::size_t>(cap) * sizeof(std::atomic<task *>)));
+            horizon_misc::exit_heap_fail(r->M_items, "horizon::horizon_deps::work_deque");
+            for (std::int64_t i = 0; i < cap; i++)
+                ::new (static_cast<void *>(r->M_items + i)) std::atomic<task *>(nullptr);
+            r->M_cap = cap;
+            r->M_prev = nullptr;
+            return r;
+        }
+
+        work_deque::work_deque()
+            : M_top(0), M_bottom(0), M_ring(work_deque::new_ring(64)) {}
+
+        void work_deque::push(task *t)
+        {
+            std::int64_t b = this->M_bottom.load(std::memory_order_relaxed);
+            std::int64_t top = this->M_top.load(std::memory_order_acquire);
+            ring *r = this->M_ring.load(std::memory_order_relaxed);
+            if (b - top > r->M_cap - 1)
+            {
+                ring *bigger = work_deque::new_ring(r->M_cap * 2);
+                for (std::int64_t i = top; i < b; i++)
+                    bigger->M_items[i & (bigger->M_cap - 1)].store(r->M_items[i & (r->M_cap - 1)].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                bigger->M_prev = r;
+                this->M_ring.store(bigger, std::memory_order_release);
+                r = bigger;
+            }
+            r->M_items[b & (r->M_cap - 1)].store(t, std::memory_order_relaxed);
+            // publishes the item to thieves that read the new bottom
+            this->M_bottom.store(b + 1, std::memory_order_release);
+        }
+
+        task *work_deque::pop()
+        {
+            std::int64_t b = this->M_bottom.load(std::memory_order_relaxed) - 1;
+            ring *r = this->M_ring.load(std::memory_order_relaxed);
+            // claims slot b before looking at top; seq_cst orders this against the top read in `steal`
+            this->M_bottom.store(b, std::memory_order_seq_cst);
+            std::int64_t top = this->M_top.load(std::memory_order_seq_cst);
+            if (top > b)
+            {
+                // empty
+                this->M_bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            task *t = r->M_items[b & (r->M_cap - 1)].load(std::memory_order_relaxed);
+            if (top == b)
+            {
+                // the last item, a thief may be after it too
+                if (!this->M_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    t = nullptr;
+                this->M_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return t;
+        }
+
+        task *work_deque::steal()
+        {
+            std::int64_t top = this->M_top.load(std::memory_order_seq_cst);
+            std::int64_t b = this->M_bottom.load(std::memory_order_seq_cst);
+            if (top >= b)
+                return nullptr;
+            ring *r = this->M_ring.load(std::memory_order_acquire);
+            task *t = r->M_items[top & (r->M_cap - 1)].load(std::memory_order_relaxed);
+            if (!this->M_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return t;
+        }
+
+        work_deque::~work_deque()
+        {
+            ring *r = this->M_ring.load(std::memory_order_relaxed);
+            while (r)
+            {
+                ring *prev = r->M_prev;
+                std::free(static_cast<void *>(r->M_items));
+                std::free(r);
+                r = prev;
+            }
+        }
+
+        scheduler::scheduler(const std::size_t &threads)
+            : M_threads(threads), M_prev_owner(nullptr), M_prev_index(scheduler::NOT_A_WORKER), M_deques(nullptr), M_workers(), M_tasks(nullptr), M_pending(0), M_ready(0), M_sleepers(0), M_stopping(false), M_injected()
+        {
+            if (this->M_threads == 0)
+                this->M_threads = std::thread::hardware_concurrency();
+            if (this->M_threads == 0)
+                this->M_threads = 1;
+
+            this->M_deques = static_cast<work_deque *>(std::malloc(this->M_threads * sizeof(work_deque)));
+            horizon_misc::exit_heap_fail(this->M_deques, "horizon::horizon_deps::scheduler");
+            for (std::size_t i = 0; i < this->M_threads; i++)
+                ::new (static_cast<void *>(this->M_deques + i)) work_deque();
+
+            this->M_prev_owner = current.M_scheduler;
+            this->M_prev_index = current.M_index;
+            current.M_scheduler = this;
+            current.M_index = 0;
+            allocator_scope scope(malloc_allocator::instance());
+            for (std::size_t i = 1; i < this->M_threads; i++)
+                this->M_workers.add(std::thread(&scheduler::worker_main, this, i));
+        }
+
+        void scheduler::adopt(task *t)
+        {
+            task *head = this->M_tasks.load(std::memory_order_relaxed);
+            do
+                t->M_next = head;
+            while (!this->M_tasks.compare_exchange_weak(head, t, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        std::size_t scheduler::self() const
+        {
+            return current.M_scheduler == this ? current.M_index : scheduler::NOT_A_WORKER;
+        }
+
+        void scheduler::make_ready(task *t)
+        {
+            std::size_t index = this->self();
+            if (index == scheduler::NOT_A_WORKER)
+            {
+                std::lock_guard<std::mutex> guard(this->M_inject_lock);
+                allocator_scope scope(malloc_allocator::instance());
+                this->M_injected.add(t);
+            }
+            else
+                this->M_deques[index].push(t);
+            this->M_ready.fetch_add(1, std::memory_order_seq_cst);
+            this->wake(false);
+        }
+
+        void scheduler::wake(const bool &all)
+        {
+            // pairs with `sleep`: either the sleeper sees the new state, or this sees the sleeper and its lock
+            if (this->M_sleepers.load(std::memory_order_seq_cst) == 0)
+                return;
+            {
+                std::lock_guard<std::mutex> guard(this->M_sleep_lock);
+            }
+            if (all)
+                this->M_wake.notify_all();
+            else
+                this->M_wake.notify_one();
+        }
+
+        void scheduler::sleep(const task *until)
+        {
+            for (std::size_t i = 0; i < IDLE_SPINS; i++)
+            {
+                if (this->M_ready.load(std::memory_order_relaxed) || (until && until->is_done()) || this->M_stopping.load(std::memory_order_relaxed))
+                    return;
+                std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> guard(this->M_sleep_lock);
+            this->M_sleepers.fetch_add(1, std::memory_order_seq_cst);
+            this->M_wake.wait(guard, [this, until]()
+                              { return this->M_ready.load(std::memory_order_seq_cst) || (until && until->is_done()) || this->M_stopping.load(std::memory_order_seq_cst); });
+            this->M_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        task *scheduler::find_task(const std::size_t &index)
+        {
+            task *t = nullptr;
+            if (index != scheduler::NOT_A_WORKER)
+            {
+                // one thread takes its oldest task first, so that the order is the order tasks became ready
+                t = (this->M_threads == 1 ? this->M_deques[index].steal() : this->M_deques[index].pop());
+            }
+            if (!t && this->M_ready.load(std::memory_order_relaxed))
+            {
+                {
+                    std::lock_guard<std::mutex> guard(this->M_inject_lock);
+                    if (!this->M_injected.is_empty())
+                    {
+                        t = this->M_injected[0];
+                        this->M_injected.remove(0);
+                    }
+                }
+                for (std::size_t i = 1; !t && i <= this->M_threads; i++)
+                {
+                    std::size_t victim = (index == scheduler::NOT_A_WORKER ? i - 1 : (index + i) % this->M_threads);
+                    if (victim != index)
+                        t = this->M_deques[victim].steal();
+                }
+            }
+            if (t)
+                this->M_ready.fetch_sub(1, std::memory_order_relaxed);
+            return t;
+        }
+
+        void scheduler::run(task *t)
+        {
+            {
+                allocator_scope scope(malloc_allocator::instance());
+                t->M_invoke(t);
+            }
+            this->finish(t);
+        }
+
+        void scheduler::finish(task *t)
+        {
+            vector<task *> continuations;
+            {
+                std::lock_guard<std::mutex> guard(t->M_lock);
+                t->M_done.store(true, std::memory_order_seq_cst);
+                continuations = std::move(t->M_continuations);
+            }
+            for (task *c : continuations)
+            {
+                if (c->M_waiting.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    this->make_ready(c);
+            }
+            this->M_pending.fetch_sub(1, std::memory_order_seq_cst);
+            // threads in `wait` sleep on the same condition as idle workers
+            this->wake(true);
+        }
+
+        void scheduler::worker_main(const std::size_t &index)
+        {
+            current.M_scheduler = this;
+            current.M_index = index;
+            while (!this->M_stopping.load(std::memory_order_acquire))
+            {
+                task *t = this->find_task(index);
+                if (t)
+                    this->run(t);
+                else
+                    this->sleep(nullptr);
+            }
+        }
+
+        const std::size_t &scheduler::threads() const
+        {
+            return this->M_threads;
+        }
+
+        void scheduler::depend(task *t, task *before)
+        {
+            t->M_waiting.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> guard(before->M_lock);
+                if (!before->M_done.load(std::memory_order_relaxed))
+                {
+                    allocator_scope scope(malloc_allocator::instance());
+                    before->M_continuations.add(t);
+                    return;
+                }
+            }
+            t->M_waiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void scheduler::submit(task *t)
+        {
+            this->M_pending.fetch_add(1, std::memory_order_relaxed);
+            if (t->M_waiting.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                this->make_ready(t);
+        }
+
+        void scheduler::wait(const task *t)
+        {
+            std::size_t index = this->self();
+            while (!t->is_done())
+            {
+                task *next = this->find_task(index);
+                if (next)
+                    this->run(next);
+                else
+                    this->sleep(t);
+            }
+        }
+
+        void scheduler::finish_pending()
+        {
+            // a task is done before `finish` is through with it, it is not pending anymore only once it is
+            std::size_t index = this->self();
+            while (this->M_pending.load(std::memory_order_seq_cst))
+            {
+                task *next = this->find_task(index);
+                if (next)
+                    this->run(next);
+                else
+                    std::this_thread::yield();
+            }
+        }
+
+        void scheduler::reclaim()
+        {
+            this->finish_pending();
+            task *t = this->M_tasks.exchange(nullptr, std::memory_order_acquire);
+            while (t)
+            {
+                task *next = t->M_next;
+                if (t->M_done.load(std::memory_order_relaxed))
+                    t->M_destroy(t);
+                else
+                    this->adopt(t);
+                t = next;
+            }
+        }
+
+        scheduler::~scheduler()
+        {
+            this->finish_pending();
+            this->M_stopping.store(true, std::memory_order_seq_cst);
+            this->wake(true);
+            for (std::thread &w : this->M_workers)
+                w.join();
+            if (current.M_scheduler == this)
+            {
+                current.M_scheduler = this->M_prev_owner;
+                current.M_index = this->M_prev_index;
+            }
+
+            task *t = this->M_tasks.load(std::memory_order_acquire);
+            while (t)
+            {
+                task *next = t->M_next;
+                t->M_destroy(t);
+                t = next;
+            }
+            for (std::size_t i = 0; i < this->M_threads; i++)
+                this->M_deques[i].~work_deque();
+            std::free(this->M_deques);
+        }
+    }
+}
@@ -0,0 +1,266 @@
+/**
+ * @file scheduler.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_SCHEDULER_SCHEDULER_HH
+#define HORIZON_DEPS_SCHEDULER_SCHEDULER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "../../src/colorize/colorize.h"
+#include "../../src/defines/defines.h"
+#include "../allocator/allocator.hh"
+#include "../vector/vector.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        class scheduler;
+
+        /**
+         * One unit of work of a `scheduler`. A task becomes ready once it is submitted and every task it depends on has finished;
+         * a finished task makes its continuations (the tasks that depend on it) ready on the worker that finished it.
+         */
+        class task
+        {
+            friend class scheduler;
+
+          private:
+            void (*M_invoke)(task *);
+            void (*M_destroy)(task *);
+            std::atomic<std::size_t> M_waiting; // unfinished dependencies, plus one until the task is submitted
+            std::atomic<bool> M_done;
+            std::mutex M_lock; // orders `depend` against the task finishing
+            vector<task *> M_continuations;
+            task *M_next; // every task of a scheduler, freed with it
+
+          protected:
+            task(void (*invoke)(task *), void (*destroy)(task *));
+
+          public:
+            task(const task &) = delete;
+            task &operator=(const task &) = delete;
+
+            [[nodiscard]] bool is_done() const;
+        };
+
+        /**
+         * Chase-Lev work-stealing deque: its owner pushes and pops at the bottom, any other thread steals from the top.
+         * The ring grows when full; old rings are kept (a thief may still be reading one) until the deque is destroyed.
+         */
+        class work_deque
+        {
+          private:
+            struct ring
+            {
+                std::int64_t M_cap; // power of 2
+                std::atomic<task *> *M_items;
+                ring *M_prev;
+            };
+
+            alignas(64) std::atomic<std::int64_t> M_top;
+            alignas(64) std::atomic<std::int64_t> M_bottom;
+            std::atomic<ring *> M_ring;
+
+          private:
+            [[nodiscard]] static ring *new_ring(const std::int64_t &cap);
+
+          public:
+            work_deque();
+            work_deque(const work_deque &) = delete;
+            work_deque &operator=(const work_deque &) = delete;
+
+            /**
+             * @brief Owner only
+             */
+            void push(task *t);
+
+            /**
+             * @brief Owner only, the most recently pushed task or nullptr
+             */
+            [[nodiscard]] task *pop();
+
+            /**
+             * @brief Any thread, the oldest task or nullptr if the deque is empty or another thread won the race for it
+             */
+            [[nodiscard]] task *steal();
+            ~work_deque();
+        };
+
+        /**
+         * Runs tasks on `threads` threads: the thread that creates the scheduler plus `threads - 1` workers. Every thread has its own
+         * `work_deque`; tasks made ready by a thread go to its deque, and a thread that runs out of work steals from the others.
+         * The creating thread only runs tasks while it is inside `wait` (or `parallel_for`).
+         *
+         * With one thread the scheduler is deterministic: nothing runs outside `wait`, and ready tasks run in the order they became ready.
+         *
+         * Tasks start with the default allocator (see `allocator_scope`) whatever thread runs them.
+         * Task handles stay valid until the scheduler is destroyed or `reclaim`s them; the destructor waits for every submitted task.
+         */
+        class scheduler
+        {
+          private:
+            template <typename F>
+            class callable_task final : public task
+            {
+                friend class scheduler;
+
+              private:
+                F M_fn;
+
+              private:
+                static void invoke(task *t)
+                {
+                    static_cast<callable_task *>(t)->M_fn();
+                }
+
+                static void destroy(task *t)
+                {
+                    horizon_deps::destroy(static_cast<callable_task *>(t));
+                }
+
+              public:
+                template <typename G>
+                callable_task(G &&fn)
+                    : task(&callable_task::invoke, &callable_task::destroy), M_fn(std::forward<G>(fn)) {}
+            };
+
+            std::size_t M_threads;
+            const scheduler *M_prev_owner; // of the creating thread, restored by the destructor
+            std::size_t M_prev_index;
+            work_deque *M_deques; // M_threads of them, the creating thread's first
+            vector<std::thread> M_workers;
+            std::atomic<task *> M_tasks;
+            std::atomic<std::size_t> M_pending; // submitted tasks that have not finished
+            std::atomic<std::size_t> M_ready;   // tasks sitting in a deque
+            std::atomic<std::size_t> M_sleepers;
+            std::atomic<bool> M_stopping;
+            std::mutex M_sleep_lock;
+            std::condition_variable M_wake;
+            std::mutex M_inject_lock;
+            vector<task *> M_injected; // made ready by threads that are not part of the scheduler
+
+          private:
+            void adopt(task *t);
+            void make_ready(task *t);
+            void finish(task *t);
+            void run(task *t);
+            void finish_pending();
+            [[nodiscard]] std::size_t self() const;
+            [[nodiscard]] task *find_task(const std::size_t &index);
+            void sleep(const task *until);
+            void wake(const bool &all);
+            void worker_main(const std::size_t &index);
+
+          public:
+            static constexpr std::size_t NOT_A_WORKER = static_cast<std::size_t>(-1);
+
+            /**
+             * @brief `threads` = 0 uses one thread per hardware thread, 1 is the deterministic mode
+             */
+            scheduler(const std::size_t &threads = 0);
+            scheduler(const scheduler &) = delete;
+            scheduler &operator=(const scheduler &) = delete;
+
+            [[nodiscard]] const std::size_t &threads() const;
+
+            /**
+             * @brief A task running `fn()` that does not run until it is `submit`ted, so dependencies can be added first
+             */
+            template <typename F>
+            [[nodiscard]] task *create(F &&fn);
+
+            /**
+             * @brief `t` will not run before `before` has finished; `t` must not have been submitted yet
+             */
+            void depend(task *t, task *before);
+            void submit(task *t);
+
+            /**
+             * @brief `create` + `submit`
+             */
+            template <typename F>
+            task *spawn(F &&fn);
+
+            /**
+             * @brief A submitted task running `fn()` once `before` has finished
+             */
+            template <typename F>
+            task *then(task *before, F &&fn);
+
+            /**
+             * @brief Returns once `t` has finished, running other ready tasks meanwhile
+             */
+            void wait(const task *t);
+
+            /**
+             * @brief Calls `fn(begin, end)` on disjoint sub-ranges of at most `grain` indices that together cover [`begin`, `end`),
+             * splitting the range in halves as tasks so that idle threads can steal the larger halves. Returns once all of them have run.
+             */
+            template <typename F>
+            void parallel_for(const std::size_t &begin, const std::size_t &end, const std::size_t &grain, const F &fn);
+
+            /**
+             * @brief Waits for every submitted task like the destructor, then frees the finished ones, so that a scheduler kept
+             * for many batches of tasks does not hold on to all of them. Only the creating thread may call it, with no other
+             * thread creating tasks; handles of finished tasks are invalid afterwards, tasks not submitted yet stay
+             */
+            void reclaim();
+            ~scheduler();
+        };
+
+        template <typename F>
+        task *scheduler::create(F &&fn)
+        {
+            // tasks outlive whatever allocator the caller is in the scope of
+            allocator_scope scope(malloc_allocator::instance());
+            task *t = horizon_deps::create<callable_task<typename std::decay<F>::type>>(std::forward<F>(fn));
+            this->adopt(t);
+            return t;
+        }
+
+        template <typename F>
+        task *scheduler::spawn(F &&fn)
+        {
+            task *t = this->create(std::forward<F>(fn));
+            this->submit(t);
+            return t;
+        }
+
+        template <typename F>
+        task *scheduler::then(task *before, F &&fn)
+        {
+            task *t = this->create(std::forward<F>(fn));
+            this->depend(t, before);
+            this->submit(t);
+            return t;
+        }
+
+        template <typename F>
+        void scheduler::parallel_for(const std::size_t &begin, const std::size_t &end, const std::size_t &grain, const F &fn)
+        {
+            if (end - begin <= (grain ? grain : 1))
+            {
+                if (begin < end)
+                    fn(begin, end);
+                return;
+            }
+            std::size_t mid = begin + (end - begin) / 2;
+            task *right = this->spawn([this, mid, end, grain, &fn]()
+                                      { this->parallel_for(mid, end, grain, fn); });
+            this->parallel_for(begin, mid, grain, fn);
+            this->wait(right);
+        }
+    }
+}
+
+#endif
@@ -8,6 +8,8 @@
 #define HORIZON_DEPS_SPTR_SPTR_HH
 
 #include "../../src/misc/exit_heap_fail.hh"
+#include "../allocator/allocator.hh"
+#include "../traits/traits.hh"
 
 namespace horizon
 {
@@ -25,6 +27,10 @@ namespace horizon
             sptr(T &&s) noexcept(true);
             sptr(const sptr &p);
             sptr(sptr &&p) noexcept(true);
+
+            /**
+             * @brief Adopts `p`, which must come from `horizon_deps::create` (or from a class whose `operator new` is `horizon_deps::allocate`)
+             */
             sptr(T *p);
             [[nodiscard]] bool is_null() const;
             bool release();
@@ -54,22 +60,19 @@ namespace horizon
         template <typename T>
         sptr<T>::sptr(const T &s)
         {
-            this->M_ptr = new T(s);
-            horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+            this->M_ptr = horizon_deps::create<T>(s);
         }
 
         template <typename T>
         sptr<T>::sptr(T &&s) noexcept(true)
         {
-            this->M_ptr = new T(std::move(s));
-            horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+            this->M_ptr = horizon_deps::create<T>(std::move(s));
         }
 
         template <typename T>
         sptr<T>::sptr(const sptr &p)
         {
-            this->M_ptr = new T(*p.M_ptr);
-            horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+            this->M_ptr = horizon_deps::create<T>(*p.M_ptr);
         }
 
         template <typename T>
@@ -97,7 +100,7 @@ namespace horizon
         {
             if (this->M_ptr)
             {
-                delete this->M_ptr;
+                horizon_deps::destroy(this->M_ptr);
                 this->M_ptr = nullptr;
                 return true;
             }
@@ -132,8 +135,7 @@ namespace horizon
         sptr<T> &sptr<T>::operator=(const T &s)
         {
             this->release();
-            this->M_ptr = new T(s);
-            horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+            this->M_ptr = horizon_deps::create<T>(s);
             return *this;
         }
 
@@ -141,8 +143,7 @@ namespace horizon
         sptr<T> &sptr<T>::operator=(T &&s) noexcept(true)
         {
             this->release();
-            this->M_ptr = new T(std::move(s));
-            horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+            this->M_ptr = horizon_deps::create<T>(std::move(s));
             return *this;
         }
 
@@ -152,8 +153,7 @@ namespace horizon
             if (this != &p)
             {
                 this->release();
-                this->M_ptr = new T(*p.M_ptr);
-                horizon_misc::exit_heap_fail(this->M_ptr, "horizon::horizon_deps::sptr");
+                this->M_ptr = horizon_deps::create<T>(*p.M_ptr);
             }
             return *this;
         }
@@ -213,10 +213,16 @@ namespace horizon
         {
             if (this->M_ptr)
             {
-                delete this->M_ptr;
+                horizon_deps::destroy(this->M_ptr);
                 this->M_ptr = nullptr;
             }
         }
+
+        // only owns heap pointers
+        template <typename T>
+        struct is_trivially_relocatable<sptr<T>> : std::true_type
+        {
+        };
     }
 }
 
@@ -0,0 +1,188 @@
+/**
+ * @file str_view.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_STRING_STR_VIEW_HH
+#define HORIZON_DEPS_STRING_STR_VIEW_HH
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../hash/hash.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * Non-owning view of `M_len` characters, NOT NUL-terminated. It must not outlive the characters it points to;
+         * a `string` converts to it implicitly, the other way round allocates and is explicit
+         */
+        class str_view
+        {
+          private:
+            const char *M_str;
+            std::size_t M_len;
+
+          public:
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+          public:
+            constexpr str_view()
+                : M_str(nullptr), M_len(0) {}
+
+            constexpr str_view(const char *str, const std::size_t &len)
+                : M_str(str), M_len(len) {}
+
+            str_view(const char *str)
+                : M_str(str), M_len(str ? std::strlen(str) : 0) {}
+
+            [[nodiscard]] constexpr const char *data() const
+            {
+                return this->M_str;
+            }
+
+            [[nodiscard]] constexpr const std::size_t &length() const
+            {
+                return this->M_len;
+            }
+
+            [[nodiscard]] constexpr bool is_empty() const
+            {
+                return this->M_len == 0;
+            }
+
+            [[nodiscard]] constexpr const char &operator[](const std::size_t &__index) const
+            {
+                return this->M_str[__index];
+            }
+
+            [[nodiscard]] constexpr const char *begin() const
+            {
+                return this->M_str;
+            }
+
+            [[nodiscard]] constexpr const char *end() const
+            {
+                return this->M_str + this->M_len;
+            }
+
+            /**
+             * @brief View of at most `sub_len` characters starting at `index`, empty if `index` is past the end
+             */
+            [[nodiscard]] constexpr str_view substr(const std::size_t &index, const std::size_t &sub_len = npos) const
+            {
+                if (index >= this->M_len)
+                    return str_view(this->M_str + this->M_len, 0);
+                std::size_t left = this->M_len - index;
+                return str_view(this->M_str + index, sub_len < left ? sub_len : left);
+            }
+
+            /**
+             * @brief <0, 0 or >0 like `strcmp`, a shorter view that is a prefix of the other one is smaller
+             */
+            [[nodiscard]] int compare(const str_view &other) const
+            {
+                std::size_t len = this->M_len < other.M_len ? this->M_len : other.M_len;
+                int res = len ? std::memcmp(this->M_str, other.M_str, len) : 0;
+                if (res != 0)
+                    return res;
+                return this->M_len < other.M_len ? -1 : (this->M_len > other.M_len ? 1 : 0);
+            }
+
+            [[nodiscard]] bool starts_with(const str_view &prefix) const
+            {
+                return prefix.M_len <= this->M_len && (prefix.M_len == 0 || std::memcmp(this->M_str, prefix.M_str, prefix.M_len) == 0);
+            }
+
+            [[nodiscard]] std::size_t hash() const
+            {
+                return hash_bytes(this->M_str, this->M_len);
+            }
+
+            /**
+             * @brief Index of the first `c` at or after `from`, npos if there is none; scans 16 characters at a time
+             */
+            [[nodiscard]] std::size_t find_char(const char &c, const std::size_t &from = 0) const
+            {
+                std::size_t i = from;
+#if defined(__SSE2__)
+                const __m128i needle = _mm_set1_epi8(c);
+                for (; i + 16 <= this->M_len; i += 16)
+                {
+                    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(this->M_str + i)), needle));
+                    if (mask != 0)
+                        return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+                }
+#endif
+                for (; i < this->M_len; i++)
+                    if (this->M_str[i] == c)
+                        return i;
+                return npos;
+            }
+
+            /**
+             * @brief Number of `c` in the view, used to count lines
+             */
+            [[nodiscard]] std::size_t count_char(const char &c) const
+            {
+                std::size_t count = 0;
+                for (std::size_t i = this->find_char(c); i != npos; i = this->find_char(c, i + 1))
+                    count++;
+                return count;
+            }
+
+            /**
+             * @brief Index of the first occurrence of `needle` at or after `from`, npos if there is none
+             */
+            [[nodiscard]] std::size_t find(const str_view &needle, const std::size_t &from = 0) const
+            {
+                if (needle.M_len == 0)
+                    return from <= this->M_len ? from : npos;
+                if (needle.M_len > this->M_len)
+                    return npos;
+                std::size_t last = this->M_len - needle.M_len;
+                for (std::size_t i = this->find_char(needle.M_str[0], from); i != npos && i <= last; i = this->find_char(needle.M_str[0], i + 1))
+                    if (std::memcmp(this->M_str + i, needle.M_str, needle.M_len) == 0)
+                        return i;
+                return npos;
+            }
+
+            [[nodiscard]] bool operator==(const str_view &other) const
+            {
+                return this->M_len == other.M_len && (this->M_len == 0 || std::memcmp(this->M_str, other.M_str, this->M_len) == 0);
+            }
+
+            [[nodiscard]] bool operator!=(const str_view &other) const
+            {
+                return !(*this == other);
+            }
+
+            [[nodiscard]] bool operator<(const str_view &other) const
+            {
+                return this->compare(other) < 0;
+            }
+        };
+    }
+}
+
+namespace std
+{
+    template <>
+    struct hash<horizon::horizon_deps::str_view>
+    {
+        std::size_t operator()(const horizon::horizon_deps::str_view &str) const
+        {
+            return str.hash();
+        }
+    };
+}
+
+#endif
@@ -5,29 +5,12 @@
  */
 
 #include "./string.hh"
+#include "../../src/misc/stats.hh"
 
 namespace horizon
 {
     namespace horizon_deps
     {
-        char *&string::str_catcpy(char *&dest, const char *src, std::size_t &updating_length)
-        {
-            if (!dest || !src)
-                return dest;
-            while ((dest[updating_length] = *src++))
-                updating_length++;
-            return dest;
-        }
-
-        char *&string::str_catcpy(char *&dest, const char &c, std::size_t &updating_length)
-        {
-            if (!dest)
-                return dest;
-            dest[updating_length] = c;
-            updating_length++;
-            return dest;
-        }
-
         std::size_t string::str_len(const char *s)
         {
             if (s)
@@ -40,15 +23,6 @@ namespace horizon
             return 0;
         }
 
-        char *&string::str_init_zero(char *&ptr, const std::size_t &begin, const std::size_t &end)
-        {
-            if (!ptr)
-                return ptr;
-            for (std::size_t i = begin; i < end; i++)
-                ptr[i] = 0;
-            return ptr;
-        }
-
         bool string::str_cmp(const char *str1, const char *str2)
         {
             if (!str1 && !str2)
@@ -74,6 +48,60 @@ namespace horizon
             return *str == c;
         }
 
+        bool string::is_inline() const
+        {
+            return this->M_str == this->M_sso;
+        }
+
+        void string::release()
+        {
+            if (this->M_str && !this->is_inline())
+                horizon_deps::deallocate(this->M_str);
+            this->M_str = nullptr;
+            this->M_len = 0;
+        }
+
+        char *string::allocate(const std::size_t &len)
+        {
+            this->release();
+            if (len <= string::SSO_CAPACITY)
+                this->M_str = this->M_sso;
+            else
+            {
+                this->M_str = static_cast<char *>(horizon_deps::allocate((len + 1) * sizeof(char)));
+                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
+                this->M_cap = len;
+                horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_ALLOCS);
+                horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_BYTES, len + 1);
+            }
+            this->M_str[len] = 0;
+            return this->M_str;
+        }
+
+        char *string::grow(const std::size_t &new_len)
+        {
+            std::size_t cap = this->capacity();
+            if (new_len <= cap)
+                return this->M_str;
+            std::size_t new_cap = (cap * 2 > new_len ? cap * 2 : new_len);
+            if (this->is_inline())
+            {
+                char *buff = static_cast<char *>(horizon_deps::allocate((new_cap + 1) * sizeof(char)));
+                horizon_misc::exit_heap_fail(buff, "horizon::horizon_deps::string");
+                std::memcpy(buff, this->M_sso, this->M_len + 1);
+                this->M_str = buff;
+            }
+            else
+            {
+                this->M_str = static_cast<char *>(horizon_deps::reallocate(this->M_str, (new_cap + 1) * sizeof(char)));
+                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
+            }
+            this->M_cap = new_cap;
+            horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_ALLOCS);
+            horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_BYTES, new_cap + 1);
+            return this->M_str;
+        }
+
         string::string()
         {
             this->M_len = 0;
@@ -83,50 +111,47 @@ namespace horizon
         string::string(const char &c)
         {
             this->M_len = 0;
-            this->M_str = static_cast<char *>(std::calloc(2, sizeof(char)));
-            horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-            this->M_str = string::str_catcpy(this->M_str, c, this->M_len);
+            this->M_str = nullptr;
+            this->allocate(1)[0] = c;
+            this->M_len = 1;
         }
 
         string::string(const char *src)
         {
+            this->M_len = 0;
+            this->M_str = nullptr;
             if (src)
             {
-                this->M_len = 0;
-                this->M_str = static_cast<char *>(std::calloc(string::str_len(src) + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-                this->M_str = string::str_catcpy(this->M_str, src, this->M_len);
-            }
-            else
-            {
-                this->M_len = 0;
-                this->M_str = nullptr;
+                std::size_t len = string::str_len(src);
+                std::memcpy(this->allocate(len), src, len);
+                this->M_len = len;
             }
         }
 
         string::string(const string &src)
         {
+            this->M_len = 0;
+            this->M_str = nullptr;
             if (src.M_str)
             {
-                this->M_len = 0;
-                this->M_str = static_cast<char *>(std::calloc(src.M_len + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-                this->M_str = string::str_catcpy(this->M_str, src.M_str, this->M_len);
-            }
-            else
-            {
-                this->M_len = 0;
-                this->M_str = nullptr;
+                std::memcpy(this->allocate(src.M_len), src.M_str, src.M_len);
+                this->M_len = src.M_len;
             }
         }
 
         string::string(string &&src) noexcept(true)
         {
-            this->M_str = src.M_str;
             this->M_len = src.M_len;
+            if (src.is_inline())
+            {
+                std::memcpy(this->M_sso, src.M_sso, src.M_len + 1);
+                this->M_str = this->M_sso;
+            }
+            else
+            {
+                this->M_str = src.M_str;
+                this->M_cap = src.M_cap;
+            }
 
             src.M_len = 0;
             src.M_str = nullptr;
@@ -134,103 +159,91 @@ namespace horizon
 
         string::string(const char *begin, const char *end)
         {
+            this->M_len = 0;
+            this->M_str = nullptr;
             if (begin && end)
             {
-                this->M_len = 0;
-                this->M_str = static_cast<char *>(std::calloc((static_cast<std::size_t>(end - begin)) + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-                for (const char *ptr = begin; ptr != end; ptr++)
-                    this->M_str[this->M_len++] = *ptr;
+                std::size_t len = static_cast<std::size_t>(end - begin);
+                std::memcpy(this->allocate(len), begin, len);
+                this->M_len = len;
             }
-            else
+        }
+
+        string::string(const str_view &view)
+        {
+            this->M_len = 0;
+            this->M_str = nullptr;
+            if (view.data())
             {
-                this->M_len = 0;
-                this->M_str = nullptr;
+                std::memcpy(this->allocate(view.length()), view.data(), view.length());
+                this->M_len = view.length();
             }
         }
 
         string::string(const char &c, const std::size_t &n)
         {
             this->M_len = 0;
-            this->M_str = static_cast<char *>(std::calloc(n + 1, sizeof(char)));
-            horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-            for (; this->M_len < n; this->M_len++)
-                this->M_str[this->M_len] = c;
+            this->M_str = nullptr;
+            std::memset(this->allocate(n), c, n);
+            this->M_len = n;
         }
 
         string &string::assign(const char &c)
         {
-            if (this->M_str)
-            {
-                std::free(this->M_str);
-                this->M_str = nullptr;
-            }
-            this->M_len = 0;
-            this->M_str = static_cast<char *>(std::calloc(2, sizeof(char)));
-            horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-            this->M_str = string::str_catcpy(this->M_str, c, this->M_len);
+            this->allocate(1)[0] = c;
+            this->M_len = 1;
             return *this;
         }
 
         string &string::assign(const char *src)
         {
-            if (this->M_str)
-            {
-                std::free(this->M_str);
-                this->M_str = nullptr;
-            }
             if (src)
             {
-                this->M_len = 0;
-                this->M_str = static_cast<char *>(std::calloc(string::str_len(src) + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-                this->M_str = string::str_catcpy(this->M_str, src, this->M_len);
+                std::size_t len = string::str_len(src);
+                if (src >= this->M_str && this->M_str && src <= this->M_str + this->M_len)
+                {
+                    // `src` points into this string
+                    string temp(src);
+                    return this->assign(std::move(temp));
+                }
+                std::memcpy(this->allocate(len), src, len);
+                this->M_len = len;
             }
             else
-            {
-                this->M_len = 0;
-                this->M_str = nullptr;
-            }
+                this->release();
             return *this;
         }
 
         string &string::assign(const string &src)
         {
-            if (this->M_str)
-            {
-                std::free(this->M_str);
-                this->M_str = nullptr;
-            }
+            if (this == &src)
+                return *this;
             if (src.M_str)
             {
-                this->M_len = 0;
-                this->M_str = static_cast<char *>(std::calloc(src.M_len + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-
-                this->M_str = string::str_catcpy(this->M_str, src.M_str, this->M_len);
+                std::memcpy(this->allocate(src.M_len), src.M_str, src.M_len);
+                this->M_len = src.M_len;
             }
             else
-            {
-                this->M_len = 0;
-                this->M_str = nullptr;
-            }
+                this->release();
             return *this;
         }
 
         string &string::assign(string &&src) noexcept(true)
         {
-            if (this->M_str)
+            if (this == &src)
+                return *this;
+            this->release();
+            this->M_len = src.M_len;
+            if (src.is_inline())
             {
-                std::free(this->M_str);
-                this->M_str = nullptr;
+                std::memcpy(this->M_sso, src.M_sso, src.M_len + 1);
+                this->M_str = this->M_sso;
+            }
+            else
+            {
+                this->M_str = src.M_str;
+                this->M_cap = src.M_cap;
             }
-
-            this->M_str = src.M_str;
-            this->M_len = src.M_len;
 
             src.M_len = 0;
             src.M_str = nullptr;
@@ -241,17 +254,38 @@ namespace horizon
         {
             if (this->M_str)
             {
-                this->M_str = static_cast<char *>(std::realloc(this->M_str, (this->M_len + 2) * sizeof(char)));
-                horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-                this->M_str = string::str_init_zero(this->M_str, this->M_len, this->M_len + 2);
-
+                this->grow(this->M_len + 1);
                 this->M_str[this->M_len++] = c;
+                this->M_str[this->M_len] = 0;
                 return *this;
             }
             else
                 return this->assign(c);
         }
 
+        string &string::append(const str_view &view)
+        {
+            if (!view.data())
+                return *this;
+            if (view.data() >= this->M_str && view.data() <= this->M_str + this->M_len)
+            {
+                // `view` points into this string, which may move
+                string temp(view);
+                return this->append(temp);
+            }
+            if (!this->M_str)
+            {
+                std::memcpy(this->allocate(view.length()), view.data(), view.length());
+                this->M_len = view.length();
+                return *this;
+            }
+            this->grow(this->M_len + view.length());
+            std::memcpy(this->M_str + this->M_len, view.data(), view.length());
+            this->M_len += view.length();
+            this->M_str[this->M_len] = 0;
+            return *this;
+        }
+
         string &string::append(const char *src)
         {
             if (this->M_str)
@@ -259,11 +293,16 @@ namespace horizon
                 if (src)
                 {
                     std::size_t src_len = string::str_len(src);
-                    this->M_str = static_cast<char *>(std::realloc(this->M_str, (this->M_len + src_len + 1) * sizeof(char)));
-                    horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-                    this->M_str = string::str_init_zero(this->M_str, this->M_len, this->M_len + src_len);
-
-                    this->M_str = string::str_catcpy(this->M_str, src, this->M_len);
+                    if (src >= this->M_str && src <= this->M_str + this->M_len)
+                    {
+                        // `src` points into this string, which may move
+                        string temp(src);
+                        return this->append(temp);
+                    }
+                    this->grow(this->M_len + src_len);
+                    std::memcpy(this->M_str + this->M_len, src, src_len);
+                    this->M_len += src_len;
+                    this->M_str[this->M_len] = 0;
                 }
                 return *this;
             }
@@ -277,11 +316,11 @@ namespace horizon
             {
                 if (src.M_str)
                 {
-                    this->M_str = static_cast<char *>(std::realloc(this->M_str, (this->M_len + src.M_len + 1) * sizeof(char)));
-                    horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-                    this->M_str = string::str_init_zero(this->M_str, this->M_len, this->M_len + src.M_len);
-
-                    this->M_str = string::str_catcpy(this->M_str, src.M_str, this->M_len);
+                    std::size_t src_len = src.M_len; // `src` may be this string
+                    this->grow(this->M_len + src_len);
+                    std::memcpy(this->M_str + this->M_len, src.M_str, src_len);
+                    this->M_len += src_len;
+                    this->M_str[this->M_len] = 0;
                 }
                 return *this;
             }
@@ -338,16 +377,14 @@ namespace horizon
         {
             if (__s)
             {
-                std::size_t __s_len = string::str_len(__s), b_len = 0;
-                char *buffer = static_cast<char *>(std::calloc(__s_len * 2 + this->M_len + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(buffer, "horizon::horizon_deps::string");
-                string::str_catcpy(buffer, __s, b_len);
-                string::str_catcpy(buffer, this->M_str, b_len);
-                string::str_catcpy(buffer, __s, b_len);
-
+                std::size_t __s_len = string::str_len(__s);
                 string val;
-                val.M_str = buffer;
-                val.M_len = b_len;
+                char *buffer = val.allocate(__s_len * 2 + this->M_len);
+                std::memcpy(buffer, __s, __s_len);
+                if (this->M_str)
+                    std::memcpy(buffer + __s_len, this->M_str, this->M_len);
+                std::memcpy(buffer + __s_len + this->M_len, __s, __s_len);
+                val.M_len = __s_len * 2 + this->M_len;
                 return val;
             }
             return *this;
@@ -356,30 +393,13 @@ namespace horizon
         string string::wrap(const string &__s) const
         {
             if (__s.M_str)
-            {
-                std::size_t b_len = 0;
-                char *buffer = static_cast<char *>(std::calloc(__s.M_len * 2 + this->M_len + 1, sizeof(char)));
-                horizon_misc::exit_heap_fail(buffer, "horizon::horizon_deps::string");
-                string::str_catcpy(buffer, __s.M_str, b_len);
-                string::str_catcpy(buffer, this->M_str, b_len);
-                string::str_catcpy(buffer, __s.M_str, b_len);
-
-                string val;
-                val.M_str = buffer;
-                val.M_len = b_len;
-                return val;
-            }
+                return this->wrap(__s.M_str);
             return *this;
         }
 
         string &string::clear()
         {
-            if (this->M_str)
-            {
-                std::free(this->M_str);
-                this->M_str = nullptr;
-            }
-            this->M_len = 0;
+            this->release();
             return *this;
         }
 
@@ -389,49 +409,73 @@ namespace horizon
             {
                 if (this->M_str)
                 {
-                    this->M_str = static_cast<char *>(std::realloc(this->M_str, sizeof(char) * new_length));
-                    horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
-                    this->M_str = string::str_init_zero(this->M_str, this->M_len, new_length);
+                    std::size_t old_end = this->M_len + 1;
+                    this->grow(new_length - 1);
+                    if (new_length > old_end)
+                        std::memset(this->M_str + old_end, 0, new_length - old_end);
                 }
                 else
                 {
-                    this->M_str = static_cast<char *>(std::calloc(new_length, sizeof(char)));
+                    this->allocate(new_length - 1);
+                    std::memset(this->M_str, 0, new_length);
+                }
+            }
+            return *this;
+        }
+
+        string &string::reserve(const std::size_t &new_capacity)
+        {
+            if (!this->M_str)
+                this->allocate(0);
+            if (new_capacity > this->capacity())
+            {
+                if (this->is_inline())
+                    this->grow(new_capacity);
+                else
+                {
+                    this->M_str = static_cast<char *>(horizon_deps::reallocate(this->M_str, (new_capacity + 1) * sizeof(char)));
                     horizon_misc::exit_heap_fail(this->M_str, "horizon::horizon_deps::string");
+                    this->M_cap = new_capacity;
+                    horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_ALLOCS);
+                    horizon_misc::count(horizon_misc::stat_counter::STAT_STRING_BYTES, new_capacity + 1);
                 }
             }
             return *this;
         }
 
+        std::size_t string::capacity() const
+        {
+            if (!this->M_str)
+                return 0;
+            return this->is_inline() ? string::SSO_CAPACITY : this->M_cap;
+        }
+
         string string::substr(const std::size_t &index, std::size_t sub_len) const
         {
             if (index >= this->M_len || !this->M_str)
                 return nullptr;
             if (sub_len == static_cast<std::size_t>(-1) || index + sub_len > this->M_len)
                 sub_len = this->M_len - index;
-            char *buff = static_cast<char *>(std::calloc(sub_len + 1, sizeof(char)));
-            horizon_misc::exit_heap_fail(buff, "horizon::horizon_deps::string");
-
-            std::memmove(buff, this->M_str + index, sub_len * sizeof(char));
 
             string ret;
-            ret.M_str = buff;
+            std::memcpy(ret.allocate(sub_len), this->M_str + index, sub_len * sizeof(char));
             ret.M_len = sub_len;
             return ret;
         }
 
-        std::size_t string::hash() const
+        str_view string::view(const std::size_t &index, const std::size_t &sub_len) const
         {
-            std::size_t p = 53;
-            std::size_t m = 1e9 + 9;
-            long long power_of_p = 1;
-            long long hash_val = 0;
+            return str_view(this->M_str, this->M_len).substr(index, sub_len);
+        }
 
-            for (std::size_t i = 0; i < this->M_len; i++)
-            {
-                hash_val = (hash_val + (this->M_str[i] - 97 + 1) * power_of_p) % m;
-                power_of_p = (power_of_p * p) % m;
-            }
-            return (hash_val % m + m) % m;
+        string::operator str_view() const
+        {
+            return str_view(this->M_str, this->M_len);
+        }
+
+        std::size_t string::hash() const
+        {
+            return hash_bytes(this->M_str, this->M_len);
         }
 
         unsigned string::multichar_uint() const
@@ -527,21 +571,7 @@ namespace horizon
 
         string &string::operator=(string &&src) noexcept(true)
         {
-            if (this != &src)
-            {
-                if (this->M_str)
-                {
-                    std::free(this->M_str);
-                    this->M_str = nullptr;
-                }
-
-                this->M_str = src.M_str;
-                this->M_len = src.M_len;
-
-                src.M_len = 0;
-                src.M_str = nullptr;
-            }
-            return *this;
+            return this->assign(std::move(src));
         }
 
         int string::lexicographical_comparison(const char *src) const
@@ -591,6 +621,16 @@ namespace horizon
             return this->compare(src);
         }
 
+        bool string::operator==(const str_view &view) const
+        {
+            return str_view(this->M_str, this->M_len) == view;
+        }
+
+        bool string::operator!=(const str_view &view) const
+        {
+            return !(*this == view);
+        }
+
         bool string::operator!=(const char &c) const
         {
             return !this->compare(c);
@@ -618,24 +658,14 @@ namespace horizon
 
         string::~string()
         {
-            if (this->M_str)
-            {
-                std::free(this->M_str);
-                this->M_str = nullptr;
-            }
-            this->M_len = 0;
+            this->release();
         }
 
         string string::to_string(const unsigned int &num)
         {
-            char *ptr = static_cast<char *>(std::calloc(std::numeric_limits<unsigned int>::digits10 + 1, sizeof(char)));
-            horizon_misc::exit_heap_fail(ptr, "horizon::horizon_deps::string");
-            int sn_len = std::snprintf(ptr, std::numeric_limits<unsigned int>::digits10, "%u", num);
-
-            string ret;
-            ret.M_str = ptr;
-            ret.M_len = sn_len;
-            return ret;
+            char buff[std::numeric_limits<unsigned int>::digits10 + 2];
+            int sn_len = std::snprintf(buff, sizeof(buff), "%u", num);
+            return string(buff, buff + sn_len);
         }
     }
 }
@@ -15,6 +15,9 @@
 
 #include "../../src/misc/exit_heap_fail.hh"
 #include "../../src/defines/defines.h"
+#include "../allocator/allocator.hh"
+#include "../hash/hash.hh"
+#include "./str_view.hh"
 
 namespace horizon
 {
@@ -25,24 +28,39 @@ namespace horizon
          * RULES:
          *      1. Make it simple and raw
          *      2. Make only those functions which are really needed in the program
-         *      3. USE `calloc` and `realloc` only
+         *      3. USE `horizon_deps::allocate` and `horizon_deps::reallocate` only
          *      4. If any function is missing and is really needed, make it yourself
          *      5. Main priority of this class is ONLY performance and efficiency both instruction and memory wise
          *      6. NO function should create any memory error or leaks
+         * Strings of up to `SSO_CAPACITY` characters are kept inline in `M_sso` (`M_str` then points to `M_sso`),
+         * so most lexemes never touch the heap. A default-constructed string is still null.
+         * Heap buffers grow geometrically and remember their capacity in `M_cap` (which shares its bytes with `M_sso`),
+         * so appending is amortized O(1). Bytes past the terminating NUL are never initialized.
          */
         class string
         {
           private:
-            static char *&str_catcpy(char *&dest, const char *src, std::size_t &updating_length);
-            static char *&str_catcpy(char *&dest, const char &c, std::size_t &updating_length);
             static std::size_t str_len(const char *s);
-            static char *&str_init_zero(char *&ptr, const std::size_t &begin, const std::size_t &end);
             static bool str_cmp(const char *str1, const char *str2);
             static bool str_cmp(const char *str, const std::size_t &len, const char &c);
 
+          public:
+            static constexpr std::size_t SSO_CAPACITY = 23;
+
           private:
             char *M_str;
             std::size_t M_len;
+            union
+            {
+                char M_sso[SSO_CAPACITY + 1];
+                std::size_t M_cap; // heap capacity, excluding the NUL
+            };
+
+          private:
+            [[nodiscard]] bool is_inline() const;
+            void release();
+            char *allocate(const std::size_t &len);
+            char *grow(const std::size_t &new_len);
 
           public:
             string();
@@ -52,6 +70,7 @@ namespace horizon
             string(string &&src) noexcept(true);
             string(const char *begin, const char *end);
             string(const char &c, const std::size_t &n);
+            explicit string(const str_view &view);
             string &assign(const char &c);
             string &assign(const char *src);
             string &assign(const string &src);
@@ -59,6 +78,7 @@ namespace horizon
             string &append(const char &c);
             string &append(const char *src);
             string &append(const string &src);
+            string &append(const str_view &view);
             [[nodiscard]] char *&raw();
             [[nodiscard]] const char *c_str() const;
             [[nodiscard]] const std::size_t &length() const;
@@ -72,7 +92,19 @@ namespace horizon
             [[nodiscard]] string wrap(const string &__s) const;
             string &clear();
             string &resize(const std::size_t &new_length);
+
+            /**
+             * @brief Makes room for at least `new_capacity` characters (plus the NUL) without changing the content, a null string becomes empty
+             */
+            string &reserve(const std::size_t &new_capacity);
+            [[nodiscard]] std::size_t capacity() const;
             [[nodiscard]] string substr(const std::size_t &index, std::size_t sub_len = static_cast<std::size_t>(-1)) const;
+
+            /**
+             * @brief Same as substr() without copying, the view is invalidated by any change to this string
+             */
+            [[nodiscard]] str_view view(const std::size_t &index = 0, const std::size_t &sub_len = str_view::npos) const;
+            [[nodiscard]] operator str_view() const;
             [[nodiscard]] std::size_t hash() const;
             [[nodiscard]] unsigned multichar_uint() const;
             [[nodiscard]] const char &operator[](const std::size_t &__index) const;
@@ -92,9 +124,11 @@ namespace horizon
             [[nodiscard]] bool operator==(const char &c) const;
             [[nodiscard]] bool operator==(const char *src) const;
             [[nodiscard]] bool operator==(const string &src) const;
+            [[nodiscard]] bool operator==(const str_view &view) const;
             [[nodiscard]] bool operator!=(const char &c) const;
             [[nodiscard]] bool operator!=(const char *src) const;
             [[nodiscard]] bool operator!=(const string &src) const;
+            [[nodiscard]] bool operator!=(const str_view &view) const;
             [[nodiscard]] bool operator<(const char *src) const;
             [[nodiscard]] bool operator<(const string &src) const;
             ~string();
@@ -109,10 +143,17 @@ namespace std
     template <>
     struct hash<horizon::horizon_deps::string>
     {
+        using is_transparent = void; // a str_view hashes like the string it views
+
         std::size_t operator()(const horizon::horizon_deps::string &str) const
         {
             return str.hash();
         }
+
+        std::size_t operator()(const horizon::horizon_deps::str_view &str) const
+        {
+            return str.hash();
+        }
     };
 }
 
@@ -0,0 +1,31 @@
+/**
+ * @file traits.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_TRAITS_TRAITS_HH
+#define HORIZON_DEPS_TRAITS_TRAITS_HH
+
+#include <type_traits>
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * A type is trivially relocatable if moving an object to a new address and ending the old one is the same as copying its bytes,
+         * i.e. it holds no pointer into itself. Containers then move such elements with memcpy/realloc.
+         * Specialize it next to the type: `string` is NOT relocatable, its small-string buffer is pointed to by `M_str`
+         */
+        template <typename T>
+        struct is_trivially_relocatable : std::is_trivially_copyable<T>
+        {
+        };
+
+        template <typename T>
+        inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+    }
+}
+
+#endif
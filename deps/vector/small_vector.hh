@@ -0,0 +1,351 @@
+/**
+ * @file small_vector.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DEPS_VECTOR_SMALL_VECTOR_HH
+#define HORIZON_DEPS_VECTOR_SMALL_VECTOR_HH
+
+#include <utility>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+
+#include "../../src/misc/exit_heap_fail.hh"
+#include "../../src/misc/stats.hh"
+#include "../../src/colorize/colorize.h"
+#include "../../src/defines/defines.h"
+#include "../allocator/allocator.hh"
+#include "../traits/traits.hh"
+
+namespace horizon
+{
+    namespace horizon_deps
+    {
+        /**
+         * A vector whose first `N` elements live inside the object, it only allocates once it grows past `N`.
+         * Meant for short lists (call arguments, qualifiers, declarators) that almost never exceed a handful of items.
+         * `M_data` points into the object while inline, so a small_vector is not trivially relocatable.
+         */
+        template <typename T, std::size_t N>
+        class small_vector
+        {
+            static_assert(N > 0, "horizon::horizon_deps::small_vector: inline capacity must not be 0");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "horizon::horizon_deps::small_vector: over-aligned types are not supported");
+
+          private:
+            T *M_data;
+            std::size_t M_len, M_cap;
+            alignas(T) unsigned char M_inline[N * sizeof(T)];
+
+          private:
+            [[nodiscard]] bool is_inline() const;
+            [[nodiscard]] T *inline_data();
+            void relocate(const std::size_t &new_cap);
+            void steal(small_vector &other);
+            [[noreturn]] void out_of_range(const std::size_t &nth) const;
+
+          public:
+            small_vector();
+            small_vector(const small_vector &other);
+            small_vector(small_vector &&other) noexcept(true);
+            [[nodiscard]] const std::size_t &length() const;
+            [[nodiscard]] const std::size_t &capacity() const;
+            small_vector &add(const T &item);
+            small_vector &add(T &&item);
+            template <typename... ARGS>
+            T &emplace(ARGS &&...args);
+            small_vector &reserve(const std::size_t &new_cap);
+            small_vector &remove();
+            [[nodiscard]] bool is_empty() const;
+            small_vector &erase();
+            [[nodiscard]] const T *raw() const;
+            [[nodiscard]] T *raw();
+            [[nodiscard]] const T *begin() const;
+            [[nodiscard]] T *begin();
+            [[nodiscard]] const T *end() const;
+            [[nodiscard]] T *end();
+            [[nodiscard]] const T &operator[](const std::size_t &nth) const;
+            [[nodiscard]] T &operator[](const std::size_t &nth);
+            small_vector &operator=(const small_vector &other);
+            small_vector &operator=(small_vector &&other) noexcept(true);
+            ~small_vector();
+        };
+
+        template <typename T, std::size_t N>
+        bool small_vector<T, N>::is_inline() const
+        {
+            return this->M_data == reinterpret_cast<const T *>(this->M_inline);
+        }
+
+        template <typename T, std::size_t N>
+        T *small_vector<T, N>::inline_data()
+        {
+            return reinterpret_cast<T *>(this->M_inline);
+        }
+
+        template <typename T, std::size_t N>
+        void small_vector<T, N>::relocate(const std::size_t &new_cap)
+        {
+            T *old = this->M_data;
+            bool was_inline = this->is_inline();
+            if (new_cap <= N)
+                this->M_data = this->inline_data();
+            else
+            {
+                this->M_data = static_cast<T *>(horizon_deps::allocate(new_cap * sizeof(T)));
+                horizon_misc::exit_heap_fail(this->M_data, "horizon::horizon_deps::small_vector");
+                if (new_cap > this->M_cap)
+                {
+                    horizon_misc::count(horizon_misc::stat_counter::STAT_VECTOR_GROWTHS);
+                    horizon_misc::count(horizon_misc::stat_counter::STAT_VECTOR_BYTES, new_cap * sizeof(T));
+                }
+            }
+            for (std::size_t i = 0; i < this->M_len; i++)
+            {
+                ::new (static_cast<void *>(this->M_data + i)) T(std::move(old[i]));
+                old[i].~T();
+            }
+            if (!was_inline)
+                horizon_deps::deallocate(static_cast<void *>(old));
+            this->M_cap = (new_cap <= N ? N : new_cap);
+        }
+
+        template <typename T, std::size_t N>
+        void small_vector<T, N>::steal(small_vector &other)
+        {
+            if (other.is_inline())
+            {
+                this->M_data = this->inline_data();
+                for (std::size_t i = 0; i < other.M_len; i++)
+                {
+                    ::new (static_cast<void *>(this->M_data + i)) T(std::move(other.M_data[i]));
+                    other.M_data[i].~T();
+                }
+                this->M_cap = N;
+            }
+            else
+            {
+                this->M_data = other.M_data;
+                this->M_cap = other.M_cap;
+            }
+            this->M_len = other.M_len;
+
+            other.M_data = other.inline_data();
+            other.M_len = 0;
+            other.M_cap = N;
+        }
+
+        template <typename T, std::size_t N>
+        void small_vector<T, N>::out_of_range(const std::size_t &nth) const
+        {
+            if (COLOR_ERR)
+                std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " " ENCLOSE(WHITE_FG, "horizon::horizon_deps::small_vector:") " invalid memory access in %p for %zu, max was %zu\n", static_cast<const void *>(this->M_data), nth, this->M_len);
+            else
+                std::fprintf(stderr, "horizon: error: horizon::horizon_deps::small_vector: invalid memory access in %p for %zu, max was %zu\n", static_cast<const void *>(this->M_data), nth, this->M_len);
+            std::exit(EXIT_FAILURE);
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N>::small_vector()
+        {
+            this->M_data = this->inline_data();
+            this->M_len = 0;
+            this->M_cap = N;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N>::small_vector(const small_vector &other)
+        {
+            this->M_data = this->inline_data();
+            this->M_len = 0;
+            this->M_cap = N;
+            this->reserve(other.M_len);
+            for (std::size_t i = 0; i < other.M_len; i++)
+                ::new (static_cast<void *>(this->M_data + i)) T(other.M_data[i]);
+            this->M_len = other.M_len;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N>::small_vector(small_vector &&other) noexcept(true)
+        {
+            this->steal(other);
+        }
+
+        template <typename T, std::size_t N>
+        const std::size_t &small_vector<T, N>::length() const
+        {
+            return this->M_len;
+        }
+
+        template <typename T, std::size_t N>
+        const std::size_t &small_vector<T, N>::capacity() const
+        {
+            return this->M_cap;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::add(const T &item)
+        {
+            if (this->M_len == this->M_cap)
+            {
+                T copy(item); // `item` may live in this vector
+                this->relocate(this->M_cap * 2);
+                ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::move(copy));
+            }
+            else
+                ::new (static_cast<void *>(this->M_data + this->M_len)) T(item);
+            this->M_len++;
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::add(T &&item)
+        {
+            if (this->M_len == this->M_cap)
+            {
+                T temp(std::move(item));
+                this->relocate(this->M_cap * 2);
+                ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::move(temp));
+            }
+            else
+                ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::move(item));
+            this->M_len++;
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        template <typename... ARGS>
+        T &small_vector<T, N>::emplace(ARGS &&...args)
+        {
+            if (this->M_len == this->M_cap)
+                this->relocate(this->M_cap * 2);
+            T *slot = ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::forward<ARGS>(args)...);
+            this->M_len++;
+            return *slot;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::reserve(const std::size_t &new_cap)
+        {
+            if (new_cap > this->M_cap)
+                this->relocate(new_cap);
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::remove()
+        {
+            if (this->M_len == 0)
+                return *this;
+            this->M_data[--this->M_len].~T();
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        bool small_vector<T, N>::is_empty() const
+        {
+            return this->M_len == 0;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::erase()
+        {
+            for (std::size_t i = 0; i < this->M_len; i++)
+                this->M_data[i].~T();
+            if (!this->is_inline())
+                horizon_deps::deallocate(static_cast<void *>(this->M_data));
+            this->M_data = this->inline_data();
+            this->M_len = 0;
+            this->M_cap = N;
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        const T *small_vector<T, N>::raw() const
+        {
+            return this->M_data;
+        }
+
+        template <typename T, std::size_t N>
+        T *small_vector<T, N>::raw()
+        {
+            return this->M_data;
+        }
+
+        template <typename T, std::size_t N>
+        const T *small_vector<T, N>::begin() const
+        {
+            return this->M_data;
+        }
+
+        template <typename T, std::size_t N>
+        T *small_vector<T, N>::begin()
+        {
+            return this->M_data;
+        }
+
+        template <typename T, std::size_t N>
+        const T *small_vector<T, N>::end() const
+        {
+            return this->M_data + this->M_len;
+        }
+
+        template <typename T, std::size_t N>
+        T *small_vector<T, N>::end()
+        {
+            return this->M_data + this->M_len;
+        }
+
+        template <typename T, std::size_t N>
+        const T &small_vector<T, N>::operator[](const std::size_t &nth) const
+        {
+            if (nth < this->M_len)
+                return this->M_data[nth];
+            this->out_of_range(nth);
+        }
+
+        template <typename T, std::size_t N>
+        T &small_vector<T, N>::operator[](const std::size_t &nth)
+        {
+            if (nth < this->M_len)
+                return this->M_data[nth];
+            this->out_of_range(nth);
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::operator=(const small_vector &other)
+        {
+            if (this != &other)
+            {
+                this->erase();
+                this->reserve(other.M_len);
+                for (std::size_t i = 0; i < other.M_len; i++)
+                    ::new (static_cast<void *>(this->M_data + i)) T(other.M_data[i]);
+                this->M_len = other.M_len;
+            }
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N> &small_vector<T, N>::operator=(small_vector &&other) noexcept(true)
+        {
+            if (this != &other)
+            {
+                this->erase();
+                this->steal(other);
+            }
+            return *this;
+        }
+
+        template <typename T, std::size_t N>
+        small_vector<T, N>::~small_vector()
+        {
+            this->erase();
+        }
+    }
+}
+
+#endif
@@ -9,10 +9,16 @@
 
 #include <initializer_list>
 #include <utility>
+#include <new>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cstddef>
 
 #include "../../src/misc/exit_heap_fail.hh"
+#include "../../src/misc/stats.hh"
+#include "../allocator/allocator.hh"
+#include "../traits/traits.hh"
 
 namespace horizon
 {
@@ -26,10 +32,14 @@ namespace horizon
          *      3. If any function is missing and is really needed, make it yourself
          *      4. Main priority of this class is ONLY performance and efficiency both instruction and memory wise
          *      5. NO function should create any memory error or leaks
+         * Storage is raw memory from `horizon_deps::allocate`, only the first `M_len` slots hold constructed objects.
+         * Trivially relocatable elements are moved by `horizon_deps::reallocate`, every other type is move-constructed into the new block.
          */
         template <typename T>
         class vector
         {
+            static_assert(alignof(T) <= alignof(std::max_align_t), "horizon::horizon_deps::vector: over-aligned types are not supported");
+
           private:
             T *M_data;
             std::size_t M_len, M_cap;
@@ -37,10 +47,16 @@ namespace horizon
           private:
             void init_vector(const std::size_t &N);
             void resize_vector();
+            void relocate(const std::size_t &new_cap);
+            void destroy_all();
 
           public:
             vector();
             vector(T *ptr_begin, T *ptr_end);
+
+            /**
+             * @brief Adopts `ptr`, which must hold `__len` constructed objects in a block from `horizon_deps::allocate`
+             */
             vector(T *ptr, const std::size_t &__len);
             vector(const vector &vec);
             vector(vector &&other) noexcept(true);
@@ -51,6 +67,17 @@ namespace horizon
             [[nodiscard]] const std::size_t &capacity() const;
             vector &add(const T &item);
             vector &add(T &&item);
+
+            /**
+             * @brief Constructs a new last element in place from `args`
+             */
+            template <typename... ARGS>
+            T &emplace(ARGS &&...args);
+
+            /**
+             * @brief Makes room for at least `new_cap` elements without changing the length
+             */
+            vector &reserve(const std::size_t &new_cap);
             vector &remove();
             vector &remove(const std::size_t &nth);
             [[nodiscard]] bool is_empty() const;
@@ -60,9 +87,9 @@ namespace horizon
             [[nodiscard]] const T *raw() const;
             [[nodiscard]] T *&raw();
             [[nodiscard]] const T *begin() const;
-            [[nodiscard]] T *&begin();
+            [[nodiscard]] T *begin();
             [[nodiscard]] const T *end() const;
-            [[nodiscard]] T *&end();
+            [[nodiscard]] T *end();
             [[nodiscard]] const T &operator[](const std::size_t &nth) const;
             [[nodiscard]] T &operator[](const std::size_t &nth);
             vector &operator=(const vector &vec);
@@ -73,22 +100,55 @@ namespace horizon
         template <typename T>
         void vector<T>::init_vector(const std::size_t &N)
         {
-            this->M_data = new T[N];
+            this->M_cap = (N == 0 ? 1 : N);
+            this->M_data = static_cast<T *>(horizon_deps::allocate(this->M_cap * sizeof(T)));
             horizon_misc::exit_heap_fail(this->M_data, "horizon::horizon_deps::vector");
-            this->M_cap = N;
             this->M_len = 0;
         }
 
+        template <typename T>
+        void vector<T>::relocate(const std::size_t &new_cap)
+        {
+            if (new_cap > this->M_cap)
+            {
+                horizon_misc::count(horizon_misc::stat_counter::STAT_VECTOR_GROWTHS);
+                horizon_misc::count(horizon_misc::stat_counter::STAT_VECTOR_BYTES, new_cap * sizeof(T));
+            }
+            if constexpr (is_trivially_relocatable_v<T>)
+            {
+                this->M_data = static_cast<T *>(horizon_deps::reallocate(static_cast<void *>(this->M_data), new_cap * sizeof(T)));
+                horizon_misc::exit_heap_fail(this->M_data, "horizon::horizon_deps::vector");
+            }
+            else
+            {
+                T *old = this->M_data;
+                this->M_data = static_cast<T *>(horizon_deps::allocate(new_cap * sizeof(T)));
+                horizon_misc::exit_heap_fail(this->M_data, "horizon::horizon_deps::vector");
+                for (std::size_t i = 0; i < this->M_len; i++)
+                {
+                    ::new (static_cast<void *>(this->M_data + i)) T(std::move(old[i]));
+                    old[i].~T();
+                }
+                horizon_deps::deallocate(static_cast<void *>(old));
+            }
+            this->M_cap = new_cap;
+        }
+
         template <typename T>
         void vector<T>::resize_vector()
         {
-            this->M_cap *= 2;
-            T *temp = new T[this->M_cap];
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::vector");
-            for (std::size_t i = 0; i < this->M_len; i++)
-                temp[i] = std::move(this->M_data[i]);
-            delete[] this->M_data;
-            this->M_data = temp;
+            this->relocate(this->M_cap * 2);
+        }
+
+        template <typename T>
+        void vector<T>::destroy_all()
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                for (std::size_t i = 0; i < this->M_len; i++)
+                    this->M_data[i].~T();
+            }
+            this->M_len = 0;
         }
 
         template <typename T>
@@ -201,8 +261,17 @@ namespace horizon
             if (!this->M_data)
                 this->init_vector(16);
             if (this->M_len == this->M_cap)
+            {
+                if (&item >= this->M_data && &item < this->M_data + this->M_len)
+                {
+                    // `item` lives in this vector and is about to move
+                    T copy(item);
+                    return this->add(std::move(copy));
+                }
                 this->resize_vector();
-            this->M_data[this->M_len++] = item;
+            }
+            ::new (static_cast<void *>(this->M_data + this->M_len)) T(item);
+            this->M_len++;
             return *this;
         }
 
@@ -212,8 +281,42 @@ namespace horizon
             if (!this->M_data)
                 this->init_vector(16);
             if (this->M_len == this->M_cap)
+            {
+                if (&item >= this->M_data && &item < this->M_data + this->M_len)
+                {
+                    T temp(std::move(item));
+                    this->resize_vector();
+                    ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::move(temp));
+                    this->M_len++;
+                    return *this;
+                }
                 this->resize_vector();
-            this->M_data[this->M_len++] = std::move(item);
+            }
+            ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::move(item));
+            this->M_len++;
+            return *this;
+        }
+
+        template <typename T>
+        template <typename... ARGS>
+        T &vector<T>::emplace(ARGS &&...args)
+        {
+            if (!this->M_data)
+                this->init_vector(16);
+            if (this->M_len == this->M_cap)
+                this->resize_vector();
+            T *slot = ::new (static_cast<void *>(this->M_data + this->M_len)) T(std::forward<ARGS>(args)...);
+            this->M_len++;
+            return *slot;
+        }
+
+        template <typename T>
+        vector<T> &vector<T>::reserve(const std::size_t &new_cap)
+        {
+            if (!this->M_data)
+                this->init_vector(new_cap);
+            else if (new_cap > this->M_cap)
+                this->relocate(new_cap);
             return *this;
         }
 
@@ -243,7 +346,7 @@ namespace horizon
             {
                 this->M_data[i] = std::move(this->M_data[i + 1]);
             }
-            this->M_len--;
+            this->M_data[--this->M_len].~T();
             return *this;
         }
 
@@ -263,7 +366,10 @@ namespace horizon
         vector<T> &vector<T>::erase()
         {
             if (this->M_data)
-                delete[] this->M_data;
+            {
+                this->destroy_all();
+                horizon_deps::deallocate(static_cast<void *>(this->M_data));
+            }
             this->M_data = nullptr;
             this->M_len = 0;
             this->M_cap = 0;
@@ -273,15 +379,9 @@ namespace horizon
         template <typename T>
         vector<T> &vector<T>::shrink_to_fit()
         {
-            if (!this->M_data)
+            if (!this->M_data || this->M_len == this->M_cap || this->M_len == 0)
                 return *this;
-            T *temp = new T[this->M_len];
-            horizon_misc::exit_heap_fail(temp, "horizon::horizon_deps::vector");
-            for (std::size_t i = 0; i < this->M_len; i++)
-                temp[i] = std::move(this->M_data[i]);
-            this->M_cap = this->M_len;
-            delete[] this->M_data;
-            this->M_data = temp;
+            this->relocate(this->M_len);
             return *this;
         }
 
@@ -304,7 +404,7 @@ namespace horizon
         }
 
         template <typename T>
-        T *&vector<T>::begin()
+        T *vector<T>::begin()
         {
             return this->M_data;
         }
@@ -316,7 +416,7 @@ namespace horizon
         }
 
         template <typename T>
-        T *&vector<T>::end()
+        T *vector<T>::end()
         {
             return this->M_data + this->M_len;
         }
@@ -350,13 +450,14 @@ namespace horizon
         {
             if (this != &vec)
             {
-                if (this->M_data)
-                    delete[] this->M_data;
-                this->M_cap = vec.M_cap;
-                this->init_vector(this->M_cap);
-                this->M_len = vec.M_len;
-                for (std::size_t i = 0; i < vec.M_len; i++)
-                    this->M_data[i] = vec.M_data[i];
+                this->erase();
+                if (vec.M_data)
+                {
+                    this->init_vector(vec.M_cap);
+                    for (std::size_t i = 0; i < vec.M_len; i++)
+                        ::new (static_cast<void *>(this->M_data + i)) T(vec.M_data[i]);
+                    this->M_len = vec.M_len;
+                }
             }
             return *this;
         }
@@ -366,8 +467,7 @@ namespace horizon
         {
             if (this != &__s)
             {
-                if (this->M_data)
-                    delete[] this->M_data;
+                this->erase();
                 this->M_data = __s.M_data;
                 this->M_cap = __s.M_cap;
                 this->M_len = __s.M_len;
@@ -382,12 +482,14 @@ namespace horizon
         template <typename T>
         vector<T>::~vector()
         {
-            if (this->M_data)
-                delete[] this->M_data;
-            this->M_data = nullptr;
-            this->M_len = 0;
-            this->M_cap = 0;
+            this->erase();
         }
+
+        // only owns a heap block
+        template <typename T>
+        struct is_trivially_relocatable<vector<T>> : std::true_type
+        {
+        };
     }
 }
 
@@ -0,0 +1,596 @@
+/**
+ * @file perf_fuzz.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// Looks for inputs that are slow to lex and parse, rather than for crashes: the score of an input is the time (or the number of
+// allocations) the lexer and the parser spend on it per byte. Without HORIZON_LIBFUZZER it is a program of its own:
+//
+//   perf_fuzz search [--seconds=60] [--metric=time|allocs] [--out=./fuzz/slow] ... [seed files or directories]
+//       mutates the seeds for a while, minimizes the slowest inputs it found and writes them with their budgets to --out
+//   perf_fuzz check <dir>
+//       runs every input listed in <dir>/budgets.txt and fails if one of them is over its time or allocation budget
+//       (time budgets are in runs of a reference input measured alongside, so they hold on slower or busier machines too)
+//   perf_fuzz run <file>...
+//       prints the cost of every file
+//
+// With HORIZON_LIBFUZZER (clang, -fsanitize=fuzzer) libFuzzer drives `LLVMFuzzerTestOneInput`, which aborts on inputs that score
+// above HORIZON_FUZZ_NS_PER_BYTE or HORIZON_FUZZ_ALLOCS_PER_BYTE, so libFuzzer keeps and minimizes them like crashes
+// (-minimize_crash=1).
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../bench/bench_util.hh"
+#include "../deps/allocator/allocator.hh"
+#include "../deps/hash/hash.hh"
+#include "../deps/string/string.hh"
+#include "../src/lexer/lexer.hh"
+#include "../src/misc/diagnostic.hh"
+#include "../src/misc/file/file.hh"
+#include "../src/parser/parser.hh"
+
+namespace
+{
+    using clock_type = std::chrono::steady_clock;
+    namespace hd = horizon::horizon_deps;
+    using horizon::horizon_bench::next_random;
+
+    /**
+     * What lexing and parsing one input cost
+     */
+    struct cost
+    {
+        double M_ns = 0;
+        std::size_t M_allocs = 0; // allocations and reallocations
+    };
+
+    enum class metric : unsigned char
+    {
+        METRIC_TIME,
+        METRIC_ALLOCS
+    };
+
+    /**
+     * @brief Lexes and parses `data` as one file the way the driver does, with its diagnostics captured instead of printed
+     */
+    cost run_once(const std::uint8_t *data, const std::size_t &len)
+    {
+        // declared first, every block below has to be freed before it goes
+        hd::counting_allocator counter;
+        clock_type::time_point start = clock_type::now();
+        {
+            hd::allocator_scope scope(counter);
+            horizon::horizon_misc::HR_FILE file;
+            file.M_location = "fuzz.hr";
+            file.M_content = hd::string(reinterpret_cast<const char *>(data), reinterpret_cast<const char *>(data) + len);
+            hd::string diagnostics;
+            horizon::horizon_misc::diagnostic_capture capture(diagnostics);
+            horizon::horizon_lexer::lexer lex(&file);
+            if (lex.init_lexing())
+            {
+                horizon::horizon_parser::parser parse(std::move(lex.move()), &file);
+                (void)parse.init_parsing();
+            }
+        }
+        cost c;
+        c.M_ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+        c.M_allocs = counter.stats().M_allocs + counter.stats().M_reallocs;
+        return c;
+    }
+
+    // best time of `reps` runs, the allocations do not change between runs
+    cost measure(const std::string &input, const std::size_t &reps)
+    {
+        cost best;
+        for (std::size_t r = 0; r < reps; r++)
+        {
+            cost c = run_once(reinterpret_cast<const std::uint8_t *>(input.data()), input.size());
+            if (r == 0 || c.M_ns < best.M_ns)
+                best = c;
+        }
+        return best;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size);
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size)
+{
+    // limits are read once, 0 turns a check off
+    static const double ns_limit = (std::getenv("HORIZON_FUZZ_NS_PER_BYTE") ? std::strtod(std::getenv("HORIZON_FUZZ_NS_PER_BYTE"), nullptr) : 0);
+    static const double allocs_limit = (std::getenv("HORIZON_FUZZ_ALLOCS_PER_BYTE") ? std::strtod(std::getenv("HORIZON_FUZZ_ALLOCS_PER_BYTE"), nullptr) : 0);
+    // tiny inputs are all fixed cost, nothing to learn from their score
+    if (size < 64)
+        return 0;
+
+    cost c = run_once(data, size);
+    double ns = c.M_ns / static_cast<double>(size), allocs = static_cast<double>(c.M_allocs) / static_cast<double>(size);
+    if ((ns_limit > 0 && ns > ns_limit) || (allocs_limit > 0 && allocs > allocs_limit))
+    {
+        std::fprintf(stderr, "perf_fuzz: slow input: %zu bytes, %.1f ns/byte, %.2f allocations/byte\n", size, ns, allocs);
+        std::abort();
+    }
+    return 0;
+}
+
+#ifndef HORIZON_LIBFUZZER
+namespace
+{
+    constexpr const char *BUDGETS = "budgets.txt";
+
+    // tokens and fragments of the language, mutations insert them to reach deeper than random bytes do
+    constexpr const char *DICTIONARY[] = {
+        "func ", "f", "(", ")", ":", ",", " ", "\n", "{", "}", ";", "=", "int32", "let", "a", "b", "1", "0x1f", "1.5",
+        "\"", "'", "\\", "\\n", "/*", "*/", "//", "+", "-", "*", "/", "^", "<", ">", "[", "]", ".", "return ", "if", "else",
+        "for", "const ", "T", "<T>", "a: int32", "int32: a", "int32: a, b = 1, c", "a = (1 + 2)",
+    };
+
+    constexpr const char *SEEDS[] = {
+        "func add(int32: a, int32: b): int32 {\n    return a + b;\n}\n",
+        "func f(int32: a, b = 1, c, dec32: d = (1 + 2) * 3, e): int32 {\n    return a;\n}\n",
+        "func main(): int32 {\n    int32: i = 13, j = 45;\n    i += j;\n    j = add(-1, -5);\n    return i;\n}\n",
+        "func main(): int32 {\n    let: is_horizon = true, my_name = \"Tushar\", ret = 0;\n    return ret;\n}\n",
+        "func main(): int32 {\n    for(int32: K = 0; K < 10; K++)\n    {\n        i -= K;\n    }\n}\n",
+        "/* comment */\n// line comment\nlet a: int = 5 $ 3;\n",
+    };
+
+    constexpr std::size_t REFERENCE_LEN = 4096;
+
+    /**
+     * @brief What time budgets are measured in: the seeds that parse, repeated to REFERENCE_LEN bytes. Timing it in the same
+     * run as the inputs takes the speed of the machine out of the budgets
+     */
+    const std::string &reference_input()
+    {
+        static const std::string input = []
+        {
+            std::string out;
+            // the last seed stops the parser at its first line
+            while (out.size() < REFERENCE_LEN)
+                for (const char *const *seed = std::begin(SEEDS); seed != std::end(SEEDS) - 1; seed++)
+                    out += *seed;
+            return out;
+        }();
+        return input;
+    }
+
+    std::size_t below(std::uint64_t &state, const std::size_t &n)
+    {
+        return (n ? static_cast<std::size_t>(next_random(state) % n) : 0);
+    }
+
+    struct settings
+    {
+        metric M_metric = metric::METRIC_TIME;
+        double M_seconds = 60;
+        std::size_t M_max_len = 4096;
+        std::size_t M_min_len = 256; // scores are per byte, but never per fewer bytes than this
+        std::size_t M_keep = 8;
+        double M_slack = 4; // time budget = measured time / reference time * slack
+        std::uint64_t M_seed = 42;
+        std::filesystem::path M_out = "./fuzz/slow";
+        double M_fixed_ns = 0; // cost of an empty input, taken off every time
+    };
+
+    struct entry
+    {
+        std::string M_data;
+        cost M_cost;
+        double M_score;
+    };
+
+    double score_of(const settings &s, const std::string &input, const cost &c)
+    {
+        double bytes = static_cast<double>(std::max(input.size(), s.M_min_len));
+        if (s.M_metric == metric::METRIC_ALLOCS)
+            return static_cast<double>(c.M_allocs) / bytes;
+        return std::max(c.M_ns - s.M_fixed_ns, 0.0) / bytes;
+    }
+
+    void mutate(const settings &s, std::string &data, const std::vector<entry> &population, std::uint64_t &state)
+    {
+        std::size_t ops = 1 + below(state, 4);
+        for (std::size_t op = 0; op < ops; op++)
+        {
+            std::size_t pos = below(state, data.size() + 1);
+            switch (below(state, 6))
+            {
+            case 0: // insert a token
+                data.insert(pos, DICTIONARY[below(state, sizeof(DICTIONARY) / sizeof(DICTIONARY[0]))]);
+                break;
+            case 1: // repeat a chunk, how the super-linear paths are reached
+            {
+                std::size_t len = std::min<std::size_t>(1 + below(state, 32), data.size() - std::min(pos, data.size()));
+                std::string chunk = data.substr(std::min(pos, data.size()), len);
+                std::size_t times = 2 + below(state, 63);
+                for (std::size_t i = 0; i < times && !chunk.empty(); i++)
+                    data.insert(pos, chunk);
+                break;
+            }
+            case 2: // delete a chunk
+                if (pos < data.size())
+                    data.erase(pos, 1 + below(state, std::min<std::size_t>(data.size() - pos, 32)));
+                break;
+            case 3: // overwrite a byte
+                if (pos < data.size())
+                    data[pos] = (below(state, 4) == 0 ? static_cast<char>(next_random(state)) : DICTIONARY[below(state, sizeof(DICTIONARY) / sizeof(DICTIONARY[0]))][0]);
+                break;
+            case 4: // splice a chunk of another input
+            {
+                const std::string &other = population[below(state, population.size())].M_data;
+                std::size_t from = below(state, other.size());
+                data.insert(pos, other.substr(from, 1 + below(state, 64)));
+                break;
+            }
+            default: // double it
+                data += data;
+                break;
+            }
+        }
+        if (data.size() > s.M_max_len)
+            data.resize(s.M_max_len);
+    }
+
+    /**
+     * @brief Takes chunks out of `e` for as long as its score stays within 10%, so only the bytes that make it slow are left
+     */
+    void minimize(const settings &s, entry &e, const clock_type::time_point &deadline)
+    {
+        double floor = e.M_score * 0.9;
+        for (std::size_t chunk = e.M_data.size() / 2; chunk >= 1 && clock_type::now() < deadline; chunk /= 2)
+        {
+            for (std::size_t pos = 0; pos + chunk <= e.M_data.size() && clock_type::now() < deadline;)
+            {
+                std::string candidate = e.M_data;
+                candidate.erase(pos, chunk);
+                cost c = measure(candidate, 3);
+                double score = score_of(s, candidate, c);
+                if (score >= floor)
+                    e = entry{std::move(candidate), c, score};
+                else
+                    pos += chunk;
+            }
+        }
+    }
+
+    bool read_file(const std::filesystem::path &path, std::string &out)
+    {
+        std::FILE *fptr = std::fopen(path.string().c_str(), "rb");
+        if (!fptr)
+        {
+            std::fprintf(stderr, "perf_fuzz: error: cannot open '%s': %s\n", path.string().c_str(), std::strerror(errno));
+            return false;
+        }
+        char buffer[4096];
+        std::size_t n;
+        out.clear();
+        while ((n = std::fread(buffer, 1, sizeof(buffer), fptr)) > 0)
+            out.append(buffer, n);
+        std::fclose(fptr);
+        return true;
+    }
+
+    struct budget
+    {
+        std::string M_name;
+        double M_time; // in runs of reference_input()
+        std::size_t M_allocs;
+    };
+
+    // lines of "<file> <time budget> <allocation budget>", '#' starts a comment
+    bool read_budgets(const std::filesystem::path &dir, std::vector<budget> &out)
+    {
+        std::string text;
+        if (!std::filesystem::exists(dir / BUDGETS))
+            return true;
+        if (!read_file(dir / BUDGETS, text))
+            return false;
+        std::size_t line_no = 0;
+        for (std::size_t begin = 0; begin < text.size();)
+        {
+            std::size_t end = text.find('\n', begin);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string line = text.substr(begin, end - begin);
+            begin = end + 1;
+            line_no++;
+            if (line.empty() || line[0] == '#')
+                continue;
+            char name[256];
+            double time;
+            unsigned long long allocs;
+            if (std::sscanf(line.c_str(), "%255s %lf %llu", name, &time, &allocs) != 3)
+            {
+                std::fprintf(stderr, "perf_fuzz: error: %s:%zu: expected '<file> <time> <allocations>'\n", (dir / BUDGETS).string().c_str(), line_no);
+                return false;
+            }
+            out.push_back(budget{name, time, static_cast<std::size_t>(allocs)});
+        }
+        return true;
+    }
+
+    bool write_budgets(const std::filesystem::path &dir, const std::vector<budget> &budgets)
+    {
+        std::FILE *fptr = std::fopen((dir / BUDGETS).string().c_str(), "w");
+        if (!fptr)
+        {
+            std::fprintf(stderr, "perf_fuzz: error: cannot write '%s': %s\n", (dir / BUDGETS).string().c_str(), std::strerror(errno));
+            return false;
+        }
+        std::fprintf(fptr, "# slow inputs found by perf_fuzz: <file> <time budget in runs of the reference input> <allocation budget>, see 'perf_fuzz check'\n");
+        for (const budget &b : budgets)
+            std::fprintf(fptr, "%s %.3f %zu\n", b.M_name.c_str(), b.M_time, b.M_allocs);
+        return std::fclose(fptr) == 0;
+    }
+
+    bool add_seeds(const std::filesystem::path &path, std::vector<std::string> &seeds)
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(path, ec))
+        {
+            for (const std::filesystem::directory_entry &de : std::filesystem::directory_iterator(path, ec))
+                if (de.is_regular_file() && de.path().filename() != BUDGETS)
+                {
+                    seeds.emplace_back();
+                    if (!read_file(de.path(), seeds.back()))
+                        return false;
+                }
+            return true;
+        }
+        seeds.emplace_back();
+        return read_file(path, seeds.back());
+    }
+
+    int search(settings &s, const std::vector<std::string> &seeds)
+    {
+        constexpr std::size_t POPULATION = 32;
+        s.M_fixed_ns = measure(std::string(), 21).M_ns;
+
+        std::vector<entry> population;
+        auto offer = [&](std::string &&data, const cost &c)
+        {
+            double score = score_of(s, data, c);
+            if (population.size() == POPULATION && score <= population.back().M_score)
+                return false;
+            if (s.M_metric == metric::METRIC_TIME)
+            {
+                // one run is noisy, confirm before taking it in
+                cost again = measure(data, 3);
+                score = std::min(score, score_of(s, data, again));
+                if (population.size() == POPULATION && score <= population.back().M_score)
+                    return false;
+            }
+            if (population.size() == POPULATION)
+                population.pop_back();
+            entry e{std::move(data), c, score};
+            population.insert(std::upper_bound(population.begin(), population.end(), e, [](const entry &a, const entry &b)
+                                               { return a.M_score > b.M_score; }),
+                              std::move(e));
+            return true;
+        };
+        for (const std::string &seed : seeds)
+        {
+            std::string data = seed.substr(0, s.M_max_len);
+            cost c = measure(data, 3);
+            offer(std::move(data), c);
+        }
+
+        std::uint64_t state = s.M_seed;
+        clock_type::time_point start = clock_type::now();
+        // 80% of the time searching, the rest minimizing
+        clock_type::time_point search_end = start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(s.M_seconds * 0.8));
+        clock_type::time_point end = start + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(s.M_seconds));
+        std::size_t execs = 0;
+        double best = (population.empty() ? 0 : population.front().M_score);
+        while (clock_type::now() < search_end)
+        {
+            std::string data = population[below(state, population.size())].M_data;
+            mutate(s, data, population, state);
+            cost c = measure(data, 1);
+            execs++;
+            if (offer(std::move(data), c) && population.front().M_score > best)
+            {
+                best = population.front().M_score;
+                std::fprintf(stderr, "perf_fuzz: #%zu best %.2f %s/byte (%zu bytes)\n", execs, best, (s.M_metric == metric::METRIC_TIME ? "ns" : "allocations"), population.front().M_data.size());
+            }
+        }
+
+        std::fprintf(stderr, "perf_fuzz: %zu inputs tried, minimizing the %zu slowest\n", execs, std::min(s.M_keep, population.size()));
+
+        std::error_code ec;
+        std::filesystem::create_directories(s.M_out, ec);
+        std::vector<budget> budgets;
+        if (!read_budgets(s.M_out, budgets))
+            return EXIT_FAILURE;
+
+        std::size_t keep = std::min(s.M_keep, population.size());
+        std::vector<entry> kept;
+        std::printf("%-28s %8s %12s %10s %10s\n", "input", "bytes", "score/byte", "time", "allocs");
+        for (std::size_t i = 0; i < keep; i++)
+        {
+            entry e = population[i];
+            clock_type::time_point now = clock_type::now();
+            minimize(s, e, now + (end - now) / static_cast<clock_type::rep>(keep - i));
+            // mutants of one input tend to minimize to about the same thing
+            if (std::any_of(kept.begin(), kept.end(), [&](const entry &k)
+                            { return std::abs(k.M_score - e.M_score) <= k.M_score * 0.02 && std::abs(static_cast<double>(k.M_data.size()) - static_cast<double>(e.M_data.size())) <= static_cast<double>(k.M_data.size()) * 0.1; }))
+                continue;
+            kept.push_back(e);
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "slow-%016zx.hr", hd::hash_bytes(e.M_data.data(), e.M_data.size()));
+            if (std::any_of(budgets.begin(), budgets.end(), [&](const budget &b)
+                            { return b.M_name == name; }))
+                continue;
+            std::FILE *fptr = std::fopen((s.M_out / name).string().c_str(), "wb");
+            if (!fptr || std::fwrite(e.M_data.data(), 1, e.M_data.size(), fptr) != e.M_data.size() || std::fclose(fptr) != 0)
+            {
+                std::fprintf(stderr, "perf_fuzz: error: cannot write '%s'\n", (s.M_out / name).string().c_str());
+                return EXIT_FAILURE;
+            }
+            cost c = measure(e.M_data, 5);
+            double time = c.M_ns / measure(reference_input(), 5).M_ns;
+            // two reference runs at least, timers are too noisy below that
+            budgets.push_back(budget{name, std::max(time * s.M_slack, 2.0), c.M_allocs + c.M_allocs / 4 + 16});
+            std::printf("%-28s %8zu %12.2f %10.3f %10zu\n", name, e.M_data.size(), e.M_score, time, c.M_allocs);
+        }
+        return write_budgets(s.M_out, budgets) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int check(const std::filesystem::path &dir)
+    {
+        std::vector<budget> budgets;
+        if (!read_budgets(dir, budgets))
+            return EXIT_FAILURE;
+        if (budgets.empty())
+        {
+            std::fprintf(stderr, "perf_fuzz: error: no inputs listed in '%s'\n", (dir / BUDGETS).string().c_str());
+            return EXIT_FAILURE;
+        }
+        std::size_t failed = 0;
+        std::printf("%-28s %8s %10s %10s %10s %10s  %s\n", "input", "bytes", "time", "budget", "allocs", "budget", "result");
+        for (const budget &b : budgets)
+        {
+            std::string data;
+            if (!read_file(dir / b.M_name, data))
+            {
+                failed++;
+                continue;
+            }
+            cost c = measure(data, 5);
+            // the reference is timed next to every input, in case the machine speeds up or slows down in between
+            double time = c.M_ns / measure(reference_input(), 5).M_ns;
+            bool ok = time <= b.M_time && c.M_allocs <= b.M_allocs;
+            failed += !ok;
+            std::printf("%-28s %8zu %10.3f %10.3f %10zu %10zu  %s\n", b.M_name.c_str(), data.size(), time, b.M_time, c.M_allocs, b.M_allocs, (ok ? "ok" : "OVER BUDGET"));
+        }
+        if (failed)
+            std::fprintf(stderr, "perf_fuzz: %zu of %zu inputs over budget\n", failed, budgets.size());
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    int run(int argc, char **argv)
+    {
+        std::printf("%-40s %8s %10s %10s %12s\n", "input", "bytes", "ms", "allocs", "ns/byte");
+        for (int i = 0; i < argc; i++)
+        {
+            std::string data;
+            if (!read_file(argv[i], data))
+                return EXIT_FAILURE;
+            cost c = measure(data, 5);
+            std::printf("%-40s %8zu %10.3f %10zu %12.2f\n", argv[i], data.size(), c.M_ns / 1e6, c.M_allocs, c.M_ns / static_cast<double>(std::max<std::size_t>(data.size(), 1)));
+        }
+        return EXIT_SUCCESS;
+    }
+
+    bool parse_size(const char *arg, const char *name, std::size_t &out)
+    {
+        char *end = nullptr;
+        unsigned long long val = std::strtoull(arg, &end, 10);
+        if (!*arg || *end)
+        {
+            std::fprintf(stderr, "perf_fuzz: error: invalid value '%s' for '%s'\n", arg, name);
+            return false;
+        }
+        out = static_cast<std::size_t>(val);
+        return true;
+    }
+
+    bool parse_double(const char *arg, const char *name, double &out)
+    {
+        char *end = nullptr;
+        out = std::strtod(arg, &end);
+        if (!*arg || *end || out <= 0)
+        {
+            std::fprintf(stderr, "perf_fuzz: error: invalid value '%s' for '%s'\n", arg, name);
+            return false;
+        }
+        return true;
+    }
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: perf_fuzz search [--seconds=60] [--metric=time|allocs] [--max-len=4096] [--min-len=256] [--keep=8]\n"
+                             "                        [--slack=4] [--seed=42] [--out=./fuzz/slow] [<seed file or directory>...]\n"
+                             "       perf_fuzz check <directory>\n"
+                             "       perf_fuzz run <file>...\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && std::strcmp(argv[1], "check") == 0)
+        return check(argv[2]);
+    if (argc >= 3 && std::strcmp(argv[1], "run") == 0)
+        return run(argc - 2, argv + 2);
+    if (argc < 2 || std::strcmp(argv[1], "search") != 0)
+    {
+        usage();
+        return (argc >= 2 && std::strcmp(argv[1], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    settings s;
+    std::vector<std::string> seeds(std::begin(SEEDS), std::end(SEEDS));
+    for (int i = 2; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        std::size_t seed = 0;
+        if (std::strncmp(arg, "--seconds=", 10) == 0)
+        {
+            if (!parse_double(arg + 10, "--seconds", s.M_seconds))
+                return EXIT_FAILURE;
+        }
+        else if (std::strcmp(arg, "--metric=time") == 0)
+            s.M_metric = metric::METRIC_TIME;
+        else if (std::strcmp(arg, "--metric=allocs") == 0)
+            s.M_metric = metric::METRIC_ALLOCS;
+        else if (std::strncmp(arg, "--max-len=", 10) == 0)
+        {
+            if (!parse_size(arg + 10, "--max-len", s.M_max_len) || s.M_max_len == 0)
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--min-len=", 10) == 0)
+        {
+            if (!parse_size(arg + 10, "--min-len", s.M_min_len))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--keep=", 7) == 0)
+        {
+            if (!parse_size(arg + 7, "--keep", s.M_keep))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--slack=", 8) == 0)
+        {
+            if (!parse_double(arg + 8, "--slack", s.M_slack))
+                return EXIT_FAILURE;
+        }
+        else if (std::strncmp(arg, "--seed=", 7) == 0)
+        {
+            if (!parse_size(arg + 7, "--seed", seed))
+                return EXIT_FAILURE;
+            s.M_seed = seed;
+        }
+        else if (std::strncmp(arg, "--out=", 6) == 0)
+            s.M_out = arg + 6;
+        else if (arg[0] == '-')
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        else if (!add_seeds(arg, seeds))
+            return EXIT_FAILURE;
+    }
+    return search(s, seeds);
+}
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file api.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./api.hh"
+
+#include "../lexer/lexer.hh"
+#include "../misc/diagnostic.hh"
+#include "../misc/load_file.hh"
+
+namespace horizon
+{
+    namespace horizon_api
+    {
+        compilation_context::compilation_context()
+            : M_compilations(0) {}
+
+        void compilation_context::clear()
+        {
+            // everything goes back to the arena before it is rewound
+            this->M_parser = nullptr;
+            this->M_tokens.erase();
+            this->M_file = nullptr;
+            this->M_errors.erase();
+            this->M_diagnostics.clear();
+            this->M_arena.reset();
+        }
+
+        bool compilation_context::run(const compile_options &options)
+        {
+            horizon_lexer::lexer lex(this->M_file.raw());
+            if (!lex.init_lexing())
+                return false;
+            if (!options.M_parse)
+            {
+                this->M_tokens = std::move(lex.move());
+                return true;
+            }
+            if (options.M_keep_tokens)
+                this->M_tokens = lex.get();
+            this->M_parser = horizon_deps::create<horizon_parser::parser>(std::move(lex.move()), this->M_file.raw());
+            if (!this->M_parser->init_parsing())
+            {
+                this->M_parser = nullptr;
+                return false;
+            }
+            if (options.M_hash_cons)
+                this->M_parser->hash_cons();
+            return true;
+        }
+
+        bool compilation_context::compile(const horizon_deps::str_view &source, const char *location, const compile_options &options)
+        {
+            this->clear();
+            this->M_compilations++;
+            horizon_deps::allocator_scope scope(this->M_arena);
+            horizon_misc::diagnostic_capture capture(this->M_diagnostics);
+            horizon_errors::error_collector collector(this->M_errors);
+
+            this->M_file = horizon_deps::create<horizon_misc::HR_FILE>();
+            this->M_file->M_location = location;
+            // a default str_view has no data at all, the lexer still wants an empty string
+            this->M_file->M_content = (source.length() == 0 ? horizon_deps::string("") : horizon_deps::string(source.data(), source.data() + source.length()));
+            return this->run(options);
+        }
+
+        bool compilation_context::compile_file(const char *path, const compile_options &options)
+        {
+            this->clear();
+            this->M_compilations++;
+            horizon_deps::allocator_scope scope(this->M_arena);
+            horizon_misc::diagnostic_capture capture(this->M_diagnostics);
+            horizon_errors::error_collector collector(this->M_errors);
+
+            this->M_file = horizon_misc::load_file(path);
+            if (!this->M_file)
+            {
+                // load_file printed why
+                horizon_deps::string message("'");
+                message.append(path).append("' cannot be opened for reading");
+                this->M_errors.add(horizon_errors::error_info{horizon_errors::error_code::HORIZON_IO_ERROR, "horizon", 0, 0, 0, 0, std::move(message)});
+                return false;
+            }
+            return this->run(options);
+        }
+
+        const horizon_deps::vector<token> &compilation_context::tokens() const
+        {
+            return this->M_tokens;
+        }
+
+        const horizon_parser::ast_node *compilation_context::ast() const
+        {
+            return (this->M_parser ? this->M_parser->get_ast().raw() : nullptr);
+        }
+
+        const horizon_deps::vector<horizon_errors::error_info> &compilation_context::errors() const
+        {
+            return this->M_errors;
+        }
+
+        const horizon_deps::string &compilation_context::diagnostics() const
+        {
+            return this->M_diagnostics;
+        }
+
+        const horizon_misc::HR_FILE *compilation_context::file() const
+        {
+            return this->M_file.raw();
+        }
+
+        const std::size_t &compilation_context::compilations() const
+        {
+            return this->M_compilations;
+        }
+
+        const std::size_t &compilation_context::reserved() const
+        {
+            return this->M_arena.reserved();
+        }
+
+        compilation_context::~compilation_context()
+        {
+            this->clear();
+        }
+    }
+}
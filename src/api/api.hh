@@ -0,0 +1,105 @@
+/**
+ * @file api.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_API_API_HH
+#define HORIZON_API_API_HH
+
+#include <cstddef>
+
+#include "../../deps/allocator/allocator.hh"
+#include "../../deps/sptr/sptr.hh"
+#include "../../deps/string/str_view.hh"
+#include "../../deps/string/string.hh"
+#include "../../deps/vector/vector.hh"
+#include "../errors/errors.hh"
+#include "../misc/file/file.hh"
+#include "../parser/parser.hh"
+#include "../token/token.hh"
+
+namespace horizon
+{
+    namespace horizon_api
+    {
+        struct compile_options
+        {
+            bool M_parse = true;       // false stops after the lexer
+            bool M_keep_tokens = true; // the parser consumes the lexer's tokens, keep a copy of them for `tokens()`
+            bool M_hash_cons = false;  // see `horizon_parser::parser::hash_cons`
+        };
+
+        /**
+         * Compiles sources from memory or from files, one after another, for programs that link libhorizon instead of running `horizon`.
+         * Everything a compilation allocates (the source, tokens, AST and diagnostics) comes from an arena of the context that the next
+         * compilation rewinds instead of freeing, and identifiers and string literals stay in the process-wide `string_table`, so
+         * compiling many small sources with one context is cheap. Results are valid until the next compilation or until the context
+         * is destroyed. A context belongs to one thread at a time; separate contexts may compile in parallel.
+         */
+        class compilation_context
+        {
+          private:
+            horizon_deps::arena_allocator M_arena; // first, every other member may hold blocks of it
+            horizon_deps::sptr<horizon_misc::HR_FILE> M_file;
+            horizon_deps::vector<token> M_tokens;
+            horizon_deps::sptr<horizon_parser::parser> M_parser;
+            horizon_deps::vector<horizon_errors::error_info> M_errors;
+            horizon_deps::string M_diagnostics;
+            std::size_t M_compilations;
+
+          private:
+            void clear();
+            [[nodiscard]] bool run(const compile_options &options);
+
+          public:
+            compilation_context();
+            compilation_context(const compilation_context &) = delete;
+            compilation_context &operator=(const compilation_context &) = delete;
+
+            /**
+             * @brief Compiles `source`; `location` is the file name shown in diagnostics
+             * @return false if there was an error, `errors()` and `diagnostics()` say which
+             */
+            [[nodiscard]] bool compile(const horizon_deps::str_view &source, const char *location = "<memory>", const compile_options &options = compile_options());
+
+            /**
+             * @brief Loads and compiles the file at `path`
+             */
+            [[nodiscard]] bool compile_file(const char *path, const compile_options &options = compile_options());
+
+            /**
+             * @brief Tokens of the last compilation, ending with TOKEN_END_OF_FILE; empty if the lexer failed or they were not kept
+             */
+            [[nodiscard]] const horizon_deps::vector<token> &tokens() const;
+
+            /**
+             * @brief Root of the AST of the last compilation (an `ast_program_node`), nullptr if it was not parsed or had an error
+             */
+            [[nodiscard]] const horizon_parser::ast_node *ast() const;
+
+            [[nodiscard]] const horizon_deps::vector<horizon_errors::error_info> &errors() const;
+
+            /**
+             * @brief The diagnostics of the last compilation as `horizon` prints them
+             */
+            [[nodiscard]] const horizon_deps::string &diagnostics() const;
+
+            /**
+             * @brief Source of the last compilation, nullptr if a file could not be loaded
+             */
+            [[nodiscard]] const horizon_misc::HR_FILE *file() const;
+
+            [[nodiscard]] const std::size_t &compilations() const;
+
+            /**
+             * @brief Bytes the arena holds on to between compilations
+             */
+            [[nodiscard]] const std::size_t &reserved() const;
+
+            ~compilation_context();
+        };
+    }
+}
+
+#endif
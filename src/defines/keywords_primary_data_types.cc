@@ -6,22 +6,39 @@
 
 #include "./keywords_primary_data_types.h"
 
+// the view need not be NUL-terminated, a word matches only if its length is the same
+static int is_one_of(const horizon::horizon_deps::str_view &str, const char **words, const size_t &count)
+{
+    for (size_t i = 0; i < count; i++)
+        if (strlen(words[i]) == str.length() && memcmp(str.data(), words[i], str.length()) == 0)
+            return true;
+    return false;
+}
+
 int is_keyword(const char *str)
 {
     if (!str)
         return false;
-    for (size_t i = 0; i < (sizeof(horizon_keywords) / sizeof(*horizon_keywords)); i++)
-        if (strcmp(str, horizon_keywords[i]) == 0)
-            return true;
-    return false;
+    return is_keyword(horizon::horizon_deps::str_view(str));
+}
+
+int is_keyword(const horizon::horizon_deps::str_view &str)
+{
+    if (!str.data())
+        return false;
+    return is_one_of(str, horizon_keywords, sizeof(horizon_keywords) / sizeof(*horizon_keywords));
 }
 
 int is_primary_data_type(const char *str)
 {
     if (!str)
         return false;
-    for (size_t i = 0; i < (sizeof(horizon_primary_data_types) / sizeof(*horizon_primary_data_types)); i++)
-        if (strcmp(str, horizon_primary_data_types[i]) == 0)
-            return true;
-    return false;
+    return is_primary_data_type(horizon::horizon_deps::str_view(str));
+}
+
+int is_primary_data_type(const horizon::horizon_deps::str_view &str)
+{
+    if (!str.data())
+        return false;
+    return is_one_of(str, horizon_primary_data_types, sizeof(horizon_primary_data_types) / sizeof(*horizon_primary_data_types));
 }
@@ -9,6 +9,8 @@
 
 #include <cstring>
 
+#include "../../deps/string/str_view.hh"
+
 static const char *horizon_keywords[] = {
     "let",
     "func",
@@ -71,7 +73,9 @@ static const char *horizon_primary_data_types[] = {
     "void"};
 
 int is_keyword(const char *str);
+int is_keyword(const horizon::horizon_deps::str_view &str);
 
 int is_primary_data_type(const char *str);
+int is_primary_data_type(const horizon::horizon_deps::str_view &str);
 
 #endif
\ No newline at end of file
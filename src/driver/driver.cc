@@ -0,0 +1,498 @@
+/**
+ * @file driver.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./driver.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "../../deps/hash/hash.hh"
+#include "../lexer/lexer.hh"
+#include "../misc/diagnostic.hh"
+#include "../misc/load_file.hh"
+#include "../misc/stats.hh"
+#include "../misc/trace.hh"
+#include "../parser/ast/string_table.hh"
+
+namespace horizon
+{
+    namespace horizon_driver
+    {
+        namespace
+        {
+            using clock_type = std::chrono::steady_clock;
+
+            // top-level declarations printed by one task when the AST is printed in parallel
+            constexpr std::size_t PRINT_GRAIN = 64;
+
+            void add_stats(horizon_deps::allocator_stats &to, const horizon_deps::allocator_stats &from)
+            {
+                to.M_allocs += from.M_allocs;
+                to.M_reallocs += from.M_reallocs;
+                to.M_frees += from.M_frees;
+                to.M_bytes += from.M_bytes;
+                to.M_live += from.M_live;
+                // files are compiled one after another or at the same time, the larger peak is a lower bound either way
+                if (from.M_peak > to.M_peak)
+                    to.M_peak = from.M_peak;
+            }
+
+            /**
+             * One input file on its way through the lexer, parser and emit tasks. Output goes to `M_out`, which is
+             * either the shared stdout buffer (one thread, one file at a time) or a buffer of the file's own that
+             * the calling thread copies out in input order.
+             */
+            struct file_job
+            {
+                const char *M_loc = nullptr;
+                horizon_deps::sptr<horizon_misc::HR_FILE> M_file;
+                horizon_deps::sptr<horizon_misc::phase_allocator> M_lexer_mem, M_parser_mem, M_emit_mem;
+                horizon_deps::sptr<horizon_lexer::lexer> M_lexer;
+                horizon_deps::sptr<horizon_parser::parser> M_parser;
+                horizon_misc::out_buffer *M_out = nullptr;
+                horizon_deps::sptr<horizon_misc::out_buffer> M_own_out;
+                horizon_deps::string M_diagnostics;
+                file_report M_report;
+                bool M_ok = false;
+                horizon_deps::task *M_done = nullptr;
+
+                // only with a compile_cache
+                compile_cache *M_cache = nullptr;
+                std::size_t M_key = 0;
+                const cached_file *M_cached = nullptr; // compiled before, nothing to lex or parse
+                horizon_deps::vector<token> M_tokens;  // copy of the lexer's tokens, cached with the AST
+            };
+
+            [[nodiscard]] const horizon_parser::parser &parser_of(const file_job &job)
+            {
+                return (job.M_cached ? *job.M_cached->M_parser : *job.M_parser);
+            }
+
+            [[nodiscard]] horizon_misc::phase_times *times_of(file_job &job, const horizon_misc::options &opts)
+            {
+                return opts.M_time_report ? &job.M_report.M_times : nullptr;
+            }
+
+            void lex_file(file_job &job, const horizon_misc::options &opts)
+            {
+                horizon_misc::diagnostic_capture capture(job.M_diagnostics);
+                horizon_misc::timing_scope timing(times_of(job, opts));
+                {
+                    horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_LOAD, job.M_loc, std::strlen(job.M_loc));
+                    job.M_file = horizon_misc::load_file(job.M_loc);
+                }
+                if (!job.M_file)
+                {
+                    // error message is already printed and memory is freed
+                    return;
+                }
+                job.M_report.M_times.M_bytes = job.M_file->M_content.length();
+
+                // each phase allocates from its own allocator (see --alloc), all of them outlive the tokens and the AST
+                job.M_lexer_mem = horizon_deps::create<horizon_misc::phase_allocator>("lexer", opts.M_alloc, opts.M_alloc_stats);
+                job.M_parser_mem = horizon_deps::create<horizon_misc::phase_allocator>("parser", opts.M_alloc, opts.M_alloc_stats);
+                job.M_emit_mem = horizon_deps::create<horizon_misc::phase_allocator>("emit", opts.M_alloc, opts.M_alloc_stats);
+
+                if (job.M_cache)
+                {
+                    job.M_key = compile_cache::key_of(*job.M_file, opts);
+                    job.M_cached = job.M_cache->find(job.M_key, *job.M_file);
+                    if (job.M_cached)
+                    {
+                        job.M_ok = true;
+                        job.M_report.M_times.M_tokens = job.M_cached->M_tokens.length() - 1;
+                        if (opts.M_emit == horizon_misc::emit_type::EMIT_TOKENS)
+                        {
+                            horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_EMIT, job.M_loc, std::strlen(job.M_loc));
+                            horizon_deps::allocator_scope scope(job.M_emit_mem->get());
+                            horizon_lexer::lexer::print_tokens(job.M_cached->M_tokens, *job.M_out);
+                        }
+                        return;
+                    }
+                }
+
+                {
+                    // the lexer times its scanning and its bracket check itself
+                    horizon_deps::allocator_scope scope(job.M_lexer_mem->get());
+                    job.M_lexer = horizon_deps::create<horizon_lexer::lexer>(job.M_file.raw());
+                    job.M_ok = job.M_lexer->init_lexing();
+                    if (job.M_ok && job.M_cache)
+                        job.M_tokens = job.M_lexer->get();
+                }
+                // without the end of file token
+                job.M_report.M_times.M_tokens = (job.M_ok ? job.M_lexer->get().length() - 1 : 0);
+
+                if (job.M_ok && opts.M_emit == horizon_misc::emit_type::EMIT_TOKENS)
+                {
+                    horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_EMIT, job.M_loc, std::strlen(job.M_loc));
+                    horizon_deps::allocator_scope scope(job.M_emit_mem->get());
+                    job.M_lexer->debug_print(*job.M_out);
+                }
+            }
+
+            /**
+             * @brief Moves the file, its tokens and its AST with the memory they live in to the cache, unless it has the file already
+             */
+            void cache_file(file_job &job)
+            {
+                // the cache outlives the phase allocators of the job
+                horizon_deps::allocator_scope scope(horizon_deps::malloc_allocator::instance());
+                job.M_lexer = nullptr;
+                horizon_deps::sptr<cached_file> file = horizon_deps::create<cached_file>();
+                file->M_lexer_mem = std::move(job.M_lexer_mem);
+                file->M_parser_mem = std::move(job.M_parser_mem);
+                file->M_file = std::move(job.M_file);
+                file->M_tokens = std::move(job.M_tokens);
+                file->M_parser = std::move(job.M_parser);
+                job.M_cached = job.M_cache->add(job.M_key, file);
+                if (!job.M_cached)
+                {
+                    // another content with the same hash is cached, this file stays the job's own
+                    job.M_lexer_mem = std::move(file->M_lexer_mem);
+                    job.M_parser_mem = std::move(file->M_parser_mem);
+                    job.M_file = std::move(file->M_file);
+                    job.M_parser = std::move(file->M_parser);
+                }
+                else
+                {
+                    add_stats(job.M_report.M_lexer_mem, job.M_cached->M_lexer_mem->stats());
+                    add_stats(job.M_report.M_parser_mem, job.M_cached->M_parser_mem->stats());
+                }
+            }
+
+            void parse_file(file_job &job, const horizon_misc::options &opts)
+            {
+                if (!job.M_ok || job.M_cached)
+                    return;
+                {
+                    horizon_misc::diagnostic_capture capture(job.M_diagnostics);
+                    horizon_misc::timing_scope timing(times_of(job, opts));
+                    horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_PARSE, job.M_loc, std::strlen(job.M_loc));
+                    horizon_deps::allocator_scope scope(job.M_parser_mem->get());
+                    job.M_parser = horizon_deps::create<horizon_parser::parser>(std::move(job.M_lexer->move()), job.M_file.raw());
+                    job.M_ok = job.M_parser->init_parsing();
+                    if (job.M_ok && opts.M_hash_cons)
+                        job.M_parser->hash_cons();
+                }
+                if (job.M_ok && job.M_cache)
+                    cache_file(job);
+            }
+
+            /**
+             * @brief Prints the AST with its top-level declarations split over tasks, every part into a buffer of its own that is appended in order.
+             * Every part is timed by the thread that prints it and added to `times`: the thread waiting for the parts runs other files' tasks meanwhile
+             */
+            void print_parallel(horizon_deps::scheduler &sched, file_job &job, const horizon_misc::options &opts, const horizon_parser::ast_program_node *program, horizon_misc::phase_times *times)
+            {
+                std::size_t count = program->length();
+                std::size_t parts = (count + PRINT_GRAIN - 1) / PRINT_GRAIN;
+                horizon_deps::vector<horizon_deps::sptr<horizon_misc::out_buffer>> buffers(parts);
+                horizon_deps::vector<horizon_deps::allocator_stats> stats(parts);
+                horizon_deps::vector<horizon_misc::phase_times> part_times(parts);
+                for (std::size_t i = 0; i < parts; i++)
+                {
+                    buffers.add(horizon_deps::sptr<horizon_misc::out_buffer>());
+                    stats.add(horizon_deps::allocator_stats());
+                    part_times.add(horizon_misc::phase_times());
+                }
+
+                sched.parallel_for(0, parts, 1, [&](const std::size_t &begin, const std::size_t &end)
+                                   {
+                                       for (std::size_t p = begin; p < end; p++)
+                                       {
+                                           horizon_misc::timing_scope timing(times ? &part_times[p] : nullptr);
+                                           horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_EMIT, job.M_loc, std::strlen(job.M_loc));
+                                           // the emit allocator of the file is not thread-safe, every part gets one of its own
+                                           horizon_deps::allocator_scope default_scope(horizon_deps::malloc_allocator::instance());
+                                           buffers[p] = horizon_deps::create<horizon_misc::out_buffer>(horizon_misc::out_buffer::IN_MEMORY, job.M_out->is_colored());
+                                           horizon_misc::phase_allocator mem("emit", opts.M_alloc, opts.M_alloc_stats);
+                                           {
+                                               horizon_deps::allocator_scope scope(mem.get());
+                                               std::size_t last = ((p + 1) * PRINT_GRAIN < count ? (p + 1) * PRINT_GRAIN : count);
+                                               if (opts.M_emit == horizon_misc::emit_type::EMIT_AST_TEXT)
+                                                   program->print(*buffers[p], p * PRINT_GRAIN, last);
+                                               else
+                                                   program->print_json(*buffers[p], p * PRINT_GRAIN, last);
+                                           }
+                                           stats[p] = mem.stats();
+                                       } });
+
+                horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_EMIT, job.M_loc, std::strlen(job.M_loc));
+                for (std::size_t i = 0; i < parts; i++)
+                {
+                    job.M_out->append(buffers[i]->raw(), buffers[i]->length());
+                    add_stats(job.M_report.M_emit_mem, stats[i]);
+                    if (times)
+                        *times += part_times[i];
+                }
+            }
+
+            void emit_file(horizon_deps::scheduler &sched, file_job &job, const horizon_misc::options &opts)
+            {
+                if (job.M_ok)
+                {
+                    horizon_misc::diagnostic_capture capture(job.M_diagnostics);
+                    // nothing to time without --emit
+                    horizon_misc::phase_times *times = (opts.M_emit != horizon_misc::emit_type::EMIT_NONE ? times_of(job, opts) : nullptr);
+                    horizon_misc::timing_scope timing(times);
+                    const horizon_parser::ast_program_node *program = static_cast<const horizon_parser::ast_program_node *>(parser_of(job).get_ast().raw());
+                    if ((opts.M_emit == horizon_misc::emit_type::EMIT_AST_TEXT || opts.M_emit == horizon_misc::emit_type::EMIT_AST_JSON) && sched.threads() > 1 && program->length() > PRINT_GRAIN)
+                        print_parallel(sched, job, opts, program, times);
+                    else
+                    {
+                        horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_EMIT, job.M_loc, std::strlen(job.M_loc));
+                        horizon_deps::allocator_scope scope(job.M_emit_mem->get());
+                        if (opts.M_emit == horizon_misc::emit_type::EMIT_AST_TEXT)
+                            program->print(*job.M_out);
+                        else if (opts.M_emit == horizon_misc::emit_type::EMIT_AST_JSON)
+                            program->print_json(*job.M_out);
+                        else if (opts.M_emit == horizon_misc::emit_type::EMIT_HRAST)
+                        {
+                            horizon_parser::hrast_writer writer;
+                            writer.set_shared_nodes(opts.M_hash_cons);
+                            std::uint64_t root = horizon_parser::serialize_node(writer, parser_of(job).get_ast());
+                            horizon_deps::string hrast_loc(job.M_loc);
+                            hrast_loc += ".hrast";
+                            job.M_ok = writer.save(hrast_loc.c_str(), root);
+                        }
+                    }
+                }
+
+                // everything but the output is done with, free it before the allocators it came from
+                if (job.M_lexer_mem)
+                {
+                    add_stats(job.M_report.M_lexer_mem, job.M_lexer_mem->stats());
+                    add_stats(job.M_report.M_parser_mem, job.M_parser_mem->stats());
+                }
+                if (job.M_emit_mem)
+                    add_stats(job.M_report.M_emit_mem, job.M_emit_mem->stats());
+                job.M_parser = nullptr;
+                job.M_tokens.erase();
+                job.M_lexer = nullptr;
+                job.M_file = nullptr;
+                job.M_emit_mem = nullptr;
+                job.M_parser_mem = nullptr;
+                job.M_lexer_mem = nullptr;
+            }
+
+            void start_file(horizon_deps::scheduler &sched, file_job &job, const horizon_misc::options &opts)
+            {
+                horizon_deps::task *lex = sched.spawn([&job, &opts]()
+                                                      { lex_file(job, opts); });
+                horizon_deps::task *parse = sched.then(lex, [&job, &opts]()
+                                                       { parse_file(job, opts); });
+                job.M_done = sched.then(parse, [&sched, &job, &opts]()
+                                        { emit_file(sched, job, opts); });
+            }
+
+            void print_report(const horizon_misc::options &opts, const horizon_deps::vector<file_job> &jobs, const file_report &total, const double &elapsed, const std::size_t &threads)
+            {
+                // stdout only carries the requested --emit output
+                if (opts.M_time_report)
+                {
+                    if (jobs.length() > 1)
+                    {
+                        for (const file_job &job : jobs)
+                            job.M_report.M_times.print(job.M_loc);
+                        char title[64];
+                        std::snprintf(title, sizeof(title), "all %zu files", jobs.length());
+                        total.M_times.print(title);
+                    }
+                    else
+                        total.M_times.print(jobs[0].M_loc);
+                    std::fprintf(stderr, "elapsed %.6f s on %zu thread%s\n", elapsed, threads, (threads == 1 ? "" : "s"));
+                }
+
+                if (opts.M_alloc_stats)
+                {
+                    horizon_misc::phase_allocator::print_stats_header();
+                    horizon_misc::phase_allocator::print_stats("lexer", total.M_lexer_mem);
+                    horizon_misc::phase_allocator::print_stats("parser", total.M_parser_mem);
+                    horizon_misc::phase_allocator::print_stats("emit", total.M_emit_mem);
+                }
+            }
+        }
+
+        file_report &file_report::operator+=(const file_report &other)
+        {
+            this->M_times += other.M_times;
+            add_stats(this->M_lexer_mem, other.M_lexer_mem);
+            add_stats(this->M_parser_mem, other.M_parser_mem);
+            add_stats(this->M_emit_mem, other.M_emit_mem);
+            return *this;
+        }
+
+        compile_cache::compile_cache()
+            : M_jobs(0), M_request(0), M_hits(0), M_misses(0) {}
+
+        horizon_deps::scheduler &compile_cache::workers(const std::size_t &jobs)
+        {
+            if (!this->M_workers || this->M_jobs != jobs)
+            {
+                this->M_workers = nullptr;
+                this->M_workers = horizon_deps::create<horizon_deps::scheduler>(jobs);
+                this->M_jobs = jobs;
+            }
+            return *this->M_workers;
+        }
+
+        std::size_t compile_cache::key_of(const horizon_misc::HR_FILE &file, const horizon_misc::options &opts)
+        {
+            // a hash-consed AST is not the plain one
+            return horizon_deps::hash_bytes(file.M_content.c_str(), file.M_content.length(), opts.M_hash_cons ? 1 : 0);
+        }
+
+        const cached_file *compile_cache::find(const std::size_t &key, const horizon_misc::HR_FILE &file)
+        {
+            std::lock_guard<std::mutex> guard(this->M_lock);
+            horizon_deps::sptr<cached_file> *found = this->M_files.find(key);
+            if (!found || (*found)->M_file->M_content.length() != file.M_content.length() ||
+                std::memcmp((*found)->M_file->M_content.c_str(), file.M_content.c_str(), file.M_content.length()) != 0)
+            {
+                this->M_misses++;
+                return nullptr;
+            }
+            (*found)->M_last_used = this->M_request;
+            this->M_hits++;
+            return found->raw();
+        }
+
+        const cached_file *compile_cache::add(const std::size_t &key, horizon_deps::sptr<cached_file> &file)
+        {
+            std::lock_guard<std::mutex> guard(this->M_lock);
+            horizon_deps::allocator_scope scope(horizon_deps::malloc_allocator::instance());
+            horizon_deps::sptr<cached_file> *found = this->M_files.find(key);
+            if (found)
+            {
+                // a file of this request with the same content got here first, `file` goes with the job
+                const horizon_deps::string &content = (*found)->M_file->M_content;
+                if (content.length() == file->M_file->M_content.length() && std::memcmp(content.c_str(), file->M_file->M_content.c_str(), content.length()) == 0)
+                    return found->raw();
+                return nullptr;
+            }
+            file->M_last_used = this->M_request;
+            cached_file *raw = file.raw();
+            (void)this->M_files.append(std::size_t(key), std::move(file));
+            this->M_keys.add(key);
+            return raw;
+        }
+
+        void compile_cache::next_request()
+        {
+            horizon_deps::allocator_scope scope(horizon_deps::malloc_allocator::instance());
+            horizon_parser::string_table &strings = horizon_parser::string_table::instance();
+            bool drop_all = strings.count() > MAX_STRINGS;
+            horizon_deps::vector<std::size_t> kept;
+            for (const std::size_t &key : this->M_keys)
+            {
+                if (drop_all || (*this->M_files.find(key))->M_last_used + KEEP_REQUESTS <= this->M_request)
+                    (void)this->M_files.remove(key);
+                else
+                    kept.add(key);
+            }
+            this->M_keys = std::move(kept);
+            // the ASTs of the dropped files were the last ones using the strings, the workers are idle between requests
+            if (this->M_files.length() == 0 && strings.count() != 0)
+                strings.clear();
+            this->M_request++;
+            this->M_hits = this->M_misses = 0;
+        }
+
+        const std::size_t &compile_cache::hits() const
+        {
+            return this->M_hits;
+        }
+
+        const std::size_t &compile_cache::misses() const
+        {
+            return this->M_misses;
+        }
+
+        const std::size_t &compile_cache::length() const
+        {
+            return this->M_files.length();
+        }
+
+        int compile_files(const horizon_misc::options &opts, compile_cache *cache)
+        {
+            const horizon_deps::vector<horizon_deps::string> &files = opts.M_files;
+            clock_type::time_point start = clock_type::now();
+            horizon_deps::sptr<horizon_deps::scheduler> own_sched;
+            if (!cache)
+                own_sched = horizon_deps::create<horizon_deps::scheduler>(opts.M_jobs);
+            horizon_deps::scheduler &sched = (cache ? cache->workers(opts.M_jobs) : *own_sched);
+            horizon_misc::out_buffer out(STDOUT_FILENO, COLOR_OUT);
+            file_report total;
+            bool ok = true;
+
+            // with one thread files go through one at a time straight into `out`; otherwise a few files per thread are
+            // in flight, each into its own buffer, and are printed strictly in input order whatever order they finish in
+            bool direct = (sched.threads() == 1);
+            std::size_t in_flight = (direct ? 1 : 4 * sched.threads());
+
+            horizon_deps::vector<file_job> jobs(files.length());
+            for (std::size_t i = 0; i < files.length(); i++)
+            {
+                jobs.add(file_job());
+                jobs[i].M_loc = files[i].c_str();
+                jobs[i].M_cache = cache;
+            }
+
+            std::size_t started = 0;
+            for (std::size_t i = 0; i < files.length(); i++)
+            {
+                for (; started < files.length() && started < i + in_flight; started++)
+                {
+                    file_job &job = jobs[started];
+                    if (direct)
+                        job.M_out = &out;
+                    else
+                    {
+                        job.M_own_out = horizon_deps::create<horizon_misc::out_buffer>(horizon_misc::out_buffer::IN_MEMORY, COLOR_OUT);
+                        job.M_out = job.M_own_out.raw();
+                    }
+                    start_file(sched, job, opts);
+                }
+
+                file_job &done = jobs[i];
+                sched.wait(done.M_done);
+                if (!direct)
+                {
+                    out.append(done.M_out->raw(), done.M_out->length());
+                    done.M_own_out = nullptr;
+                }
+                out.flush();
+                if (!done.M_diagnostics.is_empty())
+                    std::fwrite(done.M_diagnostics.c_str(), sizeof(char), done.M_diagnostics.length(), stderr);
+                done.M_diagnostics = horizon_deps::string();
+                if (!done.M_ok)
+                    ok = false;
+                total += done.M_report;
+            }
+
+            print_report(opts, jobs, total, std::chrono::duration<double>(clock_type::now() - start).count(), sched.threads());
+            if (cache)
+                sched.reclaim(); // the cache's workers run every request, their finished tasks would pile up
+            return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        int run(const horizon_misc::options &opts, compile_cache *cache)
+        {
+            if (!opts.M_trace.is_empty())
+                horizon_misc::start_trace();
+            if (opts.M_stats != horizon_misc::stats_format::STATS_NONE)
+                horizon_misc::start_stats();
+            int exit_code = compile_files(opts, cache);
+            // every task has finished, no thread records or counts anymore
+            if (!opts.M_trace.is_empty() && !horizon_misc::finish_trace(opts.M_trace.c_str()))
+                exit_code = EXIT_FAILURE;
+            if (opts.M_stats != horizon_misc::stats_format::STATS_NONE)
+                horizon_misc::finish_stats(opts.M_stats == horizon_misc::stats_format::STATS_JSON);
+            return exit_code;
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file driver.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_DRIVER_DRIVER_HH
+#define HORIZON_DRIVER_DRIVER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "../../deps/allocator/allocator.hh"
+#include "../../deps/hashtable/hashtable.hh"
+#include "../../deps/scheduler/scheduler.hh"
+#include "../../deps/sptr/sptr.hh"
+#include "../../deps/vector/vector.hh"
+#include "../misc/file/file.hh"
+#include "../misc/options.hh"
+#include "../misc/out_buffer.hh"
+#include "../misc/phase_allocator.hh"
+#include "../misc/time_report.hh"
+#include "../parser/parser.hh"
+#include "../token/token.hh"
+
+namespace horizon
+{
+    namespace horizon_driver
+    {
+        /**
+         * What compiling one file cost, summed over all files for the report printed at the end
+         */
+        struct file_report
+        {
+            horizon_misc::phase_times M_times;
+            horizon_deps::allocator_stats M_lexer_mem, M_parser_mem, M_emit_mem;
+
+            file_report &operator+=(const file_report &other);
+        };
+
+        /**
+         * The tokens and the AST of a file that compiled without an error, together with the memory they live in
+         */
+        struct cached_file
+        {
+            horizon_deps::sptr<horizon_misc::phase_allocator> M_lexer_mem, M_parser_mem; // first, everything below lives in them
+            horizon_deps::sptr<horizon_misc::HR_FILE> M_file;
+            horizon_deps::vector<token> M_tokens; // as the lexer made them, the parser consumed a copy
+            horizon_deps::sptr<horizon_parser::parser> M_parser;
+            std::size_t M_last_used = 0; // request that last found or added it
+        };
+
+        /**
+         * What `--server` keeps warm between compilations: the worker threads, and every file that compiled without an error keyed by
+         * a hash of its content, so that an unchanged file costs a hash and a compare instead of lexing and parsing.
+         * Files are looked up and added from any thread during a compilation; `next_request` is called between compilations.
+         */
+        class compile_cache
+        {
+          private:
+            std::mutex M_lock;
+            horizon_deps::hashtable<std::size_t, horizon_deps::sptr<cached_file>> M_files;
+            horizon_deps::vector<std::size_t> M_keys; // every key of `M_files`, to sweep them
+            horizon_deps::sptr<horizon_deps::scheduler> M_workers;
+            std::size_t M_jobs, M_request;
+            std::size_t M_hits, M_misses; // of the current request
+
+          public:
+            static constexpr std::size_t KEEP_REQUESTS = 8; // files not compiled for that many requests are dropped
+            static constexpr std::uint32_t MAX_STRINGS = 1 << 22; // strings in the string table past which every file is dropped
+
+            compile_cache();
+            compile_cache(const compile_cache &) = delete;
+            compile_cache &operator=(const compile_cache &) = delete;
+
+            /**
+             * @brief The worker threads for `--jobs=jobs`, started again only when `jobs` differs from the last request
+             */
+            [[nodiscard]] horizon_deps::scheduler &workers(const std::size_t &jobs);
+
+            [[nodiscard]] static std::size_t key_of(const horizon_misc::HR_FILE &file, const horizon_misc::options &opts);
+
+            /**
+             * @brief The cached file with the content of `file`, nullptr if there is none
+             */
+            [[nodiscard]] const cached_file *find(const std::size_t &key, const horizon_misc::HR_FILE &file);
+
+            /**
+             * @brief Takes `file` and returns it, or returns the cached file with its content if there is one already. Leaves `file`
+             * alone and returns nullptr if another content is cached under `key`
+             */
+            [[nodiscard]] const cached_file *add(const std::size_t &key, horizon_deps::sptr<cached_file> &file);
+
+            /**
+             * @brief Drops the files not used by the last `KEEP_REQUESTS` requests, or all of them once the process-wide
+             * `horizon_parser::string_table` holds more than `MAX_STRINGS` strings, and starts counting hits for the next one.
+             * The string table never forgets a string on its own, so it is emptied whenever no file is left to use it
+             */
+            void next_request();
+
+            [[nodiscard]] const std::size_t &hits() const;
+            [[nodiscard]] const std::size_t &misses() const;
+            [[nodiscard]] const std::size_t &length() const;
+        };
+
+        /**
+         * @brief Compiles every file of `opts` and returns the exit code. Every file is a chain of lexer, parser and emit tasks on a
+         * `horizon_deps::scheduler` with `--jobs` threads; output and diagnostics are written in the order the files were given.
+         * With a `cache`, its workers run the tasks and files are taken from and added to it
+         */
+        [[nodiscard]] int compile_files(const horizon_misc::options &opts, compile_cache *cache = nullptr);
+
+        /**
+         * @brief `compile_files` with the `--trace` and `--stats` output that `opts` asks for around it
+         */
+        [[nodiscard]] int run(const horizon_misc::options &opts, compile_cache *cache = nullptr);
+    }
+}
+
+#endif
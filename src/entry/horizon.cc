@@ -4,11 +4,9 @@
  * @author Tushar Chaurasia (Dark-CodeX)
  */
 
-#include <ctime>
-
-#include "../lexer/lexer.hh"
-#include "../parser/parser.hh"
-#include "../misc/load_file.hh"
+#include "../driver/driver.hh"
+#include "../misc/options.hh"
+#include "../server/server.hh"
 
 int main(int argc, char **argv)
 {
@@ -16,40 +14,23 @@ int main(int argc, char **argv)
     make_prompt_colored();
 #endif
 
-    if (argc == 1)
-    {
-        if (COLOR_ERR)
-            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " no file given\n");
-        else
-            std::fprintf(stderr, "horizon: error: no file given\n");
-        return EXIT_FAILURE;
-    }
-
-    horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> file = horizon::horizon_misc::load_file(argv[1]);
-    if (!file)
-    {
-        // error message is already printed and memory is freed
-        return EXIT_FAILURE;
-    }
-
-    time_t start = clock();
-
-    horizon::horizon_deps::sptr<horizon::horizon_lexer::lexer> lexer(file.raw());
-    if (!lexer->init_lexing())
+    horizon::horizon_deps::sptr<horizon::horizon_misc::options> opts = horizon::horizon_misc::parse_options(argc, argv);
+    if (!opts)
     {
+        // error message is already printed
         return EXIT_FAILURE;
     }
-    time_t end_lexer = clock();
-
-    horizon::horizon_deps::sptr<horizon::horizon_parser::parser> parser({std::move(lexer->move()), file.raw()});
 
-    if (!parser->init_parsing())
+    if (opts->M_server != horizon::horizon_misc::server_mode::SERVER_NONE)
     {
-        return EXIT_FAILURE;
+        horizon::horizon_deps::string socket = (opts->M_socket.is_empty() ? horizon::horizon_server::default_socket() : opts->M_socket);
+        // an empty one has no place, the error is already printed
+        if (opts->M_server == horizon::horizon_misc::server_mode::SERVER_LISTEN)
+            return (socket.is_empty() ? EXIT_FAILURE : horizon::horizon_server::serve(socket.c_str()));
+        int exit_code = (socket.is_empty() ? -1 : horizon::horizon_server::forward(socket.c_str(), opts->M_args));
+        if (exit_code != -1)
+            return exit_code;
+        // no server is running, compile here
     }
-    time_t end_parser = clock();
-
-    printf("LEXER TIME: " ENCLOSE(GREEN_FG, "%lf") " sec\nPARSER TIME: " ENCLOSE(GREEN_FG, "%lf") " sec\n", double(end_lexer - start) / CLOCKS_PER_SEC, double(end_parser - end_lexer) / CLOCKS_PER_SEC);
-
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return horizon::horizon_driver::run(*opts);
+}
@@ -10,11 +10,13 @@
 #include <utility>
 
 #include "../../deps/string/string.hh"
+#include "../../deps/string/str_view.hh"
 #include "../../deps/vector/vector.hh"
 #include "../colorize/colorize.h"
 #include "../defines/defines.h"
 #include "../token/token.hh"
 #include "../misc/file/file.hh"
+#include "../misc/diagnostic.hh"
 
 namespace horizon
 {
@@ -35,12 +37,39 @@ namespace horizon
             HORIZON_NO_ERROR
         };
 
+        /**
+         * One error as the parts its printed form is made of, see `error_collector`
+         */
+        struct error_info
+        {
+            error_code M_code;
+            const char *M_phase;          // "lexer", "parser", or "horizon" for a file that could not be loaded
+            std::size_t M_line, M_column; // both counted from 1, 0 if the error is about no place in the source
+            std::size_t M_start, M_end;   // byte offsets of the marked source
+            horizon_deps::string M_message;
+        };
+
+        /**
+         * While alive, `lexer_draw_error` and `parser_draw_error` on the calling thread also add an `error_info` to `list`
+         */
+        class error_collector
+        {
+          private:
+            horizon_deps::vector<error_info> *M_prev;
+
+          public:
+            error_collector(horizon_deps::vector<error_info> &list);
+            error_collector(const error_collector &) = delete;
+            error_collector &operator=(const error_collector &) = delete;
+            ~error_collector();
+        };
+
         class errors
         {
         public:
-            [[nodiscard]] static std::pair<horizon_deps::string, std::size_t> getline(const horizon_deps::string &str, const std::size_t &start, const std::size_t &end__, const horizon_deps::string &color);
+            [[nodiscard]] static std::pair<horizon_deps::string, std::size_t> getline(const horizon_deps::str_view &str, const std::size_t &start, const std::size_t &end__, const horizon_deps::string &color);
 
-            [[nodiscard]] static std::size_t getline_no(const horizon_deps::string &str, const std::size_t &start);
+            [[nodiscard]] static std::size_t getline_no(const horizon_deps::str_view &str, const std::size_t &start);
 
             static void lexer_draw_error(const error_code &code, const horizon_misc::HR_FILE *file, const std::size_t &line_no, const std::size_t &start, const std::size_t &end, const horizon_deps::vector<horizon_deps::string> &err_msg);
 
@@ -372,12 +372,13 @@ namespace horizon
 
         void lexer::append_token(const token_type &type)
         {
-            horizon_deps::string temp(this->M_file->M_content.substr(this->M_start_lexer, this->M_current_lexer - this->M_start_lexer));
+            horizon_deps::str_view lexeme = this->M_file->M_content.view(this->M_start_lexer, this->M_current_lexer - this->M_start_lexer);
+            horizon_deps::string temp(lexeme);
             if (type == token_type::TOKEN_IDENTIFIER)
             {
-                if (is_keyword(temp.c_str()))
+                if (is_keyword(lexeme))
                     this->M_tokens.add(token{token_type::TOKEN_KEYWORD, std::move(temp), this->M_start_lexer, this->M_current_lexer});
-                else if (is_primary_data_type(temp.c_str()))
+                else if (is_primary_data_type(lexeme))
                     this->M_tokens.add(token{token_type::TOKEN_PRIMARY_TYPE, std::move(temp), this->M_start_lexer, this->M_current_lexer});
                 else
                     this->M_tokens.add(token{type, std::move(temp), this->M_start_lexer, this->M_current_lexer});
@@ -546,9 +547,7 @@ namespace horizon
                         temp_str += "\?";
                         break;
                     case '0':
-                        temp_str.resize(temp_str.length() + 2);
-                        temp_str.raw()[temp_str.length()] = 0;
-                        temp_str.length() = temp_str.length() + 1;
+                        temp_str += '\0';
                         break;
 
                     default:
@@ -638,9 +637,7 @@ namespace horizon
                         temp_str += "\?";
                         break;
                     case '0':
-                        temp_str.resize(temp_str.length() + 2);
-                        temp_str.raw()[temp_str.length()] = 0;
-                        temp_str.length() = temp_str.length() + 1;
+                        temp_str += '\0';
                         break;
 
                     default:
@@ -704,11 +701,24 @@ namespace horizon
 
         bool lexer::init_lexing()
         {
-            this->M_ch = this->M_file->M_content[this->M_current_lexer];
-            if (!this->scan_tokens())
-                return false;
-            this->M_tokens.add(token{token_type::TOKEN_END_OF_FILE, nullptr, static_cast<std::size_t>(-1), static_cast<std::size_t>(-1)});
-            std::size_t invalid_bracket_pos = this->check_brackets();
+            {
+                horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_LEX, this->M_file->M_location.c_str(), this->M_file->M_location.length());
+                this->M_ch = this->M_file->M_content[this->M_current_lexer];
+                if (!this->scan_tokens())
+                    return false;
+                this->M_tokens.add(token{token_type::TOKEN_END_OF_FILE, nullptr, static_cast<std::size_t>(-1), static_cast<std::size_t>(-1)});
+            }
+            if (horizon_misc::is_counting())
+            {
+                horizon_misc::thread_stats &stats = horizon_misc::this_thread_stats();
+                for (const token &tok : this->M_tokens)
+                    stats.M_tokens[static_cast<std::size_t>(tok.M_type)]++;
+            }
+            std::size_t invalid_bracket_pos;
+            {
+                horizon_misc::scope_timer timer(horizon_misc::phase::PHASE_BRACKETS, this->M_file->M_location.c_str(), this->M_file->M_location.length());
+                invalid_bracket_pos = this->check_brackets();
+            }
             if (invalid_bracket_pos != static_cast<std::size_t>(-1))
             {
                 horizon_errors::errors::lexer_draw_error(horizon_errors::error_code::HORIZON_INVALID_BRACKET, this->M_file, horizon_errors::errors::getline_no(this->M_file->M_content, this->M_tokens[invalid_bracket_pos].M_start),
@@ -735,69 +745,24 @@ namespace horizon
             return std::move(this->M_tokens);
         }
 
-        void lexer::debug_print() const
+        void lexer::debug_print(horizon_misc::out_buffer &out) const
         {
-            const char *to_str[] =
-                {
-                    "TOKEN_IDENTIFIER",
-                    "TOKEN_CHAR_LITERAL",
-                    "TOKEN_STRING_LITERAL",
-                    "TOKEN_INTEGER_LITERAL",
-                    "TOKEN_DECIMAL_LITERAL",
-                    "TOKEN_ARITHMETIC_ADD",
-                    "TOKEN_ARITHMETIC_SUBSTRACT",
-                    "TOKEN_ARITHMETIC_MULTIPLY",
-                    "TOKEN_ARITHMETIC_POWER",
-                    "TOKEN_ARITHMETIC_DIVIDE",
-                    "TOKEN_ARITHMETIC_MODULUS",
-                    "TOKEN_RELATIONAL_EQUAL_TO",
-                    "TOKEN_RELATIONAL_NOT_EQUAL_TO",
-                    "TOKEN_RELATIONAL_GREATER_THAN",
-                    "TOKEN_RELATIONAL_LESS_THAN",
-                    "TOKEN_RELATIONAL_GREATER_THAN_OR_EQUAL_TO",
-                    "TOKEN_RELATIONAL_LESS_THAN_OR_EQUAL_TO",
-                    "TOKEN_LOGICAL_NOT",
-                    "TOKEN_LOGICAL_AND",
-                    "TOKEN_LOGICAL_OR",
-                    "TOKEN_BITWISE_NOT",
-                    "TOKEN_BITWISE_AND",
-                    "TOKEN_BITWISE_OR",
-                    "TOKEN_BITWISE_XOR",
-                    "TOKEN_BITWISE_LEFT_SHIFT",
-                    "TOKEN_BITWISE_RIGHT_SHIFT",
-                    "TOKEN_ASSIGN",
-                    "TOKEN_ASSIGN_ADD",
-                    "TOKEN_ASSIGN_SUBSTRACT",
-                    "TOKEN_ASSIGN_MULTIPLY",
-                    "TOKEN_ASSIGN_POWER",
-                    "TOKEN_ASSIGN_DIVIDE",
-                    "TOKEN_ASSIGN_MODULUS",
-                    "TOKEN_ASSIGN_BITWISE_AND",
-                    "TOKEN_ASSIGN_BITWISE_OR",
-                    "TOKEN_ASSIGN_BITWISE_XOR",
-                    "TOKEN_ASSIGN_LEFT_SHIFT",
-                    "TOKEN_ASSIGN_RIGHT_SHIFT",
-                    "TOKEN_INCREMENT",
-                    "TOKEN_DECREMENT",
-                    "TOKEN_QUESTION",
-                    "TOKEN_SEMICOLON",
-                    "TOKEN_COLON",
-                    "TOKEN_MEMEBER_ACCESS",
-                    "TOKEN_COMMA",
-                    "TOKEN_DOT",
-                    "TOKEN_RIGHT_PAREN",
-                    "TOKEN_LEFT_PAREN",
-                    "TOKEN_RIGHT_BRACE",
-                    "TOKEN_LEFT_BRACE",
-                    "TOKEN_RIGHT_BRACKET",
-                    "TOKEN_LEFT_BRACKET",
-                    "TOKEN_KEYWORD",
-                    "TOKEN_PRIMARY_TYPE",
-                    "TOKEN_END_OF_FILE"};
-
-            for (std::size_t i = 0; i < this->M_tokens.length(); i++)
+            lexer::print_tokens(this->M_tokens, out);
+        }
+
+        void lexer::print_tokens(const horizon_deps::vector<token> &tokens, horizon_misc::out_buffer &out)
+        {
+            for (std::size_t i = 0; i < tokens.length(); i++)
             {
-                std::printf("'%s': %s: start:%zu, end:%zu\n", (this->M_tokens[i].M_lexeme == "\n" ? "\\n" : this->M_tokens[i].M_lexeme.c_str()), to_str[static_cast<std::size_t>(this->M_tokens[i].M_type)], this->M_tokens[i].M_start, this->M_tokens[i].M_end);
+                out.append('\'');
+                if (tokens[i].M_lexeme == "\n")
+                    out.append("\\n", 2);
+                else if (tokens[i].M_lexeme.is_null())
+                    out.append("(null)", 6);
+                else
+                    out.append(tokens[i].M_lexeme);
+                out.append("': ", 3).append_colored(BLUE_FG, TOKEN_TYPE_NAMES[static_cast<std::size_t>(tokens[i].M_type)]);
+                out.append(": start:", 8).append_uint(tokens[i].M_start).append(", end:", 6).append_uint(tokens[i].M_end).append('\n');
             }
         }
     }
@@ -20,6 +20,9 @@
 #include "../errors/errors.hh"
 #include "../colorize/colorize.h"
 #include "../misc/file/file.hh"
+#include "../misc/out_buffer.hh"
+#include "../misc/stats.hh"
+#include "../misc/time_report.hh"
 
 namespace horizon
 {
@@ -81,7 +84,12 @@ namespace horizon
             [[nodiscard]] horizon_deps::vector<token> &get();
             [[nodiscard]] horizon_deps::vector<token> &&move();
 
-            void debug_print() const;
+            void debug_print(horizon_misc::out_buffer &out) const;
+
+            /**
+             * @brief Prints `tokens` the way `debug_print` prints the lexer's own
+             */
+            static void print_tokens(const horizon_deps::vector<token> &tokens, horizon_misc::out_buffer &out);
         };
     }
 }
@@ -0,0 +1,45 @@
+/**
+ * @file diagnostic.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_DIAGNOSTIC_HH
+#define HORIZON_MISC_DIAGNOSTIC_HH
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "../../deps/string/string.hh"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        /**
+         * @brief `fprintf(stderr, ...)` for messages about an input file, or appends to the calling thread's `diagnostic_capture` if there is one
+         */
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 1, 2)))
+#endif
+        int diagnostic(const char *fmt, ...);
+
+        /**
+         * While alive, `diagnostic` on the calling thread appends to `buffer` instead of writing to stderr,
+         * so that files compiled in parallel can be reported in a fixed order afterwards
+         */
+        class diagnostic_capture
+        {
+          private:
+            horizon_deps::string *M_prev;
+
+          public:
+            diagnostic_capture(horizon_deps::string &buffer);
+            diagnostic_capture(const diagnostic_capture &) = delete;
+            diagnostic_capture &operator=(const diagnostic_capture &) = delete;
+            ~diagnostic_capture();
+        };
+    }
+}
+
+#endif
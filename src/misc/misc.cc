@@ -7,6 +7,22 @@
 #include "./load_file.hh"
 #include "./exit_heap_fail.hh"
 #include "./is_directory.hh"
+#include "./out_buffer.hh"
+#include "./options.hh"
+#include "./phase_allocator.hh"
+#include "./diagnostic.hh"
+#include "./time_report.hh"
+#include "./trace.hh"
+#include "./stats.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
 
 namespace horizon
 {
@@ -17,30 +33,29 @@ namespace horizon
             if (!loc)
             {
                 if (COLOR_ERR)
-                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " horizon::horizon_misc::load_file: file location was (null)\n");
+                    diagnostic("horizon: " ENCLOSE(RED_FG, "error:") " horizon::horizon_misc::load_file: file location was (null)\n");
                 else
-                    std::fprintf(stderr, "horizon: error: horizon::horizon_misc::load_file: file location was (null)\n");
+                    diagnostic("horizon: error: horizon::horizon_misc::load_file: file location was (null)\n");
                 return nullptr;
             }
             if (is_directory(loc))
             {
                 if (COLOR_ERR)
-                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " '%s' cannot be opened for reading: Is a directory\n", loc);
+                    diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " '%s' cannot be opened for reading: Is a directory\n", loc);
                 else
-                    std::fprintf(stderr, "horizon: error[E1]: '%s' cannot be opened for reading: Is a directory\n", loc);
+                    diagnostic("horizon: error[E1]: '%s' cannot be opened for reading: Is a directory\n", loc);
                 return nullptr;
             }
-            HR_FILE *file = new HR_FILE();
-            exit_heap_fail(file, "horizon::horizon_misc::load_file");
+            HR_FILE *file = horizon_deps::create<HR_FILE>();
             file->M_location = loc;
             std::FILE *fptr = std::fopen(loc, "rb");
             if (!fptr)
             {
-                delete file;
+                horizon_deps::destroy(file);
                 if (COLOR_ERR)
-                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                    diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for reading: %s\n", loc, std::strerror(errno));
                 else
-                    std::fprintf(stderr, "horizon: error[E1]: '%s' cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                    diagnostic("horizon: error[E1]: '%s' cannot be opened for reading: %s\n", loc, std::strerror(errno));
                 return nullptr;
             }
 
@@ -48,26 +63,27 @@ namespace horizon
             std::size_t LEN = std::ftell(fptr);
             std::fseek(fptr, 0, SEEK_SET);
 
-            file->M_content.resize(LEN + 1);
+            file->M_content.reserve(LEN);
             if (std::fread(file->M_content.raw(), sizeof(char), LEN, fptr) != LEN)
             {
                 std::fclose(fptr);
-                delete file;
+                horizon_deps::destroy(file);
                 if (COLOR_ERR)
-                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " not every byte was read: %s\n", loc, std::strerror(errno));
+                    diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " not every byte was read: %s\n", loc, std::strerror(errno));
                 else
-                    std::fprintf(stderr, "horizon: error[E1]: '%s' not every byte was read: %s\n", loc, std::strerror(errno));
+                    diagnostic("horizon: error[E1]: '%s' not every byte was read: %s\n", loc, std::strerror(errno));
                 return nullptr;
             }
+            file->M_content.raw()[LEN] = 0;
             file->M_content.length() = LEN;
             if (file->M_content.is_empty())
             {
                 std::fclose(fptr);
-                delete file;
+                horizon_deps::destroy(file);
                 if (COLOR_ERR)
-                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " was empty: %s\n", loc, "0 byte file size");
+                    diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " was empty: %s\n", loc, "0 byte file size");
                 else
-                    std::fprintf(stderr, "horizon: error[E1]: '%s' was empty: %s\n", loc, "0 byte file size");
+                    diagnostic("horizon: error[E1]: '%s' was empty: %s\n", loc, "0 byte file size");
                 return nullptr;
             }
             std::fclose(fptr);
@@ -86,6 +102,53 @@ namespace horizon
             }
         }
 
+        namespace
+        {
+            thread_local horizon_deps::string *capture = nullptr;
+        }
+
+        int diagnostic(const char *fmt, ...)
+        {
+            std::va_list args;
+            va_start(args, fmt);
+            int len;
+            if (!capture)
+                len = std::vfprintf(stderr, fmt, args);
+            else
+            {
+                // the captured text outlives the allocator of the phase that reported it
+                horizon_deps::allocator_scope scope(horizon_deps::malloc_allocator::instance());
+                char temp[512];
+                std::va_list copy;
+                va_copy(copy, args);
+                len = std::vsnprintf(temp, sizeof(temp), fmt, copy);
+                va_end(copy);
+                if (len > 0 && static_cast<std::size_t>(len) < sizeof(temp))
+                    capture->append(horizon_deps::str_view(temp, static_cast<std::size_t>(len)));
+                else if (len > 0)
+                {
+                    horizon_deps::string long_msg;
+                    long_msg.reserve(static_cast<std::size_t>(len));
+                    std::vsnprintf(long_msg.raw(), static_cast<std::size_t>(len) + 1, fmt, args);
+                    long_msg.length() = static_cast<std::size_t>(len);
+                    capture->append(long_msg);
+                }
+            }
+            va_end(args);
+            return len;
+        }
+
+        diagnostic_capture::diagnostic_capture(horizon_deps::string &buffer)
+            : M_prev(capture)
+        {
+            capture = &buffer;
+        }
+
+        diagnostic_capture::~diagnostic_capture()
+        {
+            capture = this->M_prev;
+        }
+
         bool is_directory(const char *loc)
         {
             if (!loc)
@@ -105,5 +168,914 @@ namespace horizon
 #endif
             return false;
         }
+
+        void out_buffer::write_fd(const char *data, std::size_t len) const
+        {
+            while (len > 0)
+            {
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+                int written = _write(this->M_fd, data, static_cast<unsigned int>(len));
+#else
+                ssize_t written = ::write(this->M_fd, data, len);
+#endif
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return;
+                }
+                data += written;
+                len -= static_cast<std::size_t>(written);
+            }
+        }
+
+        out_buffer::out_buffer(const int &fd, const bool &colored, const std::size_t &cap)
+        {
+            this->M_cap = cap;
+            this->M_len = 0;
+            this->M_fd = fd;
+            this->M_colored = colored;
+            this->M_data = static_cast<char *>(std::malloc(this->M_cap * sizeof(char)));
+            exit_heap_fail(this->M_data, "horizon::horizon_misc::out_buffer");
+        }
+
+        bool out_buffer::make_room(const std::size_t &len)
+        {
+            if (this->M_fd != out_buffer::IN_MEMORY)
+            {
+                this->flush();
+                return len <= this->M_cap;
+            }
+            std::size_t new_cap = this->M_cap * 2;
+            if (new_cap < this->M_len + len)
+                new_cap = this->M_len + len;
+            this->M_data = static_cast<char *>(std::realloc(this->M_data, new_cap * sizeof(char)));
+            exit_heap_fail(this->M_data, "horizon::horizon_misc::out_buffer");
+            this->M_cap = new_cap;
+            return true;
+        }
+
+        out_buffer &out_buffer::append(const char &c)
+        {
+            if (this->M_len == this->M_cap)
+                (void)this->make_room(1);
+            this->M_data[this->M_len++] = c;
+            return *this;
+        }
+
+        out_buffer &out_buffer::append(const char *src)
+        {
+            if (src)
+                return this->append(src, std::strlen(src));
+            return *this;
+        }
+
+        out_buffer &out_buffer::append(const char *src, const std::size_t &len)
+        {
+            if (!src || len == 0)
+                return *this;
+            if (this->M_len + len > this->M_cap && !this->make_room(len))
+            {
+                // too large to be buffered, write it directly
+                this->write_fd(src, len);
+                return *this;
+            }
+            std::memcpy(this->M_data + this->M_len, src, len);
+            this->M_len += len;
+            return *this;
+        }
+
+        out_buffer &out_buffer::append(const horizon_deps::string &src)
+        {
+            return this->append(src.c_str(), src.length());
+        }
+
+        out_buffer &out_buffer::append_uint(const std::size_t &num)
+        {
+            char temp[32];
+            int len = std::snprintf(temp, sizeof(temp), "%zu", num);
+            return this->append(temp, static_cast<std::size_t>(len));
+        }
+
+        out_buffer &out_buffer::append_int(const long long &num)
+        {
+            char temp[32];
+            int len = std::snprintf(temp, sizeof(temp), "%lld", num);
+            return this->append(temp, static_cast<std::size_t>(len));
+        }
+
+        out_buffer &out_buffer::append_decimal(const double &num, const bool &exact)
+        {
+            char temp[64];
+            int len = std::snprintf(temp, sizeof(temp), (exact ? "%.17g" : "%g"), num);
+            return this->append(temp, static_cast<std::size_t>(len));
+        }
+
+        out_buffer &out_buffer::append_colored(const char *clr, const char *txt)
+        {
+            if (this->M_colored)
+                return this->append(clr).append(txt).append(RESET_COLOR);
+            return this->append(txt);
+        }
+
+        out_buffer &out_buffer::append_json_string(const char *src, const std::size_t &len)
+        {
+            if (!src)
+                return this->append("null", 4);
+            this->append('"');
+            for (std::size_t i = 0; i < len; i++)
+            {
+                unsigned char c = static_cast<unsigned char>(src[i]);
+                switch (c)
+                {
+                case '"':
+                    this->append("\\\"", 2);
+                    break;
+                case '\\':
+                    this->append("\\\\", 2);
+                    break;
+                case '\n':
+                    this->append("\\n", 2);
+                    break;
+                case '\r':
+                    this->append("\\r", 2);
+                    break;
+                case '\t':
+                    this->append("\\t", 2);
+                    break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char temp[8];
+                        int t_len = std::snprintf(temp, sizeof(temp), "\\u%04x", c);
+                        this->append(temp, static_cast<std::size_t>(t_len));
+                    }
+                    else
+                        this->append(static_cast<char>(c));
+                    break;
+                }
+            }
+            return this->append('"');
+        }
+
+        out_buffer &out_buffer::append_json_string(const horizon_deps::string &src)
+        {
+            return this->append_json_string(src.c_str(), src.length());
+        }
+
+        const bool &out_buffer::is_colored() const
+        {
+            return this->M_colored;
+        }
+
+        const std::size_t &out_buffer::length() const
+        {
+            return this->M_len;
+        }
+
+        const char *out_buffer::raw() const
+        {
+            return this->M_data;
+        }
+
+        void out_buffer::flush()
+        {
+            if (this->M_len == 0 || this->M_fd == out_buffer::IN_MEMORY)
+                return;
+            this->write_fd(this->M_data, this->M_len);
+            this->M_len = 0;
+        }
+
+        out_buffer::~out_buffer()
+        {
+            this->flush();
+            std::free(this->M_data);
+            this->M_data = nullptr;
+            this->M_cap = 0;
+        }
+
+        namespace
+        {
+            /**
+             * @brief Appends the arguments of the response file `loc` to `args` (expanding nested `@file`s), false with the error printed if it cannot be read
+             */
+            bool expand_response_file(const char *loc, horizon_deps::vector<horizon_deps::string> &args, const std::size_t &depth)
+            {
+                // a response file that names itself would never end
+                if (depth > 16)
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " response files nested too deeply at " ENCLOSE(WHITE_FG, "'%s'") "\n", loc);
+                    else
+                        std::fprintf(stderr, "horizon: error: response files nested too deeply at '%s'\n", loc);
+                    return false;
+                }
+                std::FILE *fptr = std::fopen(loc, "rb");
+                if (!fptr)
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                    else
+                        std::fprintf(stderr, "horizon: error[E1]: '%s' cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                    return false;
+                }
+                horizon_deps::string arg;
+                bool in_arg = false;
+                char quote = 0;
+                int c;
+                while ((c = std::fgetc(fptr)) != EOF)
+                {
+                    if (c == '\\')
+                    {
+                        int next = std::fgetc(fptr);
+                        if (next != EOF)
+                            c = next;
+                        arg.append(static_cast<char>(c));
+                        in_arg = true;
+                    }
+                    else if (quote)
+                    {
+                        if (c == quote)
+                            quote = 0;
+                        else
+                            arg.append(static_cast<char>(c));
+                    }
+                    else if (c == '"' || c == '\'')
+                    {
+                        quote = static_cast<char>(c);
+                        in_arg = true;
+                    }
+                    else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                    {
+                        if (in_arg)
+                        {
+                            if (arg[0] == '@' && !expand_response_file(arg.c_str() + 1, args, depth + 1))
+                            {
+                                std::fclose(fptr);
+                                return false;
+                            }
+                            else if (arg[0] != '@')
+                                args.add(std::move(arg));
+                            arg = horizon_deps::string("");
+                            in_arg = false;
+                        }
+                    }
+                    else
+                    {
+                        arg.append(static_cast<char>(c));
+                        in_arg = true;
+                    }
+                }
+                std::fclose(fptr);
+                if (in_arg)
+                {
+                    if (arg[0] == '@')
+                        return expand_response_file(arg.c_str() + 1, args, depth + 1);
+                    args.add(std::move(arg));
+                }
+                return true;
+            }
+
+            bool parse_jobs(const char *val, std::size_t &jobs)
+            {
+                char *end = nullptr;
+                unsigned long long n = std::strtoull(val, &end, 10);
+                if (!*val || *end || n == 0)
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " invalid value " ENCLOSE(WHITE_FG, "'%s'") " for '--jobs', expected a positive number\n", val);
+                    else
+                        std::fprintf(stderr, "horizon: error: invalid value '%s' for '--jobs', expected a positive number\n", val);
+                    return false;
+                }
+                jobs = static_cast<std::size_t>(n);
+                return true;
+            }
+        }
+
+        horizon_deps::sptr<options> parse_options(int argc, char **argv)
+        {
+            horizon_deps::sptr<options> opts = horizon_deps::create<options>();
+            horizon_deps::vector<horizon_deps::string> args;
+            for (int i = 1; i < argc; i++)
+            {
+                if (argv[i][0] == '@')
+                {
+                    if (!expand_response_file(argv[i] + 1, args, 0))
+                        return nullptr;
+                }
+                else
+                    args.add(horizon_deps::string(argv[i]));
+            }
+            horizon_deps::vector<horizon_deps::string> forward; // for --client
+            for (std::size_t i = 0; i < args.length(); i++)
+            {
+                const char *arg = args[i].c_str();
+                bool is_server = (std::strcmp(arg, "--server") == 0 || std::strncmp(arg, "--server=", 9) == 0);
+                bool is_client = (std::strcmp(arg, "--client") == 0 || std::strncmp(arg, "--client=", 9) == 0);
+                if (!is_client)
+                    forward.add(args[i]);
+                if (is_server || is_client)
+                {
+                    server_mode mode = (is_server ? server_mode::SERVER_LISTEN : server_mode::SERVER_CLIENT);
+                    if (opts->M_server != server_mode::SERVER_NONE && opts->M_server != mode)
+                    {
+                        if (COLOR_ERR)
+                            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " '--server' and '--client' cannot be used together\n");
+                        else
+                            std::fprintf(stderr, "horizon: error: '--server' and '--client' cannot be used together\n");
+                        return nullptr;
+                    }
+                    opts->M_server = mode;
+                    opts->M_socket = horizon_deps::string(arg[8] == '=' ? arg + 9 : "");
+                }
+                else if (std::strncmp(arg, "--emit=", 7) == 0)
+                {
+                    const char *val = arg + 7;
+                    if (std::strcmp(val, "none") == 0)
+                        opts->M_emit = emit_type::EMIT_NONE;
+                    else if (std::strcmp(val, "ast-text") == 0)
+                        opts->M_emit = emit_type::EMIT_AST_TEXT;
+                    else if (std::strcmp(val, "ast-json") == 0)
+                        opts->M_emit = emit_type::EMIT_AST_JSON;
+                    else if (std::strcmp(val, "tokens") == 0)
+                        opts->M_emit = emit_type::EMIT_TOKENS;
+                    else if (std::strcmp(val, "hrast") == 0)
+                        opts->M_emit = emit_type::EMIT_HRAST;
+                    else
+                    {
+                        if (COLOR_ERR)
+                            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " invalid value " ENCLOSE(WHITE_FG, "'%s'") " for '--emit', expected one of none, ast-text, ast-json, tokens, hrast\n", val);
+                        else
+                            std::fprintf(stderr, "horizon: error: invalid value '%s' for '--emit', expected one of none, ast-text, ast-json, tokens, hrast\n", val);
+                        return nullptr;
+                    }
+                }
+                else if (std::strcmp(arg, "--hash-cons") == 0)
+                    opts->M_hash_cons = true;
+                else if (std::strncmp(arg, "--alloc=", 8) == 0)
+                {
+                    const char *val = arg + 8;
+                    if (std::strcmp(val, "malloc") == 0)
+                        opts->M_alloc = alloc_type::ALLOC_MALLOC;
+                    else if (std::strcmp(val, "arena") == 0)
+                        opts->M_alloc = alloc_type::ALLOC_ARENA;
+                    else if (std::strcmp(val, "pool") == 0)
+                        opts->M_alloc = alloc_type::ALLOC_POOL;
+                    else
+                    {
+                        if (COLOR_ERR)
+                            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " invalid value " ENCLOSE(WHITE_FG, "'%s'") " for '--alloc', expected one of malloc, arena, pool\n", val);
+                        else
+                            std::fprintf(stderr, "horizon: error: invalid value '%s' for '--alloc', expected one of malloc, arena, pool\n", val);
+                        return nullptr;
+                    }
+                }
+                else if (std::strcmp(arg, "--alloc-stats") == 0)
+                    opts->M_alloc_stats = true;
+                else if (std::strcmp(arg, "--time-report") == 0)
+                    opts->M_time_report = true;
+                else if (std::strcmp(arg, "--stats") == 0)
+                    opts->M_stats = stats_format::STATS_TABLE;
+                else if (std::strncmp(arg, "--stats=", 8) == 0)
+                {
+                    const char *val = arg + 8;
+                    if (std::strcmp(val, "table") == 0)
+                        opts->M_stats = stats_format::STATS_TABLE;
+                    else if (std::strcmp(val, "json") == 0)
+                        opts->M_stats = stats_format::STATS_JSON;
+                    else
+                    {
+                        if (COLOR_ERR)
+                            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " invalid value " ENCLOSE(WHITE_FG, "'%s'") " for '--stats', expected one of table, json\n", val);
+                        else
+                            std::fprintf(stderr, "horizon: error: invalid value '%s' for '--stats', expected one of table, json\n", val);
+                        return nullptr;
+                    }
+                }
+                else if (std::strncmp(arg, "--trace=", 8) == 0)
+                {
+                    if (!arg[8])
+                    {
+                        if (COLOR_ERR)
+                            std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " missing path for '--trace'\n");
+                        else
+                            std::fprintf(stderr, "horizon: error: missing path for '--trace'\n");
+                        return nullptr;
+                    }
+                    opts->M_trace = horizon_deps::string(arg + 8);
+                }
+                else if (std::strncmp(arg, "--jobs=", 7) == 0)
+                {
+                    if (!parse_jobs(arg + 7, opts->M_jobs))
+                        return nullptr;
+                }
+                else if (std::strncmp(arg, "-j", 2) == 0)
+                {
+                    const char *val = arg + 2;
+                    if (!*val)
+                    {
+                        if (i + 1 == args.length())
+                        {
+                            if (COLOR_ERR)
+                                std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " missing value for '-j'\n");
+                            else
+                                std::fprintf(stderr, "horizon: error: missing value for '-j'\n");
+                            return nullptr;
+                        }
+                        val = args[++i].c_str();
+                    }
+                    if (!parse_jobs(val, opts->M_jobs))
+                        return nullptr;
+                }
+                else if (arg[0] == '-' && arg[1] == '-')
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " unrecognized option " ENCLOSE(WHITE_FG, "'%s'") "\n", arg);
+                    else
+                        std::fprintf(stderr, "horizon: error: unrecognized option '%s'\n", arg);
+                    return nullptr;
+                }
+                else
+                    opts->M_files.add(std::move(args[i]));
+            }
+            if (opts->M_server == server_mode::SERVER_LISTEN)
+            {
+                // the files come with the command lines of the clients
+                if (!opts->M_files.is_empty())
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " '--server' takes no files, compile them with '--client'\n");
+                    else
+                        std::fprintf(stderr, "horizon: error: '--server' takes no files, compile them with '--client'\n");
+                    return nullptr;
+                }
+                return opts;
+            }
+            if (opts->M_server == server_mode::SERVER_CLIENT)
+                opts->M_args = std::move(forward);
+            if (opts->M_files.is_empty())
+            {
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " no file given\n");
+                else
+                    std::fprintf(stderr, "horizon: error: no file given\n");
+                return nullptr;
+            }
+            return opts;
+        }
+
+        horizon_deps::allocator &phase_allocator::backing(const alloc_type &type)
+        {
+            if (type == alloc_type::ALLOC_ARENA)
+                return this->M_arena;
+            if (type == alloc_type::ALLOC_POOL)
+                return this->M_pool;
+            return horizon_deps::malloc_allocator::instance();
+        }
+
+        phase_allocator::phase_allocator(const char *name, const alloc_type &type, const bool &count)
+            : M_name(name), M_arena(), M_pool(), M_counter(this->backing(type)), M_type(type), M_count(count) {}
+
+        horizon_deps::allocator &phase_allocator::get()
+        {
+            if (this->M_count)
+                return this->M_counter;
+            return this->backing(this->M_type);
+        }
+
+        void phase_allocator::print_stats_header()
+        {
+            if (COLOR_ERR)
+                std::fprintf(stderr, ENCLOSE(WHITE_FG, "%-8s %12s %12s %12s %16s %16s") "\n", "phase", "allocs", "reallocs", "frees", "bytes", "peak bytes");
+            else
+                std::fprintf(stderr, "%-8s %12s %12s %12s %16s %16s\n", "phase", "allocs", "reallocs", "frees", "bytes", "peak bytes");
+        }
+
+        const char *phase_allocator::name() const
+        {
+            return this->M_name;
+        }
+
+        const horizon_deps::allocator_stats &phase_allocator::stats() const
+        {
+            return this->M_counter.stats();
+        }
+
+        void phase_allocator::print_stats(const char *name, const horizon_deps::allocator_stats &stats)
+        {
+            std::fprintf(stderr, "%-8s %12zu %12zu %12zu %16zu %16zu\n", name, stats.M_allocs, stats.M_reallocs, stats.M_frees, stats.M_bytes, stats.M_peak);
+        }
+
+        namespace
+        {
+            thread_local phase_times *current_times = nullptr;
+
+            const char *const PHASE_NAMES[static_cast<std::size_t>(phase::PHASE_COUNT)] = {"load_file", "lex", "bracket check", "parse", "emit"};
+        }
+
+        phase_times &phase_times::operator+=(const phase_times &other)
+        {
+            for (std::size_t i = 0; i < static_cast<std::size_t>(phase::PHASE_COUNT); i++)
+            {
+                this->M_wall[i] += other.M_wall[i];
+                this->M_cpu[i] += other.M_cpu[i];
+            }
+            this->M_bytes += other.M_bytes;
+            this->M_tokens += other.M_tokens;
+            return *this;
+        }
+
+        void phase_times::print(const char *title) const
+        {
+            double wall = 0, cpu = 0;
+            for (std::size_t i = 0; i < static_cast<std::size_t>(phase::PHASE_COUNT); i++)
+            {
+                wall += this->M_wall[i];
+                cpu += this->M_cpu[i];
+            }
+            double mb = static_cast<double>(this->M_bytes) / (1024.0 * 1024.0);
+            if (COLOR_ERR)
+                std::fprintf(stderr, ENCLOSE(WHITE_FG, "%s") " (%.2f MB, %zu tokens)\n" ENCLOSE(WHITE_FG, "%-14s %12s %12s %8s %12s %14s") "\n", title, mb, this->M_tokens, "phase", "wall (s)", "cpu (s)", "%", "MB/s", "tokens/s");
+            else
+                std::fprintf(stderr, "%s (%.2f MB, %zu tokens)\n%-14s %12s %12s %8s %12s %14s\n", title, mb, this->M_tokens, "phase", "wall (s)", "cpu (s)", "%", "MB/s", "tokens/s");
+            for (std::size_t i = 0; i <= static_cast<std::size_t>(phase::PHASE_COUNT); i++)
+            {
+                bool is_total = (i == static_cast<std::size_t>(phase::PHASE_COUNT));
+                double w = (is_total ? wall : this->M_wall[i]);
+                double c = (is_total ? cpu : this->M_cpu[i]);
+                double percent = (wall > 0 ? 100.0 * w / wall : 0);
+                double mb_s = (w > 0 ? mb / w : 0);
+                double tokens_s = (w > 0 ? static_cast<double>(this->M_tokens) / w : 0);
+                std::fprintf(stderr, "%-14s %12.6f %12.6f %7.1f%% %12.2f %14.0f\n", (is_total ? "total" : PHASE_NAMES[i]), w, c, percent, mb_s, tokens_s);
+            }
+        }
+
+        timing_scope::timing_scope(phase_times *times)
+            : M_prev(current_times)
+        {
+            current_times = times;
+        }
+
+        timing_scope::~timing_scope()
+        {
+            current_times = this->M_prev;
+        }
+
+        scope_timer::scope_timer(const phase &p, const char *detail, const std::size_t &detail_len)
+            : M_trace(PHASE_NAMES[static_cast<std::size_t>(p)], detail, detail_len), M_times(current_times), M_phase(p), M_wall(), M_cpu(0)
+        {
+            if (!this->M_times)
+                return;
+            this->M_wall = std::chrono::steady_clock::now();
+            this->M_cpu = thread_cpu_seconds();
+        }
+
+        scope_timer::~scope_timer()
+        {
+            if (!this->M_times)
+                return;
+            std::size_t i = static_cast<std::size_t>(this->M_phase);
+            this->M_times->M_wall[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - this->M_wall).count();
+            this->M_times->M_cpu[i] += thread_cpu_seconds() - this->M_cpu;
+        }
+
+        double thread_cpu_seconds()
+        {
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+            FILETIME created, exited, kernel, user;
+            if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user))
+                return 0;
+            // 100 ns units
+            return static_cast<double>((static_cast<unsigned long long>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime) + (static_cast<unsigned long long>(user.dwHighDateTime) << 32 | user.dwLowDateTime)) * 1e-7;
+#else
+            struct timespec ts;
+            if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+                return 0;
+            return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+        }
+
+        namespace
+        {
+            struct trace_event
+            {
+                std::uint64_t M_ns; // since `start_trace`
+                const char *M_name;
+                std::size_t M_detail, M_detail_len; // in the thread's `M_chars`
+                char M_phase;                       // 'B' or 'E'
+            };
+
+            // written only by its own thread while recording, read by `finish_trace` after every thread is done
+            struct trace_thread
+            {
+                trace_event *M_events;
+                std::size_t M_len, M_cap;
+                char *M_chars;
+                std::size_t M_chars_len, M_chars_cap;
+                std::size_t M_tid;
+                trace_thread *M_next;
+            };
+
+            std::atomic<bool> tracing(false);
+            std::atomic<std::size_t> trace_generation(0);
+            std::atomic<trace_thread *> trace_threads(nullptr);
+            std::atomic<std::size_t> trace_thread_count(0);
+            std::chrono::steady_clock::time_point trace_start;
+            // `finish_trace` frees the buffers of every thread, so a thread checks the generation it recorded in before it
+            // touches its old buffer again
+            thread_local trace_thread *this_thread_trace = nullptr;
+            thread_local std::size_t this_thread_trace_generation = static_cast<std::size_t>(-1);
+
+            trace_thread *get_trace_thread()
+            {
+                std::size_t generation = trace_generation.load(std::memory_order_relaxed);
+                if (this_thread_trace_generation == generation)
+                    return this_thread_trace;
+                // the buffers live outside of every horizon_deps::allocator, a phase's arena would not outlive them
+                trace_thread *t = static_cast<trace_thread *>(std::calloc(1, sizeof(trace_thread)));
+                exit_heap_fail(t, "horizon::horizon_misc::trace_scope");
+                t->M_tid = trace_thread_count.fetch_add(1, std::memory_order_relaxed);
+                t->M_next = trace_threads.load(std::memory_order_relaxed);
+                while (!trace_threads.compare_exchange_weak(t->M_next, t, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+                this_thread_trace = t;
+                this_thread_trace_generation = generation;
+                return t;
+            }
+
+            void record(const char &phase, const char *name, const char *detail, const std::size_t &detail_len)
+            {
+                trace_thread *t = get_trace_thread();
+                if (t->M_len == t->M_cap)
+                {
+                    t->M_cap = (t->M_cap ? t->M_cap * 2 : 1024);
+                    t->M_events = static_cast<trace_event *>(std::realloc(static_cast<void *>(t->M_events), t->M_cap * sizeof(trace_event)));
+                    exit_heap_fail(t->M_events, "horizon::horizon_misc::trace_scope");
+                }
+                trace_event &e = t->M_events[t->M_len++];
+                e.M_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start).count());
+                e.M_name = name;
+                e.M_phase = phase;
+                e.M_detail = e.M_detail_len = 0;
+                if (detail && detail_len)
+                {
+                    if (t->M_chars_len + detail_len > t->M_chars_cap)
+                    {
+                        t->M_chars_cap = (t->M_chars_cap * 2 > t->M_chars_len + detail_len ? t->M_chars_cap * 2 : t->M_chars_len + detail_len + 4096);
+                        t->M_chars = static_cast<char *>(std::realloc(t->M_chars, t->M_chars_cap));
+                        exit_heap_fail(t->M_chars, "horizon::horizon_misc::trace_scope");
+                    }
+                    std::memcpy(t->M_chars + t->M_chars_len, detail, detail_len);
+                    e.M_detail = t->M_chars_len;
+                    e.M_detail_len = detail_len;
+                    t->M_chars_len += detail_len;
+                }
+            }
+        }
+
+        void start_trace()
+        {
+            trace_start = std::chrono::steady_clock::now();
+            tracing.store(true, std::memory_order_release);
+        }
+
+        bool is_tracing()
+        {
+            return tracing.load(std::memory_order_relaxed);
+        }
+
+        bool finish_trace(const char *loc)
+        {
+            tracing.store(false, std::memory_order_relaxed);
+            trace_thread *threads = trace_threads.exchange(nullptr, std::memory_order_acquire);
+            trace_generation.fetch_add(1, std::memory_order_relaxed);
+            trace_thread_count.store(0, std::memory_order_relaxed);
+
+            out_buffer out(out_buffer::IN_MEMORY, false);
+            out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+            bool first = true;
+            for (trace_thread *t = threads; t; t = t->M_next)
+            {
+                out.append(first ? "" : ",").append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":").append_uint(t->M_tid);
+                out.append(",\"args\":{\"name\":\"thread ").append_uint(t->M_tid).append("\"}}");
+                first = false;
+                for (std::size_t i = 0; i < t->M_len; i++)
+                {
+                    const trace_event &e = t->M_events[i];
+                    char ts[32];
+                    int ts_len = std::snprintf(ts, sizeof(ts), "%.3f", static_cast<double>(e.M_ns) / 1000.0);
+                    out.append(",{\"name\":").append_json_string(e.M_name, std::strlen(e.M_name));
+                    out.append(",\"cat\":\"horizon\",\"ph\":\"").append(e.M_phase).append("\",\"ts\":").append(ts, static_cast<std::size_t>(ts_len));
+                    out.append(",\"pid\":1,\"tid\":").append_uint(t->M_tid);
+                    if (e.M_detail_len)
+                        out.append(",\"args\":{\"detail\":").append_json_string(t->M_chars + e.M_detail, e.M_detail_len).append('}');
+                    out.append('}');
+                }
+            }
+            out.append("]}\n");
+
+            while (threads)
+            {
+                trace_thread *next = threads->M_next;
+                std::free(static_cast<void *>(threads->M_events));
+                std::free(threads->M_chars);
+                std::free(threads);
+                threads = next;
+            }
+
+            std::FILE *fptr = std::fopen(loc, "wb");
+            if (!fptr || std::fwrite(out.raw(), sizeof(char), out.length(), fptr) != out.length())
+            {
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for writing: %s\n", loc, std::strerror(errno));
+                else
+                    std::fprintf(stderr, "horizon: error[E1]: '%s' cannot be opened for writing: %s\n", loc, std::strerror(errno));
+                if (fptr)
+                    std::fclose(fptr);
+                return false;
+            }
+            std::fclose(fptr);
+            return true;
+        }
+
+        trace_scope::trace_scope(const char *name, const char *detail, const std::size_t &detail_len)
+            : M_name(nullptr)
+        {
+            if (!tracing.load(std::memory_order_acquire))
+                return;
+            this->M_name = name;
+            record('B', name, detail, detail_len);
+        }
+
+        trace_scope::~trace_scope()
+        {
+            if (this->M_name)
+                record('E', this->M_name, nullptr, 0);
+        }
+
+        namespace stats_detail
+        {
+            std::atomic<bool> counting(false);
+        }
+
+        namespace
+        {
+            std::atomic<std::size_t> stats_generation(0);
+            std::atomic<thread_stats *> stats_threads(nullptr);
+            // `finish_stats` frees the counters of every thread, see `this_thread_trace_generation`
+            thread_local thread_stats *this_thread_counters = nullptr;
+            thread_local std::size_t this_thread_counters_generation = static_cast<std::size_t>(-1);
+
+            std::size_t peak_rss()
+            {
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+                PROCESS_MEMORY_COUNTERS counters;
+                if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+                    return 0;
+                return counters.PeakWorkingSetSize;
+#else
+                struct rusage usage;
+                if (getrusage(RUSAGE_SELF, &usage) != 0)
+                    return 0;
+#if defined __APPLE__
+                return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+                return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // KiB
+#endif
+#endif
+            }
+
+            void add_ast_nodes(thread_stats &to, const char *cls, const std::uint64_t &n)
+            {
+                // the same literal may have a different address in every translation unit
+                std::size_t i = 0;
+                for (; i < thread_stats::AST_CLASSES && to.M_ast_names[i]; i++)
+                    if (to.M_ast_names[i] == cls || std::strcmp(to.M_ast_names[i], cls) == 0)
+                        break;
+                if (i == thread_stats::AST_CLASSES)
+                    return;
+                to.M_ast_names[i] = cls;
+                to.M_ast_nodes[i] += n;
+            }
+        }
+
+        void start_stats()
+        {
+            stats_detail::counting.store(true, std::memory_order_release);
+        }
+
+        thread_stats &this_thread_stats()
+        {
+            std::size_t generation = stats_generation.load(std::memory_order_relaxed);
+            if (this_thread_counters_generation == generation)
+                return *this_thread_counters;
+            // counted from inside horizon_deps containers, so it must not be one
+            thread_stats *t = static_cast<thread_stats *>(std::calloc(1, sizeof(thread_stats)));
+            exit_heap_fail(t, "horizon::horizon_misc::thread_stats");
+            t->M_next = stats_threads.load(std::memory_order_relaxed);
+            while (!stats_threads.compare_exchange_weak(t->M_next, t, std::memory_order_release, std::memory_order_relaxed))
+                ;
+            this_thread_counters = t;
+            this_thread_counters_generation = generation;
+            return *t;
+        }
+
+        void count_ast_node(const char *cls)
+        {
+            thread_stats &s = this_thread_stats();
+            for (std::size_t i = 0; i < thread_stats::AST_CLASSES && s.M_ast_names[i]; i++)
+            {
+                if (s.M_ast_names[i] == cls)
+                {
+                    s.M_ast_nodes[i]++;
+                    return;
+                }
+            }
+            add_ast_nodes(s, cls, 1);
+        }
+
+        void finish_stats(const bool &json)
+        {
+            stats_detail::counting.store(false, std::memory_order_relaxed);
+            thread_stats *threads = stats_threads.exchange(nullptr, std::memory_order_acquire);
+            stats_generation.fetch_add(1, std::memory_order_relaxed);
+
+            thread_stats total;
+            std::memset(static_cast<void *>(&total), 0, sizeof(total));
+            while (threads)
+            {
+                for (std::size_t i = 0; i < static_cast<std::size_t>(stat_counter::STAT_COUNT); i++)
+                    total.M_counters[i] += threads->M_counters[i];
+                if (threads->M_max_probe > total.M_max_probe)
+                    total.M_max_probe = threads->M_max_probe;
+                for (std::size_t i = 0; i <= static_cast<std::size_t>(token_type::TOKEN_END_OF_FILE); i++)
+                    total.M_tokens[i] += threads->M_tokens[i];
+                for (std::size_t i = 0; i < thread_stats::AST_CLASSES && threads->M_ast_names[i]; i++)
+                    add_ast_nodes(total, threads->M_ast_names[i], threads->M_ast_nodes[i]);
+                thread_stats *next = threads->M_next;
+                std::free(threads);
+                threads = next;
+            }
+
+            const std::uint64_t *c = total.M_counters;
+            std::uint64_t lookups = c[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_LOOKUPS)];
+            std::uint64_t probes = c[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_PROBES)];
+            double mean_probe = (lookups ? static_cast<double>(probes) / static_cast<double>(lookups) : 0);
+            std::size_t rss = peak_rss();
+            if (json)
+            {
+                out_buffer out(STDERR_FILENO, false);
+                out.append("{\"tokens\":{");
+                bool first = true;
+                for (std::size_t i = 0; i <= static_cast<std::size_t>(token_type::TOKEN_END_OF_FILE); i++)
+                {
+                    if (!total.M_tokens[i])
+                        continue;
+                    out.append(first ? "\"" : ",\"").append(TOKEN_TYPE_NAMES[i]).append("\":").append_uint(total.M_tokens[i]);
+                    first = false;
+                }
+                out.append("},\"ast_nodes\":{");
+                for (std::size_t i = 0; i < thread_stats::AST_CLASSES && total.M_ast_names[i]; i++)
+                    out.append(i ? ",\"" : "\"").append(total.M_ast_names[i]).append("\":").append_uint(total.M_ast_nodes[i]);
+                out.append("},\"string\":{\"allocations\":").append_uint(c[static_cast<std::size_t>(stat_counter::STAT_STRING_ALLOCS)]);
+                out.append(",\"bytes\":").append_uint(c[static_cast<std::size_t>(stat_counter::STAT_STRING_BYTES)]);
+                out.append("},\"vector\":{\"growths\":").append_uint(c[static_cast<std::size_t>(stat_counter::STAT_VECTOR_GROWTHS)]);
+                out.append(",\"bytes\":").append_uint(c[static_cast<std::size_t>(stat_counter::STAT_VECTOR_BYTES)]);
+                out.append("},\"hashtable\":{\"rehashes\":").append_uint(c[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_REHASHES)]);
+                out.append(",\"lookups\":").append_uint(lookups).append(",\"probes\":").append_uint(probes);
+                out.append(",\"mean_probe\":").append_decimal(mean_probe, false).append(",\"max_probe\":").append_uint(total.M_max_probe);
+                out.append("},\"peak_rss\":").append_uint(rss).append("}\n");
+                return;
+            }
+
+            if (COLOR_ERR)
+                std::fprintf(stderr, ENCLOSE(WHITE_FG, "%-42s %14s") "\n", "tokens", "count");
+            else
+                std::fprintf(stderr, "%-42s %14s\n", "tokens", "count");
+            for (std::size_t i = 0; i <= static_cast<std::size_t>(token_type::TOKEN_END_OF_FILE); i++)
+                if (total.M_tokens[i])
+                    std::fprintf(stderr, "%-42s %14llu\n", TOKEN_TYPE_NAMES[i], static_cast<unsigned long long>(total.M_tokens[i]));
+            if (COLOR_ERR)
+                std::fprintf(stderr, ENCLOSE(WHITE_FG, "%-42s %14s") "\n", "ast nodes", "count");
+            else
+                std::fprintf(stderr, "%-42s %14s\n", "ast nodes", "count");
+            for (std::size_t i = 0; i < thread_stats::AST_CLASSES && total.M_ast_names[i]; i++)
+                std::fprintf(stderr, "%-42s %14llu\n", total.M_ast_names[i], static_cast<unsigned long long>(total.M_ast_nodes[i]));
+            if (COLOR_ERR)
+                std::fprintf(stderr, ENCLOSE(WHITE_FG, "%-42s %14s") "\n", "containers", "count");
+            else
+                std::fprintf(stderr, "%-42s %14s\n", "containers", "count");
+            std::fprintf(stderr, "%-42s %14llu\n", "string allocations", static_cast<unsigned long long>(c[static_cast<std::size_t>(stat_counter::STAT_STRING_ALLOCS)]));
+            std::fprintf(stderr, "%-42s %14llu\n", "string bytes", static_cast<unsigned long long>(c[static_cast<std::size_t>(stat_counter::STAT_STRING_BYTES)]));
+            std::fprintf(stderr, "%-42s %14llu\n", "vector growths", static_cast<unsigned long long>(c[static_cast<std::size_t>(stat_counter::STAT_VECTOR_GROWTHS)]));
+            std::fprintf(stderr, "%-42s %14llu\n", "vector bytes", static_cast<unsigned long long>(c[static_cast<std::size_t>(stat_counter::STAT_VECTOR_BYTES)]));
+            std::fprintf(stderr, "%-42s %14llu\n", "hashtable rehashes", static_cast<unsigned long long>(c[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_REHASHES)]));
+            std::fprintf(stderr, "%-42s %14llu\n", "hashtable lookups", static_cast<unsigned long long>(lookups));
+            std::fprintf(stderr, "%-42s %14llu\n", "hashtable probes", static_cast<unsigned long long>(probes));
+            std::fprintf(stderr, "%-42s %14.2f\n", "hashtable mean probe length", mean_probe);
+            std::fprintf(stderr, "%-42s %14llu\n", "hashtable max probe length", static_cast<unsigned long long>(total.M_max_probe));
+            std::fprintf(stderr, "%-42s %14.2f\n", "peak RSS (MB)", static_cast<double>(rss) / (1024.0 * 1024.0));
+        }
     }
 }
@@ -0,0 +1,77 @@
+/**
+ * @file options.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_OPTIONS_HH
+#define HORIZON_MISC_OPTIONS_HH
+
+#include <cstdio>
+#include <cstring>
+
+#include "../../deps/sptr/sptr.hh"
+#include "../../deps/string/string.hh"
+#include "../../deps/vector/vector.hh"
+#include "../colorize/colorize.h"
+#include "../defines/defines.h"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        enum class emit_type : unsigned char
+        {
+            EMIT_NONE,     // --emit=none (default), nothing is printed
+            EMIT_AST_TEXT, // --emit=ast-text
+            EMIT_AST_JSON, // --emit=ast-json
+            EMIT_TOKENS,   // --emit=tokens
+            EMIT_HRAST     // --emit=hrast, writes the binary AST to `<file>.hrast`
+        };
+
+        enum class alloc_type : unsigned char
+        {
+            ALLOC_MALLOC, // --alloc=malloc (default)
+            ALLOC_ARENA,  // --alloc=arena, one bump arena per phase, freed at exit in one go
+            ALLOC_POOL    // --alloc=pool, size-class free lists per phase
+        };
+
+        enum class stats_format : unsigned char
+        {
+            STATS_NONE,  // no --stats (default)
+            STATS_TABLE, // --stats or --stats=table
+            STATS_JSON   // --stats=json
+        };
+
+        enum class server_mode : unsigned char
+        {
+            SERVER_NONE,   // compile in this process (default)
+            SERVER_LISTEN, // --server[=<socket>], compile the command lines clients send, with warm caches
+            SERVER_CLIENT  // --client[=<socket>], have a server compile this command line
+        };
+
+        struct options
+        {
+            horizon_deps::vector<horizon_deps::string> M_files; // in command line order, `@file` arguments already expanded
+            std::size_t M_jobs = 0;                             // -j N / --jobs=N, 0 means one per core
+            emit_type M_emit = emit_type::EMIT_NONE;
+            bool M_hash_cons = false; // --hash-cons, share structurally identical expressions after parsing
+            alloc_type M_alloc = alloc_type::ALLOC_MALLOC;
+            bool M_alloc_stats = false; // --alloc-stats, print allocation counts of every phase to stderr
+            bool M_time_report = false; // --time-report, print wall and CPU time of every phase and file to stderr
+            horizon_deps::string M_trace; // --trace=<path>, write a Chrome trace-event profile of the run to <path>
+            stats_format M_stats = stats_format::STATS_NONE; // print token, AST node and container counters to stderr at exit
+            server_mode M_server = server_mode::SERVER_NONE;
+            horizon_deps::string M_socket;                       // of --server or --client, empty for the default one
+            horizon_deps::vector<horizon_deps::string> M_args;   // with --client, every other argument, `@file` arguments already expanded
+        };
+
+        /**
+         * @brief Parses the command line, prints the error and returns nullptr on any invalid option.
+         * `@path` is replaced by the whitespace-separated arguments in the file at `path` (quotes group, `\\` escapes)
+         */
+        [[nodiscard]] horizon_deps::sptr<options> parse_options(int argc, char **argv);
+    }
+}
+
+#endif
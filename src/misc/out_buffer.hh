@@ -0,0 +1,100 @@
+/**
+ * @file out_buffer.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_OUT_BUFFER_HH
+#define HORIZON_MISC_OUT_BUFFER_HH
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+#include <io.h>
+#ifndef STDOUT_FILENO
+#define STDOUT_FILENO 1
+#endif
+#ifndef STDERR_FILENO
+#define STDERR_FILENO 2
+#endif
+#else
+#include <unistd.h>
+#endif
+
+#include "../../deps/string/string.hh"
+#include "../defines/defines.h"
+#include "./exit_heap_fail.hh"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        /**
+         * Collects output in one large block and hands it to the OS with a single write() per flush,
+         * instead of pushing hundreds of small fragments through `std::cout`/`printf`.
+         * ANSI colors are emitted only when the buffer was created as colored (see `COLOR_OUT`).
+         * A buffer created with `IN_MEMORY` as its fd never writes, it grows instead and is read back with `raw()`/`length()`.
+         */
+        class out_buffer
+        {
+          public:
+            static constexpr int IN_MEMORY = -1;
+
+          private:
+            char *M_data;
+            std::size_t M_len, M_cap;
+            int M_fd;
+            bool M_colored;
+
+          private:
+            void write_fd(const char *data, std::size_t len) const;
+
+            /**
+             * @brief Makes room for `len` more bytes, by flushing or, in memory, by growing; false if `len` has to be written directly
+             */
+            [[nodiscard]] bool make_room(const std::size_t &len);
+
+          public:
+            out_buffer(const int &fd, const bool &colored, const std::size_t &cap = 1 << 16);
+            out_buffer(const out_buffer &) = delete;
+            out_buffer &operator=(const out_buffer &) = delete;
+
+            out_buffer &append(const char &c);
+            out_buffer &append(const char *src);
+            out_buffer &append(const char *src, const std::size_t &len);
+            out_buffer &append(const horizon_deps::string &src);
+            out_buffer &append_uint(const std::size_t &num);
+            out_buffer &append_int(const long long &num);
+
+            /**
+             * @brief `exact` prints enough digits (17) for the value to read back as the same double
+             */
+            out_buffer &append_decimal(const double &num, const bool &exact = false);
+
+            /**
+             * @brief Appends `txt` enclosed in `clr` and `RESET_COLOR`, colors are skipped if the buffer is not colored
+             */
+            out_buffer &append_colored(const char *clr, const char *txt);
+
+            /**
+             * @brief Appends `len` bytes of `src` as a double-quoted JSON string, escaping as needed
+             */
+            out_buffer &append_json_string(const char *src, const std::size_t &len);
+            out_buffer &append_json_string(const horizon_deps::string &src);
+
+            [[nodiscard]] const bool &is_colored() const;
+            [[nodiscard]] const std::size_t &length() const;
+            [[nodiscard]] const char *raw() const;
+
+            /**
+             * @brief Writes the buffered bytes with a single write() and empties the buffer, does nothing `IN_MEMORY`
+             */
+            void flush();
+            ~out_buffer();
+        };
+    }
+}
+
+#endif
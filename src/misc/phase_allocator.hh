@@ -0,0 +1,64 @@
+/**
+ * @file phase_allocator.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_PHASE_ALLOCATOR_HH
+#define HORIZON_MISC_PHASE_ALLOCATOR_HH
+
+#include <cstdio>
+
+#include "../../deps/allocator/allocator.hh"
+#include "../colorize/colorize.h"
+#include "../defines/defines.h"
+#include "./options.hh"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        /**
+         * Memory of one compiler phase (lexer, parser, ...), selected by `--alloc` and counted by `--alloc-stats`.
+         * Everything the phase allocates stays valid until this object is destroyed, so it has to outlive the phase's output.
+         */
+        class phase_allocator
+        {
+          private:
+            const char *M_name;
+            horizon_deps::arena_allocator M_arena;
+            horizon_deps::pool_allocator M_pool;
+            horizon_deps::counting_allocator M_counter;
+            alloc_type M_type;
+            bool M_count;
+
+          private:
+            [[nodiscard]] horizon_deps::allocator &backing(const alloc_type &type);
+
+          public:
+            phase_allocator(const char *name, const alloc_type &type, const bool &count);
+            phase_allocator(const phase_allocator &) = delete;
+            phase_allocator &operator=(const phase_allocator &) = delete;
+
+            [[nodiscard]] horizon_deps::allocator &get();
+            [[nodiscard]] const char *name() const;
+
+            /**
+             * @brief Prints the column names of `print_stats` to stderr
+             */
+            static void print_stats_header();
+
+            /**
+             * @brief Counts so far, all zero unless the phase was created with `count`
+             */
+            [[nodiscard]] const horizon_deps::allocator_stats &stats() const;
+
+            /**
+             * @brief Prints one row of counts for the phase `name` to stderr
+             */
+            static void print_stats(const char *name, const horizon_deps::allocator_stats &stats);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file stats.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_STATS_HH
+#define HORIZON_MISC_STATS_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../token_type/token_type.hh"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        enum class stat_counter : unsigned char
+        {
+            STAT_STRING_ALLOCS,      // heap buffers allocated or grown by horizon_deps::string
+            STAT_STRING_BYTES,       // their sizes
+            STAT_VECTOR_GROWTHS,     // horizon_deps::vector and small_vector moving into a bigger block
+            STAT_VECTOR_BYTES,       // sizes of the bigger blocks
+            STAT_HASHTABLE_REHASHES, // hashtable, flat_hashtable and concurrent_interner
+            STAT_HASHTABLE_LOOKUPS,
+            STAT_HASHTABLE_PROBES, // chain nodes, groups or slots looked at by all lookups
+            STAT_COUNT
+        };
+
+        /**
+         * Counters of one thread, only ever written by that thread. `M_ast_names` are the class names given to `count_ast_node`
+         */
+        struct thread_stats
+        {
+            static constexpr std::size_t AST_CLASSES = 32;
+
+            std::uint64_t M_counters[static_cast<std::size_t>(stat_counter::STAT_COUNT)];
+            std::uint64_t M_max_probe;
+            std::uint64_t M_tokens[static_cast<std::size_t>(token_type::TOKEN_END_OF_FILE) + 1];
+            const char *M_ast_names[AST_CLASSES];
+            std::uint64_t M_ast_nodes[AST_CLASSES];
+            thread_stats *M_next;
+        };
+
+        namespace stats_detail
+        {
+            // set by `start_stats` before any other thread exists, checked inline on hot paths
+            extern std::atomic<bool> counting;
+        }
+
+        /**
+         * @brief Starts counting (`--stats`). Every thread counts into a `thread_stats` of its own, they are merged by `finish_stats`
+         */
+        void start_stats();
+
+        /**
+         * @brief Stops counting, prints the merged counters and the peak RSS to stderr as a table or as JSON and frees them.
+         * No thread may count anymore
+         */
+        void finish_stats(const bool &json);
+
+        [[nodiscard]] inline bool is_counting()
+        {
+            return stats_detail::counting.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Counters of the calling thread, must only be called while counting
+         */
+        [[nodiscard]] thread_stats &this_thread_stats();
+
+        inline void count(const stat_counter &s, const std::uint64_t &n = 1)
+        {
+            if (is_counting())
+                this_thread_stats().M_counters[static_cast<std::size_t>(s)] += n;
+        }
+
+        /**
+         * @brief `cls` must be a string literal, the class name of the node
+         */
+        void count_ast_node(const char *cls);
+
+        /**
+         * Counts one hashtable lookup with as many probes as `step` was called, when it goes out of scope
+         */
+        class probe_counter
+        {
+          private:
+            std::uint64_t M_probes;
+
+          public:
+            inline probe_counter()
+                : M_probes(0) {}
+
+            probe_counter(const probe_counter &) = delete;
+            probe_counter &operator=(const probe_counter &) = delete;
+
+            inline void step()
+            {
+                this->M_probes++;
+            }
+
+            inline ~probe_counter()
+            {
+                if (!is_counting())
+                    return;
+                thread_stats &s = this_thread_stats();
+                s.M_counters[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_LOOKUPS)]++;
+                s.M_counters[static_cast<std::size_t>(stat_counter::STAT_HASHTABLE_PROBES)] += this->M_probes;
+                if (this->M_probes > s.M_max_probe)
+                    s.M_max_probe = this->M_probes;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file time_report.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_TIME_REPORT_HH
+#define HORIZON_MISC_TIME_REPORT_HH
+
+#include <chrono>
+#include <cstddef>
+
+#include "./trace.hh"
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        enum class phase : unsigned char
+        {
+            PHASE_LOAD,     // load_file
+            PHASE_LEX,      // scanning the tokens
+            PHASE_BRACKETS, // the bracket check at the end of lexing
+            PHASE_PARSE,    // parsing, and hash-consing with --hash-cons
+            PHASE_EMIT,     // --emit output
+            PHASE_COUNT
+        };
+
+        /**
+         * Wall and CPU seconds spent in every phase of one file (or of several, added up), and how much input they went through
+         */
+        struct phase_times
+        {
+            double M_wall[static_cast<std::size_t>(phase::PHASE_COUNT)] = {};
+            double M_cpu[static_cast<std::size_t>(phase::PHASE_COUNT)] = {};
+            std::size_t M_bytes = 0, M_tokens = 0;
+
+            phase_times &operator+=(const phase_times &other);
+
+            /**
+             * @brief Prints one block of the `--time-report` table for `title` to stderr
+             */
+            void print(const char *title) const;
+        };
+
+        /**
+         * Makes `times` the target of the calling thread's `scope_timer`s until the end of the scope; with nullptr the timers do nothing
+         */
+        class timing_scope
+        {
+          private:
+            phase_times *M_prev;
+
+          public:
+            timing_scope(phase_times *times);
+            timing_scope(const timing_scope &) = delete;
+            timing_scope &operator=(const timing_scope &) = delete;
+            ~timing_scope();
+        };
+
+        /**
+         * Adds the wall (`steady_clock`) and CPU time (of the calling thread) of its own lifetime to `phase` of the current
+         * `timing_scope`, and is a `trace_scope` named after the phase. Outside a timing scope, which is all of the time
+         * without `--time-report`, it reads no clock at all.
+         */
+        class scope_timer
+        {
+          private:
+            trace_scope M_trace;
+            phase_times *M_times;
+            phase M_phase;
+            std::chrono::steady_clock::time_point M_wall;
+            double M_cpu;
+
+          public:
+            scope_timer(const phase &p, const char *detail = nullptr, const std::size_t &detail_len = 0);
+            scope_timer(const scope_timer &) = delete;
+            scope_timer &operator=(const scope_timer &) = delete;
+            ~scope_timer();
+        };
+
+        /**
+         * @brief CPU seconds used by the calling thread so far
+         */
+        [[nodiscard]] double thread_cpu_seconds();
+    }
+}
+
+#endif
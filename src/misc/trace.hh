@@ -0,0 +1,47 @@
+/**
+ * @file trace.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_MISC_TRACE_HH
+#define HORIZON_MISC_TRACE_HH
+
+#include <cstddef>
+
+namespace horizon
+{
+    namespace horizon_misc
+    {
+        /**
+         * @brief Starts recording `trace_scope`s (`--trace`). Every thread records into a buffer of its own, no thread ever waits for another
+         */
+        void start_trace();
+
+        /**
+         * @brief Stops recording and writes everything recorded as Chrome trace-event JSON (chrome://tracing, Perfetto) to `loc`.
+         * No thread may be inside a `trace_scope` anymore. Prints the error and returns false if `loc` cannot be written
+         */
+        [[nodiscard]] bool finish_trace(const char *loc);
+
+        [[nodiscard]] bool is_tracing();
+
+        /**
+         * Records a begin event when created and an end event when destroyed, on the calling thread, if a trace is being recorded.
+         * `name` must be a string literal, `detail` (a file, a function) is copied and shows up as the event's argument
+         */
+        class trace_scope
+        {
+          private:
+            const char *M_name;
+
+          public:
+            trace_scope(const char *name, const char *detail = nullptr, const std::size_t &detail_len = 0);
+            trace_scope(const trace_scope &) = delete;
+            trace_scope &operator=(const trace_scope &) = delete;
+            ~trace_scope();
+        };
+    }
+}
+
+#endif
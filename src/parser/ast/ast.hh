@@ -7,40 +7,506 @@
 #ifndef HORIZON_PARSER_AST_AST_HH
 #define HORIZON_PARSER_AST_AST_HH
 
-#include <iostream>
+#include <cstddef>
 
 #include "../../../deps/sptr/sptr.hh"
 #include "../../../deps/string/string.hh"
 #include "../../token_type/token_type.hh"
 #include "../../../deps/vector/vector.hh"
-#include "../../../deps/pair/pair.hh"
+#include "../../../deps/vector/small_vector.hh"
+#include "../../../deps/pair/inline_pair.hh"
+#include "../../../deps/hashtable/hashtable.hh"
+#include "../../../deps/hash/hash.hh"
+#include "../../token/token.hh"
+#include "../../misc/out_buffer.hh"
+#include "../../misc/stats.hh"
+#include "./hrast.hh"
+#include "./string_table.hh"
 
 namespace horizon
 {
     namespace horizon_parser
     {
+        /**
+         * Half-open range `[M_begin, M_end)` of token indices
+         */
+        struct ast_token_range
+        {
+            std::size_t M_begin;
+            std::size_t M_end;
+        };
+
+        class ast_node;
+        class ast_hash_cons;
+
+        /**
+         * Slots of the blocks nested in a node, collected to find the smallest block enclosing an edit
+         */
+        using ast_block_slots = horizon_deps::vector<horizon_deps::sptr<ast_node> *>;
+
+        /**
+         * Short lists of a node, kept inline so that building the node does not allocate in the common case
+         */
+        using ast_arguments = horizon_deps::small_vector<horizon_deps::sptr<ast_node>, 4>;
+        using ast_type_qualifiers = horizon_deps::small_vector<token, 2>;
+        using ast_declarator = horizon_deps::inline_pair<token, horizon_deps::sptr<ast_node>>; // name, value (null if none)
+        using ast_branch = horizon_deps::inline_pair<horizon_deps::sptr<ast_node>>;             // condition, block
+        using ast_declarators = horizon_deps::small_vector<ast_declarator, 2>;
+        using ast_elif_branches = horizon_deps::small_vector<ast_branch, 2>;
+        using ast_parameter_group = horizon_deps::inline_pair<horizon_deps::sptr<ast_node>, ast_declarators>; // type, names
+
         class ast_node
         {
+          protected:
+            /**
+             * @brief `cls` is the class name of the node, counted with `--stats`
+             */
+            inline explicit ast_node(const char *cls)
+            {
+                if (horizon_misc::is_counting())
+                    horizon_misc::count_ast_node(cls);
+            }
+
           public:
+            // nodes are created with `new` all over the parser and owned by `sptr`, which frees them with `horizon_deps::destroy`
+            [[nodiscard]] static void *operator new(std::size_t size)
+            {
+                void *ptr = horizon_deps::allocate(size);
+                horizon_misc::exit_heap_fail(ptr, "horizon::horizon_parser::ast_node");
+                return ptr;
+            }
+
+            static void operator delete(void *ptr)
+            {
+                horizon_deps::deallocate(ptr);
+            }
+
             virtual ~ast_node() = default;
-            virtual void print() const = 0;
+            virtual void print(horizon_misc::out_buffer &out) const = 0;
+            virtual void print_json(horizon_misc::out_buffer &out) const = 0;
+
+            /**
+             * @brief Writes the node (children first) into `writer` and returns its offset in the `.hrast` image
+             */
+            [[nodiscard]] virtual std::uint64_t serialize(hrast_writer &writer) const = 0;
+
+            /**
+             * @brief Moves the byte offsets of every token starting at or after `from` by `delta`, used to keep reused subtrees in sync with an edited source
+             */
+            virtual void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from)
+            {
+                (void)delta;
+                (void)from;
+            }
+
+            /**
+             * @brief Adds the blocks directly nested in this node (without descending into them) to `blocks`
+             */
+            virtual void get_blocks(ast_block_slots &blocks)
+            {
+                (void)blocks;
+            }
+
+            /**
+             * @brief Token range of a block relative to the start of its enclosing block (or top-level declaration), nullptr for every other node
+             */
+            [[nodiscard]] virtual ast_token_range *get_block_range()
+            {
+                return nullptr;
+            }
+
+            /**
+             * @brief Hash of an expression built from its operator token types, operand values and the hashes of its children, 0 if the node cannot be shared
+             */
+            [[nodiscard]] virtual std::size_t structural_hash() const
+            {
+                return 0;
+            }
+
+            /**
+             * @brief Whether `other` is the same expression, token positions are ignored
+             */
+            [[nodiscard]] virtual bool is_same(const ast_node &other) const
+            {
+                (void)other;
+                return false;
+            }
+
+            /**
+             * @brief Whether identical copies of this node may be replaced by a shared node
+             */
+            [[nodiscard]] virtual bool is_shareable() const
+            {
+                return false;
+            }
+
+            /**
+             * @brief The node a shared node refers to, the node itself otherwise
+             */
+            [[nodiscard]] virtual const ast_node *canonical() const
+            {
+                return this;
+            }
+
+            /**
+             * @brief Interns every child slot of this node into `table`
+             */
+            virtual void intern_children(ast_hash_cons &table)
+            {
+                (void)table;
+            }
+        };
+
+        /**
+         * A non-owning reference to the first occurrence of an expression, the shared node stays immutable and is owned by
+         * the subtree it first appeared in
+         */
+        class ast_shared_node : public ast_node
+        {
+            const ast_node *M_node;
+
+          public:
+            inline explicit ast_shared_node(const ast_node *node)
+                : ast_node("ast_shared_node"), M_node(node) {}
+
+            inline void print(horizon_misc::out_buffer &out) const override
+            {
+                this->M_node->print(out);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                this->M_node->print_json(out);
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                return this->M_node->serialize(writer);
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                return this->M_node->structural_hash();
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                return this->M_node->is_same(other);
+            }
+
+            [[nodiscard]] inline bool is_shareable() const override
+            {
+                return true;
+            }
+
+            [[nodiscard]] inline const ast_node *canonical() const override
+            {
+                return this->M_node;
+            }
         };
 
-        template <typename T>
-        class ast_operand_node : public ast_node
+        /**
+         * Hash-consing table, deduplicates structurally identical expression subtrees into shared nodes
+         */
+        class ast_hash_cons
         {
-            T M_val;
+            horizon_deps::hashtable<std::size_t, horizon_deps::vector<const ast_node *>> M_table; // structural hash -> first occurrences
+            std::size_t M_shared_count;
 
           public:
-            inline ast_operand_node(const T &val)
-                : M_val(val) {}
+            inline ast_hash_cons()
+                : M_table(1024), M_shared_count(0) {}
+
+            ast_hash_cons(const ast_hash_cons &) = delete;
+            ast_hash_cons &operator=(const ast_hash_cons &) = delete;
 
-            inline void print() const override
+            /**
+             * @brief Interns the children of `slot` first, then replaces `slot` by a shared node if an identical expression was interned before
+             */
+            inline void intern(horizon_deps::sptr<ast_node> &slot)
             {
-                if constexpr (std::is_same<T, horizon_deps::string>::value)
-                    std::cout << PURPLE_FG << (this->M_val.c_str() == nullptr ? "(null)" : this->M_val.c_str()) << RESET_COLOR;
+                if (!slot)
+                    return;
+                slot->intern_children(*this);
+                if (!slot->is_shareable() || slot->canonical() != slot.raw())
+                    return;
+                std::size_t hash = slot->structural_hash();
+                if (hash == 0)
+                    return;
+                if (this->M_table.contains(hash))
+                {
+                    horizon_deps::vector<const ast_node *> &candidates = this->M_table.get_value(hash);
+                    for (const ast_node *i : candidates)
+                    {
+                        if (i->is_same(*slot.raw()))
+                        {
+                            slot = new ast_shared_node(i);
+                            horizon_misc::exit_heap_fail(slot.raw(), "horizon::horizon_parser::ast_hash_cons");
+                            this->M_shared_count++;
+                            return;
+                        }
+                    }
+                    candidates.add(slot.raw());
+                }
                 else
-                    std::cout << GREEN_FG << this->M_val << RESET_COLOR;
+                {
+                    horizon_deps::vector<const ast_node *> candidates;
+                    candidates.add(slot.raw());
+                    (void)this->M_table.append(std::move(hash), std::move(candidates));
+                }
+            }
+
+            [[nodiscard]] inline const std::size_t &get_shared_count() const
+            {
+                return this->M_shared_count;
+            }
+        };
+
+        inline std::size_t ast_hash_combine(const std::size_t &seed, const std::size_t &value)
+        {
+            return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+        }
+
+        inline std::size_t ast_hash_bytes(const char *str, const std::size_t &len)
+        {
+            return horizon_deps::hash_bytes(str, len);
+        }
+
+        /**
+         * @brief Keeps 0 free to mean "not shareable"
+         */
+        inline std::size_t ast_hash_finish(const std::size_t &hash)
+        {
+            return hash == 0 ? 1 : hash;
+        }
+
+        /**
+         * @brief Structural hash of a child slot, an empty slot hashes to a fixed non-zero value
+         */
+        inline std::size_t ast_child_hash(const horizon_deps::sptr<ast_node> &node)
+        {
+            return node ? node->structural_hash() : 0x51ed270b27ULL;
+        }
+
+        /**
+         * @brief Structural equality of two child slots
+         */
+        inline bool same_node(const horizon_deps::sptr<ast_node> &a, const horizon_deps::sptr<ast_node> &b)
+        {
+            if (!a || !b)
+                return !a && !b;
+            if (a->canonical() == b->canonical())
+                return true;
+            return a->structural_hash() == b->structural_hash() && a->is_same(*b.raw());
+        }
+
+        /**
+         * @brief Writes `node` as JSON, or `null` if there is no node
+         */
+        inline void print_json_node(horizon_misc::out_buffer &out, const horizon_deps::sptr<ast_node> &node)
+        {
+            if (node)
+                node->print_json(out);
+            else
+                out.append("null", 4);
+        }
+
+        /**
+         * @brief Serializes `node`, or returns 0 (no node) if there is no node
+         */
+        [[nodiscard]] inline std::uint64_t serialize_node(hrast_writer &writer, const horizon_deps::sptr<ast_node> &node)
+        {
+            if (!node)
+                return 0;
+            if (!writer.has_shared_nodes() || !node->is_shareable())
+                return node->serialize(writer);
+            const ast_node *canonical = node->canonical();
+            std::uint64_t offset = 0;
+            if (writer.find_shared(canonical, offset))
+                return offset;
+            offset = canonical->serialize(writer);
+            writer.add_shared(canonical, offset);
+            return offset;
+        }
+
+        inline void shift_token(token &tok, const std::ptrdiff_t &delta, const std::size_t &from)
+        {
+            if (tok.M_start != static_cast<std::size_t>(-1) && tok.M_start >= from)
+            {
+                tok.M_start += delta;
+                tok.M_end += delta;
+            }
+        }
+
+        inline void shift_node(horizon_deps::sptr<ast_node> &node, const std::ptrdiff_t &delta, const std::size_t &from)
+        {
+            if (node)
+                node->shift_positions(delta, from);
+        }
+
+        /**
+         * @brief Adds `node` to `blocks` if it is a block, otherwise collects the blocks nested in it
+         */
+        inline void collect_block(horizon_deps::sptr<ast_node> &node, ast_block_slots &blocks)
+        {
+            if (!node)
+                return;
+            if (node->get_block_range())
+                blocks.add(&node);
+            else
+                node->get_blocks(blocks);
+        }
+
+        enum class ast_literal_type : std::uint8_t
+        {
+            AST_LITERAL_IDENTIFIER, // also names primary types in data types
+            AST_LITERAL_INTEGER,
+            AST_LITERAL_DECIMAL,
+            AST_LITERAL_CHAR,
+            AST_LITERAL_BOOL,
+            AST_LITERAL_STRING,
+            AST_LITERAL_NULL
+        };
+
+        /**
+         * Every operand of an expression: numbers, chars and bools are stored inline, identifiers and string literals
+         * by their index into the string table
+         */
+        class ast_literal_node : public ast_node
+        {
+            union
+            {
+                long long M_integer;
+                double M_decimal;
+                char M_char;
+                bool M_bool;
+                std::uint32_t M_string;
+                std::uint64_t M_bits; // the whole payload, compared and hashed
+            };
+            ast_literal_type M_type;
+
+          public:
+            inline explicit ast_literal_node(const long long &val)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(ast_literal_type::AST_LITERAL_INTEGER) { this->M_integer = val; }
+
+            inline explicit ast_literal_node(const double &val)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(ast_literal_type::AST_LITERAL_DECIMAL) { this->M_decimal = val; }
+
+            inline explicit ast_literal_node(const char &val)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(ast_literal_type::AST_LITERAL_CHAR) { this->M_char = val; }
+
+            inline explicit ast_literal_node(const bool &val)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(ast_literal_type::AST_LITERAL_BOOL) { this->M_bool = val; }
+
+            inline explicit ast_literal_node(std::nullptr_t)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(ast_literal_type::AST_LITERAL_NULL) {}
+
+            /**
+             * @brief Identifier or string literal, `str` is interned into the string table
+             */
+            inline ast_literal_node(const ast_literal_type &type, const horizon_deps::string &str)
+                : ast_node("ast_literal_node"), M_bits(0), M_type(type) { this->M_string = string_table::instance().intern(str.c_str(), str.length()); }
+
+            [[nodiscard]] inline const ast_literal_type &get_type() const
+            {
+                return this->M_type;
+            }
+
+            [[nodiscard]] inline const char *get_string() const
+            {
+                return string_table::instance().get(this->M_string);
+            }
+
+            inline void print(horizon_misc::out_buffer &out) const override
+            {
+                switch (this->M_type)
+                {
+                case ast_literal_type::AST_LITERAL_IDENTIFIER:
+                    out.append_colored(PURPLE_FG, (this->get_string() == nullptr ? "(null)" : this->get_string()));
+                    return;
+                case ast_literal_type::AST_LITERAL_STRING:
+                    out.append_colored(GREEN_FG, (this->get_string() == nullptr ? "(null)" : this->get_string()));
+                    return;
+                case ast_literal_type::AST_LITERAL_NULL:
+                    out.append_colored(GREEN_FG, "0");
+                    return;
+                default:
+                    break;
+                }
+                if (out.is_colored())
+                    out.append(GREEN_FG);
+                if (this->M_type == ast_literal_type::AST_LITERAL_BOOL)
+                    out.append(this->M_bool ? '1' : '0');
+                else if (this->M_type == ast_literal_type::AST_LITERAL_CHAR)
+                    out.append(this->M_char);
+                else if (this->M_type == ast_literal_type::AST_LITERAL_DECIMAL)
+                    out.append_decimal(this->M_decimal);
+                else
+                    out.append_int(this->M_integer);
+                if (out.is_colored())
+                    out.append(RESET_COLOR);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                switch (this->M_type)
+                {
+                case ast_literal_type::AST_LITERAL_IDENTIFIER:
+                    out.append("{\"node\":\"identifier\",\"name\":").append_json_string(this->get_string(), string_table::instance().length(this->M_string)).append('}');
+                    break;
+                case ast_literal_type::AST_LITERAL_STRING:
+                    out.append("{\"node\":\"literal\",\"type\":\"string\",\"value\":").append_json_string(this->get_string(), string_table::instance().length(this->M_string)).append('}');
+                    break;
+                case ast_literal_type::AST_LITERAL_NULL:
+                    out.append("{\"node\":\"literal\",\"type\":\"null\",\"value\":null}");
+                    break;
+                case ast_literal_type::AST_LITERAL_BOOL:
+                    out.append("{\"node\":\"literal\",\"type\":\"bool\",\"value\":").append(this->M_bool ? "true" : "false").append('}');
+                    break;
+                case ast_literal_type::AST_LITERAL_CHAR:
+                    out.append("{\"node\":\"literal\",\"type\":\"char\",\"value\":").append_json_string(&this->M_char, 1).append('}');
+                    break;
+                case ast_literal_type::AST_LITERAL_DECIMAL:
+                    out.append("{\"node\":\"literal\",\"type\":\"decimal\",\"value\":").append_decimal(this->M_decimal, true).append('}');
+                    break;
+                case ast_literal_type::AST_LITERAL_INTEGER:
+                    out.append("{\"node\":\"literal\",\"type\":\"integer\",\"value\":").append_int(this->M_integer).append('}');
+                    break;
+                }
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                switch (this->M_type)
+                {
+                case ast_literal_type::AST_LITERAL_IDENTIFIER:
+                    return writer.write_node(hrast_kind::HRAST_IDENTIFIER, this->get_string(), string_table::instance().length(this->M_string), 0, 0, nullptr, 0);
+                case ast_literal_type::AST_LITERAL_STRING:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, this->get_string(), string_table::instance().length(this->M_string), static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_STRING), 0, nullptr, 0);
+                case ast_literal_type::AST_LITERAL_NULL:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, nullptr, 0, static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_NULL), 0, nullptr, 0);
+                case ast_literal_type::AST_LITERAL_BOOL:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, nullptr, 0, static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_BOOL), this->M_bool, nullptr, 0);
+                case ast_literal_type::AST_LITERAL_CHAR:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, nullptr, 0, static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_CHAR), static_cast<unsigned char>(this->M_char), nullptr, 0);
+                case ast_literal_type::AST_LITERAL_DECIMAL:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, nullptr, 0, static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_DECIMAL), this->M_bits, nullptr, 0);
+                case ast_literal_type::AST_LITERAL_INTEGER:
+                default:
+                    return writer.write_node(hrast_kind::HRAST_LITERAL, nullptr, 0, static_cast<std::uint16_t>(hrast_literal_type::HRAST_LITERAL_INTEGER), this->M_bits, nullptr, 0);
+                }
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                // interned strings compare by index, so the payload bits identify every literal
+                return ast_hash_finish(ast_hash_combine(static_cast<std::size_t>(this->M_type), this->M_bits));
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                const ast_literal_node *literal = dynamic_cast<const ast_literal_node *>(other.canonical());
+                return literal && literal->M_type == this->M_type && literal->M_bits == this->M_bits;
             }
         };
 
@@ -49,27 +515,76 @@ namespace horizon
             horizon_deps::sptr<ast_node> M_operand;
             token M_operator;
             bool M_is_prefix;
+            mutable std::size_t M_hash = 0;
 
           public:
             inline ast_unary_operation_node(horizon_deps::sptr<ast_node> &&operand, token &&opr, bool prefix)
-                : M_operand(std::move(operand)), M_operator(std::move(opr)), M_is_prefix(prefix) {}
+                : ast_node("ast_unary_operation_node"), M_operand(std::move(operand)), M_operator(std::move(opr)), M_is_prefix(prefix) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                printf("( ");
+                out.append("( ", 2);
                 if (this->M_is_prefix)
                 {
-                    std::cout << BLUE_FG << this->M_operator.M_lexeme.c_str() << RESET_COLOR " ";
+                    out.append_colored(BLUE_FG, this->M_operator.M_lexeme.c_str()).append(' ');
                     if (this->M_operand)
-                        this->M_operand->print();
+                        this->M_operand->print(out);
                 }
                 else
                 {
                     if (this->M_operand)
-                        this->M_operand->print();
-                    std::cout << " " << BLUE_FG << this->M_operator.M_lexeme.c_str() << RESET_COLOR;
+                        this->M_operand->print(out);
+                    out.append(' ').append_colored(BLUE_FG, this->M_operator.M_lexeme.c_str());
                 }
-                printf(" )");
+                out.append(" )", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"unary_operation\",\"operator\":").append_json_string(this->M_operator.M_lexeme);
+                out.append(",\"prefix\":").append(this->M_is_prefix ? "true" : "false");
+                out.append(",\"operand\":");
+                print_json_node(out, this->M_operand);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[1] = {serialize_node(writer, this->M_operand)};
+                return writer.write_node(hrast_kind::HRAST_UNARY_OPERATION, &this->M_operator, (this->M_is_prefix ? 1 : 0), children, 1);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_token(this->M_operator, delta, from);
+                shift_node(this->M_operand, delta, from);
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                if (this->M_hash == 0)
+                {
+                    std::size_t operand = ast_child_hash(this->M_operand);
+                    if (operand != 0)
+                        this->M_hash = ast_hash_finish(ast_hash_combine(ast_hash_combine(ast_hash_combine(static_cast<std::size_t>(hrast_kind::HRAST_UNARY_OPERATION), static_cast<std::size_t>(this->M_operator.M_type)), this->M_is_prefix), operand));
+                }
+                return this->M_hash;
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                const ast_unary_operation_node *node = dynamic_cast<const ast_unary_operation_node *>(other.canonical());
+                return node && node->M_operator.M_type == this->M_operator.M_type && node->M_is_prefix == this->M_is_prefix && same_node(this->M_operand, node->M_operand);
+            }
+
+            [[nodiscard]] inline bool is_shareable() const override
+            {
+                return true;
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_operand);
             }
         };
 
@@ -78,41 +593,124 @@ namespace horizon
             horizon_deps::sptr<ast_node> M_left;
             token M_operator;
             horizon_deps::sptr<ast_node> M_right;
+            mutable std::size_t M_hash = 0;
 
           public:
             inline ast_binary_operation_node(horizon_deps::sptr<ast_node> &&left, token &&opr, horizon_deps::sptr<ast_node> &&right)
-                : M_left(std::move(left)), M_operator(std::move(opr)), M_right(std::move(right)) {}
+                : ast_node("ast_binary_operation_node"), M_left(std::move(left)), M_operator(std::move(opr)), M_right(std::move(right)) {}
+
+            inline void print(horizon_misc::out_buffer &out) const override
+            {
+                out.append("( ", 2);
+                this->M_left->print(out);
+                out.append(' ').append_colored(BLUE_FG, this->M_operator.M_lexeme.c_str()).append(' ');
+                this->M_right->print(out);
+                out.append(" )", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"binary_operation\",\"operator\":").append_json_string(this->M_operator.M_lexeme);
+                out.append(",\"left\":");
+                print_json_node(out, this->M_left);
+                out.append(",\"right\":");
+                print_json_node(out, this->M_right);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[2] = {serialize_node(writer, this->M_left), 0};
+                children[1] = serialize_node(writer, this->M_right);
+                return writer.write_node(hrast_kind::HRAST_BINARY_OPERATION, &this->M_operator, 0, children, 2);
+            }
 
-            inline void print() const override
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
             {
-                printf("( ");
-                this->M_left->print();
-                std::cout << " " << BLUE_FG << this->M_operator.M_lexeme.c_str() << RESET_COLOR " ";
-                this->M_right->print();
-                printf(" )");
+                shift_node(this->M_left, delta, from);
+                shift_token(this->M_operator, delta, from);
+                shift_node(this->M_right, delta, from);
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                if (this->M_hash == 0)
+                {
+                    std::size_t left = ast_child_hash(this->M_left), right = ast_child_hash(this->M_right);
+                    if (left != 0 && right != 0)
+                        this->M_hash = ast_hash_finish(ast_hash_combine(ast_hash_combine(ast_hash_combine(static_cast<std::size_t>(hrast_kind::HRAST_BINARY_OPERATION), static_cast<std::size_t>(this->M_operator.M_type)), left), right));
+                }
+                return this->M_hash;
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                const ast_binary_operation_node *node = dynamic_cast<const ast_binary_operation_node *>(other.canonical());
+                return node && node->M_operator.M_type == this->M_operator.M_type && same_node(this->M_left, node->M_left) && same_node(this->M_right, node->M_right);
+            }
+
+            [[nodiscard]] inline bool is_shareable() const override
+            {
+                return true;
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_left);
+                table.intern(this->M_right);
             }
         };
 
         class ast_data_type_node : public ast_node
         {
-            horizon_deps::vector<token> M_type_qualifiers;
+            ast_type_qualifiers M_type_qualifiers;
             horizon_deps::sptr<ast_node> M_type;
 
           public:
-            inline ast_data_type_node(horizon_deps::vector<token> &&type_qual, horizon_deps::sptr<ast_node> &&type_)
-                : M_type_qualifiers(std::move(type_qual)), M_type(std::move(type_)) {}
+            inline ast_data_type_node(ast_type_qualifiers &&type_qual, horizon_deps::sptr<ast_node> &&type_)
+                : ast_node("ast_data_type_node"), M_type_qualifiers(std::move(type_qual)), M_type(std::move(type_)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
                 if (!this->M_type_qualifiers.is_empty())
                 {
                     for (const token &i : this->M_type_qualifiers)
                     {
-                        std::cout << RED_FG << i.M_lexeme.c_str() << RESET_COLOR " ";
+                        out.append_colored(RED_FG, i.M_lexeme.c_str()).append(' ');
                     }
                 }
                 if (this->M_type)
-                    this->M_type->print();
+                    this->M_type->print(out);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"data_type\",\"qualifiers\":[");
+                for (std::size_t i = 0; i < this->M_type_qualifiers.length(); i++)
+                {
+                    if (i > 0)
+                        out.append(',');
+                    out.append_json_string(this->M_type_qualifiers[i].M_lexeme);
+                }
+                out.append("],\"type\":");
+                print_json_node(out, this->M_type);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_type_qualifiers.length() + 1);
+                children.add(serialize_node(writer, this->M_type));
+                for (const token &i : this->M_type_qualifiers)
+                    children.add(writer.write_node(hrast_kind::HRAST_TOKEN, &i, 0, nullptr, 0));
+                return writer.write_node(hrast_kind::HRAST_DATA_TYPE, nullptr, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                for (token &i : this->M_type_qualifiers)
+                    shift_token(i, delta, from);
+                shift_node(this->M_type, delta, from);
             }
         };
 
@@ -121,137 +719,428 @@ namespace horizon
             horizon_deps::sptr<ast_node> M_condition;
             horizon_deps::sptr<ast_node> M_val_if_true;
             horizon_deps::sptr<ast_node> M_val_if_false;
+            mutable std::size_t M_hash = 0;
 
           public:
             inline ast_ternary_operator_node(horizon_deps::sptr<ast_node> &&cond, horizon_deps::sptr<ast_node> &&if_true, horizon_deps::sptr<ast_node> &&if_false)
-                : M_condition(std::move(cond)), M_val_if_true(std::move(if_true)), M_val_if_false(std::move(if_false)) {}
+                : ast_node("ast_ternary_operator_node"), M_condition(std::move(cond)), M_val_if_true(std::move(if_true)), M_val_if_false(std::move(if_false)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "TERNARY: CONDITION: ";
+                out.append("TERNARY: CONDITION: ");
                 if (this->M_condition)
-                    this->M_condition->print();
-                std::cout << " VALUE_IF_TRUE: ";
+                    this->M_condition->print(out);
+                out.append(" VALUE_IF_TRUE: ");
                 if (this->M_val_if_true)
-                    this->M_val_if_true->print();
-                std::cout << " VALUE_IF_FALSE: ";
+                    this->M_val_if_true->print(out);
+                out.append(" VALUE_IF_FALSE: ");
                 if (this->M_val_if_false)
-                    this->M_val_if_false->print();
-                std::cout << "\n";
+                    this->M_val_if_false->print(out);
+                out.append('\n');
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"ternary_operator\",\"condition\":");
+                print_json_node(out, this->M_condition);
+                out.append(",\"value_if_true\":");
+                print_json_node(out, this->M_val_if_true);
+                out.append(",\"value_if_false\":");
+                print_json_node(out, this->M_val_if_false);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[3] = {serialize_node(writer, this->M_condition), 0, 0};
+                children[1] = serialize_node(writer, this->M_val_if_true);
+                children[2] = serialize_node(writer, this->M_val_if_false);
+                return writer.write_node(hrast_kind::HRAST_TERNARY_OPERATOR, nullptr, 0, children, 3);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_condition, delta, from);
+                shift_node(this->M_val_if_true, delta, from);
+                shift_node(this->M_val_if_false, delta, from);
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                if (this->M_hash == 0)
+                {
+                    std::size_t cond = ast_child_hash(this->M_condition), if_true = ast_child_hash(this->M_val_if_true), if_false = ast_child_hash(this->M_val_if_false);
+                    if (cond != 0 && if_true != 0 && if_false != 0)
+                        this->M_hash = ast_hash_finish(ast_hash_combine(ast_hash_combine(ast_hash_combine(static_cast<std::size_t>(hrast_kind::HRAST_TERNARY_OPERATOR), cond), if_true), if_false));
+                }
+                return this->M_hash;
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                const ast_ternary_operator_node *node = dynamic_cast<const ast_ternary_operator_node *>(other.canonical());
+                return node && same_node(this->M_condition, node->M_condition) && same_node(this->M_val_if_true, node->M_val_if_true) && same_node(this->M_val_if_false, node->M_val_if_false);
+            }
+
+            [[nodiscard]] inline bool is_shareable() const override
+            {
+                return true;
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_condition);
+                table.intern(this->M_val_if_true);
+                table.intern(this->M_val_if_false);
             }
         };
 
         class ast_variable_declaration_node : public ast_node
         {
             horizon_deps::sptr<ast_node> M_type;
-            horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>> M_variables;
+            ast_declarators M_variables;
 
           public:
-            inline ast_variable_declaration_node(horizon_deps::sptr<ast_node> &&type, horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>> &&vars)
-                : M_type(std::move(type)), M_variables(std::move(vars)) {}
+            inline ast_variable_declaration_node(horizon_deps::sptr<ast_node> &&type, ast_declarators &&vars)
+                : ast_node("ast_variable_declaration_node"), M_type(std::move(type)), M_variables(std::move(vars)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "VAR_DECL TYPE: ";
+                out.append("VAR_DECL TYPE: ");
                 if (this->M_type)
-                    this->M_type->print();
-                std::cout << "(\n";
-                for (const horizon_deps::pair<token, horizon_deps::sptr<ast_node>> &i : this->M_variables)
+                    this->M_type->print(out);
+                out.append("(\n", 2);
+                for (const ast_declarator &i : this->M_variables)
+                {
+                    out.append("\tNAME: ").append_colored(PURPLE_FG, (i.get_first().M_lexeme.c_str() == nullptr ? "(null)" : i.get_first().M_lexeme.c_str())).append("    VALUE: ");
+                    if (i.get_second())
+                        i.get_second()->print(out);
+                    out.append('\n');
+                }
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"variable_declaration\",\"type\":");
+                print_json_node(out, this->M_type);
+                out.append(",\"variables\":[");
+                for (std::size_t i = 0; i < this->M_variables.length(); i++)
+                {
+                    if (i > 0)
+                        out.append(',');
+                    out.append("{\"name\":").append_json_string(this->M_variables[i].get_first().M_lexeme).append(",\"value\":");
+                    if (this->M_variables[i].get_second())
+                        print_json_node(out, this->M_variables[i].get_second());
+                    else
+                        out.append("null", 4);
+                    out.append('}');
+                }
+                out.append("]}");
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_variables.length() + 1);
+                children.add(serialize_node(writer, this->M_type));
+                for (const ast_declarator &i : this->M_variables)
                 {
-                    std::cout << "\tNAME: " << PURPLE_FG << (i.get_first().M_lexeme.c_str() == nullptr ? "(null)" : i.get_first().M_lexeme.c_str()) << RESET_COLOR "    VALUE: ";
-                    if (i.raw_second())
-                        i.get_second()->print();
-                    std::cout << "\n";
+                    std::uint64_t value[1] = {i.get_second() ? serialize_node(writer, i.get_second()) : 0};
+                    children.add(writer.write_node(hrast_kind::HRAST_DECLARATOR, &i.get_first(), 0, value, 1));
+                }
+                return writer.write_node(hrast_kind::HRAST_VARIABLE_DECLARATION, nullptr, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_type, delta, from);
+                for (ast_declarator &i : this->M_variables)
+                {
+                    shift_token(i.get_first(), delta, from);
+                    if (i.get_second())
+                        shift_node(i.get_second(), delta, from);
+                }
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                for (ast_declarator &i : this->M_variables)
+                {
+                    if (i.get_second())
+                        table.intern(i.get_second());
                 }
-                std::cout << ")\n";
             }
         };
 
         class ast_function_call_node : public ast_node
         {
             token M_identifier;
-            horizon_deps::vector<horizon_deps::sptr<ast_node>> M_arguments;
+            ast_arguments M_arguments;
+            mutable std::size_t M_hash = 0;
 
           public:
-            inline ast_function_call_node(token &&identifier, horizon_deps::vector<horizon_deps::sptr<ast_node>> &&args)
-                : M_identifier(std::move(identifier)), M_arguments(std::move(args)) {}
+            inline ast_function_call_node(token &&identifier, ast_arguments &&args)
+                : ast_node("ast_function_call_node"), M_identifier(std::move(identifier)), M_arguments(std::move(args)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "CALL NAME: " << PURPLE_FG << this->M_identifier.M_lexeme.c_str() << RESET_COLOR "( ";
+                out.append("CALL NAME: ").append_colored(PURPLE_FG, this->M_identifier.M_lexeme.c_str()).append("( ", 2);
                 for (std::size_t i = 0; i < this->M_arguments.length(); i++)
                 {
                     if (this->M_arguments[i])
                     {
-                        this->M_arguments[i]->print();
-                        std::cout << (i < this->M_arguments.length() - 1 ? ", " : " ");
+                        this->M_arguments[i]->print(out);
+                        out.append(i < this->M_arguments.length() - 1 ? ", " : " ");
+                    }
+                }
+                out.append(')');
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"function_call\",\"name\":").append_json_string(this->M_identifier.M_lexeme).append(",\"arguments\":[");
+                for (std::size_t i = 0; i < this->M_arguments.length(); i++)
+                {
+                    if (i > 0)
+                        out.append(',');
+                    print_json_node(out, this->M_arguments[i]);
+                }
+                out.append("]}");
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_arguments.length() + 1);
+                for (const horizon_deps::sptr<ast_node> &i : this->M_arguments)
+                    children.add(serialize_node(writer, i));
+                return writer.write_node(hrast_kind::HRAST_FUNCTION_CALL, &this->M_identifier, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_token(this->M_identifier, delta, from);
+                for (horizon_deps::sptr<ast_node> &i : this->M_arguments)
+                    shift_node(i, delta, from);
+            }
+
+            [[nodiscard]] inline std::size_t structural_hash() const override
+            {
+                if (this->M_hash == 0)
+                {
+                    std::size_t hash = ast_hash_combine(static_cast<std::size_t>(hrast_kind::HRAST_FUNCTION_CALL), ast_hash_bytes(this->M_identifier.M_lexeme.c_str(), this->M_identifier.M_lexeme.length()));
+                    for (const horizon_deps::sptr<ast_node> &i : this->M_arguments)
+                    {
+                        std::size_t arg = ast_child_hash(i);
+                        if (arg == 0)
+                            return 0;
+                        hash = ast_hash_combine(hash, arg);
                     }
+                    this->M_hash = ast_hash_finish(ast_hash_combine(hash, this->M_arguments.length()));
                 }
-                std::cout << ")";
+                return this->M_hash;
+            }
+
+            [[nodiscard]] inline bool is_same(const ast_node &other) const override
+            {
+                const ast_function_call_node *node = dynamic_cast<const ast_function_call_node *>(other.canonical());
+                if (!node || node->M_arguments.length() != this->M_arguments.length() || node->M_identifier.M_lexeme.length() != this->M_identifier.M_lexeme.length())
+                    return false;
+                if (this->M_identifier.M_lexeme.length() != 0 && std::memcmp(node->M_identifier.M_lexeme.c_str(), this->M_identifier.M_lexeme.c_str(), this->M_identifier.M_lexeme.length()) != 0)
+                    return false;
+                for (std::size_t i = 0; i < this->M_arguments.length(); i++)
+                {
+                    if (!same_node(this->M_arguments[i], node->M_arguments[i]))
+                        return false;
+                }
+                return true;
+            }
+
+            [[nodiscard]] inline bool is_shareable() const override
+            {
+                return true;
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                for (horizon_deps::sptr<ast_node> &i : this->M_arguments)
+                    table.intern(i);
             }
         };
 
         class ast_block_node : public ast_node
         {
             horizon_deps::vector<horizon_deps::sptr<ast_node>> M_nodes;
+            ast_token_range M_range;
 
           public:
-            inline ast_block_node(horizon_deps::vector<horizon_deps::sptr<ast_node>> &&nodes)
-                : M_nodes(std::move(nodes)) {}
+            inline ast_block_node(horizon_deps::vector<horizon_deps::sptr<ast_node>> &&nodes, const ast_token_range &range)
+                : ast_node("ast_block_node"), M_nodes(std::move(nodes)), M_range(range) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "BLOCK {\n";
+                out.append("BLOCK {\n");
                 for (std::size_t i = 0; i < this->M_nodes.length(); i++)
                 {
 
                     if (this->M_nodes[i])
                     {
-                        std::cout << YELLOW_FG << i << RESET_COLOR "\n";
-                        this->M_nodes[i]->print();
-                        std::cout << "\n";
+                        if (out.is_colored())
+                            out.append(YELLOW_FG);
+                        out.append_uint(i);
+                        if (out.is_colored())
+                            out.append(RESET_COLOR);
+                        out.append('\n');
+                        this->M_nodes[i]->print(out);
+                        out.append('\n');
                     }
                 }
-                std::cout << "}\n";
+                out.append("}\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"block\",\"statements\":[");
+                for (std::size_t i = 0; i < this->M_nodes.length(); i++)
+                {
+                    if (i > 0)
+                        out.append(',');
+                    print_json_node(out, this->M_nodes[i]);
+                }
+                out.append("]}");
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_nodes.length() + 1);
+                for (const horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                    children.add(serialize_node(writer, i));
+                return writer.write_node(hrast_kind::HRAST_BLOCK, nullptr, 0, 0, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                for (horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                    shift_node(i, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                for (horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                    collect_block(i, blocks);
+            }
+
+            [[nodiscard]] inline ast_token_range *get_block_range() override
+            {
+                return &this->M_range;
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                for (horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                    table.intern(i);
             }
         };
 
         class ast_if_elif_else_node : public ast_node
         {
-            horizon_deps::pair<horizon_deps::sptr<ast_node>> M_if_condition_block;
-            horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>>> M_elif_condition_block;
+            ast_branch M_if_condition_block;
+            ast_elif_branches M_elif_condition_block;
             horizon_deps::sptr<ast_node> M_else_block;
 
           public:
-            inline ast_if_elif_else_node(horizon_deps::pair<horizon_deps::sptr<ast_node>> &&if_cond_block, horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>>> &&elif_cond_block, horizon_deps::sptr<ast_node> &&else_block)
-                : M_if_condition_block(std::move(if_cond_block)), M_elif_condition_block(std::move(elif_cond_block)), M_else_block(std::move(else_block)) {}
+            inline ast_if_elif_else_node(ast_branch &&if_cond_block, ast_elif_branches &&elif_cond_block, horizon_deps::sptr<ast_node> &&else_block)
+                : ast_node("ast_if_elif_else_node"), M_if_condition_block(std::move(if_cond_block)), M_elif_condition_block(std::move(elif_cond_block)), M_else_block(std::move(else_block)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << ENCLOSE(RED_FG, "IF ");
-                if (this->M_if_condition_block)
+                out.append_colored(RED_FG, "IF ");
+                this->M_if_condition_block.get_first()->print(out);
+                out.append(' ');
+                this->M_if_condition_block.get_second()->print(out);
+
+                for (const ast_branch &i : this->M_elif_condition_block)
+                {
+                    out.append_colored(RED_FG, "ELIF ");
+                    i.get_first()->print(out);
+                    out.append(' ');
+                    i.get_second()->print(out);
+                }
+
+                if (this->M_else_block)
                 {
-                    this->M_if_condition_block.get_first()->print();
-                    std::cout << " ";
-                    this->M_if_condition_block.get_second()->print();
+                    out.append_colored(RED_FG, "ELSE ");
+                    this->M_else_block->print(out);
                 }
+            }
 
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"if_elif_else\",\"if\":{\"condition\":");
+                print_json_node(out, this->M_if_condition_block.get_first());
+                out.append(",\"block\":");
+                print_json_node(out, this->M_if_condition_block.get_second());
+                out.append('}');
+                out.append(",\"elif\":[");
                 for (std::size_t i = 0; i < this->M_elif_condition_block.length(); i++)
                 {
-                    if (this->M_elif_condition_block[i])
-                    {
-                        std::cout << ENCLOSE(RED_FG, "ELIF ");
-                        this->M_elif_condition_block[i].get_first()->print();
-                        std::cout << " ";
-                        this->M_elif_condition_block[i].get_second()->print();
-                    }
+                    if (i > 0)
+                        out.append(',');
+                    out.append("{\"condition\":");
+                    print_json_node(out, this->M_elif_condition_block[i].get_first());
+                    out.append(",\"block\":");
+                    print_json_node(out, this->M_elif_condition_block[i].get_second());
+                    out.append('}');
                 }
+                out.append("],\"else\":");
+                print_json_node(out, this->M_else_block);
+                out.append('}');
+            }
 
-                if (this->M_else_block)
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_elif_condition_block.length() + 2);
+                std::uint64_t branch[2] = {serialize_node(writer, this->M_if_condition_block.get_first()), serialize_node(writer, this->M_if_condition_block.get_second())};
+                children.add(writer.write_node(hrast_kind::HRAST_BRANCH, nullptr, 0, 0, 0, branch, 2));
+                for (const ast_branch &i : this->M_elif_condition_block)
                 {
-                    std::cout << ENCLOSE(RED_FG, "ELSE ");
-                    this->M_else_block->print();
+                    branch[0] = serialize_node(writer, i.get_first());
+                    branch[1] = serialize_node(writer, i.get_second());
+                    children.add(writer.write_node(hrast_kind::HRAST_BRANCH, nullptr, 0, 0, 0, branch, 2));
                 }
+                children.add(serialize_node(writer, this->M_else_block));
+                return writer.write_node(hrast_kind::HRAST_IF_ELIF_ELSE, nullptr, 0, 0, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_if_condition_block.get_first(), delta, from);
+                shift_node(this->M_if_condition_block.get_second(), delta, from);
+                for (ast_branch &i : this->M_elif_condition_block)
+                {
+                    shift_node(i.get_first(), delta, from);
+                    shift_node(i.get_second(), delta, from);
+                }
+                shift_node(this->M_else_block, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                collect_block(this->M_if_condition_block.get_second(), blocks);
+                for (ast_branch &i : this->M_elif_condition_block)
+                    collect_block(i.get_second(), blocks);
+                collect_block(this->M_else_block, blocks);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_if_condition_block.get_first());
+                table.intern(this->M_if_condition_block.get_second());
+                for (ast_branch &i : this->M_elif_condition_block)
+                {
+                    table.intern(i.get_first());
+                    table.intern(i.get_second());
+                }
+                table.intern(this->M_else_block);
             }
         };
 
@@ -264,29 +1153,72 @@ namespace horizon
 
           public:
             inline ast_for_loop_node(horizon_deps::sptr<ast_node> &&var_decl, horizon_deps::sptr<ast_node> &&condition, horizon_deps::sptr<ast_node> &&step, horizon_deps::sptr<ast_node> &&block)
-                : M_variable_decl(std::move(var_decl)), M_condition(std::move(condition)), M_step(std::move(step)), M_block(std::move(block)) {}
+                : ast_node("ast_for_loop_node"), M_variable_decl(std::move(var_decl)), M_condition(std::move(condition)), M_step(std::move(step)), M_block(std::move(block)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << ENCLOSE(RED_FG, "FOR LOOP ") << "(\n";
+                out.append_colored(RED_FG, "FOR LOOP ").append("(\n", 2);
                 if (this->M_variable_decl)
-                    this->M_variable_decl->print();
+                    this->M_variable_decl->print(out);
                 if (this->M_condition)
                 {
-                    std::cout << ENCLOSE(RED_FG, "CONDITION") << "\n";
-                    this->M_condition->print();
+                    out.append_colored(RED_FG, "CONDITION").append('\n');
+                    this->M_condition->print(out);
                 }
                 if (this->M_step)
                 {
-                    std::cout << ENCLOSE(RED_FG, "\nSTEP") << "\n";
-                    this->M_step->print();
+                    out.append_colored(RED_FG, "\nSTEP").append('\n');
+                    this->M_step->print(out);
                 }
                 if (this->M_block)
                 {
-                    std::cout << "\n";
-                    this->M_block->print();
+                    out.append('\n');
+                    this->M_block->print(out);
                 }
-                std::cout << ")\n";
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"for_loop\",\"variable_declaration\":");
+                print_json_node(out, this->M_variable_decl);
+                out.append(",\"condition\":");
+                print_json_node(out, this->M_condition);
+                out.append(",\"step\":");
+                print_json_node(out, this->M_step);
+                out.append(",\"block\":");
+                print_json_node(out, this->M_block);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[4] = {serialize_node(writer, this->M_variable_decl), 0, 0, 0};
+                children[1] = serialize_node(writer, this->M_condition);
+                children[2] = serialize_node(writer, this->M_step);
+                children[3] = serialize_node(writer, this->M_block);
+                return writer.write_node(hrast_kind::HRAST_FOR_LOOP, nullptr, 0, 0, 0, children, 4);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_variable_decl, delta, from);
+                shift_node(this->M_condition, delta, from);
+                shift_node(this->M_step, delta, from);
+                shift_node(this->M_block, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                collect_block(this->M_block, blocks);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_variable_decl);
+                table.intern(this->M_condition);
+                table.intern(this->M_step);
+                table.intern(this->M_block);
             }
         };
 
@@ -297,22 +1229,55 @@ namespace horizon
 
           public:
             inline ast_while_loop_node(horizon_deps::sptr<ast_node> &&condition, horizon_deps::sptr<ast_node> &&block)
-                : M_condition(std::move(condition)), M_block(std::move(block)) {}
+                : ast_node("ast_while_loop_node"), M_condition(std::move(condition)), M_block(std::move(block)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << ENCLOSE(RED_FG, "WHILE LOOP ") << "(\n";
+                out.append_colored(RED_FG, "WHILE LOOP ").append("(\n", 2);
                 if (this->M_condition)
                 {
-                    std::cout << ENCLOSE(RED_FG, "CONDITION") << "\n";
-                    this->M_condition->print();
+                    out.append_colored(RED_FG, "CONDITION").append('\n');
+                    this->M_condition->print(out);
                 }
                 if (this->M_block)
                 {
-                    std::cout << "\n";
-                    this->M_block->print();
+                    out.append('\n');
+                    this->M_block->print(out);
                 }
-                std::cout << ")\n";
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"while_loop\",\"condition\":");
+                print_json_node(out, this->M_condition);
+                out.append(",\"block\":");
+                print_json_node(out, this->M_block);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[2] = {serialize_node(writer, this->M_condition), 0};
+                children[1] = serialize_node(writer, this->M_block);
+                return writer.write_node(hrast_kind::HRAST_WHILE_LOOP, nullptr, 0, 0, 0, children, 2);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_condition, delta, from);
+                shift_node(this->M_block, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                collect_block(this->M_block, blocks);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_condition);
+                table.intern(this->M_block);
             }
         };
 
@@ -323,23 +1288,56 @@ namespace horizon
 
           public:
             inline ast_do_while_loop_node(horizon_deps::sptr<ast_node> &&block, horizon_deps::sptr<ast_node> &&condition)
-                : M_block(std::move(block)), M_condition(std::move(condition)) {}
+                : ast_node("ast_do_while_loop_node"), M_block(std::move(block)), M_condition(std::move(condition)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << ENCLOSE(RED_FG, "DO WHILE LOOP ") << "(\n";
-                std::cout << ENCLOSE(RED_FG, "DO");
+                out.append_colored(RED_FG, "DO WHILE LOOP ").append("(\n", 2);
+                out.append_colored(RED_FG, "DO");
                 if (this->M_block)
                 {
-                    std::cout << "\n";
-                    this->M_block->print();
+                    out.append('\n');
+                    this->M_block->print(out);
                 }
                 if (this->M_condition)
                 {
-                    std::cout << ENCLOSE(RED_FG, "CONDITION") << "\n";
-                    this->M_condition->print();
+                    out.append_colored(RED_FG, "CONDITION").append('\n');
+                    this->M_condition->print(out);
                 }
-                std::cout << ")\n";
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"do_while_loop\",\"block\":");
+                print_json_node(out, this->M_block);
+                out.append(",\"condition\":");
+                print_json_node(out, this->M_condition);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[2] = {serialize_node(writer, this->M_block), 0};
+                children[1] = serialize_node(writer, this->M_condition);
+                return writer.write_node(hrast_kind::HRAST_DO_WHILE_LOOP, nullptr, 0, 0, 0, children, 2);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_node(this->M_block, delta, from);
+                shift_node(this->M_condition, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                collect_block(this->M_block, blocks);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_block);
+                table.intern(this->M_condition);
             }
         };
 
@@ -350,52 +1348,148 @@ namespace horizon
 
           public:
             inline ast_jump_statement_node(token &&keyword__, horizon_deps::sptr<ast_node> &&expr)
-                : M_keyword(std::move(keyword__)), M_expression(std::move(expr)) {}
+                : ast_node("ast_jump_statement_node"), M_keyword(std::move(keyword__)), M_expression(std::move(expr)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << RED_FG << this->M_keyword.M_lexeme.c_str() << RESET_COLOR " ";
+                out.append_colored(RED_FG, this->M_keyword.M_lexeme.c_str()).append(' ');
                 if (this->M_expression)
-                    this->M_expression->print();
+                    this->M_expression->print(out);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"jump_statement\",\"keyword\":").append_json_string(this->M_keyword.M_lexeme).append(",\"expression\":");
+                print_json_node(out, this->M_expression);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[1] = {serialize_node(writer, this->M_expression)};
+                return writer.write_node(hrast_kind::HRAST_JUMP_STATEMENT, &this->M_keyword, 0, children, 1);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_token(this->M_keyword, delta, from);
+                shift_node(this->M_expression, delta, from);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_expression);
             }
         };
 
         class ast_parameter_node : public ast_node
         {
-            horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>, horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>>>> M_parameters;
+            horizon_deps::vector<ast_parameter_group> M_parameters;
 
           public:
-            inline ast_parameter_node(horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>, horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>>>> &&params)
-                : M_parameters(std::move(params)) {}
+            inline ast_parameter_node(horizon_deps::vector<ast_parameter_group> &&params)
+                : ast_node("ast_parameter_node"), M_parameters(std::move(params)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "(\n";
+                out.append("(\n", 2);
                 for (std::size_t i = 0; i < this->M_parameters.length(); i++)
                 {
-                    if (this->M_parameters[i])
+                    if (out.is_colored())
+                        out.append(YELLOW_FG);
+                    out.append_uint(i);
+                    if (out.is_colored())
+                        out.append(RESET_COLOR);
+                    out.append("\tTYPE: ");
+                    if (this->M_parameters[i].get_first())
                     {
-                        std::cout << YELLOW_FG << i << RESET_COLOR << "\tTYPE: ";
-                        if (this->M_parameters[i].get_first())
-                        {
-                            this->M_parameters[i].get_first()->print();
-                            std::cout << " (";
-                        }
-                        for (std::size_t j = 0; j < this->M_parameters[i].get_second().length(); j++)
+                        this->M_parameters[i].get_first()->print(out);
+                        out.append(" (", 2);
+                    }
+                    for (std::size_t j = 0; j < this->M_parameters[i].get_second().length(); j++)
+                    {
+                        out.append("NAME: ").append_colored(PURPLE_FG, this->M_parameters[i].get_second()[j].get_first().M_lexeme.c_str()).append(" VALUE: ");
+                        if (this->M_parameters[i].get_second()[j].get_second())
                         {
-                            std::cout << "NAME: " << PURPLE_FG << this->M_parameters[i].get_second()[j].get_first().M_lexeme.c_str() << RESET_COLOR " VALUE: ";
-                            if (this->M_parameters[i].get_second()[j].raw_second())
-                            {
-                                this->M_parameters[i].get_second()[j].get_second()->print();
-                                std::cout << (j < this->M_parameters[i].get_second().length() - 1 ? ", " : "");
-                            }
-                            else
-                                std::cout << "(null)" << (j < this->M_parameters[i].get_second().length() - 1 ? ", " : "");
+                            this->M_parameters[i].get_second()[j].get_second()->print(out);
+                            out.append(j < this->M_parameters[i].get_second().length() - 1 ? ", " : "");
                         }
-                        std::cout << " )\n";
+                        else
+                            out.append("(null)").append(j < this->M_parameters[i].get_second().length() - 1 ? ", " : "");
+                    }
+                    out.append(" )\n");
+                }
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"parameters\",\"parameters\":[");
+                for (std::size_t i = 0; i < this->M_parameters.length(); i++)
+                {
+                    if (i > 0)
+                        out.append(',');
+                    out.append("{\"type\":");
+                    print_json_node(out, this->M_parameters[i].get_first());
+                    out.append(",\"names\":[");
+                    for (std::size_t j = 0; j < this->M_parameters[i].get_second().length(); j++)
+                    {
+                        if (j > 0)
+                            out.append(',');
+                        out.append("{\"name\":").append_json_string(this->M_parameters[i].get_second()[j].get_first().M_lexeme).append(",\"value\":");
+                        if (this->M_parameters[i].get_second()[j].get_second())
+                            print_json_node(out, this->M_parameters[i].get_second()[j].get_second());
+                        else
+                            out.append("null", 4);
+                        out.append('}');
+                    }
+                    out.append("]}");
+                }
+                out.append("]}");
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_parameters.length() + 1);
+                for (std::size_t i = 0; i < this->M_parameters.length(); i++)
+                {
+                    const ast_declarators &names = this->M_parameters[i].get_second();
+                    horizon_deps::vector<std::uint64_t> group(names.length() + 1);
+                    group.add(serialize_node(writer, this->M_parameters[i].get_first()));
+                    for (const ast_declarator &j : names)
+                    {
+                        std::uint64_t value[1] = {j.get_second() ? serialize_node(writer, j.get_second()) : 0};
+                        group.add(writer.write_node(hrast_kind::HRAST_DECLARATOR, &j.get_first(), 0, value, 1));
+                    }
+                    children.add(writer.write_node(hrast_kind::HRAST_PARAMETER_GROUP, nullptr, 0, 0, 0, group.raw(), group.length()));
+                }
+                return writer.write_node(hrast_kind::HRAST_PARAMETERS, nullptr, 0, 0, 0, children.raw(), children.length());
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                for (ast_parameter_group &i : this->M_parameters)
+                {
+                    shift_node(i.get_first(), delta, from);
+                    for (ast_declarator &j : i.get_second())
+                    {
+                        shift_token(j.get_first(), delta, from);
+                        if (j.get_second())
+                            shift_node(j.get_second(), delta, from);
+                    }
+                }
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                for (ast_parameter_group &i : this->M_parameters)
+                {
+                    for (ast_declarator &j : i.get_second())
+                    {
+                        if (j.get_second())
+                            table.intern(j.get_second());
                     }
                 }
-                std::cout << ")\n";
             }
         };
 
@@ -408,43 +1502,169 @@ namespace horizon
 
           public:
             inline ast_function_declaration_node(token &&identifier, horizon_deps::sptr<ast_node> &&var_decl, horizon_deps::sptr<ast_node> &&return_type, horizon_deps::sptr<ast_node> &&block)
-                : M_identifier(std::move(identifier)), M_parameters(std::move(var_decl)), M_return_type(std::move(return_type)), M_block(std::move(block)) {}
+                : ast_node("ast_function_declaration_node"), M_identifier(std::move(identifier)), M_parameters(std::move(var_decl)), M_return_type(std::move(return_type)), M_block(std::move(block)) {}
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                std::cout << "FUNC_DECL NAME: " << PURPLE_FG << this->M_identifier.M_lexeme.c_str() << RESET_COLOR "(\nPARAMETERS:\n";
+                out.append("FUNC_DECL NAME: ").append_colored(PURPLE_FG, this->M_identifier.M_lexeme.c_str()).append("(\nPARAMETERS:\n");
                 if (this->M_parameters)
-                    this->M_parameters->print();
-                std::cout << "RETURN TYPE: ";
+                    this->M_parameters->print(out);
+                out.append("RETURN TYPE: ");
                 if (this->M_return_type)
                 {
-                    this->M_return_type->print();
-                    std::cout << "\n";
+                    this->M_return_type->print(out);
+                    out.append('\n');
                 }
                 if (this->M_block)
-                    this->M_block->print();
-                std::cout << ")\n";
+                    this->M_block->print(out);
+                out.append(")\n", 2);
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                out.append("{\"node\":\"function_declaration\",\"name\":").append_json_string(this->M_identifier.M_lexeme).append(",\"parameters\":");
+                print_json_node(out, this->M_parameters);
+                out.append(",\"return_type\":");
+                print_json_node(out, this->M_return_type);
+                out.append(",\"block\":");
+                print_json_node(out, this->M_block);
+                out.append('}');
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                std::uint64_t children[3] = {serialize_node(writer, this->M_parameters), 0, 0};
+                children[1] = serialize_node(writer, this->M_return_type);
+                children[2] = serialize_node(writer, this->M_block);
+                return writer.write_node(hrast_kind::HRAST_FUNCTION_DECLARATION, &this->M_identifier, 0, children, 3);
+            }
+
+            inline void shift_positions(const std::ptrdiff_t &delta, const std::size_t &from) override
+            {
+                shift_token(this->M_identifier, delta, from);
+                shift_node(this->M_parameters, delta, from);
+                shift_node(this->M_return_type, delta, from);
+                shift_node(this->M_block, delta, from);
+            }
+
+            inline void get_blocks(ast_block_slots &blocks) override
+            {
+                collect_block(this->M_block, blocks);
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                table.intern(this->M_parameters);
+                table.intern(this->M_block);
             }
         };
 
         class ast_program_node : public ast_node
         {
             horizon_deps::vector<horizon_deps::sptr<ast_node>> M_nodes;
+            horizon_deps::vector<ast_token_range> M_ranges;   // absolute token range of every top-level declaration
+            horizon_deps::vector<std::ptrdiff_t> M_byte_shifts; // pending byte shift of the token offsets in every top-level declaration
 
           public:
-            inline ast_program_node(horizon_deps::vector<horizon_deps::sptr<ast_node>> &&nodes)
-                : M_nodes(std::move(nodes)) {}
+            inline ast_program_node(horizon_deps::vector<horizon_deps::sptr<ast_node>> &&nodes, horizon_deps::vector<ast_token_range> &&ranges)
+                : ast_node("ast_program_node"), M_nodes(std::move(nodes)), M_ranges(std::move(ranges)), M_byte_shifts(this->M_nodes.length() + 1)
+            {
+                for (std::size_t i = 0; i < this->M_nodes.length(); i++)
+                    this->M_byte_shifts.add(0);
+            }
 
-            inline void print() const override
+            inline void print(horizon_misc::out_buffer &out) const override
             {
-                for (const horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                this->print(out, 0, this->M_nodes.length());
+            }
+
+            /**
+             * @brief Prints only the declarations [`begin`, `end`), the parts of a split range concatenate to the whole `print`
+             */
+            inline void print(horizon_misc::out_buffer &out, const std::size_t &begin, const std::size_t &end) const
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    if (this->M_nodes[i])
+                        this->M_nodes[i]->print(out);
+                }
+            }
+
+            inline void print_json(horizon_misc::out_buffer &out) const override
+            {
+                this->print_json(out, 0, this->M_nodes.length());
+            }
+
+            /**
+             * @brief Like `print(out, begin, end)`, the first part opens the program object and the last one closes it
+             */
+            inline void print_json(horizon_misc::out_buffer &out, const std::size_t &begin, const std::size_t &end) const
+            {
+                if (begin == 0)
+                    out.append("{\"node\":\"program\",\"declarations\":[");
+                for (std::size_t i = begin; i < end; i++)
                 {
-                    if (i)
-                        i->print();
+                    if (i > 0)
+                        out.append(',');
+                    print_json_node(out, this->M_nodes[i]);
                 }
+                if (end == this->M_nodes.length())
+                    out.append("]}\n");
+            }
+
+            [[nodiscard]] inline std::size_t length() const
+            {
+                return this->M_nodes.length();
+            }
+
+            [[nodiscard]] inline std::uint64_t serialize(hrast_writer &writer) const override
+            {
+                horizon_deps::vector<std::uint64_t> children(this->M_nodes.length() + 1);
+                for (std::size_t i = 0; i < this->M_nodes.length(); i++)
+                {
+                    writer.set_position_shift(this->M_byte_shifts[i]);
+                    children.add(serialize_node(writer, this->M_nodes[i]));
+                }
+                writer.set_position_shift(0);
+                return writer.write_node(hrast_kind::HRAST_PROGRAM, nullptr, 0, 0, 0, children.raw(), children.length());
+            }
+
+            [[nodiscard]] inline horizon_deps::vector<horizon_deps::sptr<ast_node>> &get_nodes()
+            {
+                return this->M_nodes;
+            }
+
+            [[nodiscard]] inline horizon_deps::vector<ast_token_range> &get_ranges()
+            {
+                return this->M_ranges;
+            }
+
+            [[nodiscard]] inline horizon_deps::vector<std::ptrdiff_t> &get_byte_shifts()
+            {
+                return this->M_byte_shifts;
+            }
+
+            /**
+             * @brief Applies the byte shifts left pending by incremental reparsing to every token offset
+             */
+            inline void settle_positions()
+            {
+                for (std::size_t i = 0; i < this->M_nodes.length(); i++)
+                {
+                    if (this->M_byte_shifts[i] != 0 && this->M_nodes[i])
+                        this->M_nodes[i]->shift_positions(this->M_byte_shifts[i], 0);
+                    this->M_byte_shifts[i] = 0;
+                }
+            }
+
+            inline void intern_children(ast_hash_cons &table) override
+            {
+                this->settle_positions();
+                for (horizon_deps::sptr<ast_node> &i : this->M_nodes)
+                    table.intern(i);
             }
         };
     }
 }
 
-#endif
\ No newline at end of file
+#endif
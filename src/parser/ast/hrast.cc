@@ -0,0 +1,450 @@
+/**
+ * @file hrast.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./hrast.hh"
+
+#include <cstdio>
+#include <cerrno>
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../defines/defines.h"
+#include "../../colorize/colorize.h"
+#include "../../misc/diagnostic.hh"
+
+namespace horizon
+{
+    namespace horizon_parser
+    {
+        void hrast_writer::grow(char *&buff, std::size_t &cap, const std::size_t &needed)
+        {
+            if (needed <= cap)
+                return;
+            std::size_t new_cap = (cap == 0 ? 4096 : cap);
+            while (new_cap < needed)
+                new_cap *= 2;
+            buff = static_cast<char *>(std::realloc(buff, new_cap * sizeof(char)));
+            if (!buff)
+                horizon_misc::exit_heap_fail(buff, "horizon::horizon_parser::hrast_writer");
+            cap = new_cap;
+        }
+
+        hrast_writer::hrast_writer()
+        {
+            this->M_nodes = nullptr;
+            this->M_nodes_cap = 0;
+            this->M_strings = nullptr;
+            this->M_strings_len = 0;
+            this->M_strings_cap = 0;
+            this->M_node_count = 0;
+            this->M_position_shift = 0;
+            this->M_has_shared_nodes = false;
+
+            // the header is written in place once the image is complete
+            hrast_writer::grow(this->M_nodes, this->M_nodes_cap, sizeof(hrast_header));
+            std::memset(this->M_nodes, 0, sizeof(hrast_header));
+            this->M_nodes_len = sizeof(hrast_header);
+        }
+
+        void hrast_writer::set_position_shift(const std::ptrdiff_t &shift)
+        {
+            this->M_position_shift = shift;
+        }
+
+        void hrast_writer::set_shared_nodes(const bool &has_shared_nodes)
+        {
+            this->M_has_shared_nodes = has_shared_nodes;
+        }
+
+        bool hrast_writer::has_shared_nodes() const
+        {
+            return this->M_has_shared_nodes;
+        }
+
+        bool hrast_writer::find_shared(const void *node, std::uint64_t &offset) const
+        {
+            if (this->M_shared.is_null() || !this->M_shared.contains(node))
+                return false;
+            offset = this->M_shared.get_value(node);
+            return true;
+        }
+
+        void hrast_writer::add_shared(const void *node, const std::uint64_t &offset)
+        {
+            const void *key = node;
+            std::uint64_t value = offset;
+            (void)this->M_shared.append(std::move(key), std::move(value));
+        }
+
+        std::uint64_t hrast_writer::write_node(const hrast_kind &kind, const token *tok, const std::uint16_t &flags, const std::uint64_t *children, const std::size_t &child_count)
+        {
+            std::uint64_t offset = this->write_node(kind, (tok ? tok->M_lexeme.c_str() : nullptr), (tok ? tok->M_lexeme.length() : 0), flags, 0, children, child_count);
+            hrast_node *node = reinterpret_cast<hrast_node *>(this->M_nodes + offset);
+            if (tok)
+            {
+                node->M_token_type = tok->M_type;
+                if (tok->M_start != static_cast<std::size_t>(-1))
+                {
+                    std::size_t start = tok->M_start + this->M_position_shift, end = tok->M_end + this->M_position_shift;
+                    node->M_start = (start > HRAST_NO_POS ? HRAST_NO_POS : static_cast<std::uint32_t>(start));
+                    node->M_end = (end > HRAST_NO_POS ? HRAST_NO_POS : static_cast<std::uint32_t>(end));
+                }
+            }
+            return offset;
+        }
+
+        std::uint64_t hrast_writer::write_node(const hrast_kind &kind, const char *str, const std::size_t &str_len, const std::uint16_t &flags, const std::uint64_t &value, const std::uint64_t *children, const std::size_t &child_count)
+        {
+            hrast_node node;
+            std::memset(&node, 0, sizeof(hrast_node));
+            node.M_kind = kind;
+            node.M_token_type = token_type::TOKEN_END_OF_FILE;
+            node.M_flags = flags;
+            node.M_child_count = static_cast<std::uint32_t>(child_count);
+            node.M_start = HRAST_NO_POS;
+            node.M_end = HRAST_NO_POS;
+            node.M_value = value;
+            if (str)
+            {
+                hrast_writer::grow(this->M_strings, this->M_strings_cap, this->M_strings_len + str_len + 1);
+                std::memcpy(this->M_strings + this->M_strings_len, str, str_len);
+                this->M_strings[this->M_strings_len + str_len] = 0; // lets readers use the text as a C string
+                node.M_str_offset = static_cast<std::uint32_t>(this->M_strings_len);
+                node.M_str_length = static_cast<std::uint32_t>(str_len);
+                this->M_strings_len += str_len + 1;
+            }
+            else
+            {
+                node.M_str_offset = HRAST_NO_POS;
+                node.M_str_length = 0;
+            }
+
+            std::size_t record_size = sizeof(hrast_node) + child_count * sizeof(std::uint64_t);
+            hrast_writer::grow(this->M_nodes, this->M_nodes_cap, this->M_nodes_len + record_size);
+            std::uint64_t offset = this->M_nodes_len;
+            std::memcpy(this->M_nodes + this->M_nodes_len, &node, sizeof(hrast_node));
+            if (child_count > 0)
+                std::memcpy(this->M_nodes + this->M_nodes_len + sizeof(hrast_node), children, child_count * sizeof(std::uint64_t));
+            this->M_nodes_len += record_size;
+            this->M_node_count++;
+            return offset;
+        }
+
+        bool hrast_writer::save(const char *loc, const std::uint64_t &root)
+        {
+            std::size_t strings_offset = this->M_nodes_len;
+            hrast_writer::grow(this->M_nodes, this->M_nodes_cap, this->M_nodes_len + this->M_strings_len);
+            if (this->M_strings_len > 0)
+                std::memcpy(this->M_nodes + strings_offset, this->M_strings, this->M_strings_len);
+            std::size_t total = strings_offset + this->M_strings_len;
+
+            hrast_header header;
+            std::memcpy(header.M_magic, HRAST_MAGIC, sizeof(HRAST_MAGIC));
+            header.M_version = HRAST_VERSION;
+            header.M_endian = HRAST_ENDIAN;
+            header.M_size = total;
+            header.M_root = root;
+            header.M_node_count = this->M_node_count;
+            header.M_strings = strings_offset;
+            header.M_strings_size = this->M_strings_len;
+            header.M_reserved = 0;
+            std::memcpy(this->M_nodes, &header, sizeof(hrast_header));
+
+            std::FILE *fptr = std::fopen(loc, "wb");
+            if (!fptr)
+            {
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for writing: %s\n", loc, std::strerror(errno));
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' cannot be opened for writing: %s\n", loc, std::strerror(errno));
+                return false;
+            }
+            std::setvbuf(fptr, nullptr, _IONBF, 0); // the image is already one block, hand it to a single write()
+            bool is_written = std::fwrite(this->M_nodes, sizeof(char), total, fptr) == total;
+            if (std::fclose(fptr) != 0)
+                is_written = false;
+            if (!is_written)
+            {
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " not every byte was written: %s\n", loc, std::strerror(errno));
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' not every byte was written: %s\n", loc, std::strerror(errno));
+            }
+            return is_written;
+        }
+
+        hrast_writer::~hrast_writer()
+        {
+            std::free(this->M_nodes);
+            std::free(this->M_strings);
+            this->M_nodes = nullptr;
+            this->M_strings = nullptr;
+        }
+
+        hrast_node_view::hrast_node_view(const hrast_file *file, const hrast_node *node)
+        {
+            this->M_file = file;
+            this->M_node = node;
+        }
+
+        bool hrast_node_view::is_null() const
+        {
+            return this->M_node == nullptr;
+        }
+
+        hrast_node_view::operator bool() const
+        {
+            return !this->is_null();
+        }
+
+        hrast_kind hrast_node_view::kind() const
+        {
+            return this->M_node->M_kind;
+        }
+
+        token_type hrast_node_view::get_token_type() const
+        {
+            return this->M_node->M_token_type;
+        }
+
+        std::uint16_t hrast_node_view::flags() const
+        {
+            return this->M_node->M_flags;
+        }
+
+        std::uint32_t hrast_node_view::child_count() const
+        {
+            return this->M_node->M_child_count;
+        }
+
+        hrast_node_view hrast_node_view::child(const std::uint32_t &nth) const
+        {
+            if (nth >= this->M_node->M_child_count)
+                return {this->M_file, nullptr};
+            std::uint64_t offset;
+            std::memcpy(&offset, reinterpret_cast<const char *>(this->M_node) + sizeof(hrast_node) + nth * sizeof(std::uint64_t), sizeof(std::uint64_t));
+            // a corrupted offset must never point outside of the node records
+            if (offset < sizeof(hrast_header) || offset + sizeof(hrast_node) > this->M_file->header().M_strings)
+                return {this->M_file, nullptr};
+            return {this->M_file, reinterpret_cast<const hrast_node *>(this->M_file->M_data + offset)};
+        }
+
+        const char *hrast_node_view::str() const
+        {
+            const hrast_header &header = this->M_file->header();
+            if (this->M_node->M_str_offset == HRAST_NO_POS || static_cast<std::uint64_t>(this->M_node->M_str_offset) + this->M_node->M_str_length >= header.M_strings_size)
+                return nullptr;
+            return this->M_file->M_data + header.M_strings + this->M_node->M_str_offset;
+        }
+
+        std::uint32_t hrast_node_view::str_length() const
+        {
+            return this->M_node->M_str_length;
+        }
+
+        std::uint32_t hrast_node_view::start() const
+        {
+            return this->M_node->M_start;
+        }
+
+        std::uint32_t hrast_node_view::end() const
+        {
+            return this->M_node->M_end;
+        }
+
+        long long hrast_node_view::value_int() const
+        {
+            return static_cast<long long>(this->M_node->M_value);
+        }
+
+        double hrast_node_view::value_decimal() const
+        {
+            double val;
+            std::memcpy(&val, &this->M_node->M_value, sizeof(double));
+            return val;
+        }
+
+        char hrast_node_view::value_char() const
+        {
+            return static_cast<char>(this->M_node->M_value);
+        }
+
+        bool hrast_node_view::value_bool() const
+        {
+            return this->M_node->M_value != 0;
+        }
+
+        hrast_file::hrast_file()
+        {
+            this->M_data = nullptr;
+            this->M_size = 0;
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+            this->M_mapping = nullptr;
+#endif
+        }
+
+        bool hrast_file::load(const char *loc)
+        {
+            this->unload();
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+            HANDLE file = CreateFileA(loc, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for reading\n", loc);
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' cannot be opened for reading\n", loc);
+                return false;
+            }
+            LARGE_INTEGER size;
+            GetFileSizeEx(file, &size);
+            this->M_size = static_cast<std::size_t>(size.QuadPart);
+            this->M_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            CloseHandle(file);
+            if (this->M_mapping)
+                this->M_data = static_cast<const char *>(MapViewOfFile(this->M_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+            int fd = open(loc, O_RDONLY);
+            if (fd < 0)
+            {
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' cannot be opened for reading: %s\n", loc, std::strerror(errno));
+                return false;
+            }
+            struct stat buffer;
+            if (fstat(fd, &buffer) == 0 && buffer.st_size > 0)
+            {
+                this->M_size = static_cast<std::size_t>(buffer.st_size);
+                void *ptr = mmap(nullptr, this->M_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr != MAP_FAILED)
+                    this->M_data = static_cast<const char *>(ptr);
+            }
+            close(fd);
+#endif
+            if (!this->M_data)
+            {
+                this->unload();
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " cannot be mapped into memory\n", loc);
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' cannot be mapped into memory\n", loc);
+                return false;
+            }
+
+            const hrast_header *header = reinterpret_cast<const hrast_header *>(this->M_data);
+            if (this->M_size < sizeof(hrast_header) ||
+                std::memcmp(header->M_magic, HRAST_MAGIC, sizeof(HRAST_MAGIC)) != 0 ||
+                header->M_version != HRAST_VERSION ||
+                header->M_endian != HRAST_ENDIAN ||
+                header->M_size != this->M_size ||
+                header->M_strings > this->M_size ||
+                header->M_strings_size != this->M_size - header->M_strings ||
+                header->M_root < sizeof(hrast_header) ||
+                header->M_root + sizeof(hrast_node) > header->M_strings ||
+                !this->check_nodes())
+            {
+                this->unload();
+                if (COLOR_ERR)
+                    horizon_misc::diagnostic("horizon: " ENCLOSE(RED_FG, "error[E1]:") " " ENCLOSE(WHITE_FG, "'%s'") " is not a valid version %u .hrast file\n", loc, HRAST_VERSION);
+                else
+                    horizon_misc::diagnostic("horizon: error[E1]: '%s' is not a valid version %u .hrast file\n", loc, HRAST_VERSION);
+                return false;
+            }
+            return true;
+        }
+
+        bool hrast_file::check_nodes() const
+        {
+            // records are a whole number of 8 bytes long and follow each other from the end of the header; one bit per 8 bytes
+            // marks where a record starts
+            const hrast_header &header = this->header();
+            std::size_t slots = static_cast<std::size_t>(header.M_strings / 8) + 1;
+            unsigned char *starts = static_cast<unsigned char *>(std::calloc(slots / 8 + 1, sizeof(unsigned char)));
+            horizon_misc::exit_heap_fail(starts, "horizon::horizon_parser::hrast_file");
+            auto is_start = [starts](const std::uint64_t &offset)
+            { return offset % 8 == 0 && (starts[offset / 64] >> (offset / 8 % 8) & 1) != 0; };
+
+            bool ok = true;
+            std::uint64_t pos = sizeof(hrast_header), count = 0;
+            while (ok && pos < header.M_strings)
+            {
+                // the fixed part has to be there before its child count can be read
+                if (header.M_strings - pos < sizeof(hrast_node))
+                {
+                    ok = false;
+                    break;
+                }
+                const hrast_node *node = reinterpret_cast<const hrast_node *>(this->M_data + pos);
+                std::uint64_t record = sizeof(hrast_node) + static_cast<std::uint64_t>(node->M_child_count) * sizeof(std::uint64_t);
+                if (header.M_strings - pos < record)
+                {
+                    ok = false;
+                    break;
+                }
+                // children are written before their parent: 0 or an earlier record, which also rules out cycles
+                for (std::uint32_t i = 0; ok && i < node->M_child_count; i++)
+                {
+                    std::uint64_t offset;
+                    std::memcpy(&offset, this->M_data + pos + sizeof(hrast_node) + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+                    if (offset != 0 && (offset >= pos || !is_start(offset)))
+                        ok = false;
+                }
+                starts[pos / 64] = static_cast<unsigned char>(starts[pos / 64] | 1U << (pos / 8 % 8));
+                pos += record;
+                count++;
+            }
+            ok = ok && pos == header.M_strings && count == header.M_node_count && is_start(header.M_root);
+            std::free(starts);
+            return ok;
+        }
+
+        bool hrast_file::is_null() const
+        {
+            return this->M_data == nullptr;
+        }
+
+        const hrast_header &hrast_file::header() const
+        {
+            return *reinterpret_cast<const hrast_header *>(this->M_data);
+        }
+
+        hrast_node_view hrast_file::root() const
+        {
+            if (!this->M_data)
+                return {this, nullptr};
+            return {this, reinterpret_cast<const hrast_node *>(this->M_data + this->header().M_root)};
+        }
+
+        void hrast_file::unload()
+        {
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+            if (this->M_data)
+                UnmapViewOfFile(this->M_data);
+            if (this->M_mapping)
+                CloseHandle(this->M_mapping);
+            this->M_mapping = nullptr;
+#else
+            if (this->M_data)
+                munmap(const_cast<char *>(this->M_data), this->M_size);
+#endif
+            this->M_data = nullptr;
+            this->M_size = 0;
+        }
+
+        hrast_file::~hrast_file()
+        {
+            this->unload();
+        }
+    }
+}
@@ -0,0 +1,216 @@
+/**
+ * @file hrast.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_PARSER_AST_HRAST_HH
+#define HORIZON_PARSER_AST_HRAST_HH
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+#include "../../token/token.hh"
+#include "../../token_type/token_type.hh"
+#include "../../misc/exit_heap_fail.hh"
+#include "../../../deps/hashtable/hashtable.hh"
+
+namespace horizon
+{
+    namespace horizon_parser
+    {
+        /**
+         * `.hrast` is a position-independent binary image of the AST:
+         *      [hrast_header][hrast_node records ...][string table]
+         * Every node refers to its children by their byte offset from the start of the file (0 means no child),
+         * and to its text by an (offset, length) pair into the string table, so a mapped file can be walked
+         * directly without any parsing or fix-ups.
+         * An image written from a hash-consed AST is a DAG: a shared expression is written once and every parent
+         * refers to the same offset (its token positions are those of its first occurrence).
+         */
+        constexpr const char HRAST_MAGIC[8] = {'H', 'R', 'A', 'S', 'T', '\0', '\r', '\n'};
+        constexpr std::uint32_t HRAST_VERSION = 1U;
+        constexpr std::uint32_t HRAST_ENDIAN = 0x01020304U;
+        constexpr std::uint32_t HRAST_NO_POS = static_cast<std::uint32_t>(-1);
+
+        enum class hrast_kind : std::uint8_t
+        {
+            HRAST_PROGRAM = 1U,          // children: declarations
+            HRAST_IDENTIFIER,            // name: identifier or type name
+            HRAST_LITERAL,               // flags: hrast_literal_type, value: payload, name: string literal
+            HRAST_UNARY_OPERATION,       // token: operator, flags: 1 if prefix, children: [operand]
+            HRAST_BINARY_OPERATION,      // token: operator, children: [left, right]
+            HRAST_DATA_TYPE,             // children: [type, qualifier tokens...]
+            HRAST_TERNARY_OPERATOR,      // children: [condition, value_if_true, value_if_false]
+            HRAST_VARIABLE_DECLARATION,  // children: [type, declarators...]
+            HRAST_DECLARATOR,            // token: name, children: [value]
+            HRAST_FUNCTION_CALL,         // token: name, children: arguments
+            HRAST_BLOCK,                 // children: statements
+            HRAST_IF_ELIF_ELSE,          // children: [branches..., else_block]
+            HRAST_BRANCH,                // children: [condition, block]
+            HRAST_FOR_LOOP,              // children: [variable_declaration, condition, step, block]
+            HRAST_WHILE_LOOP,            // children: [condition, block]
+            HRAST_DO_WHILE_LOOP,         // children: [block, condition]
+            HRAST_JUMP_STATEMENT,        // token: keyword, children: [expression]
+            HRAST_PARAMETERS,            // children: parameter groups
+            HRAST_PARAMETER_GROUP,       // children: [type, declarators...]
+            HRAST_FUNCTION_DECLARATION,  // token: name, children: [parameters, return_type, block]
+            HRAST_TOKEN                  // token: a bare token, e.g. type qualifiers
+        };
+
+        enum class hrast_literal_type : std::uint16_t
+        {
+            HRAST_LITERAL_INTEGER,
+            HRAST_LITERAL_DECIMAL,
+            HRAST_LITERAL_CHAR,
+            HRAST_LITERAL_BOOL,
+            HRAST_LITERAL_STRING,
+            HRAST_LITERAL_NULL
+        };
+
+        struct hrast_header
+        {
+            char M_magic[8];
+            std::uint32_t M_version;
+            std::uint32_t M_endian;
+            std::uint64_t M_size;         // size of the whole file
+            std::uint64_t M_root;         // offset of the root node
+            std::uint64_t M_node_count;
+            std::uint64_t M_strings;      // offset of the string table
+            std::uint64_t M_strings_size; // size of the string table
+            std::uint64_t M_reserved;
+        };
+
+        struct hrast_node
+        {
+            hrast_kind M_kind;
+            token_type M_token_type;
+            std::uint16_t M_flags;
+            std::uint32_t M_child_count;
+            std::uint32_t M_str_offset; // into the string table
+            std::uint32_t M_str_length;
+            std::uint32_t M_start; // source byte offsets, HRAST_NO_POS if unknown
+            std::uint32_t M_end;
+            std::uint64_t M_value; // literal payload, doubles are stored by their bits
+            // followed by `M_child_count` std::uint64_t child offsets
+        };
+
+        static_assert(sizeof(hrast_header) == 64, "hrast_header must stay 64 bytes");
+        static_assert(sizeof(hrast_node) == 32, "hrast_node must stay 32 bytes");
+
+        /**
+         * Builds a `.hrast` image in memory, children are always written before their parent
+         */
+        class hrast_writer
+        {
+          private:
+            char *M_nodes;
+            std::size_t M_nodes_len, M_nodes_cap;
+            char *M_strings;
+            std::size_t M_strings_len, M_strings_cap;
+            std::uint64_t M_node_count;
+            std::ptrdiff_t M_position_shift;
+            bool M_has_shared_nodes;
+            horizon_deps::hashtable<const void *, std::uint64_t> M_shared; // shared node -> offset
+
+          private:
+            static void grow(char *&buff, std::size_t &cap, const std::size_t &needed);
+
+          public:
+            hrast_writer();
+            hrast_writer(const hrast_writer &) = delete;
+            hrast_writer &operator=(const hrast_writer &) = delete;
+
+            /**
+             * @brief Byte shift added to the source offsets of every token written from now on
+             */
+            void set_position_shift(const std::ptrdiff_t &shift);
+
+            /**
+             * @brief Marks the AST being written as hash-consed, shared nodes are then written only once
+             */
+            void set_shared_nodes(const bool &has_shared_nodes);
+            [[nodiscard]] bool has_shared_nodes() const;
+            [[nodiscard]] bool find_shared(const void *node, std::uint64_t &offset) const;
+            void add_shared(const void *node, const std::uint64_t &offset);
+
+            [[nodiscard]] std::uint64_t write_node(const hrast_kind &kind, const token *tok, const std::uint16_t &flags, const std::uint64_t *children, const std::size_t &child_count);
+            [[nodiscard]] std::uint64_t write_node(const hrast_kind &kind, const char *str, const std::size_t &str_len, const std::uint16_t &flags, const std::uint64_t &value, const std::uint64_t *children, const std::size_t &child_count);
+
+            /**
+             * @brief Writes the image (header, nodes and string table) to `loc` with a single write()
+             */
+            [[nodiscard]] bool save(const char *loc, const std::uint64_t &root);
+            ~hrast_writer();
+        };
+
+        class hrast_file;
+
+        /**
+         * A read-only view of one node inside a mapped `.hrast` file
+         */
+        class hrast_node_view
+        {
+          private:
+            const hrast_file *M_file;
+            const hrast_node *M_node;
+
+          public:
+            hrast_node_view(const hrast_file *file, const hrast_node *node);
+            [[nodiscard]] bool is_null() const;
+            operator bool() const;
+            [[nodiscard]] hrast_kind kind() const;
+            [[nodiscard]] token_type get_token_type() const;
+            [[nodiscard]] std::uint16_t flags() const;
+            [[nodiscard]] std::uint32_t child_count() const;
+
+            /**
+             * @brief A null view if `nth` >= `child_count()` or the child is absent (offset 0)
+             */
+            [[nodiscard]] hrast_node_view child(const std::uint32_t &nth) const;
+            [[nodiscard]] const char *str() const;
+            [[nodiscard]] std::uint32_t str_length() const;
+            [[nodiscard]] std::uint32_t start() const;
+            [[nodiscard]] std::uint32_t end() const;
+            [[nodiscard]] long long value_int() const;
+            [[nodiscard]] double value_decimal() const;
+            [[nodiscard]] char value_char() const;
+            [[nodiscard]] bool value_bool() const;
+        };
+
+        /**
+         * Maps a `.hrast` file into memory. Loading validates the header and walks every record once: each one must lie inside
+         * the node area, and each child offset must be 0 or a record written before its parent, so that no view of a truncated
+         * or corrupt file reads outside of it
+         */
+        class hrast_file
+        {
+          private:
+            const char *M_data;
+            std::size_t M_size;
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+            void *M_mapping;
+#endif
+
+            friend class hrast_node_view;
+
+          private:
+            [[nodiscard]] bool check_nodes() const;
+
+          public:
+            hrast_file();
+            hrast_file(const hrast_file &) = delete;
+            hrast_file &operator=(const hrast_file &) = delete;
+
+            [[nodiscard]] bool load(const char *loc);
+            [[nodiscard]] bool is_null() const;
+            [[nodiscard]] const hrast_header &header() const;
+            [[nodiscard]] hrast_node_view root() const;
+            void unload();
+            ~hrast_file();
+        };
+    }
+}
+
+#endif
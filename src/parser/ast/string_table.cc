@@ -0,0 +1,47 @@
+/**
+ * @file string_table.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./string_table.hh"
+
+namespace horizon
+{
+    namespace horizon_parser
+    {
+        string_table::string_table()
+            : M_interner() {}
+
+        std::uint32_t string_table::intern(const char *str, const std::size_t &len)
+        {
+            return this->M_interner.intern(str, len);
+        }
+
+        const char *string_table::get(const std::uint32_t &index) const
+        {
+            return this->M_interner.get(index);
+        }
+
+        std::size_t string_table::length(const std::uint32_t &index) const
+        {
+            return this->M_interner.length(index);
+        }
+
+        std::uint32_t string_table::count() const
+        {
+            return this->M_interner.count();
+        }
+
+        void string_table::clear()
+        {
+            this->M_interner.clear();
+        }
+
+        string_table &string_table::instance()
+        {
+            static string_table table;
+            return table;
+        }
+    }
+}
\ No newline at end of file
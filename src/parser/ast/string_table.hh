@@ -0,0 +1,64 @@
+/**
+ * @file string_table.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_PARSER_AST_STRING_TABLE_HH
+#define HORIZON_PARSER_AST_STRING_TABLE_HH
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../../../deps/hashtable/concurrent_interner.hh"
+
+namespace horizon
+{
+    namespace horizon_parser
+    {
+        /**
+         * Index of a string that does not exist (e.g. a literal whose lexeme was never allocated)
+         */
+        constexpr std::uint32_t STRING_TABLE_NULL = horizon_deps::concurrent_interner::NULL_ID;
+
+        /**
+         * Interns every identifier and string literal of the AST, so equal strings share one copy and one index.
+         * Safe to use from several threads at once (see `horizon_deps::concurrent_interner`): indices are dense and stable,
+         * and pointers returned by get() stay valid until the table is cleared
+         */
+        class string_table
+        {
+          private:
+            horizon_deps::concurrent_interner M_interner;
+
+          public:
+            string_table();
+            string_table(const string_table &) = delete;
+            string_table &operator=(const string_table &) = delete;
+
+            /**
+             * @brief Returns the index of `str`, adding it if it is not in the table yet
+             */
+            [[nodiscard]] std::uint32_t intern(const char *str, const std::size_t &len);
+
+            /**
+             * @brief NUL-terminated string at `index`, nullptr for STRING_TABLE_NULL
+             */
+            [[nodiscard]] const char *get(const std::uint32_t &index) const;
+            [[nodiscard]] std::size_t length(const std::uint32_t &index) const;
+            [[nodiscard]] std::uint32_t count() const;
+
+            /**
+             * @brief Empties the table, for when no AST using it is left. No other thread may use the table meanwhile
+             */
+            void clear();
+
+            /**
+             * @brief The table shared by every AST of the process
+             */
+            [[nodiscard]] static string_table &instance();
+        };
+    }
+}
+
+#endif
@@ -51,32 +51,143 @@ namespace horizon
                 this->M_current_parser--;
         }
 
+        std::size_t parser::common_prefix(const char *a, const char *b, const std::size_t &len)
+        {
+            // memcmp() whole chunks first, only the chunk with the difference is walked byte by byte
+            constexpr std::size_t chunk = 4096;
+            std::size_t i = 0;
+            while (i + chunk <= len && std::memcmp(a + i, b + i, chunk) == 0)
+                i += chunk;
+            while (i < len && a[i] == b[i])
+                i++;
+            return i;
+        }
+
+        std::size_t parser::common_suffix(const char *a_end, const char *b_end, const std::size_t &len)
+        {
+            constexpr std::size_t chunk = 4096;
+            std::size_t i = 0;
+            while (i + chunk <= len && std::memcmp(a_end - i - chunk, b_end - i - chunk, chunk) == 0)
+                i += chunk;
+            while (i < len && a_end[-static_cast<std::ptrdiff_t>(i) - 1] == b_end[-static_cast<std::ptrdiff_t>(i) - 1])
+                i++;
+            return i;
+        }
+
+        void parser::reserve_token_starts(const std::size_t &count)
+        {
+            if (count <= this->M_token_starts_cap)
+                return;
+            this->M_token_starts_cap = count + count / 8; // leaves room for insertions without another realloc
+            this->M_token_starts = static_cast<std::size_t *>(horizon_deps::reallocate(this->M_token_starts, this->M_token_starts_cap * sizeof(std::size_t)));
+            horizon_misc::exit_heap_fail(this->M_token_starts, "horizon::horizon_parser::parser");
+        }
+
+        void parser::save_token_starts()
+        {
+            this->reserve_token_starts(this->M_tokens.length());
+            for (std::size_t i = 0; i < this->M_tokens.length(); i++)
+                this->M_token_starts[i] = this->M_tokens[i].M_start;
+            this->M_token_count = this->M_tokens.length();
+        }
+
+        bool parser::is_balanced_region(const std::size_t &begin, const std::size_t &end) const
+        {
+            // a region can be parsed on its own only if its braces close exactly at its last token, which must end a declaration or block
+            if (begin >= end || (this->M_tokens[end - 1].M_type != token_type::TOKEN_RIGHT_BRACE && this->M_tokens[end - 1].M_type != token_type::TOKEN_SEMICOLON))
+                return false;
+            std::size_t depth = 0;
+            for (std::size_t i = begin; i < end; i++)
+            {
+                if (this->M_tokens[i].M_type == token_type::TOKEN_LEFT_BRACE)
+                    depth++;
+                else if (this->M_tokens[i].M_type == token_type::TOKEN_RIGHT_BRACE)
+                {
+                    if (depth == 0)
+                        return false;
+                    if (--depth == 0 && i != end - 1)
+                        return false;
+                }
+            }
+            return depth == 0;
+        }
+
+        horizon_deps::sptr<ast_node> parser::parse_region(const std::size_t &begin, const std::size_t &end, const std::size_t &block_base, const bool &is_block, bool &has_error)
+        {
+            // the region is parsed from copies, so that a rejected region leaves the tokens intact for a full parse
+            horizon_deps::vector<token> region(end - begin + 1);
+            for (std::size_t i = begin; i < end; i++)
+                region.add(this->M_tokens[i]);
+            region.add(token{token_type::TOKEN_END_OF_FILE, nullptr, static_cast<std::size_t>(-1), static_cast<std::size_t>(-1)});
+
+            horizon_deps::vector<token> tokens = std::move(this->M_tokens);
+            this->M_tokens = std::move(region);
+            this->M_current_parser = 0;
+            this->M_token_base = begin;
+            this->M_block_base = block_base;
+
+            horizon_deps::sptr<ast_node> node = (is_block ? this->parse_block() : this->parse_top_level());
+            bool is_exact = this->has_reached_end();
+
+            this->M_tokens = std::move(tokens);
+            this->M_token_base = 0;
+            has_error = !node;
+            if (!is_exact)
+                return nullptr;
+            return node;
+        }
+
+        bool parser::parse_all()
+        {
+            this->M_current_parser = 0;
+            this->M_token_base = 0;
+            horizon_deps::sptr<ast_node> ast = this->parse_program();
+            if (!ast)
+                return false;
+            this->M_ast = std::move(ast);
+            this->M_is_hash_consed = false;
+            this->save_token_starts();
+            return true;
+        }
+
         horizon_deps::sptr<ast_node> parser::parse_program()
         {
             horizon_deps::vector<horizon_deps::sptr<ast_node>> nodes;
+            horizon_deps::vector<ast_token_range> ranges;
             while (!this->has_reached_end())
             {
-                horizon_deps::sptr<ast_node> temp = nullptr;
-                if (this->get_token().M_lexeme == "func")
-                    temp = this->parse_function();
-                else
-                {
-                    // global varibales
-                    temp = this->parse_variable_decl();
-                    if (!this->handle_semicolon())
-                        return nullptr;
-                }
+                std::size_t begin = this->M_current_parser;
+                this->M_block_base = begin;
+                horizon_deps::sptr<ast_node> temp = this->parse_top_level();
                 if (!temp)
                     return nullptr;
                 nodes.add(std::move(temp));
+                ranges.add({begin, this->M_current_parser});
             }
             nodes.shrink_to_fit();
-            return new ast_program_node(std::move(nodes));
+            ranges.shrink_to_fit();
+            return new ast_program_node(std::move(nodes), std::move(ranges));
+        }
+
+        horizon_deps::sptr<ast_node> parser::parse_top_level()
+        {
+            if (this->get_token().M_lexeme == "func")
+            {
+                // the name follows `func`, parse_function reports it if it does not
+                const token &name = this->M_tokens[this->M_current_parser + 1 < this->M_tokens.length() ? this->M_current_parser + 1 : this->M_current_parser];
+                horizon_misc::trace_scope trace("function", name.M_lexeme.c_str(), name.M_lexeme.length());
+                return this->parse_function();
+            }
+            // global varibales
+            horizon_deps::sptr<ast_node> temp = this->parse_variable_decl();
+            if (!this->handle_semicolon())
+                return nullptr;
+            return temp;
         }
 
         horizon_deps::sptr<ast_node> parser::parse_data_type()
         {
-            horizon_deps::vector<token> type_qualifiers;
+            ast_type_qualifiers type_qualifiers;
             horizon_deps::sptr<ast_node> _type = nullptr;
 
             if (this->get_token().M_type == token_type::TOKEN_KEYWORD)
@@ -87,7 +198,6 @@ namespace horizon
                 {
                     type_qualifiers.add(std::move(this->post_advance()));
                 }
-                type_qualifiers.shrink_to_fit();
             }
             if (this->get_token().M_type == token_type::TOKEN_IDENTIFIER)
             {
@@ -97,7 +207,7 @@ namespace horizon
             }
             else if (this->get_token().M_type == token_type::TOKEN_PRIMARY_TYPE || this->get_token().M_lexeme == "let")
             {
-                _type = new ast_operand_node(this->post_advance().M_lexeme);
+                _type = new ast_literal_node(ast_literal_type::AST_LITERAL_IDENTIFIER, this->post_advance().M_lexeme);
             }
             else
             {
@@ -110,12 +220,11 @@ namespace horizon
 
         horizon_deps::sptr<ast_node> parser::parse_parameters()
         {
-            horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>, horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>>>> params;
+            horizon_deps::vector<ast_parameter_group> params;
             while (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN && !this->has_reached_end())
             {
-                horizon_deps::pair<horizon_deps::sptr<ast_node>, horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>>> temp_pair1;
-                temp_pair1.raw_first() = new horizon_deps::sptr<ast_node>(this->parse_data_type());
-                if (!(*temp_pair1.raw_first()))
+                horizon_deps::sptr<ast_node> type_ = this->parse_data_type();
+                if (!type_)
                     return nullptr;
                 if (this->get_token().M_type != token_type::TOKEN_COLON)
                 {
@@ -124,10 +233,10 @@ namespace horizon
                     return nullptr;
                 }
                 this->post_advance();
-                horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>> temp_vec;
+                ast_declarators temp_vec;
                 while (this->get_token().M_type != token_type::TOKEN_COMMA && this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN && !this->has_reached_end())
                 {
-                    horizon_deps::pair<token, horizon_deps::sptr<ast_node>> temp_pair2;
+                    ast_declarator temp_pair2;
                     std::size_t temp_curr_parser = this->M_current_parser;
                     bool is_data_type = false;
                     while (this->get_token().M_type != token_type::TOKEN_COMMA && this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN && !this->has_reached_end())
@@ -148,7 +257,7 @@ namespace horizon
                         return nullptr;
                     }
                     else if (this->get_token().M_type == token_type::TOKEN_IDENTIFIER)
-                        temp_pair2.raw_first() = new token(std::move(this->get_token()));
+                        temp_pair2.get_first() = std::move(this->get_token());
                     else
                     {
                         this->handle_eof();
@@ -159,8 +268,8 @@ namespace horizon
                     if (this->get_token().M_type == token_type::TOKEN_ASSIGN)
                     {
                         this->post_advance();
-                        temp_pair2.raw_second() = new horizon_deps::sptr<ast_node>(this->parse_operators());
-                        if (!(*temp_pair2.raw_second()))
+                        temp_pair2.get_second() = this->parse_operators();
+                        if (!temp_pair2.get_second())
                             return nullptr;
                         if (this->get_token().M_type == token_type::TOKEN_COMMA)
                             this->post_advance();
@@ -174,7 +283,6 @@ namespace horizon
                     else if (this->get_token().M_type == token_type::TOKEN_COMMA)
                     {
                         this->post_advance();
-                        temp_pair2.raw_second() = nullptr;
                     }
                     else if (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN)
                     {
@@ -184,9 +292,7 @@ namespace horizon
                     }
                     temp_vec.add(std::move(temp_pair2));
                 }
-                temp_vec.shrink_to_fit();
-                temp_pair1.raw_second() = new horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>>(std::move(temp_vec));
-                params.add(std::move(temp_pair1));
+                params.emplace(std::move(type_), std::move(temp_vec));
             }
             params.shrink_to_fit();
             return new ast_parameter_node(std::move(params));
@@ -232,6 +338,8 @@ namespace horizon
             if (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN)
             {
                 parameters = this->parse_parameters();
+                if (!parameters)
+                    return nullptr;
                 if (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN)
                 {
                     this->handle_eof();
@@ -282,7 +390,7 @@ namespace horizon
                 else
                 {
                     expr = this->parse_operators();
-                    if (!this->handle_semicolon())
+                    if (!expr || !this->handle_semicolon())
                         return nullptr;
                 }
             }
@@ -435,7 +543,7 @@ namespace horizon
             if (this->get_token().M_type != token_type::TOKEN_SEMICOLON)
             {
                 condition = this->parse_operators();
-                if (!this->handle_semicolon())
+                if (!condition || !this->handle_semicolon())
                     return nullptr;
             }
             else
@@ -443,6 +551,8 @@ namespace horizon
             if (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN)
             {
                 step = this->parse_operators();
+                if (!step)
+                    return nullptr;
                 if (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN)
                 {
                     this->handle_eof();
@@ -467,8 +577,8 @@ namespace horizon
         {
             if (this->get_token().M_lexeme == "if")
             {
-                horizon_deps::pair<horizon_deps::sptr<ast_node>> if_condition_block = {nullptr, nullptr};
-                horizon_deps::vector<horizon_deps::pair<horizon_deps::sptr<ast_node>>> elif_condition_block;
+                ast_branch if_condition_block;
+                ast_elif_branches elif_condition_block;
                 horizon_deps::sptr<ast_node> else_block = nullptr;
 
                 {
@@ -480,11 +590,11 @@ namespace horizon
                         horizon_errors::errors::parser_draw_error(horizon_errors::error_code::HORIZON_SYNTAX_ERROR, this->M_file, this->get_token(), {"expected '(' before", this->get_token().M_lexeme.wrap("'")});
                         return nullptr;
                     }
-                    if_condition_block.raw_first() = new horizon_deps::sptr<ast_node>(this->parse_operators());
-                    if (!(*if_condition_block.raw_first()))
+                    if_condition_block.get_first() = this->parse_operators();
+                    if (!if_condition_block.get_first())
                         return nullptr;
-                    if_condition_block.raw_second() = new horizon_deps::sptr<ast_node>(this->parse_block());
-                    if (!(*if_condition_block.raw_second()))
+                    if_condition_block.get_second() = this->parse_block();
+                    if (!if_condition_block.get_second())
                         return nullptr;
                 }
 
@@ -492,7 +602,7 @@ namespace horizon
                 {
                     while (this->get_token().M_lexeme == "elif")
                     {
-                        horizon_deps::pair<horizon_deps::sptr<ast_node>> temp = {nullptr, nullptr};
+                        ast_branch temp;
                         this->post_advance();
                         if (this->get_token().M_type != token_type::TOKEN_LEFT_PAREN)
                         {
@@ -500,15 +610,14 @@ namespace horizon
                             horizon_errors::errors::parser_draw_error(horizon_errors::error_code::HORIZON_SYNTAX_ERROR, this->M_file, this->get_token(), {"expected '(' before", this->get_token().M_lexeme.wrap("'")});
                             return nullptr;
                         }
-                        temp.raw_first() = new horizon_deps::sptr<ast_node>(this->parse_operators());
-                        if (!(*temp.raw_first()))
+                        temp.get_first() = this->parse_operators();
+                        if (!temp.get_first())
                             return nullptr;
-                        temp.raw_second() = new horizon_deps::sptr<ast_node>(this->parse_block());
-                        if (!(*temp.raw_second()))
+                        temp.get_second() = this->parse_block();
+                        if (!temp.get_second())
                             return nullptr;
                         elif_condition_block.add(std::move(temp));
                     }
-                    elif_condition_block.shrink_to_fit();
                 }
 
                 if (this->get_token().M_lexeme == "else")
@@ -533,6 +642,9 @@ namespace horizon
         {
             if (this->get_token().M_type == token_type::TOKEN_LEFT_BRACE)
             {
+                std::size_t begin = this->M_token_base + this->M_current_parser;
+                std::size_t parent_base = this->M_block_base;
+                this->M_block_base = begin;
                 this->post_advance();
                 horizon_deps::vector<horizon_deps::sptr<ast_node>> nodes;
                 while (this->get_token().M_type != token_type::TOKEN_RIGHT_BRACE && !this->has_reached_end())
@@ -614,7 +726,8 @@ namespace horizon
                 else
                     this->post_advance();
                 nodes.shrink_to_fit();
-                return new ast_block_node(std::move(nodes));
+                this->M_block_base = parent_base;
+                return new ast_block_node(std::move(nodes), {begin - parent_base, this->M_token_base + this->M_current_parser - parent_base});
             }
             return nullptr;
         }
@@ -624,7 +737,7 @@ namespace horizon
             horizon_deps::sptr<ast_node> type_ = this->parse_data_type();
             if (!type_)
                 return nullptr;
-            horizon_deps::vector<horizon_deps::pair<token, horizon_deps::sptr<ast_node>>> vec(5);
+            ast_declarators vec;
             if (this->get_token().M_type != token_type::TOKEN_COLON)
             {
                 this->handle_eof();
@@ -634,7 +747,7 @@ namespace horizon
             this->post_advance();
             while (this->get_token().M_type != token_type::TOKEN_SEMICOLON && !this->has_reached_end())
             {
-                horizon_deps::pair<token, horizon_deps::sptr<ast_node>> pair;
+                ast_declarator pair;
                 if (this->get_token().M_type == token_type::TOKEN_PRIMARY_TYPE || this->get_token().M_type == token_type::TOKEN_KEYWORD)
                 {
                     this->handle_eof();
@@ -643,7 +756,7 @@ namespace horizon
                 }
                 else if (this->get_token().M_type == token_type::TOKEN_IDENTIFIER)
                 {
-                    pair.raw_first() = new token(std::move(this->get_token()));
+                    pair.get_first() = std::move(this->get_token());
                 }
                 else
                 {
@@ -655,8 +768,8 @@ namespace horizon
                 if (this->get_token().M_type == token_type::TOKEN_ASSIGN)
                 {
                     this->post_advance();
-                    pair.raw_second() = new horizon_deps::sptr<ast_node>(this->parse_operators());
-                    if (!(*pair.raw_second()))
+                    pair.get_second() = this->parse_operators();
+                    if (!pair.get_second())
                         return nullptr;
                     if (this->get_token().M_type == token_type::TOKEN_COMMA)
                         this->post_advance();
@@ -670,7 +783,6 @@ namespace horizon
                 else if (this->get_token().M_type == token_type::TOKEN_COMMA)
                 {
                     this->post_advance();
-                    pair.raw_second() = nullptr;
                 }
                 else if (this->get_token().M_type != token_type::TOKEN_SEMICOLON)
                 {
@@ -680,7 +792,6 @@ namespace horizon
                 }
                 vec.add(std::move(pair));
             }
-            vec.shrink_to_fit();
             return new ast_variable_declaration_node(std::move(type_), std::move(vec));
         }
 
@@ -1006,7 +1117,7 @@ namespace horizon
                 if (this->get_token().M_type == token_type::TOKEN_LEFT_PAREN)
                 {
                     this->post_advance();
-                    horizon_deps::vector<horizon_deps::sptr<ast_node>> vec(5);
+                    ast_arguments vec;
                     while (this->get_token().M_type != token_type::TOKEN_RIGHT_PAREN && !this->has_reached_end())
                     {
                         horizon_deps::sptr<ast_node> temp = this->parse_operators();
@@ -1032,28 +1143,27 @@ namespace horizon
                         horizon_errors::errors::parser_draw_error(horizon_errors::error_code::HORIZON_SYNTAX_ERROR, this->M_file, this->get_token(), {"expected ')', but got", this->get_token().M_lexeme.wrap("'")});
                         return nullptr;
                     }
-                    vec.shrink_to_fit();
                     return new ast_function_call_node(std::move(identifier), std::move(vec));
                 }
                 else
-                    return new ast_operand_node(std::move(identifier.M_lexeme));
+                    return new ast_literal_node(ast_literal_type::AST_LITERAL_IDENTIFIER, identifier.M_lexeme);
             }
             else if (this->get_token().M_type == token_type::TOKEN_KEYWORD)
             {
                 if (this->get_token().M_lexeme == "true")
                 {
                     this->post_advance();
-                    return new ast_operand_node(true);
+                    return new ast_literal_node(true);
                 }
                 else if (this->get_token().M_lexeme == "false")
                 {
                     this->post_advance();
-                    return new ast_operand_node(false);
+                    return new ast_literal_node(false);
                 }
                 else if (this->get_token().M_lexeme == "null")
                 {
                     this->post_advance();
-                    return new ast_operand_node<void *>(nullptr);
+                    return new ast_literal_node(nullptr);
                 }
             }
             return this->parse_brackets();
@@ -1085,21 +1195,19 @@ namespace horizon
         {
             if (this->get_token().M_type == token_type::TOKEN_DECIMAL_LITERAL)
             {
-                return new ast_operand_node(std::strtold(this->post_advance().M_lexeme.c_str(), NULL));
+                return new ast_literal_node(std::strtod(this->post_advance().M_lexeme.c_str(), NULL));
             }
             else if (this->get_token().M_type == token_type::TOKEN_INTEGER_LITERAL)
             {
-                return new ast_operand_node(std::strtoll(this->post_advance().M_lexeme.c_str(), NULL, 10));
+                return new ast_literal_node(std::strtoll(this->post_advance().M_lexeme.c_str(), NULL, 10));
             }
             else if (this->get_token().M_type == token_type::TOKEN_STRING_LITERAL)
             {
-                const char *ptr = this->get_token().M_lexeme.c_str();
-                this->post_advance().M_lexeme.raw() = nullptr;
-                return new ast_operand_node(ptr);
+                return new ast_literal_node(ast_literal_type::AST_LITERAL_STRING, this->post_advance().M_lexeme);
             }
             else if (this->get_token().M_type == token_type::TOKEN_CHAR_LITERAL)
             {
-                return new ast_operand_node(*this->post_advance().M_lexeme.c_str());
+                return new ast_literal_node(*this->post_advance().M_lexeme.c_str());
             }
             else
             {
@@ -1115,16 +1223,246 @@ namespace horizon
             this->M_file = file;
 
             this->M_current_parser = 0;
+            this->M_token_base = 0;
+            this->M_block_base = 0;
+            this->M_token_starts = nullptr;
+            this->M_token_count = 0;
+            this->M_token_starts_cap = 0;
+            this->M_is_hash_consed = false;
+        }
+
+        parser::parser(parser &&other) noexcept(true)
+            : M_tokens(std::move(other.M_tokens)), M_file(other.M_file), M_ast(std::move(other.M_ast)), M_current_parser(other.M_current_parser),
+              M_token_starts(other.M_token_starts), M_token_count(other.M_token_count), M_token_starts_cap(other.M_token_starts_cap),
+              M_token_base(other.M_token_base), M_block_base(other.M_block_base), M_is_hash_consed(other.M_is_hash_consed)
+        {
+            other.M_token_starts = nullptr;
+            other.M_token_count = 0;
+            other.M_token_starts_cap = 0;
         }
 
         bool parser::init_parsing()
         {
-            this->M_ast = this->parse_program();
-            if (!this->M_ast)
+            if (!this->parse_all())
                 return false;
             this->M_tokens.erase();
-            this->M_ast->print();
             return true;
         }
+
+        bool parser::reparse(horizon_deps::vector<token> &tokens, horizon_misc::HR_FILE *file)
+        {
+            // the tokens are only borrowed, moving a vector is just a pointer swap
+            this->M_tokens = std::move(tokens);
+            const horizon_misc::HR_FILE *old_file = this->M_file;
+            this->M_file = file;
+
+            bool is_parsed = this->reparse_changed(old_file);
+            if (!is_parsed)
+                this->M_file = const_cast<horizon_misc::HR_FILE *>(old_file);
+            tokens = std::move(this->M_tokens);
+            return is_parsed;
+        }
+
+        bool parser::reparse_changed(const horizon_misc::HR_FILE *old_file)
+        {
+            if (!this->M_ast || !old_file || this->M_is_hash_consed)
+                return this->parse_all();
+
+            const horizon_deps::string &old_source = old_file->M_content;
+            const horizon_deps::string &new_source = this->M_file->M_content;
+            std::size_t old_len = old_source.length(), new_len = new_source.length();
+            std::size_t min_len = (old_len < new_len ? old_len : new_len);
+            std::size_t same_prefix = parser::common_prefix(old_source.c_str(), new_source.c_str(), min_len);
+            if (same_prefix == old_len && old_len == new_len)
+                return true; // nothing changed
+            std::size_t same_suffix = parser::common_suffix(old_source.c_str() + old_len, new_source.c_str() + new_len, min_len - same_prefix);
+            std::ptrdiff_t byte_delta = static_cast<std::ptrdiff_t>(new_len) - static_cast<std::ptrdiff_t>(old_len);
+            std::size_t old_n = this->M_token_count, new_n = this->M_tokens.length();
+
+            // tokens ending before the first changed byte are unchanged, one more is given up in case the lexer looked ahead into the edit
+            std::size_t first = 0, high = new_n - 1;
+            while (first < high)
+            {
+                std::size_t mid = first + (high - first) / 2;
+                if (this->M_tokens[mid].M_end < same_prefix)
+                    first = mid + 1;
+                else
+                    high = mid;
+            }
+            if (first > 0)
+                first--;
+
+            // the lexer carries no state between tokens, so once a new token starts where an old one did inside of
+            // the unchanged tail, every token from there on is identical in both versions
+            std::size_t new_last = first, old_last = old_n - 1;
+            high = new_n - 1;
+            while (new_last < high)
+            {
+                std::size_t mid = new_last + (high - new_last) / 2;
+                if (this->M_tokens[mid].M_start < new_len - same_suffix)
+                    new_last = mid + 1;
+                else
+                    high = mid;
+            }
+            for (; new_last < new_n - 1; new_last++)
+            {
+                std::size_t target = this->M_tokens[new_last].M_start - byte_delta, low = first;
+                high = old_n - 1;
+                while (low < high)
+                {
+                    std::size_t mid = low + (high - low) / 2;
+                    if (this->M_token_starts[mid] < target)
+                        low = mid + 1;
+                    else
+                        high = mid;
+                }
+                if (low < old_n - 1 && this->M_token_starts[low] == target)
+                {
+                    old_last = low;
+                    break;
+                }
+            }
+            if (new_last >= new_n - 1)
+            {
+                // only the end of file token is shared
+                new_last = new_n - 1;
+                old_last = old_n - 1;
+            }
+            if (first > old_last)
+                return this->parse_all();
+            std::ptrdiff_t token_delta = static_cast<std::ptrdiff_t>(new_last) - static_cast<std::ptrdiff_t>(old_last);
+            // old byte offset from which reused tokens have to move by `byte_delta`
+            std::size_t shift_from = (old_last < old_n - 1 ? this->M_token_starts[old_last] : old_len);
+
+            ast_program_node *program = static_cast<ast_program_node *>(this->M_ast.raw());
+            horizon_deps::vector<horizon_deps::sptr<ast_node>> &nodes = program->get_nodes();
+            horizon_deps::vector<ast_token_range> &ranges = program->get_ranges();
+            horizon_deps::vector<std::ptrdiff_t> &byte_shifts = program->get_byte_shifts();
+
+            // the last top-level declaration starting at or before the edit has to contain all of it
+            std::size_t low = 0;
+            high = ranges.length();
+            while (low < high)
+            {
+                std::size_t mid = low + (high - low) / 2;
+                if (ranges[mid].M_begin <= first)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            if (low == 0 || first >= ranges[low - 1].M_end || old_last > ranges[low - 1].M_end)
+                return this->parse_all();
+            std::size_t decl = low - 1;
+
+            // descend into the smallest block whose braces enclose the edit
+            horizon_deps::vector<horizon_deps::sptr<ast_node> *> chain;
+            horizon_deps::vector<std::size_t> chain_bases;
+            horizon_deps::sptr<ast_node> *slot = &nodes[decl];
+            std::size_t base = ranges[decl].M_begin;
+            for (bool is_found = true; is_found;)
+            {
+                is_found = false;
+                ast_block_slots blocks;
+                (*slot)->get_blocks(blocks);
+                for (horizon_deps::sptr<ast_node> *i : blocks)
+                {
+                    const ast_token_range *range = (*i)->get_block_range();
+                    if (base + range->M_begin < first && old_last < base + range->M_end)
+                    {
+                        chain.add(i);
+                        chain_bases.add(base);
+                        base += range->M_begin;
+                        slot = i;
+                        is_found = true;
+                        break;
+                    }
+                }
+            }
+
+            std::size_t begin, end, block_base;
+            if (chain.is_empty())
+            {
+                begin = ranges[decl].M_begin;
+                end = ranges[decl].M_end + token_delta;
+                block_base = begin;
+            }
+            else
+            {
+                block_base = chain_bases[chain.length() - 1];
+                begin = block_base + (*slot)->get_block_range()->M_begin;
+                end = block_base + (*slot)->get_block_range()->M_end + token_delta;
+            }
+            if (!this->is_balanced_region(begin, end))
+                return this->parse_all();
+            bool has_error = false;
+            horizon_deps::sptr<ast_node> node = this->parse_region(begin, end, block_base, !chain.is_empty(), has_error);
+            if (!node)
+                return has_error ? false : this->parse_all();
+
+            // the edited declaration is brought up to date before splicing the new node in, later declarations
+            // only record the shift so that the cost of an edit does not grow with the rest of the file
+            if (byte_shifts[decl] != 0)
+                nodes[decl]->shift_positions(byte_shifts[decl], 0);
+            if (byte_delta != 0)
+                nodes[decl]->shift_positions(byte_delta, shift_from);
+            byte_shifts[decl] = 0;
+            *slot = std::move(node);
+
+            // enclosing blocks grow by the edit and their later siblings move along with it
+            for (std::size_t i = 0; i < chain.length(); i++)
+            {
+                if (i + 1 < chain.length())
+                    (*chain[i])->get_block_range()->M_end += token_delta;
+                ast_block_slots siblings;
+                (i == 0 ? nodes[decl] : *chain[i - 1])->get_blocks(siblings);
+                for (horizon_deps::sptr<ast_node> *j : siblings)
+                {
+                    ast_token_range *range = (*j)->get_block_range();
+                    if (j != chain[i] && chain_bases[i] + range->M_begin >= old_last)
+                    {
+                        range->M_begin += token_delta;
+                        range->M_end += token_delta;
+                    }
+                }
+            }
+            ranges[decl].M_end += token_delta;
+            for (std::size_t i = decl + 1; i < ranges.length(); i++)
+            {
+                ranges[i].M_begin += token_delta;
+                ranges[i].M_end += token_delta;
+                byte_shifts[i] += byte_delta;
+            }
+
+            // token offsets: unchanged head, freshly lexed middle, shifted tail
+            this->reserve_token_starts(new_n);
+            if (new_last != old_last)
+                std::memmove(this->M_token_starts + new_last, this->M_token_starts + old_last, (old_n - old_last) * sizeof(std::size_t));
+            for (std::size_t i = first; i < new_last; i++)
+                this->M_token_starts[i] = this->M_tokens[i].M_start;
+            if (byte_delta != 0)
+                for (std::size_t i = new_last; i < new_n - 1; i++) // the end of file token has no offset
+                    this->M_token_starts[i] += byte_delta;
+            this->M_token_count = new_n;
+            return true;
+        }
+
+        std::size_t parser::hash_cons()
+        {
+            ast_hash_cons table;
+            table.intern(this->M_ast);
+            this->M_is_hash_consed = true;
+            return table.get_shared_count();
+        }
+
+        const horizon_deps::sptr<ast_node> &parser::get_ast() const
+        {
+            return this->M_ast;
+        }
+
+        parser::~parser()
+        {
+            horizon_deps::deallocate(this->M_token_starts);
+            this->M_token_starts = nullptr;
+        }
     }
 }
\ No newline at end of file
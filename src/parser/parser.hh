@@ -14,6 +14,7 @@
 #include "../defines/keywords_primary_data_types.h"
 #include "../errors/errors.hh"
 #include "../misc/file/file.hh"
+#include "../misc/trace.hh"
 #include "./ast/ast.hh"
 
 namespace horizon
@@ -29,6 +30,13 @@ namespace horizon
 
             std::size_t M_current_parser;
 
+            // incremental reparsing
+            std::size_t *M_token_starts; // byte offset of every token of the last successful parse, spliced in place on reparse
+            std::size_t M_token_count, M_token_starts_cap;
+            std::size_t M_token_base; // absolute index of `M_tokens[0]`, non-zero only while reparsing a region
+            std::size_t M_block_base; // absolute index that block ranges are relative to
+            bool M_is_hash_consed;    // shared nodes may alias into any subtree, so such a tree is never patched in place
+
           private:
             [[nodiscard]] bool has_reached_end() const;
             token &post_advance();
@@ -38,7 +46,17 @@ namespace horizon
             [[nodiscard]] bool handle_semicolon();
             void handle_eof();
 
+            [[nodiscard]] static std::size_t common_prefix(const char *a, const char *b, const std::size_t &len);
+            [[nodiscard]] static std::size_t common_suffix(const char *a_end, const char *b_end, const std::size_t &len);
+            void save_token_starts();
+            void reserve_token_starts(const std::size_t &count);
+            [[nodiscard]] bool is_balanced_region(const std::size_t &begin, const std::size_t &end) const;
+            [[nodiscard]] horizon_deps::sptr<ast_node> parse_region(const std::size_t &begin, const std::size_t &end, const std::size_t &block_base, const bool &is_block, bool &has_error);
+            [[nodiscard]] bool parse_all();
+            [[nodiscard]] bool reparse_changed(const horizon_misc::HR_FILE *old_file);
+
             [[nodiscard]] horizon_deps::sptr<ast_node> parse_program();
+            [[nodiscard]] horizon_deps::sptr<ast_node> parse_top_level();
             [[nodiscard]] horizon_deps::sptr<ast_node> parse_data_type();
             [[nodiscard]] horizon_deps::sptr<ast_node> parse_parameters();
             [[nodiscard]] horizon_deps::sptr<ast_node> parse_function();
@@ -72,7 +90,28 @@ namespace horizon
 
           public: // non-static public functions
             parser(horizon_deps::vector<token> &&movable_tokens, horizon_misc::HR_FILE *file);
+            parser(const parser &) = delete;
+            parser(parser &&other) noexcept(true);
+            parser &operator=(const parser &) = delete;
             [[nodiscard]] bool init_parsing();
+
+            /**
+             * @brief Reparses an edited version of the source, reusing every top-level declaration and block that the diff
+             * against the previous parse did not touch; only the smallest function or block enclosing the edit is parsed again.
+             * `tokens` stays owned by the caller, its lexemes are only moved out if the edit forces a full parse. The file given to
+             * the previous parse is diffed against `file`, so it has to stay alive until this returns
+             * @return false on a syntax error, the previous AST is kept in that case
+             */
+            [[nodiscard]] bool reparse(horizon_deps::vector<token> &tokens, horizon_misc::HR_FILE *file);
+
+            /**
+             * @brief Replaces every expression subtree that is structurally identical to an earlier one by a shared node
+             * @return number of subtrees that were replaced
+             */
+            std::size_t hash_cons();
+
+            [[nodiscard]] const horizon_deps::sptr<ast_node> &get_ast() const;
+            ~parser();
         };
     }
 }
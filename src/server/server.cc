@@ -0,0 +1,470 @@
+/**
+ * @file server.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include "./server.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "../../deps/sptr/sptr.hh"
+#include "../../deps/string/str_view.hh"
+#include "../colorize/colorize.h"
+#include "../defines/defines.h"
+#include "../driver/driver.hh"
+#include "../misc/options.hh"
+#include "../parser/ast/string_table.hh"
+
+namespace horizon
+{
+    namespace horizon_server
+    {
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+        horizon_deps::string default_socket()
+        {
+            return horizon_deps::string();
+        }
+
+        int serve(const char *)
+        {
+            if (COLOR_ERR)
+                std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " '--server' is not supported on this platform\n");
+            else
+                std::fprintf(stderr, "horizon: error: '--server' is not supported on this platform\n");
+            return EXIT_FAILURE;
+        }
+
+        int forward(const char *, const horizon_deps::vector<horizon_deps::string> &)
+        {
+            return -1;
+        }
+#else
+        namespace
+        {
+            constexpr char MAGIC[4] = {'H', 'R', 'Z', '1'};
+            constexpr std::uint32_t MAX_REQUEST = 64u << 20;
+            constexpr time_t REQUEST_TIMEOUT = 10; // seconds a client may take to send its request
+
+            // for the signal handler, which may only unlink it
+            char listening_path[sizeof(sockaddr_un::sun_path)];
+
+            void on_signal(int)
+            {
+                ::unlink(listening_path);
+                ::_exit(EXIT_SUCCESS);
+            }
+
+            void print_socket_error(const char *what, const char *path)
+            {
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " %s " ENCLOSE(WHITE_FG, "'%s'") ": %s\n", what, path, std::strerror(errno));
+                else
+                    std::fprintf(stderr, "horizon: error: %s '%s': %s\n", what, path, std::strerror(errno));
+            }
+
+            bool address_of(const char *path, sockaddr_un &addr)
+            {
+                std::size_t len = std::strlen(path);
+                if (len >= sizeof(addr.sun_path))
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " socket path " ENCLOSE(WHITE_FG, "'%s'") " is too long\n", path);
+                    else
+                        std::fprintf(stderr, "horizon: error: socket path '%s' is too long\n", path);
+                    return false;
+                }
+                std::memset(&addr, 0, sizeof(addr));
+                addr.sun_family = AF_UNIX;
+                std::memcpy(addr.sun_path, path, len + 1);
+                return true;
+            }
+
+            // -1 if nothing listens at `addr`
+            int connect_to(const sockaddr_un &addr)
+            {
+                int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd == -1)
+                    return -1;
+                if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == -1)
+                {
+                    int err = errno;
+                    ::close(fd);
+                    errno = err;
+                    return -1;
+                }
+                return fd;
+            }
+
+            /**
+             * The other end of `conn` is a process of this user. Anybody who can reach the socket could otherwise get a
+             * client's stdout, stderr and working directory, or have the server write where the user can
+             */
+            bool same_user(int conn)
+            {
+#if defined __linux__
+                ucred cred;
+                socklen_t len = sizeof(cred);
+                return ::getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == ::getuid();
+#else
+                uid_t uid;
+                gid_t gid;
+                return ::getpeereid(conn, &uid, &gid) == 0 && uid == ::getuid();
+#endif
+            }
+
+            bool write_all(int fd, const char *data, std::size_t len)
+            {
+                while (len > 0)
+                {
+                    ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+                    if (n == -1 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        return false;
+                    data += n;
+                    len -= static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+
+            bool read_all(int fd, char *data, std::size_t len)
+            {
+                while (len > 0)
+                {
+                    ssize_t n = ::read(fd, data, len);
+                    if (n == -1 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        return false;
+                    data += n;
+                    len -= static_cast<std::size_t>(n);
+                }
+                return true;
+            }
+
+            void append_u32(horizon_deps::string &out, const std::uint32_t &val)
+            {
+                char bytes[sizeof(val)];
+                std::memcpy(bytes, &val, sizeof(val));
+                out.append(horizon_deps::str_view(bytes, sizeof(val)));
+            }
+
+            void append_field(horizon_deps::string &out, const char *data, const std::size_t &len)
+            {
+                append_u32(out, static_cast<std::uint32_t>(len));
+                out.append(horizon_deps::str_view(data, len));
+            }
+
+            // reads the u32 at `pos` of `body`, false if it runs past the end
+            bool take_u32(const horizon_deps::string &body, std::size_t &pos, std::uint32_t &val)
+            {
+                if (body.length() - pos < sizeof(val))
+                    return false;
+                std::memcpy(&val, body.c_str() + pos, sizeof(val));
+                pos += sizeof(val);
+                return true;
+            }
+
+            bool take_field(const horizon_deps::string &body, std::size_t &pos, horizon_deps::string &field)
+            {
+                std::uint32_t len = 0;
+                if (!take_u32(body, pos, len) || body.length() - pos < len)
+                    return false;
+                field = horizon_deps::string(body.c_str() + pos, body.c_str() + pos + len);
+                pos += len;
+                return true;
+            }
+
+            /**
+             * A request is MAGIC, sent together with the client's stdout and stderr (SCM_RIGHTS), then a u32 length and as many
+             * bytes of body: the u32 count of arguments, each argument and the client's working directory as a u32 length and
+             * its bytes. The reply is the i32 exit code. All integers are in host byte order, both ends run on the same machine
+             */
+            bool receive_request(int conn, int (&fds)[2], horizon_deps::vector<horizon_deps::string> &args, horizon_deps::string &cwd)
+            {
+                char magic[sizeof(MAGIC)];
+                iovec iov = {magic, sizeof(magic)};
+                alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+                msghdr msg;
+                std::memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                ssize_t n;
+                do
+                    n = ::recvmsg(conn, &msg, MSG_CMSG_CLOEXEC);
+                while (n == -1 && errno == EINTR);
+                cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+                if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                    return false;
+                std::size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                if (received > 0)
+                    std::memcpy(fds, CMSG_DATA(cmsg), (received < 2 ? received : 2) * sizeof(int));
+                if (received != 2 || n != static_cast<ssize_t>(sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(magic)) != 0)
+                    return false; // the caller closes whatever was received
+
+                std::uint32_t len = 0;
+                if (!read_all(conn, reinterpret_cast<char *>(&len), sizeof(len)) || len > MAX_REQUEST)
+                    return false;
+                horizon_deps::string body;
+                char chunk[4096];
+                for (std::uint32_t left = len; left > 0;)
+                {
+                    std::size_t part = (left < sizeof(chunk) ? left : sizeof(chunk));
+                    if (!read_all(conn, chunk, part))
+                        return false;
+                    body.append(horizon_deps::str_view(chunk, part));
+                    left -= static_cast<std::uint32_t>(part);
+                }
+
+                std::size_t pos = 0;
+                std::uint32_t argc = 0;
+                if (!take_u32(body, pos, argc) || argc > len)
+                    return false;
+                for (std::uint32_t i = 0; i < argc; i++)
+                {
+                    horizon_deps::string arg;
+                    if (!take_field(body, pos, arg))
+                        return false;
+                    args.add(std::move(arg));
+                }
+                return take_field(body, pos, cwd) && pos == body.length();
+            }
+
+            /**
+             * Compiles one command line as if `horizon` had been run with it in `cwd`, writing to `fds`
+             */
+            int compile_request(horizon_driver::compile_cache &cache, const int (&fds)[2], const horizon_deps::vector<horizon_deps::string> &args, const horizon_deps::string &cwd)
+            {
+                if (::dup2(fds[0], STDOUT_FILENO) == -1 || ::dup2(fds[1], STDERR_FILENO) == -1)
+                    return EXIT_FAILURE;
+                if (::chdir(cwd.c_str()) == -1)
+                {
+                    print_socket_error("cannot change to the directory", cwd.c_str());
+                    return EXIT_FAILURE;
+                }
+
+                horizon_deps::vector<char *> argv(args.length() + 2);
+                argv.add(const_cast<char *>("horizon"));
+                for (const horizon_deps::string &arg : args)
+                    argv.add(const_cast<char *>(arg.c_str()));
+                argv.add(nullptr);
+                horizon_deps::sptr<horizon_misc::options> opts = horizon_misc::parse_options(static_cast<int>(args.length() + 1), argv.raw());
+                if (!opts)
+                    return EXIT_FAILURE; // error message is already printed
+                if (opts->M_server != horizon_misc::server_mode::SERVER_NONE)
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " '--server' and '--client' cannot be sent to a server\n");
+                    else
+                        std::fprintf(stderr, "horizon: error: '--server' and '--client' cannot be sent to a server\n");
+                    return EXIT_FAILURE;
+                }
+                return horizon_driver::run(*opts, &cache);
+            }
+        }
+
+        horizon_deps::string default_socket()
+        {
+            const char *runtime = std::getenv("XDG_RUNTIME_DIR");
+            if (runtime && *runtime)
+                return horizon_deps::string(runtime).append("/horizon.sock");
+
+            // anybody can create names in /tmp, so the socket goes into a directory that only this user can use
+            horizon_deps::string dir = horizon_deps::string("/tmp/horizon-").append(horizon_deps::string::to_string(static_cast<unsigned int>(::getuid())));
+            if (::mkdir(dir.c_str(), 0700) == -1 && errno != EEXIST)
+            {
+                print_socket_error("cannot create the directory", dir.c_str());
+                return horizon_deps::string();
+            }
+            struct stat st;
+            if (::lstat(dir.c_str(), &st) == -1 || !S_ISDIR(st.st_mode) || st.st_uid != ::getuid() || (st.st_mode & 077) != 0)
+            {
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " " ENCLOSE(WHITE_FG, "'%s'") " is not a directory that only this user can access\n", dir.c_str());
+                else
+                    std::fprintf(stderr, "horizon: error: '%s' is not a directory that only this user can access\n", dir.c_str());
+                return horizon_deps::string();
+            }
+            return dir.append("/horizon.sock");
+        }
+
+        int serve(const char *path)
+        {
+            sockaddr_un addr;
+            if (!address_of(path, addr))
+                return EXIT_FAILURE;
+            int other = connect_to(addr);
+            if (other != -1)
+            {
+                ::close(other);
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " a server is already listening on " ENCLOSE(WHITE_FG, "'%s'") "\n", path);
+                else
+                    std::fprintf(stderr, "horizon: error: a server is already listening on '%s'\n", path);
+                return EXIT_FAILURE;
+            }
+            ::unlink(path); // left behind by a server that did not exit cleanly
+
+            int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (listener == -1 || ::bind(listener, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == -1 || ::chmod(path, 0600) == -1 || ::listen(listener, 16) == -1)
+            {
+                print_socket_error("cannot listen on", path);
+                if (listener != -1)
+                    ::close(listener);
+                return EXIT_FAILURE;
+            }
+            std::memcpy(listening_path, addr.sun_path, sizeof(listening_path));
+            std::signal(SIGINT, on_signal);
+            std::signal(SIGTERM, on_signal);
+            std::signal(SIGPIPE, SIG_IGN); // a client that went away must not take the server with it
+
+            // requests swap these in and out
+            int own_out = ::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 3);
+            int own_err = ::fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 3);
+            int own_dir = ::open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            std::fprintf(stderr, "horizon: listening on '%s'\n", path);
+
+            horizon_driver::compile_cache cache;
+            for (std::size_t request = 1;;)
+            {
+                int conn = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (conn == -1)
+                    continue;
+                if (!same_user(conn))
+                {
+                    std::fprintf(stderr, "horizon: request %zu: from another user, dropped\n", request++);
+                    ::close(conn);
+                    continue;
+                }
+                // one client at a time is served, one that never sends its request must not keep the others waiting
+                timeval timeout = {REQUEST_TIMEOUT, 0};
+                (void)::setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                char first;
+                if (::recv(conn, &first, 1, MSG_PEEK) <= 0)
+                {
+                    // another `--server` checking whether this one is running, or a client that timed out
+                    ::close(conn);
+                    continue;
+                }
+                int fds[2] = {-1, -1};
+                horizon_deps::vector<horizon_deps::string> args;
+                horizon_deps::string cwd;
+                if (receive_request(conn, fds, args, cwd))
+                {
+                    std::int32_t exit_code = compile_request(cache, fds, args, cwd);
+                    std::fflush(stdout);
+                    std::fflush(stderr);
+                    ::dup2(own_out, STDOUT_FILENO);
+                    ::dup2(own_err, STDERR_FILENO);
+                    if (own_dir != -1)
+                        (void)::fchdir(own_dir);
+                    std::fprintf(stderr, "horizon: request %zu: %zu cached, %zu compiled, exit code %d, %u strings interned\n", request, cache.hits(), cache.misses(), exit_code, horizon_parser::string_table::instance().count());
+                    cache.next_request();
+                    (void)write_all(conn, reinterpret_cast<const char *>(&exit_code), sizeof(exit_code));
+                }
+                else
+                {
+                    std::fprintf(stderr, "horizon: request %zu: malformed, dropped\n", request);
+                }
+                for (int fd : fds)
+                    if (fd != -1)
+                        ::close(fd);
+                ::close(conn);
+                request++;
+            }
+        }
+
+        int forward(const char *path, const horizon_deps::vector<horizon_deps::string> &args)
+        {
+            sockaddr_un addr;
+            if (!address_of(path, addr))
+                return -1;
+            char cwd[4096];
+            if (!::getcwd(cwd, sizeof(cwd)))
+                return -1;
+            int conn = connect_to(addr);
+            if (conn == -1)
+            {
+                // the socket is there but nothing accepts: the server was killed or crashed, say so rather than hiding it
+                if (errno == ECONNREFUSED)
+                {
+                    if (COLOR_ERR)
+                        std::fprintf(stderr, "horizon: " ENCLOSE(YELLOW_FG, "warning:") " no server answers on " ENCLOSE(WHITE_FG, "'%s'") ", compiling without it\n", path);
+                    else
+                        std::fprintf(stderr, "horizon: warning: no server answers on '%s', compiling without it\n", path);
+                }
+                return -1;
+            }
+            if (!same_user(conn))
+            {
+                // it would get this process's stdout, stderr, working directory and arguments
+                ::close(conn);
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " the server on " ENCLOSE(WHITE_FG, "'%s'") " belongs to another user\n", path);
+                else
+                    std::fprintf(stderr, "horizon: error: the server on '%s' belongs to another user\n", path);
+                return EXIT_FAILURE;
+            }
+
+            horizon_deps::string body;
+            append_u32(body, static_cast<std::uint32_t>(args.length()));
+            for (const horizon_deps::string &arg : args)
+                append_field(body, arg.c_str(), arg.length());
+            append_field(body, cwd, std::strlen(cwd));
+
+            char magic[sizeof(MAGIC)];
+            std::memcpy(magic, MAGIC, sizeof(magic));
+            iovec iov = {magic, sizeof(magic)};
+            int fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+            std::memset(control, 0, sizeof(control));
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+            std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+            // whatever is buffered goes out before the server writes to the same files
+            std::fflush(stdout);
+            std::fflush(stderr);
+            std::uint32_t len = static_cast<std::uint32_t>(body.length());
+            std::int32_t exit_code = EXIT_FAILURE;
+            if (::sendmsg(conn, &msg, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(magic)) || !write_all(conn, reinterpret_cast<const char *>(&len), sizeof(len)) || !write_all(conn, body.c_str(), body.length()) || !read_all(conn, reinterpret_cast<char *>(&exit_code), sizeof(exit_code)))
+            {
+                // the server may have printed some of the output already, compiling here too would print it twice
+                if (COLOR_ERR)
+                    std::fprintf(stderr, "horizon: " ENCLOSE(RED_FG, "error:") " lost the connection to the server on " ENCLOSE(WHITE_FG, "'%s'") "\n", path);
+                else
+                    std::fprintf(stderr, "horizon: error: lost the connection to the server on '%s'\n", path);
+                exit_code = EXIT_FAILURE;
+            }
+            ::close(conn);
+            return exit_code;
+        }
+#endif
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * @file server.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_SERVER_SERVER_HH
+#define HORIZON_SERVER_SERVER_HH
+
+#include "../../deps/string/string.hh"
+#include "../../deps/vector/vector.hh"
+
+namespace horizon
+{
+    namespace horizon_server
+    {
+        /**
+         * @brief `$XDG_RUNTIME_DIR/horizon.sock`, or without it `/tmp/horizon-<uid>/horizon.sock` in a directory made only
+         * accessible to this user. Prints the error and returns an empty string if that directory is not
+         */
+        [[nodiscard]] horizon_deps::string default_socket();
+
+        /**
+         * @brief `--server`: listens on the Unix domain socket `path` and compiles the command lines that `forward` sends, one at
+         * a time, with a `horizon_driver::compile_cache` kept between them. Output and diagnostics go to the client's stdout and
+         * stderr, which come with the request. Returns only if the socket cannot be set up, until then SIGINT and SIGTERM remove
+         * the socket and exit. Connections of other users are dropped. The strings of every AST stay in the process-wide
+         * `horizon_parser::string_table` until the cache has no file left; the whole cache is dropped once the table holds more
+         * than `compile_cache::MAX_STRINGS` strings, and each request's log line gives its size
+         */
+        [[nodiscard]] int serve(const char *path);
+
+        /**
+         * @brief `--client`: has the server at `path` compile `args` (without the program name) in the current directory
+         * @return the exit code of the compilation, -1 if no server is listening at `path`. A server of another user gets nothing
+         */
+        [[nodiscard]] int forward(const char *path, const horizon_deps::vector<horizon_deps::string> &args);
+    }
+}
+
+#endif
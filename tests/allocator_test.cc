@@ -0,0 +1,213 @@
+/**
+ * @file allocator_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// The arena, pool and counting allocators, and blocks going back to the allocator recorded in their header after the
+// `allocator_scope` they came from has ended. A counting_allocator underneath shows what reaches upstream
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "../deps/allocator/allocator.hh"
+#include "./test.hh"
+
+namespace
+{
+    namespace hd = horizon::horizon_deps;
+
+    bool aligned(const void *ptr)
+    {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignof(std::max_align_t) == 0;
+    }
+
+    void arena()
+    {
+        hd::counting_allocator upstream;
+        {
+            hd::arena_allocator arena(1024, upstream);
+            HORIZON_CHECK(arena.reserved() == 0);
+            char *a = static_cast<char *>(arena.allocate(40));
+            char *b = static_cast<char *>(arena.allocate(24));
+            HORIZON_CHECK(a && b && aligned(a) && aligned(b) && b > a);
+            HORIZON_CHECK(upstream.stats().M_allocs == 1 && arena.reserved() == 1024);
+            std::memset(a, 'a', 40);
+            std::memset(b, 'b', 24);
+
+            // the last block grows and shrinks where it is
+            HORIZON_CHECK(arena.reallocate(b, 24, 200) == b);
+            HORIZON_CHECK(arena.reallocate(b, 200, 8) == b && b[0] == 'b');
+            // an older one is copied when it grows, and stays when it shrinks
+            char *moved = static_cast<char *>(arena.reallocate(a, 40, 100));
+            HORIZON_CHECK(moved && moved != a && aligned(moved));
+            HORIZON_CHECK(moved && moved[0] == 'a' && moved[39] == 'a');
+            HORIZON_CHECK(arena.reallocate(b, 8, 4) == b);
+
+            // only the last block is taken back
+            arena.deallocate(moved, 100);
+            HORIZON_CHECK(arena.allocate(16) == moved);
+            char *next = static_cast<char *>(arena.allocate(16));
+            arena.deallocate(a, 40);
+            HORIZON_CHECK(arena.allocate(16) != a);
+            HORIZON_CHECK(next != a);
+
+            // a block bigger than the next chunk gets a chunk of its own
+            char *big = static_cast<char *>(arena.allocate(10000));
+            HORIZON_CHECK(big && aligned(big));
+            std::size_t chunks = upstream.stats().M_allocs;
+            HORIZON_CHECK(chunks == 2 && arena.reserved() > 10000);
+            for (int i = 0; i < 100; i++)
+                (void)arena.allocate(1000);
+            chunks = upstream.stats().M_allocs;
+            HORIZON_CHECK(chunks > 2);
+
+            // reset keeps only the newest chunk, and allocates from it again without asking upstream
+            arena.reset();
+            HORIZON_CHECK(upstream.stats().M_frees == chunks - 1);
+            HORIZON_CHECK(arena.reserved() == upstream.stats().M_live);
+            for (int i = 0; i < 10; i++)
+                HORIZON_CHECK(aligned(arena.allocate(100)));
+            HORIZON_CHECK(upstream.stats().M_allocs == chunks);
+
+            arena.release();
+            HORIZON_CHECK(arena.reserved() == 0 && upstream.stats().M_live == 0);
+            HORIZON_CHECK(arena.allocate(8) != nullptr);
+        }
+        // and the destructor frees what was taken after release
+        HORIZON_CHECK(upstream.stats().M_live == 0 && upstream.stats().M_frees == upstream.stats().M_allocs);
+    }
+
+    void pool()
+    {
+        hd::counting_allocator upstream;
+        {
+            hd::pool_allocator pool(upstream);
+            constexpr std::size_t GRANULE = hd::pool_allocator::GRANULE, MAX = hd::pool_allocator::MAX_POOLED;
+
+            // sizes 1 to GRANULE share a class, GRANULE + 1 is the next one
+            void *small = pool.allocate(GRANULE);
+            HORIZON_CHECK(small && aligned(small));
+            std::size_t chunks = upstream.stats().M_allocs;
+            pool.deallocate(small, GRANULE);
+            HORIZON_CHECK(pool.allocate(1) == small);
+            void *other = pool.allocate(GRANULE + 1);
+            HORIZON_CHECK(other != small && aligned(other));
+            pool.deallocate(small, 1);
+            HORIZON_CHECK(pool.allocate(GRANULE + 1) != small);
+            HORIZON_CHECK(pool.allocate(GRANULE) == small);
+
+            // MAX_POOLED is the largest pooled size, still without going upstream once a chunk is there
+            void *largest = pool.allocate(MAX);
+            HORIZON_CHECK(largest && aligned(largest));
+            pool.deallocate(largest, MAX);
+            HORIZON_CHECK(pool.allocate(MAX - GRANULE + 1) == largest);
+            HORIZON_CHECK(upstream.stats().M_allocs == chunks);
+
+            // one byte more goes straight upstream, both ways
+            void *direct = pool.allocate(MAX + 1);
+            HORIZON_CHECK(direct && upstream.stats().M_allocs == chunks + 1 && upstream.stats().M_bytes >= MAX + 1);
+            std::memset(direct, 'd', MAX + 1);
+            void *grown = pool.reallocate(direct, MAX + 1, 4 * MAX);
+            HORIZON_CHECK(grown && upstream.stats().M_reallocs == 1 && static_cast<char *>(grown)[MAX] == 'd');
+            pool.deallocate(grown, 4 * MAX);
+            HORIZON_CHECK(upstream.stats().M_frees == 1);
+
+            // reallocating within a class keeps the block, across classes copies it
+            char *block = static_cast<char *>(pool.allocate(20));
+            std::memset(block, 'x', 20);
+            HORIZON_CHECK(pool.reallocate(block, 20, 2 * GRANULE) == block);
+            char *copied = static_cast<char *>(pool.reallocate(block, 2 * GRANULE, 3 * GRANULE));
+            HORIZON_CHECK(copied && copied != block && copied[0] == 'x' && copied[19] == 'x');
+            // and the old block is free for its class again
+            HORIZON_CHECK(pool.allocate(2 * GRANULE) == block);
+            // out of the pool into upstream
+            char *out = static_cast<char *>(pool.reallocate(copied, 3 * GRANULE, 2 * MAX));
+            HORIZON_CHECK(out && out[0] == 'x' && upstream.stats().M_allocs == chunks + 2);
+            pool.deallocate(out, 2 * MAX);
+        }
+        HORIZON_CHECK(upstream.stats().M_live == 0);
+    }
+
+    void headers_outlive_scopes()
+    {
+        hd::counting_allocator counter;
+        void *ptr;
+        {
+            hd::allocator_scope scope(counter);
+            HORIZON_CHECK(&hd::current_allocator() == &counter);
+            {
+                hd::allocator_scope inner(hd::malloc_allocator::instance());
+                HORIZON_CHECK(&hd::current_allocator() == &hd::malloc_allocator::instance());
+            }
+            HORIZON_CHECK(&hd::current_allocator() == &counter);
+            ptr = hd::allocate(100);
+        }
+        HORIZON_CHECK(&hd::current_allocator() == &hd::malloc_allocator::instance());
+        HORIZON_CHECK(ptr && aligned(ptr) && counter.stats().M_allocs == 1);
+        std::memset(ptr, 'p', 100);
+
+        // grown and freed through the counter, though it is not the current allocator anymore
+        ptr = hd::reallocate(ptr, 5000);
+        HORIZON_CHECK(ptr && static_cast<char *>(ptr)[99] == 'p' && counter.stats().M_reallocs == 1);
+        hd::deallocate(ptr);
+        HORIZON_CHECK(counter.stats().M_frees == 1 && counter.stats().M_live == 0);
+
+        // a block from an arena scope is taken back by that arena
+        hd::arena_allocator arena;
+        void *last;
+        {
+            hd::allocator_scope scope(arena);
+            last = hd::allocate(64);
+        }
+        hd::deallocate(last);
+        {
+            hd::allocator_scope scope(arena);
+            HORIZON_CHECK(hd::allocate(64) == last);
+        }
+        hd::deallocate(nullptr);
+        void *fresh = hd::reallocate(nullptr, 10);
+        HORIZON_CHECK(fresh != nullptr);
+        hd::deallocate(fresh);
+    }
+
+    void counting()
+    {
+        std::FILE *trace = std::tmpfile();
+        hd::counting_allocator counter(hd::malloc_allocator::instance(), trace);
+        void *a = counter.allocate(100);
+        void *b = counter.allocate(50);
+        a = counter.reallocate(a, 100, 300); // live 350, the peak
+        b = counter.reallocate(b, 50, 10);
+        const hd::allocator_stats &stats = counter.stats();
+        HORIZON_CHECK(stats.M_allocs == 2 && stats.M_reallocs == 2 && stats.M_frees == 0);
+        HORIZON_CHECK(stats.M_bytes == 350);
+        HORIZON_CHECK(stats.M_live == 310 && stats.M_peak == 350);
+        counter.deallocate(a, 300);
+        counter.deallocate(b, 10);
+        counter.deallocate(nullptr, 0);
+        HORIZON_CHECK(stats.M_frees == 2 && stats.M_live == 0 && stats.M_peak == 350 && stats.M_bytes == 350);
+
+        // one line per call
+        if (trace)
+        {
+            std::rewind(trace);
+            int lines = 0, c;
+            while ((c = std::fgetc(trace)) != EOF)
+                lines += c == '\n';
+            HORIZON_CHECK(lines == 7);
+            std::fclose(trace);
+        }
+    }
+}
+
+int main()
+{
+    arena();
+    pool();
+    headers_outlive_scopes();
+    counting();
+    return horizon::horizon_tests::result();
+}
@@ -0,0 +1,41 @@
+/**
+ * @file api_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#include <cstring>
+
+#include "../src/api/api.hh"
+#include "./test.hh"
+
+int main()
+{
+    horizon::horizon_api::compilation_context ctx;
+
+    // empty sources, with and without data behind them
+    HORIZON_CHECK(ctx.compile(horizon::horizon_deps::str_view()));
+    HORIZON_CHECK(ctx.errors().is_empty());
+    HORIZON_CHECK(ctx.compile(horizon::horizon_deps::str_view("", 0)));
+    HORIZON_CHECK(ctx.errors().is_empty());
+
+    HORIZON_CHECK(ctx.compile("func main(): int32 {\n    return 0;\n}\n", "ok.hr"));
+    HORIZON_CHECK(ctx.ast());
+    HORIZON_CHECK(!ctx.tokens().is_empty());
+
+    HORIZON_CHECK(!ctx.compile("func main(): int32 {\n    i = ;\n}\n", "bad.hr"));
+    HORIZON_CHECK(!ctx.errors().is_empty());
+    HORIZON_CHECK(ctx.errors().is_empty() || ctx.errors()[0].M_line == 2);
+
+    HORIZON_CHECK(!ctx.compile_file("api_test_missing.hr"));
+    HORIZON_CHECK(ctx.errors().length() == 1);
+    if (ctx.errors().length() == 1)
+    {
+        const horizon::horizon_errors::error_info &io = ctx.errors()[0];
+        HORIZON_CHECK(io.M_code == horizon::horizon_errors::error_code::HORIZON_IO_ERROR);
+        HORIZON_CHECK(io.M_line == 0 && io.M_column == 0);
+        HORIZON_CHECK(std::strstr(io.M_message.c_str(), "api_test_missing.hr"));
+    }
+    HORIZON_CHECK(ctx.compilations() == 5);
+    return horizon::horizon_tests::result();
+}
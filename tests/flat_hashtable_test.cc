@@ -0,0 +1,257 @@
+/**
+ * @file flat_hashtable_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// flat_hashtable against std::unordered_map under random insertions and removals, then the paths that randomness rarely
+// reaches on purpose: removed slots going back to EMPTY, rehashing tombstones in place, reserve, copy and move, and
+// heterogeneous lookups of string keys
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../bench/bench_util.hh"
+#include "../deps/hashtable/flat_hashtable.hh"
+#include "../deps/string/str_view.hh"
+#include "../deps/string/string.hh"
+#include "../src/misc/stats.hh"
+#include "./test.hh"
+
+namespace
+{
+    namespace hd = horizon::horizon_deps;
+
+    using int_table = hd::flat_hashtable<std::uint64_t, std::uint64_t>;
+    using string_table = hd::flat_hashtable<hd::string, int, hd::flat_string_hash, hd::flat_string_equal>;
+
+    using horizon::horizon_bench::next_random;
+
+    // every key of a hash class has the same hash, so where its probe starts is up to the class
+    struct class_hash
+    {
+        [[nodiscard]] std::size_t operator()(const std::uint64_t &key) const
+        {
+            return static_cast<std::size_t>(key >> 32);
+        }
+    };
+
+    using class_table = hd::flat_hashtable<std::uint64_t, std::uint64_t, class_hash>;
+
+    std::uint64_t rehashes()
+    {
+        return horizon::horizon_misc::this_thread_stats().M_counters[static_cast<std::size_t>(horizon::horizon_misc::stat_counter::STAT_HASHTABLE_REHASHES)];
+    }
+
+    bool same(const int_table &table, const std::unordered_map<std::uint64_t, std::uint64_t> &model, const std::uint64_t &keys)
+    {
+        if (table.length() != model.size())
+            return false;
+        for (std::uint64_t k = 0; k < keys; k++)
+        {
+            std::unordered_map<std::uint64_t, std::uint64_t>::const_iterator it = model.find(k);
+            const std::uint64_t *v = table.find(k);
+            if ((it == model.end()) != (v == nullptr) || (v && *v != it->second))
+                return false;
+        }
+        std::size_t visited = 0;
+        bool match = true;
+        table.for_each([&](const std::uint64_t &k, const std::uint64_t &v)
+                       {
+                           visited++;
+                           std::unordered_map<std::uint64_t, std::uint64_t>::const_iterator it = model.find(k);
+                           match = match && it != model.end() && it->second == v; });
+        return match && visited == model.size();
+    }
+
+    void against_unordered_map()
+    {
+        // key ranges small enough that removals and re-insertions of the same keys are frequent
+        const std::uint64_t ranges[] = {8, 100, 5000};
+        std::uint64_t state = 7;
+        for (std::uint64_t keys : ranges)
+        {
+            int_table table;
+            std::unordered_map<std::uint64_t, std::uint64_t> model;
+            bool ok = true;
+            for (std::size_t op = 0; op < 200000 && ok; op++)
+            {
+                std::uint64_t k = next_random(state) % keys, v = next_random(state);
+                if (next_random(state) % 3 == 0)
+                    ok = table.remove(k) == (model.erase(k) == 1);
+                else
+                    ok = table.append(k, v) == model.emplace(k, v).second;
+                if (op % 4096 == 0)
+                    ok = ok && same(table, model, keys);
+            }
+            HORIZON_CHECK(ok);
+            HORIZON_CHECK(same(table, model, keys));
+        }
+    }
+
+    void removed_slots_are_reused()
+    {
+        // never more than 9 of the 16 slots of a one-group table in use: removals give the slots back as EMPTY, so a long
+        // churn of new keys does not run out of room for insertions and never rehashes
+        int_table table;
+        std::uint64_t k = 0;
+        for (; k < 8; k++)
+            (void)table.append(k, k);
+        std::size_t cap = table.capacity();
+        std::uint64_t before = rehashes();
+        for (; k < 100000; k++)
+        {
+            (void)table.append(k, k);
+            table.remove(k - 8);
+        }
+        HORIZON_CHECK(rehashes() == before);
+        HORIZON_CHECK(table.capacity() == cap);
+        HORIZON_CHECK(table.length() == 8);
+        for (std::uint64_t i = k - 8; i < k; i++)
+            HORIZON_CHECK(table.find(i) && *table.find(i) == i);
+        HORIZON_CHECK(!table.contains(k - 9));
+    }
+
+    void removals_give_room_back()
+    {
+        // two groups: 14 keys of a class, then 14 of class 0, which fills the room for insertions. Removing 10 of the first
+        // class from a group that still has EMPTY slots gives the room back, so one more key of class 0 goes into an EMPTY
+        // slot without a rehash, whichever groups the two classes start in
+        std::uint64_t before = rehashes();
+        bool same_capacity = true, found = true;
+        for (std::uint64_t cls = 1; cls <= 64; cls++)
+        {
+            class_table table;
+            table.reserve(20);
+            std::size_t cap = table.capacity();
+            for (std::uint64_t i = 0; i < 14; i++)
+                (void)table.append(cls << 32 | i, i);
+            for (std::uint64_t i = 0; i < 14; i++)
+                (void)table.append(i, i);
+            for (std::uint64_t i = 0; i < 10; i++)
+                table.remove(cls << 32 | i);
+            (void)table.append(14, 14);
+            same_capacity = same_capacity && cap == 32 && table.capacity() == cap;
+            found = found && table.length() == 19 && !table.contains(cls << 32) && table.contains(cls << 32 | 13);
+            for (std::uint64_t i = 0; i <= 14; i++)
+                found = found && table.find(i) && *table.find(i) == i;
+        }
+        HORIZON_CHECK(same_capacity);
+        HORIZON_CHECK(found);
+        HORIZON_CHECK(rehashes() == before);
+    }
+
+    void tombstones_rehash_in_place()
+    {
+        // two groups: class 0 fills the one it starts in, then 15 of its keys are removed and leave tombstones behind (the
+        // group has no EMPTY slot). A class starting in the other group finds an EMPTY slot there with no room for insertions
+        // left, and since the table is mostly tombstones it is rehashed at the same capacity. Classes that start in the
+        // first group reuse a tombstone instead; out of 64 classes some start in each
+        std::uint64_t before = rehashes();
+        bool same_capacity = true, found = true;
+        for (std::uint64_t cls = 1; cls <= 64; cls++)
+        {
+            class_table table;
+            table.reserve(20);
+            std::size_t cap = table.capacity();
+            for (std::uint64_t i = 0; i < 16; i++)
+                (void)table.append(i, i);
+            for (std::uint64_t i = 0; i < 12; i++)
+                (void)table.append(cls << 32 | i, i);
+            for (std::uint64_t i = 0; i < 15; i++)
+                table.remove(i);
+            (void)table.append(cls << 32 | 12, 12);
+            same_capacity = same_capacity && cap == 32 && table.capacity() == cap;
+            found = found && table.length() == 14 && table.contains(15) && !table.contains(0);
+            for (std::uint64_t i = 0; i <= 12; i++)
+                found = found && table.find(cls << 32 | i) && *table.find(cls << 32 | i) == i;
+        }
+        HORIZON_CHECK(same_capacity);
+        HORIZON_CHECK(found);
+        HORIZON_CHECK(rehashes() > before);
+    }
+
+    void reserve_and_copies()
+    {
+        int_table table;
+        for (std::uint64_t k = 0; k < 20; k++)
+            (void)table.append(k, k + 1);
+        table.reserve(10000);
+        std::size_t cap = table.capacity();
+        HORIZON_CHECK(cap >= 10000);
+        HORIZON_CHECK(table.length() == 20);
+        for (std::uint64_t k = 0; k < 10000; k++)
+            (void)table.append(k, k + 1);
+        HORIZON_CHECK(table.capacity() == cap);
+        // reserving less than is there changes nothing
+        table.reserve(10);
+        HORIZON_CHECK(table.capacity() == cap);
+        table.remove(5);
+
+        int_table copy(table);
+        HORIZON_CHECK(copy.length() == table.length());
+        HORIZON_CHECK(!copy.contains(5));
+        HORIZON_CHECK(copy.find(9999) && *copy.find(9999) == 10000);
+        copy.remove(7);
+        (void)copy.append(5, 0);
+        HORIZON_CHECK(table.contains(7) && !table.contains(5));
+
+        int_table assigned;
+        (void)assigned.append(123456, 1);
+        assigned = table;
+        HORIZON_CHECK(assigned.length() == table.length() && !assigned.contains(123456) && assigned.contains(7));
+        int_table &self = assigned;
+        assigned = self;
+        HORIZON_CHECK(assigned.length() == table.length());
+
+        int_table moved(std::move(copy));
+        HORIZON_CHECK(copy.is_null() && copy.length() == 0 && !copy.contains(1));
+        HORIZON_CHECK(moved.contains(5) && !moved.contains(7));
+        assigned = std::move(moved);
+        HORIZON_CHECK(moved.is_null() && assigned.contains(5) && !assigned.contains(7));
+        // a moved-from table is usable again
+        (void)moved.append(1, 2);
+        HORIZON_CHECK(moved.length() == 1 && *moved.find(1) == 2);
+
+        int_table empty;
+        int_table empty_copy(empty);
+        HORIZON_CHECK(empty_copy.is_null() && !empty_copy.contains(0));
+    }
+
+    void string_keys()
+    {
+        string_table table;
+        for (int i = 0; i < 1000; i++)
+            HORIZON_CHECK(table.append(hd::string(("key_" + std::to_string(i)).c_str()), i));
+        HORIZON_CHECK(!table.append(hd::string("key_7"), 0));
+
+        // a view into a longer buffer, which is not NUL-terminated where the key ends
+        const char *text = "key_42 and more";
+        hd::str_view view(text, 6);
+        HORIZON_CHECK(table.find(view) && *table.find(view) == 42);
+        HORIZON_CHECK(!table.contains(hd::str_view(text, 3)));
+        HORIZON_CHECK(table.contains("key_999"));
+        HORIZON_CHECK(table.contains(std::string_view("key_0")));
+        HORIZON_CHECK(table.get_value(hd::string("key_500")) == 500);
+        HORIZON_CHECK(table.remove(view));
+        HORIZON_CHECK(!table.contains("key_42"));
+        HORIZON_CHECK(table.remove(std::string_view("key_43")) && !table.remove("key_43"));
+        HORIZON_CHECK(table.length() == 998);
+    }
+}
+
+int main()
+{
+    // for the rehash counter
+    horizon::horizon_misc::start_stats();
+    against_unordered_map();
+    removed_slots_are_reused();
+    removals_give_room_back();
+    tombstones_rehash_in_place();
+    reserve_and_copies();
+    string_keys();
+    horizon::horizon_misc::finish_stats(true);
+    return horizon::horizon_tests::result();
+}
@@ -0,0 +1,177 @@
+/**
+ * @file hrast_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// save -> load -> save again must give the same bytes, and truncated or corrupt images must not load
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../src/api/api.hh"
+#include "../src/misc/load_file.hh"
+#include "../src/parser/ast/hrast.hh"
+#include "./test.hh"
+
+namespace
+{
+    constexpr const char *SOURCE = "int32: g = 5;\n"
+                                   "func add(int32: a, int32: b): int32 {\n"
+                                   "    return a + b;\n"
+                                   "}\n"
+                                   "func main(): int32 {\n"
+                                   "    let: c = 'x', s = \"str\", n = null, d = 1.5, t = g < 2 ? true : false;\n"
+                                   "    int32: i;\n"
+                                   "    if (c) { i = add(-1, 2); } elif (i) { i = 3; } else { i = 4; }\n"
+                                   "    while (i < 3) { i++; }\n"
+                                   "    do { --i; } while (i)\n"
+                                   "    for (int32: k = 0; k < i; k++) { i -= k; }\n"
+                                   "    return i;\n"
+                                   "}\n";
+
+    // copies a loaded node and everything below it into `writer` as it was written
+    std::uint64_t copy_node(horizon::horizon_parser::hrast_writer &writer, const horizon::horizon_parser::hrast_node_view &node)
+    {
+        horizon::horizon_deps::vector<std::uint64_t> children;
+        for (std::uint32_t i = 0; i < node.child_count(); i++)
+        {
+            horizon::horizon_parser::hrast_node_view child = node.child(i);
+            children.add(child ? copy_node(writer, child) : 0);
+        }
+        if (node.get_token_type() != horizon::token_type::TOKEN_END_OF_FILE || node.start() != horizon::horizon_parser::HRAST_NO_POS)
+        {
+            horizon::token tok;
+            tok.M_type = node.get_token_type();
+            tok.M_lexeme = (node.str() ? horizon::horizon_deps::string(node.str(), node.str() + node.str_length()) : horizon::horizon_deps::string(""));
+            tok.M_start = node.start();
+            tok.M_end = node.end();
+            return writer.write_node(node.kind(), &tok, node.flags(), children.raw(), children.length());
+        }
+        return writer.write_node(node.kind(), node.str(), node.str_length(), node.flags(), static_cast<std::uint64_t>(node.value_int()), children.raw(), children.length());
+    }
+
+    bool write_bytes(const char *loc, const char *data, const std::size_t &len)
+    {
+        std::FILE *fptr = std::fopen(loc, "wb");
+        if (!fptr)
+            return false;
+        bool ok = std::fwrite(data, sizeof(char), len, fptr) == len;
+        return std::fclose(fptr) == 0 && ok;
+    }
+
+    // `image` changed by `corrupt` must not load
+    template <typename F>
+    void check_rejected(const horizon::horizon_deps::string &image, F corrupt, const char *what)
+    {
+        horizon::horizon_deps::string bad(image);
+        std::size_t len = corrupt(bad.raw(), bad.length());
+        HORIZON_CHECK(write_bytes("hrast_test_bad.hrast", bad.c_str(), len));
+        horizon::horizon_parser::hrast_file file;
+        bool loaded = file.load("hrast_test_bad.hrast");
+        if (loaded)
+            std::fprintf(stderr, "loaded a corrupt image: %s\n", what);
+        HORIZON_CHECK(!loaded);
+    }
+}
+
+int main()
+{
+    horizon::horizon_api::compilation_context ctx;
+    horizon::horizon_api::compile_options options;
+    options.M_keep_tokens = false;
+    HORIZON_CHECK(ctx.compile(SOURCE, "hrast_test.hr", options));
+    if (!ctx.ast())
+        return horizon::horizon_tests::result();
+
+    horizon::horizon_parser::hrast_writer writer;
+    std::uint64_t root = ctx.ast()->serialize(writer);
+    HORIZON_CHECK(writer.save("hrast_test_1.hrast", root));
+
+    horizon::horizon_parser::hrast_file file;
+    HORIZON_CHECK(file.load("hrast_test_1.hrast"));
+    if (file.is_null())
+        return horizon::horizon_tests::result();
+    horizon::horizon_parser::hrast_node_view program = file.root();
+    HORIZON_CHECK(program.kind() == horizon::horizon_parser::hrast_kind::HRAST_PROGRAM);
+    HORIZON_CHECK(program.child_count() == 3);
+    HORIZON_CHECK(program.child(2).kind() == horizon::horizon_parser::hrast_kind::HRAST_FUNCTION_DECLARATION);
+    HORIZON_CHECK(program.child(2).str() && std::strcmp(program.child(2).str(), "main") == 0);
+    HORIZON_CHECK(!program.child(program.child_count()));
+
+    horizon::horizon_parser::hrast_writer again;
+    HORIZON_CHECK(again.save("hrast_test_2.hrast", copy_node(again, program)));
+    horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> first = horizon::horizon_misc::load_file("hrast_test_1.hrast");
+    horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> second = horizon::horizon_misc::load_file("hrast_test_2.hrast");
+    HORIZON_CHECK(first && second);
+    if (!first || !second)
+        return horizon::horizon_tests::result();
+    const horizon::horizon_deps::string &image = first->M_content;
+    HORIZON_CHECK(image.length() == second->M_content.length() && std::memcmp(image.c_str(), second->M_content.c_str(), image.length()) == 0);
+
+    const horizon::horizon_parser::hrast_header &header = file.header();
+    std::uint64_t root_at = header.M_root;
+    check_rejected(image, [](char *, std::size_t len)
+                   { return len - 1; }, "truncated");
+    check_rejected(image, [](char *, std::size_t)
+                   { return sizeof(horizon::horizon_parser::hrast_header) + 8; }, "truncated into the nodes");
+    check_rejected(image, [root_at](char *data, std::size_t len)
+                   {
+                       // the root's child count past the string table
+                       std::uint32_t count = 0x10000000U;
+                       std::memcpy(data + root_at + offsetof(horizon::horizon_parser::hrast_node, M_child_count), &count, sizeof(count));
+                       return len; }, "child count");
+    check_rejected(image, [root_at](char *data, std::size_t len)
+                   {
+                       // the root's first child pointing at itself
+                       std::memcpy(data + root_at + sizeof(horizon::horizon_parser::hrast_node), &root_at, sizeof(root_at));
+                       return len; }, "cycle");
+    check_rejected(image, [root_at](char *data, std::size_t len)
+                   {
+                       // into the middle of a record
+                       std::uint64_t inside = sizeof(horizon::horizon_parser::hrast_header) + 8;
+                       std::memcpy(data + root_at + sizeof(horizon::horizon_parser::hrast_node), &inside, sizeof(inside));
+                       return len; }, "misplaced child");
+    for (std::uint64_t tail : {8, 4})
+    {
+        // the node area ends in `tail` bytes, too few for a record, right before an empty string table at the end of the
+        // file: with 8 the file is a whole number of pages long, with 4 the child count of that "record" is past its end
+        std::uint64_t nodes_end = header.M_strings, pages = (nodes_end + 8 + 4095) / 4096 * 4096, size = pages - 8 + tail;
+        std::vector<char> bad(image.c_str(), image.c_str() + nodes_end);
+        bad.resize(size, 0);
+        horizon::horizon_parser::hrast_node leaf = {};
+        std::uint64_t pos = nodes_end, fill = pages - 8 - nodes_end;
+        // leaves of 40 bytes (one null child) until the rest is a multiple of 32, then leaves of 32 bytes
+        for (leaf.M_child_count = 1; fill % 32 != 0; fill -= 40, pos += 40)
+            std::memcpy(bad.data() + pos, &leaf, sizeof(leaf));
+        for (leaf.M_child_count = 0; fill != 0; fill -= 32, pos += 32)
+            std::memcpy(bad.data() + pos, &leaf, sizeof(leaf));
+        horizon::horizon_parser::hrast_header changed = header;
+        changed.M_size = size;
+        changed.M_strings = size;
+        changed.M_strings_size = 0;
+        std::memcpy(bad.data(), &changed, sizeof(changed));
+        HORIZON_CHECK(write_bytes("hrast_test_bad.hrast", bad.data(), bad.size()));
+        horizon::horizon_parser::hrast_file short_record;
+        HORIZON_CHECK(!short_record.load("hrast_test_bad.hrast"));
+    }
+
+    // a hash-consed AST is written as a DAG, shared children are referred to by several parents
+    options.M_hash_cons = true;
+    HORIZON_CHECK(ctx.compile(SOURCE, "hrast_test.hr", options));
+    if (ctx.ast())
+    {
+        horizon::horizon_parser::hrast_writer shared;
+        shared.set_shared_nodes(true);
+        HORIZON_CHECK(shared.save("hrast_test_1.hrast", ctx.ast()->serialize(shared)));
+        HORIZON_CHECK(file.load("hrast_test_1.hrast"));
+    }
+
+    file.unload();
+    std::remove("hrast_test_1.hrast");
+    std::remove("hrast_test_2.hrast");
+    std::remove("hrast_test_bad.hrast");
+    return horizon::horizon_tests::result();
+}
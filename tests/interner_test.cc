@@ -0,0 +1,168 @@
+/**
+ * @file interner_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// concurrent_interner: dense ids that never change, `get`/`length` giving back what was interned across shard table growth,
+// id segments and character chunks, the same ids whichever thread interns a string first, and clear() starting over at id 0
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../deps/hash/hash.hh"
+#include "../deps/hashtable/concurrent_interner.hh"
+#include "./test.hh"
+
+namespace
+{
+    namespace hd = horizon::horizon_deps;
+
+    constexpr std::size_t THREADS = 8;
+
+    bool same(const hd::concurrent_interner &in, const std::uint32_t &id, const std::string &key)
+    {
+        return in.length(id) == key.size() && std::memcmp(in.get(id), key.data(), key.size()) == 0 && in.get(id)[key.size()] == 0;
+    }
+
+    // identifiers that all land in shard 0, `n` of them
+    std::vector<std::string> one_shard_keys(const std::size_t &n)
+    {
+        std::vector<std::string> keys;
+        char buffer[32];
+        for (std::size_t i = 0; keys.size() < n; i++)
+        {
+            int len = std::snprintf(buffer, sizeof(buffer), "name_%zu", i);
+            if ((hd::hash_bytes(buffer, static_cast<std::size_t>(len)) & (hd::concurrent_interner::SHARDS - 1)) == 0)
+                keys.emplace_back(buffer, static_cast<std::size_t>(len));
+        }
+        return keys;
+    }
+
+    void single_thread()
+    {
+        hd::concurrent_interner in;
+        HORIZON_CHECK(in.count() == 0);
+        HORIZON_CHECK(in.intern(nullptr, 0) == hd::concurrent_interner::NULL_ID);
+        HORIZON_CHECK(in.get(hd::concurrent_interner::NULL_ID) == nullptr);
+        HORIZON_CHECK(in.length(hd::concurrent_interner::NULL_ID) == 0);
+
+        // one shard grows its table from 64 slots several times over, the ids cross several segments
+        std::vector<std::string> keys = one_shard_keys(64 * 40);
+        keys.emplace_back("");
+        keys.emplace_back("with\0nul", 8);
+        keys.emplace_back(100 * 1024, 'x'); // bigger than a characters chunk
+        for (int i = 0; i < 500; i++)
+            keys.push_back("other_" + std::to_string(i));
+
+        std::vector<const char *> chars;
+        bool dense = true;
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            std::uint32_t id = in.intern(keys[i].data(), keys[i].size());
+            dense = dense && id == i;
+            chars.push_back(in.get(id));
+        }
+        HORIZON_CHECK(dense);
+        HORIZON_CHECK(in.count() == keys.size());
+
+        // interning again changes nothing, and nothing has moved since
+        bool stable = true, matches = true;
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            std::uint32_t id = static_cast<std::uint32_t>(i);
+            stable = stable && in.intern(keys[i].data(), keys[i].size()) == id && in.get(id) == chars[i];
+            matches = matches && same(in, id, keys[i]);
+        }
+        HORIZON_CHECK(stable);
+        HORIZON_CHECK(matches);
+        HORIZON_CHECK(in.count() == keys.size());
+        // a prefix is a different string
+        HORIZON_CHECK(in.intern("with", 4) == keys.size());
+    }
+
+    void clearing()
+    {
+        hd::concurrent_interner in;
+        std::vector<std::string> keys = one_shard_keys(64 * 40);
+        for (const std::string &key : keys)
+            (void)in.intern(key.data(), key.size());
+        in.clear();
+        HORIZON_CHECK(in.count() == 0);
+
+        // the same keys in reverse get new ids from 0, and none of the old ones is found
+        HORIZON_CHECK(in.intern("fresh", 5) == 0);
+        bool dense = true, matches = true;
+        for (std::size_t i = keys.size(); i-- > 0;)
+        {
+            std::uint32_t id = in.intern(keys[i].data(), keys[i].size());
+            dense = dense && id == keys.size() - i;
+            matches = matches && same(in, id, keys[i]);
+        }
+        HORIZON_CHECK(dense);
+        HORIZON_CHECK(matches);
+        HORIZON_CHECK(in.count() == keys.size() + 1);
+        in.clear();
+        in.clear();
+        HORIZON_CHECK(in.count() == 0 && in.intern(keys[0].data(), keys[0].size()) == 0);
+    }
+
+    void many_threads()
+    {
+        hd::concurrent_interner in;
+        std::vector<std::string> keys = one_shard_keys(64 * 40);
+        for (int i = 0; i < 20000; i++)
+            keys.push_back("id_" + std::to_string(i * 7919 % 20000));
+
+        // every thread interns all of the keys, each in an order of its own, and reads back what it got
+        std::vector<std::vector<std::uint32_t>> ids(THREADS, std::vector<std::uint32_t>(keys.size()));
+        std::vector<char> read_back(THREADS, 1);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < THREADS; t++)
+            threads.emplace_back([&, t]()
+                                 {
+                                     for (std::size_t n = 0; n < keys.size(); n++)
+                                     {
+                                         std::size_t i = (t % 2 ? keys.size() - 1 - n : n);
+                                         i = (i + t * keys.size() / THREADS) % keys.size();
+                                         ids[t][i] = in.intern(keys[i].data(), keys[i].size());
+                                         if (!same(in, ids[t][i], keys[i]))
+                                             read_back[t] = 0;
+                                     } });
+        for (std::thread &t : threads)
+            t.join();
+
+        HORIZON_CHECK(std::all_of(read_back.begin(), read_back.end(), [](char ok)
+                                  { return ok != 0; }));
+        bool agree = true;
+        for (std::size_t t = 1; t < THREADS; t++)
+            agree = agree && ids[t] == ids[0];
+        HORIZON_CHECK(agree);
+
+        // dense: every id below count() belongs to exactly one key
+        std::size_t distinct = keys.size();
+        HORIZON_CHECK(in.count() == distinct);
+        std::vector<char> used(distinct, 0);
+        bool unique = true;
+        for (std::size_t i = 0; i < keys.size(); i++)
+        {
+            std::uint32_t id = ids[0][i];
+            unique = unique && id < distinct && !used[id];
+            if (id < distinct)
+                used[id] = 1;
+        }
+        HORIZON_CHECK(unique);
+    }
+}
+
+int main()
+{
+    single_thread();
+    clearing();
+    many_threads();
+    return horizon::horizon_tests::result();
+}
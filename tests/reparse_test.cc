@@ -0,0 +1,162 @@
+/**
+ * @file reparse_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// `parser::reparse` of every edit of a chain must give the AST, token positions included, that parsing the edited source
+// from scratch gives
+
+#include <cstdio>
+#include <cstring>
+
+#include "../src/lexer/lexer.hh"
+#include "../src/misc/load_file.hh"
+#include "../src/misc/out_buffer.hh"
+#include "../src/parser/parser.hh"
+#include "./test.hh"
+
+namespace
+{
+    struct edit
+    {
+        const char *M_what;
+        const char *M_source;
+        bool M_valid;
+    };
+
+    const edit EDITS[] = {
+        {"original",
+         "int32: g = 5;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a + b;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g;\n}\n",
+         true},
+        {"inside a function",
+         "int32: g = 5;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g;\n}\n",
+         true},
+        {"inside a nested block",
+         "int32: g = 5;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n        i += 40;\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g;\n}\n",
+         true},
+        {"at the start of the file",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n        i += 40;\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g;\n}\n",
+         true},
+        {"at the end of the file",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n        i += 40;\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g + h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         true},
+        {"a syntax error",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - ;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n        i += 40;\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g + h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         false},
+        {"a function added in the middle",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func mid(): int32 {\n    return 2;\n}\n"
+         "func main(): int32 {\n    int32: i = 13;\n    if (i) {\n        i = add(i, 1);\n        i += 40;\n    }\n    return i;\n}\n"
+         "func last(): int32 {\n    return g + h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         true},
+        {"a function removed",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func mid(): int32 {\n    return 2;\n}\n"
+         "func last(): int32 {\n    return g + h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         true},
+        {"a function renamed",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func middle(): int32 {\n    return 2;\n}\n"
+         "func last(): int32 {\n    return g + h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         true},
+        {"one function split in two",
+         "int64: h = 1;\nint32: g = 7;\n"
+         "func add(int32: a, int32: b): int32 {\n    return a - b * 2;\n}\n"
+         "func middle(): int32 {\n    return 2;\n}\n"
+         "func last(): int32 {\n    return g;\n}\nfunc split(): int32 {\n    return h;\n}\nfunc extra(): int32 {\n    return 0;\n}\n",
+         true},
+    };
+
+    horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> make_file(const char *source)
+    {
+        horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> file = horizon::horizon_deps::create<horizon::horizon_misc::HR_FILE>();
+        file->M_location = "reparse_test.hr";
+        file->M_content = source;
+        return file;
+    }
+
+    // the JSON form of the AST followed by its `.hrast` image, which has the source offset of every token
+    horizon::horizon_deps::string dump(const horizon::horizon_parser::parser &p)
+    {
+        horizon::horizon_misc::out_buffer out(horizon::horizon_misc::out_buffer::IN_MEMORY, false);
+        p.get_ast()->print_json(out);
+        horizon::horizon_deps::string result(out.raw(), out.raw() + out.length());
+
+        horizon::horizon_parser::hrast_writer writer;
+        if (!writer.save("reparse_test.hrast", horizon::horizon_parser::serialize_node(writer, p.get_ast())))
+            return result;
+        horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> image = horizon::horizon_misc::load_file("reparse_test.hrast");
+        if (image)
+            result.append(horizon::horizon_deps::str_view(image->M_content.c_str(), image->M_content.length()));
+        return result;
+    }
+
+    bool same(const horizon::horizon_deps::string &a, const horizon::horizon_deps::string &b)
+    {
+        return a.length() == b.length() && std::memcmp(a.c_str(), b.c_str(), a.length()) == 0;
+    }
+}
+
+int main()
+{
+    // every version stays alive, a reparse diffs against the file of the previous one
+    horizon::horizon_deps::vector<horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE>> files;
+    files.add(make_file(EDITS[0].M_source));
+    horizon::horizon_lexer::lexer first_lex(files[0].raw());
+    HORIZON_CHECK(first_lex.init_lexing());
+    horizon::horizon_parser::parser incremental(std::move(first_lex.move()), files[0].raw());
+    HORIZON_CHECK(incremental.init_parsing());
+    horizon::horizon_deps::string expected = dump(incremental);
+
+    for (std::size_t i = 1; i < sizeof(EDITS) / sizeof(EDITS[0]); i++)
+    {
+        files.add(make_file(EDITS[i].M_source));
+        horizon::horizon_misc::HR_FILE *file = files[files.length() - 1].raw();
+        horizon::horizon_lexer::lexer lex(file);
+        HORIZON_CHECK(lex.init_lexing());
+        bool reparsed = incremental.reparse(lex.get(), file);
+        if (reparsed != EDITS[i].M_valid)
+            std::fprintf(stderr, "edit %s: reparse returned %d\n", EDITS[i].M_what, reparsed);
+        HORIZON_CHECK(reparsed == EDITS[i].M_valid);
+
+        if (EDITS[i].M_valid)
+        {
+            // the same source parsed from scratch
+            horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> fresh_file = make_file(EDITS[i].M_source);
+            horizon::horizon_lexer::lexer fresh_lex(fresh_file.raw());
+            HORIZON_CHECK(fresh_lex.init_lexing());
+            horizon::horizon_parser::parser fresh(std::move(fresh_lex.move()), fresh_file.raw());
+            HORIZON_CHECK(fresh.init_parsing());
+            expected = dump(fresh);
+        }
+        // after a syntax error the previous AST is kept
+        bool is_same = same(dump(incremental), expected);
+        if (!is_same)
+            std::fprintf(stderr, "edit %s: reparse differs from a fresh parse\n", EDITS[i].M_what);
+        HORIZON_CHECK(is_same);
+    }
+    std::remove("reparse_test.hrast");
+    return horizon::horizon_tests::result();
+}
@@ -0,0 +1,252 @@
+/**
+ * @file scheduler_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// The work-stealing deque on its own with thieves racing its owner, then the scheduler: dependencies, parallel_for,
+// reclaim and the run order of the single-thread mode
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../deps/scheduler/scheduler.hh"
+#include "./test.hh"
+
+namespace
+{
+    namespace hd = horizon::horizon_deps;
+
+    constexpr std::size_t THREADS = 4;
+
+    // the deque only moves pointers around, so the "tasks" are addresses into an array
+    void deque_under_contention()
+    {
+        constexpr std::size_t ITEMS = 100000;
+        std::vector<char> items(ITEMS);
+        std::vector<std::atomic<unsigned>> taken(ITEMS);
+        hd::work_deque deque;
+        std::atomic<bool> done(false);
+
+        auto take = [&](hd::task *t)
+        {
+            std::size_t i = static_cast<std::size_t>(reinterpret_cast<char *>(t) - items.data());
+            HORIZON_CHECK(i < ITEMS);
+            if (i < ITEMS)
+                taken[i].fetch_add(1, std::memory_order_relaxed);
+        };
+        std::vector<std::thread> thieves;
+        for (std::size_t n = 0; n < THREADS - 1; n++)
+            thieves.emplace_back([&]()
+                                 {
+                                     while (!done.load(std::memory_order_acquire))
+                                     {
+                                         hd::task *t = deque.steal();
+                                         if (t)
+                                             take(t);
+                                     } });
+        // first one item at a time, so the owner and the thieves race for the last item; then in bursts past the first ring's
+        // 64 slots, popping some back, so the ring grows while thieves read it
+        std::size_t i = 0;
+        for (; i < ITEMS / 2; i++)
+        {
+            deque.push(reinterpret_cast<hd::task *>(items.data() + i));
+            hd::task *t = deque.pop();
+            if (t)
+                take(t);
+        }
+        while (i < ITEMS)
+        {
+            for (std::size_t n = 0; n < 200 && i < ITEMS; n++, i++)
+                deque.push(reinterpret_cast<hd::task *>(items.data() + i));
+            for (std::size_t n = 0; n < 50; n++)
+            {
+                hd::task *t = deque.pop();
+                if (t)
+                    take(t);
+            }
+        }
+        while (hd::task *t = deque.pop())
+            take(t);
+        done.store(true, std::memory_order_release);
+        for (std::thread &t : thieves)
+            t.join();
+        HORIZON_CHECK(deque.steal() == nullptr);
+
+        std::size_t wrong = 0;
+        for (std::size_t i = 0; i < ITEMS; i++)
+            wrong += taken[i].load(std::memory_order_relaxed) != 1;
+        HORIZON_CHECK(wrong == 0);
+    }
+
+    std::vector<int> single_thread_order()
+    {
+        std::vector<int> order;
+        hd::scheduler sched(1);
+        // nothing runs before `wait`, then ready tasks in the order they became ready: the continuation of `first` and the
+        // task spawned by `second` queue up behind `last`
+        hd::task *first = sched.spawn([&]()
+                                      { order.push_back(0); });
+        hd::task *second = sched.spawn([&]()
+                                       { order.push_back(1);
+                                         sched.spawn([&]()
+                                                     { order.push_back(4); }); });
+        sched.then(first, [&]()
+                   { order.push_back(3); });
+        hd::task *last = sched.spawn([&]()
+                                     { order.push_back(2); });
+        HORIZON_CHECK(order.empty());
+        sched.wait(second);
+        sched.wait(last);
+        sched.reclaim();
+        return order;
+    }
+
+    void deterministic_mode()
+    {
+        std::vector<int> once = single_thread_order();
+        HORIZON_CHECK(once == std::vector<int>({0, 1, 2, 3, 4}));
+        HORIZON_CHECK(single_thread_order() == once);
+    }
+
+    void dependencies()
+    {
+        hd::scheduler sched(THREADS);
+        HORIZON_CHECK(sched.threads() == THREADS);
+        for (int round = 0; round < 200; round++)
+        {
+            // a diamond: `last` after both `left` and `right`, which both come after `root`
+            std::atomic<int> clock(0);
+            int root_at = -1, left_at = -1, right_at = -1, last_at = -1;
+            hd::task *root = sched.create([&]()
+                                          { root_at = clock.fetch_add(1); });
+            hd::task *left = sched.then(root, [&]()
+                                        { left_at = clock.fetch_add(1); });
+            hd::task *right = sched.then(root, [&]()
+                                         { right_at = clock.fetch_add(1); });
+            hd::task *last = sched.create([&]()
+                                          { last_at = clock.fetch_add(1); });
+            sched.depend(last, left);
+            sched.depend(last, right);
+            sched.submit(last);
+            HORIZON_CHECK(!last->is_done());
+            sched.submit(root);
+            sched.wait(last);
+            HORIZON_CHECK(root_at == 0);
+            HORIZON_CHECK(left_at > root_at && right_at > root_at);
+            HORIZON_CHECK(last_at == 3);
+
+            // depending on a task that has already finished does not hold the new one back
+            hd::task *after = sched.then(root, [&]()
+                                         { clock.fetch_add(1); });
+            sched.wait(after);
+            HORIZON_CHECK(clock.load() == 5);
+        }
+    }
+
+    void parallel_for_coverage()
+    {
+        hd::scheduler sched(THREADS);
+        const std::size_t sizes[] = {0, 1, 7, 64, 1000, 100003};
+        const std::size_t grains[] = {0, 1, 3, 64, 5000};
+        for (std::size_t size : sizes)
+            for (std::size_t grain : grains)
+            {
+                std::vector<std::atomic<unsigned>> seen(size + 10);
+                std::atomic<std::size_t> calls(0);
+                std::atomic<bool> in_range(true);
+                sched.parallel_for(10, size + 10, grain, [&](std::size_t begin, std::size_t end)
+                                   {
+                                       calls.fetch_add(1, std::memory_order_relaxed);
+                                       if (begin >= end || end - begin > (grain ? grain : 1) || begin < 10 || end > size + 10)
+                                           in_range.store(false, std::memory_order_relaxed);
+                                       for (std::size_t i = begin; i < end && i < seen.size(); i++)
+                                           seen[i].fetch_add(1, std::memory_order_relaxed); });
+                HORIZON_CHECK(in_range.load());
+                std::size_t wrong = 0;
+                for (std::size_t i = 0; i < seen.size(); i++)
+                    wrong += seen[i].load(std::memory_order_relaxed) != (i < 10 ? 0u : 1u);
+                HORIZON_CHECK(wrong == 0);
+                HORIZON_CHECK(size != 0 || calls.load() == 0);
+            }
+    }
+
+    void stealing()
+    {
+        // one task fans out many from its own worker, the idle threads can only get to them by stealing
+        constexpr std::size_t TASKS = 20000;
+        hd::scheduler sched(THREADS);
+        std::vector<std::atomic<unsigned>> ran(TASKS);
+        std::atomic<std::size_t> total(0);
+        hd::task *root = sched.spawn([&]()
+                                     {
+                                         for (std::size_t i = 0; i < TASKS; i++)
+                                             sched.spawn([&, i]()
+                                                         {
+                                                             ran[i].fetch_add(1, std::memory_order_relaxed);
+                                                             total.fetch_add(1, std::memory_order_relaxed); }); });
+        sched.wait(root);
+        sched.reclaim();
+        HORIZON_CHECK(total.load() == TASKS);
+        std::size_t wrong = 0;
+        for (std::size_t i = 0; i < TASKS; i++)
+            wrong += ran[i].load(std::memory_order_relaxed) != 1;
+        HORIZON_CHECK(wrong == 0);
+    }
+
+    // counts how many tasks were freed, copies and moved-from ones do not count
+    struct counted
+    {
+        std::atomic<std::size_t> *M_freed;
+        bool M_owner = true;
+
+        explicit counted(std::atomic<std::size_t> *freed) : M_freed(freed) {}
+        counted(const counted &other) : M_freed(other.M_freed) {}
+        counted(counted &&other) noexcept : M_freed(other.M_freed) { other.M_owner = false; }
+        ~counted()
+        {
+            if (this->M_owner)
+                this->M_freed->fetch_add(1, std::memory_order_relaxed);
+        }
+        void operator()() const {}
+    };
+
+    void reclaiming()
+    {
+        std::atomic<std::size_t> freed(0);
+        {
+            hd::scheduler sched(THREADS);
+            for (int batch = 0; batch < 3; batch++)
+            {
+                for (int i = 0; i < 100; i++)
+                    sched.spawn(counted(&freed));
+                // not submitted, reclaim has to leave it alone
+                hd::task *held = sched.create(counted(&freed));
+                sched.reclaim();
+                // this batch, and the held task of the one before
+                HORIZON_CHECK(freed.load() == static_cast<std::size_t>(batch) * 101 + 100);
+                HORIZON_CHECK(!held->is_done());
+                sched.submit(held);
+                sched.wait(held);
+                HORIZON_CHECK(held->is_done());
+            }
+            sched.reclaim();
+            HORIZON_CHECK(freed.load() == 303);
+        }
+        HORIZON_CHECK(freed.load() == 303);
+    }
+}
+
+int main()
+{
+    deque_under_contention();
+    deterministic_mode();
+    dependencies();
+    parallel_for_coverage();
+    stealing();
+    reclaiming();
+    return horizon::horizon_tests::result();
+}
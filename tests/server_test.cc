@@ -0,0 +1,135 @@
+/**
+ * @file server_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// A `--server` in a child process gets the requests `--client` would send: `--trace` and `--stats` twice each, every one of
+// them must compile, and the server must still be there to be stopped at the end. Then what the server does between requests,
+// in this process: the string table is emptied once the cache has dropped every file that used it
+
+#include "./test.hh"
+
+#if defined _WIN32 || defined _WIN64 || defined __CYGWIN__
+int main()
+{
+    return EXIT_SUCCESS; // no `--server` there
+}
+#else
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/driver/driver.hh"
+#include "../src/misc/options.hh"
+#include "../src/parser/ast/string_table.hh"
+#include "../src/server/server.hh"
+
+namespace
+{
+    constexpr const char *SOCKET = "server_test.sock";
+    constexpr const char *SOURCE = "server_test.hr";
+
+    int request(std::initializer_list<const char *> args)
+    {
+        horizon::horizon_deps::vector<horizon::horizon_deps::string> forwarded;
+        for (const char *arg : args)
+            forwarded.add(horizon::horizon_deps::string(arg));
+        forwarded.add(horizon::horizon_deps::string(SOURCE));
+        return horizon::horizon_server::forward(SOCKET, forwarded);
+    }
+
+    bool exists(const char *loc)
+    {
+        struct stat st;
+        return ::stat(loc, &st) == 0;
+    }
+
+    void strings_follow_the_cache()
+    {
+        namespace hdr = horizon::horizon_driver;
+        horizon::horizon_parser::string_table &strings = horizon::horizon_parser::string_table::instance();
+        char *argv[] = {const_cast<char *>("horizon"), const_cast<char *>("--emit=none"), const_cast<char *>(SOURCE), nullptr};
+        horizon::horizon_deps::sptr<horizon::horizon_misc::options> opts = horizon::horizon_misc::parse_options(3, argv);
+        HORIZON_CHECK(opts);
+        if (!opts)
+            return;
+
+        hdr::compile_cache cache;
+        HORIZON_CHECK(hdr::run(*opts, &cache) == EXIT_SUCCESS);
+        std::uint32_t count = strings.count();
+        HORIZON_CHECK(count > 0 && cache.length() == 1);
+        // the cached AST keeps its strings for KEEP_REQUESTS requests that do not compile it
+        bool kept = true;
+        for (std::size_t i = 0; i < hdr::compile_cache::KEEP_REQUESTS; i++)
+        {
+            cache.next_request();
+            kept = kept && cache.length() == 1 && strings.count() == count;
+        }
+        HORIZON_CHECK(kept);
+        cache.next_request();
+        HORIZON_CHECK(cache.length() == 0 && strings.count() == 0);
+
+        // and the table fills up again from the start
+        HORIZON_CHECK(hdr::run(*opts, &cache) == EXIT_SUCCESS);
+        HORIZON_CHECK(cache.misses() == 1 && cache.length() == 1 && strings.count() == count);
+        cache.next_request();
+        HORIZON_CHECK(strings.count() == count);
+    }
+}
+
+int main()
+{
+    std::FILE *src = std::fopen(SOURCE, "wb");
+    HORIZON_CHECK(src);
+    if (!src)
+        return horizon::horizon_tests::result();
+    std::fputs("func main(): int32 {\n    int32: i = 1;\n    return i;\n}\n", src);
+    std::fclose(src);
+    ::unlink(SOCKET);
+
+    pid_t server = ::fork();
+    if (server == 0)
+    {
+        // the server's log is not part of the test
+        int null = ::open("/dev/null", O_WRONLY);
+        ::dup2(null, STDERR_FILENO);
+        ::_exit(horizon::horizon_server::serve(SOCKET));
+    }
+    HORIZON_CHECK(server > 0);
+    if (server <= 0)
+        return horizon::horizon_tests::result();
+    for (int i = 0; i < 500 && !exists(SOCKET); i++)
+        ::usleep(10000);
+
+    HORIZON_CHECK(request({"--emit=none", "--trace=server_trace_1.json"}) == EXIT_SUCCESS);
+    HORIZON_CHECK(exists("server_trace_1.json"));
+    HORIZON_CHECK(request({"--emit=none", "--trace=server_trace_2.json"}) == EXIT_SUCCESS);
+    HORIZON_CHECK(exists("server_trace_2.json"));
+    HORIZON_CHECK(request({"--emit=none", "--jobs=4", "--stats=json"}) == EXIT_SUCCESS);
+    HORIZON_CHECK(request({"--emit=none", "--jobs=4", "--stats=json"}) == EXIT_SUCCESS);
+    HORIZON_CHECK(request({"--emit=none", "--jobs=4", "--trace=server_trace_3.json", "--stats"}) == EXIT_SUCCESS);
+    // -1 would mean the server went away
+    HORIZON_CHECK(request({"--emit=none"}) == EXIT_SUCCESS);
+
+    ::kill(server, SIGTERM);
+    int status = 0;
+    HORIZON_CHECK(::waitpid(server, &status, 0) == server);
+    HORIZON_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    HORIZON_CHECK(!exists(SOCKET));
+
+    strings_follow_the_cache();
+
+    std::remove("server_trace_1.json");
+    std::remove("server_trace_2.json");
+    std::remove("server_trace_3.json");
+    std::remove(SOURCE);
+    return horizon::horizon_tests::result();
+}
+#endif
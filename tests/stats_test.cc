@@ -0,0 +1,42 @@
+/**
+ * @file stats_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// Several `--stats` sessions in one process, as `--server` runs them: every session counts from zero into counters of its own
+
+#include <thread>
+
+#include "../src/misc/stats.hh"
+#include "./test.hh"
+
+namespace
+{
+    constexpr std::size_t LOOKUPS = static_cast<std::size_t>(horizon::horizon_misc::stat_counter::STAT_HASHTABLE_LOOKUPS);
+
+    void count_session(const std::uint64_t &n)
+    {
+        horizon::horizon_misc::start_stats();
+        HORIZON_CHECK(horizon::horizon_misc::is_counting());
+        horizon::horizon_misc::count(horizon::horizon_misc::stat_counter::STAT_HASHTABLE_LOOKUPS, n);
+        HORIZON_CHECK(horizon::horizon_misc::this_thread_stats().M_counters[LOOKUPS] == n);
+        std::thread other([n]()
+                          {
+                              horizon::horizon_misc::count(horizon::horizon_misc::stat_counter::STAT_HASHTABLE_LOOKUPS, n);
+                              horizon::horizon_misc::count_ast_node("ast_test_node");
+                              HORIZON_CHECK(horizon::horizon_misc::this_thread_stats().M_counters[LOOKUPS] == n); });
+        other.join();
+        horizon::horizon_misc::finish_stats(true);
+        HORIZON_CHECK(!horizon::horizon_misc::is_counting());
+    }
+}
+
+int main()
+{
+    count_session(3);
+    // the counters of the first session are gone, the main thread must not count into them
+    count_session(5);
+    count_session(7);
+    return horizon::horizon_tests::result();
+}
@@ -0,0 +1,228 @@
+/**
+ * @file string_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// The small-string buffer of horizon_deps::string around its 23/24 character boundary: appends moving inline strings to the
+// heap, copies and moves of inline strings keeping their own buffer, reserve, and hash() agreeing with str_view::hash().
+// A counting_allocator shows which operations reach the heap and that nothing is left behind
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../deps/allocator/allocator.hh"
+#include "../deps/string/str_view.hh"
+#include "../deps/string/string.hh"
+#include "./test.hh"
+
+namespace
+{
+    namespace hd = horizon::horizon_deps;
+
+    constexpr std::size_t SSO = hd::string::SSO_CAPACITY;
+
+    const char *const LETTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    // the characters are in the string object itself
+    bool is_inline(const hd::string &str)
+    {
+        const char *begin = reinterpret_cast<const char *>(&str);
+        return str.c_str() >= begin && str.c_str() < begin + sizeof(hd::string);
+    }
+
+    bool holds(const hd::string &str, const std::size_t &len)
+    {
+        return str.length() == len && std::memcmp(str.c_str(), LETTERS, len) == 0 && str.c_str()[len] == 0;
+    }
+
+    void boundary()
+    {
+        hd::counting_allocator counter;
+        {
+            hd::allocator_scope scope(counter);
+            hd::string longest_inline(LETTERS, LETTERS + SSO);
+            HORIZON_CHECK(is_inline(longest_inline) && longest_inline.capacity() == SSO && holds(longest_inline, SSO));
+            HORIZON_CHECK(counter.stats().M_allocs == 0);
+            hd::string shortest_heap(LETTERS, LETTERS + SSO + 1);
+            HORIZON_CHECK(!is_inline(shortest_heap) && shortest_heap.capacity() == SSO + 1 && holds(shortest_heap, SSO + 1));
+            HORIZON_CHECK(counter.stats().M_allocs == 1);
+
+            // assigning something short to a heap string frees its buffer and goes back inline
+            shortest_heap = "abc";
+            HORIZON_CHECK(is_inline(shortest_heap) && holds(shortest_heap, 3));
+            HORIZON_CHECK(counter.stats().M_live == 0);
+        }
+        HORIZON_CHECK(counter.stats().M_live == 0);
+    }
+
+    void appends()
+    {
+        hd::counting_allocator counter;
+        {
+            hd::allocator_scope scope(counter);
+
+            // by a character: 22 to 23 stays inline, 23 to 24 moves to the heap
+            hd::string by_char(LETTERS, LETTERS + SSO - 1);
+            by_char.append(LETTERS[SSO - 1]);
+            HORIZON_CHECK(is_inline(by_char) && holds(by_char, SSO));
+            HORIZON_CHECK(counter.stats().M_allocs == 0);
+            by_char.append(LETTERS[SSO]);
+            HORIZON_CHECK(!is_inline(by_char) && holds(by_char, SSO + 1) && by_char.capacity() > SSO);
+            HORIZON_CHECK(counter.stats().M_allocs == 1);
+            // and grows geometrically from there
+            for (std::size_t i = SSO + 1; i < 52; i++)
+                by_char += LETTERS[i];
+            HORIZON_CHECK(holds(by_char, 52));
+            HORIZON_CHECK(counter.stats().M_allocs + counter.stats().M_reallocs <= 3);
+
+            // by a C string, another string and a view, each crossing the boundary in one step
+            hd::string by_c_str(LETTERS, LETTERS + 20);
+            by_c_str.append("uvwx");
+            HORIZON_CHECK(!is_inline(by_c_str) && holds(by_c_str, SSO + 1));
+
+            hd::string by_string(LETTERS, LETTERS + 10);
+            by_string.append(hd::string(LETTERS + 10, LETTERS + 14));
+            HORIZON_CHECK(is_inline(by_string) && holds(by_string, 14));
+            by_string += hd::string(LETTERS + 14, LETTERS + 30);
+            HORIZON_CHECK(!is_inline(by_string) && holds(by_string, 30));
+
+            hd::string by_view(LETTERS, LETTERS + SSO);
+            by_view.append(hd::str_view(LETTERS + SSO, 1));
+            HORIZON_CHECK(!is_inline(by_view) && holds(by_view, SSO + 1));
+
+            // appending an inline string to itself, the source moves while it is copied
+            hd::string doubled("abcdefghijkl");
+            doubled.append(doubled);
+            HORIZON_CHECK(!is_inline(doubled) && doubled == "abcdefghijklabcdefghijkl");
+            hd::string own_view("abcdefghijkl");
+            own_view.append(own_view.view());
+            HORIZON_CHECK(!is_inline(own_view) && own_view == "abcdefghijklabcdefghijkl");
+            hd::string own_c_str("abcdefghijkl");
+            own_c_str.append(own_c_str.c_str());
+            HORIZON_CHECK(!is_inline(own_c_str) && own_c_str == "abcdefghijklabcdefghijkl");
+        }
+        HORIZON_CHECK(counter.stats().M_live == 0);
+    }
+
+    void copies_and_moves()
+    {
+        hd::counting_allocator counter;
+        {
+            hd::allocator_scope scope(counter);
+            hd::string inline_src(LETTERS, LETTERS + SSO);
+            hd::string heap_src(LETTERS, LETTERS + SSO + 1);
+            std::size_t allocs = counter.stats().M_allocs;
+
+            // a copy of an inline string has a buffer of its own
+            hd::string copy(inline_src);
+            HORIZON_CHECK(is_inline(copy) && copy.c_str() != inline_src.c_str() && holds(copy, SSO));
+            copy[0] = '#';
+            HORIZON_CHECK(holds(inline_src, SSO));
+            hd::string assigned(heap_src);
+            assigned = inline_src;
+            HORIZON_CHECK(is_inline(assigned) && holds(assigned, SSO));
+            HORIZON_CHECK(counter.stats().M_allocs == allocs + 1);
+
+            hd::string heap_copy(heap_src);
+            HORIZON_CHECK(!is_inline(heap_copy) && heap_copy.c_str() != heap_src.c_str() && holds(heap_copy, SSO + 1));
+
+            // moving an inline string copies its characters, the moved-to string points at its own buffer
+            hd::string moved(std::move(copy));
+            HORIZON_CHECK(is_inline(moved) && moved == hd::string("#bcdefghijklmnopqrstuvw"));
+            HORIZON_CHECK(copy.is_null() && copy.length() == 0);
+            hd::string move_assigned(heap_src);
+            move_assigned = std::move(moved);
+            HORIZON_CHECK(is_inline(move_assigned) && move_assigned.length() == SSO && move_assigned[0] == '#');
+            HORIZON_CHECK(moved.is_null());
+            // a moved-from string is usable again
+            moved.append('x');
+            HORIZON_CHECK(is_inline(moved) && moved == "x");
+
+            // a heap buffer changes hands without a copy
+            const char *buffer = heap_copy.c_str();
+            allocs = counter.stats().M_allocs;
+            hd::string heap_moved(std::move(heap_copy));
+            HORIZON_CHECK(heap_moved.c_str() == buffer && holds(heap_moved, SSO + 1) && heap_copy.is_null());
+            HORIZON_CHECK(counter.stats().M_allocs == allocs);
+
+            // strings that a vector moves around as it grows still point into themselves afterwards
+            std::vector<hd::string> strings;
+            for (std::size_t len = 0; len <= 40; len++)
+                strings.emplace_back(LETTERS, LETTERS + len);
+            bool kept = true;
+            for (std::size_t len = 0; len <= 40; len++)
+                kept = kept && holds(strings[len], len) && is_inline(strings[len]) == (len <= SSO);
+            HORIZON_CHECK(kept);
+        }
+        HORIZON_CHECK(counter.stats().M_live == 0);
+    }
+
+    void reserving()
+    {
+        hd::counting_allocator counter;
+        {
+            hd::allocator_scope scope(counter);
+
+            // a null string becomes empty, and inline as long as it fits
+            hd::string null;
+            null.reserve(SSO);
+            HORIZON_CHECK(!null.is_null() && null.length() == 0 && is_inline(null) && null.c_str()[0] == 0);
+            HORIZON_CHECK(counter.stats().M_allocs == 0);
+
+            hd::string str(LETTERS, LETTERS + 10);
+            str.reserve(5);
+            str.reserve(SSO);
+            HORIZON_CHECK(is_inline(str) && str.capacity() == SSO && holds(str, 10));
+            HORIZON_CHECK(counter.stats().M_allocs == 0);
+
+            // one past the inline capacity moves it to the heap with its characters
+            str.reserve(SSO + 1);
+            HORIZON_CHECK(!is_inline(str) && str.capacity() >= SSO + 1 && holds(str, 10));
+            HORIZON_CHECK(counter.stats().M_allocs == 1);
+            const char *buffer = str.c_str();
+            std::size_t cap = str.capacity();
+            // filling up to the capacity reserved does not move it again
+            for (std::size_t i = 10; i < cap && i < 52; i++)
+                str.append(LETTERS[i]);
+            HORIZON_CHECK(str.c_str() == buffer);
+            str.reserve(1000);
+            HORIZON_CHECK(str.capacity() >= 1000 && str.length() == (cap < 52 ? cap : 52));
+            HORIZON_CHECK(std::memcmp(str.c_str(), LETTERS, str.length()) == 0 && str.c_str()[str.length()] == 0);
+        }
+        HORIZON_CHECK(counter.stats().M_live == 0);
+    }
+
+    void hashing()
+    {
+        // views into a longer buffer, so the bytes after the view's end differ from the string's NUL
+        bool equal = true;
+        for (std::size_t len = 0; len <= 52; len++)
+        {
+            hd::string str(LETTERS, LETTERS + len);
+            hd::str_view view(LETTERS, len);
+            equal = equal && str.hash() == view.hash() && str.hash() == static_cast<hd::str_view>(str).hash();
+            equal = equal && std::hash<hd::string>()(str) == std::hash<hd::string>()(view);
+        }
+        HORIZON_CHECK(equal);
+
+        // an inline string and a heap one with the same characters hash alike
+        hd::string grown(LETTERS, LETTERS + SSO);
+        grown.reserve(100);
+        HORIZON_CHECK(grown.hash() == hd::string(LETTERS, LETTERS + SSO).hash());
+        HORIZON_CHECK(hd::string(LETTERS, LETTERS + SSO).hash() != hd::string(LETTERS, LETTERS + SSO + 1).hash());
+    }
+}
+
+int main()
+{
+    boundary();
+    appends();
+    copies_and_moves();
+    reserving();
+    hashing();
+    return horizon::horizon_tests::result();
+}
@@ -0,0 +1,40 @@
+/**
+ * @file test.hh
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+#ifndef HORIZON_TESTS_TEST_HH
+#define HORIZON_TESTS_TEST_HH
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace horizon
+{
+    namespace horizon_tests
+    {
+        inline int failures = 0;
+
+        inline void check(const bool &ok, const char *what, const char *file, const int &line)
+        {
+            if (ok)
+                return;
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+            failures++;
+        }
+
+        /**
+         * @brief What `main` of a test returns
+         */
+        inline int result()
+        {
+            return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+}
+
+// keeps going after a failed check, so one run reports every failure
+#define HORIZON_CHECK(cond) horizon::horizon_tests::check(static_cast<bool>(cond), #cond, __FILE__, __LINE__)
+
+#endif
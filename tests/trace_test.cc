@@ -0,0 +1,57 @@
+/**
+ * @file trace_test.cc
+ * @license This file is licensed under the GNU GENERAL PUBLIC LICENSE Version 3, 29 June 2007. You may obtain a copy of this license at https://www.gnu.org/licenses/gpl-3.0.en.html.
+ * @author Tushar Chaurasia (Dark-CodeX)
+ */
+
+// Several trace sessions in one process, as `--server` runs them: threads that recorded into a finished session must start
+// a new buffer instead of writing to the freed one
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "../src/misc/load_file.hh"
+#include "../src/misc/trace.hh"
+#include "./test.hh"
+
+namespace
+{
+    void record_session(const char *loc, const char *detail)
+    {
+        horizon::horizon_misc::start_trace();
+        HORIZON_CHECK(horizon::horizon_misc::is_tracing());
+        {
+            horizon::horizon_misc::trace_scope scope("main", detail, std::strlen(detail));
+        }
+        std::thread other([detail]()
+                          { horizon::horizon_misc::trace_scope scope("other", detail, std::strlen(detail)); });
+        other.join();
+        HORIZON_CHECK(horizon::horizon_misc::finish_trace(loc));
+        HORIZON_CHECK(!horizon::horizon_misc::is_tracing());
+
+        horizon::horizon_deps::sptr<horizon::horizon_misc::HR_FILE> file = horizon::horizon_misc::load_file(loc);
+        HORIZON_CHECK(file);
+        if (!file)
+            return;
+        const char *json = file->M_content.c_str();
+        HORIZON_CHECK(std::strstr(json, "\"traceEvents\""));
+        HORIZON_CHECK(std::strstr(json, "\"name\":\"main\""));
+        HORIZON_CHECK(std::strstr(json, "\"name\":\"other\""));
+        HORIZON_CHECK(std::strstr(json, detail));
+        std::remove(loc);
+    }
+}
+
+int main()
+{
+    record_session("trace_test_1.json", "first-session");
+    // the main thread recorded into the first session's buffer, which is gone now
+    record_session("trace_test_2.json", "second-session");
+    record_session("trace_test_3.json", "third-session");
+    {
+        // not tracing, nothing is recorded
+        horizon::horizon_misc::trace_scope scope("ignored");
+    }
+    return horizon::horizon_tests::result();
+}